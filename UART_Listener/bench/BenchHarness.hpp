@@ -0,0 +1,195 @@
+/**
+ ****************************************************************************************
+ * @file   BenchHarness.hpp
+ * @brief  Minimal benchmark harness and realistic UART workload generation.
+ *
+ * @author Patrik Neunteufel
+ * @date   Oct 2026
+ ****************************************************************************************
+ */
+#pragma once
+
+#include "UART.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <iomanip>
+#include <ostream>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace uart_listener::bench
+{
+    /**
+     * @brief One benchmark measurement.
+     */
+    struct BenchResult
+    {
+        std::string name;
+        uint64_t    iterations = 0;   ///< operations executed
+        double      seconds = 0.0;    ///< wall time of the measured run
+        uint64_t    bytes = 0;        ///< payload bytes processed (0 = n/a)
+
+        double nsPerOp() const { return iterations ? seconds * 1e9 / static_cast<double>(iterations) : 0.0; }
+        double opsPerSec() const { return seconds > 0.0 ? static_cast<double>(iterations) / seconds : 0.0; }
+        double mbPerSec() const { return seconds > 0.0 ? static_cast<double>(bytes) / seconds / 1e6 : 0.0; }
+    };
+
+    struct BenchOptions
+    {
+        std::chrono::milliseconds minTime{ 500 };
+        std::string               nameFilter;  ///< run only cases containing this substring
+    };
+
+    /**
+     * @brief Registered benchmark case.
+     */
+    struct BenchCase
+    {
+        std::string                                         name;
+        std::function<BenchResult(const BenchOptions& opt)> run;
+    };
+
+    /**
+     * @brief Run 'op' in batches until minTime has elapsed.
+     * @param op Performs one operation and returns the number of payload bytes it handled
+     */
+    template<typename Op>
+    BenchResult runTimed(const std::string& name, const BenchOptions& opt, Op&& op)
+    {
+        using Clock = std::chrono::steady_clock;
+
+        // Warm-up: caches, allocator, branch predictors
+        for (int i = 0; i < 1000; ++i)
+        {
+            (void)op();
+        }
+
+        BenchResult result;
+        result.name = name;
+
+        uint64_t   batch = 64;
+        const auto start = Clock::now();
+        auto       now = start;
+
+        while (now - start < opt.minTime)
+        {
+            for (uint64_t i = 0; i < batch; ++i)
+            {
+                result.bytes += op();
+            }
+            result.iterations += batch;
+            now = Clock::now();
+            batch = std::min<uint64_t>(batch * 2, 1u << 16);
+        }
+
+        result.seconds = std::chrono::duration<double>(now - start).count();
+        return result;
+    }
+
+    /**
+     * @brief Chunk sizes as returned by USB-serial drivers.
+     *
+     * Most ReadFile calls return a handful of bytes (one USB frame, or the tail of a
+     * burst); a smaller share returns full driver buffers under load.
+     */
+    class ChunkSizeDistribution
+    {
+    public:
+        explicit ChunkSizeDistribution(uint32_t seed = 42)
+            : m_rng(seed),
+              m_bucket({ 20.0, 30.0, 30.0, 15.0, 5.0 })
+        {
+        }
+
+        size_t next()
+        {
+            static constexpr size_t kLo[] = { 1, 2, 9, 65, 257 };
+            static constexpr size_t kHi[] = { 1, 8, 64, 256, 512 };
+
+            const size_t b = static_cast<size_t>(m_bucket(m_rng));
+            std::uniform_int_distribution<size_t> size(kLo[b], kHi[b]);
+            return size(m_rng);
+        }
+
+    private:
+        std::mt19937                  m_rng;
+        std::discrete_distribution<>  m_bucket;
+    };
+
+    /**
+     * @brief Generate captured packets: ASCII text lines mixed with binary frames.
+     */
+    inline std::vector<Packet> makePackets(size_t count, uint32_t seed = 42)
+    {
+        ChunkSizeDistribution sizes(seed);
+        std::mt19937          rng(seed + 1);
+        std::uniform_int_distribution<int> byteDist(0, 255);
+        std::uniform_int_distribution<int> textDist(32, 126);
+
+        std::vector<Packet> packets(count);
+        for (size_t i = 0; i < count; ++i)
+        {
+            Packet& pkt = packets[i];
+            pkt.channel = (i % 3 == 0) ? Channel::TX : Channel::RX;
+            pkt.timestamp = "12:34:56.789";
+
+            const size_t size = sizes.next();
+            const bool   text = (i % 4) != 0;
+            pkt.data.resize(size);
+            for (size_t j = 0; j < size; ++j)
+            {
+                pkt.data[j] = static_cast<uint8_t>(text ? textDist(rng) : byteDist(rng));
+            }
+            if (text && size >= 2)
+            {
+                pkt.data[size - 2] = '\r';
+                pkt.data[size - 1] = '\n';
+            }
+        }
+        return packets;
+    }
+
+    inline void writeJsonString(std::ostream& out, const std::string& s)
+    {
+        out << '"';
+        for (char c : s)
+        {
+            if (c == '"' || c == '\\')
+            {
+                out << '\\';
+            }
+            out << c;
+        }
+        out << '"';
+    }
+
+    /**
+     * @brief Machine-readable results for regression tracking between releases.
+     */
+    inline void writeJson(std::ostream& out, const std::vector<BenchResult>& results, const std::string& timestamp)
+    {
+        out << "{\n  \"schema\": 1,\n  \"timestamp\": ";
+        writeJsonString(out, timestamp);
+        out << ",\n  \"results\": [\n";
+        out << std::fixed << std::setprecision(3);
+
+        for (size_t i = 0; i < results.size(); ++i)
+        {
+            const BenchResult& r = results[i];
+            out << "    {\"name\": ";
+            writeJsonString(out, r.name);
+            out << ", \"iterations\": " << r.iterations
+                << ", \"seconds\": " << r.seconds
+                << ", \"ns_per_op\": " << r.nsPerOp()
+                << ", \"ops_per_s\": " << r.opsPerSec()
+                << ", \"bytes\": " << r.bytes
+                << ", \"mb_per_s\": " << r.mbPerSec() << "}"
+                << (i + 1 < results.size() ? ",\n" : "\n");
+        }
+        out << "  ]\n}\n";
+    }
+}
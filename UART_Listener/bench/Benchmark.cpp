@@ -0,0 +1,1045 @@
+/**
+ ****************************************************************************************
+ * @file   Benchmark.cpp
+ * @brief  Benchmarks for the UART Listener hot paths.
+ *
+ *         Usage:
+ *           uart_listener_bench [--json PATH|-] [--filter SUBSTR] [--min-time MS]
+ *                               [--loopback WRITE_PORT READ_PORT [--baud RATE]]
+ *
+ *         --loopback runs an end-to-end throughput test through a virtual null-modem
+ *         pair (e.g. com0com COM20 <-> COM21): bytes written to WRITE_PORT are read back
+ *         by the real serialReaderThread and PacketQueue.
+ *
+ * @author Patrik Neunteufel
+ * @date   Oct 2026
+ ****************************************************************************************
+ */
+
+#include "BenchHarness.hpp"
+
+#include "Analyze.hpp"
+#include "Cli.hpp"
+#include "Columnar.hpp"
+#include "Convert.hpp"
+#include "DataFormat.hpp"
+#include "DurableLog.hpp"
+#include "Echo.hpp"
+#include "FileWriter.hpp"
+#include "FormatPool.hpp"
+#include "Globals.hpp"
+#include "LogLine.hpp"
+#include "OutputPipeline.hpp"
+#include "RepeatCollapser.hpp"
+#include "SqliteLog.hpp"
+#include "Time.hpp"
+#include "Transaction.hpp"
+#include "UART.hpp"
+#include "Worker.hpp"
+
+#include <atomic>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <thread>
+
+using namespace uart_listener;
+using namespace uart_listener::bench;
+
+namespace
+{
+    constexpr size_t kPacketPoolSize = 4096;
+
+    const std::vector<Packet>& packetPool()
+    {
+        static const std::vector<Packet> pool = makePackets(kPacketPoolSize);
+        return pool;
+    }
+
+    // ============================================================================
+    // Formatting
+    // ============================================================================
+
+    template<typename Fn>
+    BenchCase formatCase(const std::string& name, Fn fn)
+    {
+        return { name, [name, fn](const BenchOptions& opt) {
+            const auto& pool = packetPool();
+            size_t      idx = 0;
+            return runTimed(name, opt, [&]() -> uint64_t {
+                const Packet& pkt = pool[idx++ & (kPacketPoolSize - 1)];
+                std::string   s = fn(pkt.data);
+                return pkt.data.size() + (s.empty() ? 1 : 0);
+            });
+        } };
+    }
+
+    void registerFormatCases(std::vector<BenchCase>& cases)
+    {
+        cases.push_back(formatCase("format.bytesToHex", [](const std::vector<uint8_t>& d) { return bytesToHex(d); }));
+        cases.push_back(formatCase("format.bytesToAscii", [](const std::vector<uint8_t>& d) { return bytesToAscii(d, false); }));
+        cases.push_back(formatCase("format.bytesToAscii.cescape", [](const std::vector<uint8_t>& d) { return bytesToAscii(d, true); }));
+
+        for (size_t f = 0; f < OutputFormatTraits::count(); ++f)
+        {
+            const auto fmt = static_cast<OutputFormat>(f);
+            cases.push_back(formatCase(std::string("formatData.") + OutputFormatTraits::toString(fmt),
+                [fmt](const std::vector<uint8_t>& d) { return formatData(d, fmt); }));
+        }
+    }
+
+    // ============================================================================
+    // Timestamps
+    // ============================================================================
+
+    void registerTimeCases(std::vector<BenchCase>& cases)
+    {
+        cases.push_back({ "time.getTimestampWithMs", [](const BenchOptions& opt) {
+            return runTimed("time.getTimestampWithMs", opt, []() -> uint64_t {
+                std::string ts = getTimestampWithMs();
+                return ts.empty() ? 1 : 0;
+            });
+        } });
+    }
+
+    // ============================================================================
+    // PacketQueue under contention
+    // ============================================================================
+
+    BenchResult runQueueContention(const std::string& name, size_t producers, size_t packetsPerProducer)
+    {
+        PacketQueue           queue;
+        std::atomic<bool>     go{ false };
+        std::vector<std::thread> threads;
+
+        const auto& pool = packetPool();
+        for (size_t p = 0; p < producers; ++p)
+        {
+            threads.emplace_back([&, p]() {
+                while (!go.load())
+                {
+                    std::this_thread::yield();
+                }
+                for (size_t i = 0; i < packetsPerProducer; ++i)
+                {
+                    Packet pkt = pool[(i + p) & (kPacketPoolSize - 1)];
+                    queue.push(std::move(pkt));
+                }
+            });
+        }
+
+        const size_t total = producers * packetsPerProducer;
+        uint64_t     bytes = 0;
+
+        const auto start = std::chrono::steady_clock::now();
+        go.store(true);
+
+        Packet out;
+        for (size_t received = 0; received < total;)
+        {
+            if (queue.pop(out, std::chrono::milliseconds(100)))
+            {
+                bytes += out.data.size();
+                ++received;
+            }
+        }
+        const auto end = std::chrono::steady_clock::now();
+
+        for (auto& t : threads)
+        {
+            t.join();
+        }
+
+        BenchResult r;
+        r.name = name;
+        r.iterations = total;
+        r.bytes = bytes;
+        r.seconds = std::chrono::duration<double>(end - start).count();
+        return r;
+    }
+
+    void registerQueueCases(std::vector<BenchCase>& cases)
+    {
+        for (size_t producers : { 1, 2, 4 })
+        {
+            const std::string name = "queue.push_pop." + std::to_string(producers) + "p1c";
+            cases.push_back({ name, [name, producers](const BenchOptions& opt) {
+                // Scale the packet count so the run lasts roughly minTime
+                const size_t perProducer = static_cast<size_t>(opt.minTime.count()) * 400 / producers;
+                return runQueueContention(name, producers, std::max<size_t>(perProducer, 10'000));
+            } });
+        }
+    }
+
+    // ============================================================================
+    // Log line emission
+    // ============================================================================
+
+    void registerLogCases(std::vector<BenchCase>& cases)
+    {
+        // Log lines only, built by OutputPipeline as in the consumer loop
+        for (LogFormat fmt : { LogFormat::Text, LogFormat::Csv })
+        {
+            const std::string name = std::string("log.") + LogFormatTraits::toString(fmt) + ".memory";
+            cases.push_back({ name, [name, fmt](const BenchOptions& opt) {
+                const auto&        pool = packetPool();
+                OutputPipeline     output(OutputFormat::Ascii, fmt, true, "", "");
+                std::ostringstream out;
+                size_t             idx = 0;
+                return runTimed(name, opt, [&]() -> uint64_t {
+                    const size_t i = idx++ & (kPacketPoolSize - 1);
+                    if (i == 0)
+                    {
+                        out.str(std::string());
+                    }
+                    output.format(pool[i], false, true);
+                    out.write(output.logLine().data(), static_cast<std::streamsize>(output.logLine().size()));
+                    return pool[i].data.size();
+                });
+            } });
+        }
+
+        for (LogFormat fmt : { LogFormat::Text, LogFormat::Csv })
+        {
+            const std::string name = std::string("log.") + LogFormatTraits::toString(fmt) + ".ofstream";
+            cases.push_back({ name, [name, fmt](const BenchOptions& opt) {
+                const auto&    pool = packetPool();
+                OutputPipeline output(OutputFormat::Ascii, fmt, true, "", "");
+
+                const std::string path = "uart_bench_" + std::string(LogFormatTraits::toString(fmt)) + ".tmp";
+                BenchResult       r;
+                {
+                    std::ofstream out(path, std::ios::out | std::ios::trunc);
+                    size_t        idx = 0;
+                    r = runTimed(name, opt, [&]() -> uint64_t {
+                        const size_t i = idx++ & (kPacketPoolSize - 1);
+                        output.format(pool[i], false, true);
+                        out.write(output.logLine().data(), static_cast<std::streamsize>(output.logLine().size()));
+                        return pool[i].data.size();
+                    });
+                }
+                std::remove(path.c_str());
+                return r;
+            } });
+        }
+    }
+
+    // ============================================================================
+    // File writer backends (log lines with periodic flush, raw dumps)
+    // ============================================================================
+
+    void registerFileWriterCases(std::vector<BenchCase>& cases)
+    {
+        for (size_t k = 0; k < FileWriterKindTraits::count(); ++k)
+        {
+            const auto        kind = static_cast<FileWriterKind>(k);
+            const std::string name = std::string("file.") + FileWriterKindTraits::toString(kind) + ".log";
+            cases.push_back({ name, [name, kind](const BenchOptions& opt) {
+                const auto&              pool = packetPool();
+                std::vector<std::string> payloads;
+                for (const auto& pkt : pool)
+                {
+                    payloads.push_back(formatData(pkt.data, OutputFormat::Ascii));
+                }
+
+                FileWriterOptions options;
+                options.kind = kind;
+
+                const std::string path = "uart_bench_file.tmp";
+                BenchResult       r;
+                {
+                    CaptureFile out;
+                    out.open(path, options, true);
+                    size_t idx = 0;
+                    r = runTimed(name, opt, [&]() -> uint64_t {
+                        const size_t i = idx++ & (kPacketPoolSize - 1);
+                        writeLogLine(out, LogFormat::Text, true, pool[i], payloads[i]);
+                        // The consumer flushes every --flush-timeout; at high rates that is every few dozen lines
+                        if ((idx & 63) == 0)
+                        {
+                            out.flush();
+                        }
+                        return payloads[i].size();
+                    });
+                    out.close();
+                }
+                std::remove(path.c_str());
+                return r;
+            } });
+        }
+
+        for (size_t k = 0; k < FileWriterKindTraits::count(); ++k)
+        {
+            const auto        kind = static_cast<FileWriterKind>(k);
+            const std::string name = std::string("file.") + FileWriterKindTraits::toString(kind) + ".raw";
+            cases.push_back({ name, [name, kind](const BenchOptions& opt) {
+                const auto& pool = packetPool();
+
+                FileWriterOptions options;
+                options.kind = kind;
+
+                const std::string path = "uart_bench_raw.tmp";
+                BenchResult       r;
+                {
+                    CaptureFile out;
+                    out.open(path, options, false);
+                    size_t idx = 0;
+                    r = runTimed(name, opt, [&]() -> uint64_t {
+                        const Packet& pkt = pool[idx++ & (kPacketPoolSize - 1)];
+                        out.write(reinterpret_cast<const char*>(pkt.data.data()),
+                                  static_cast<std::streamsize>(pkt.data.size()));
+                        return pkt.data.size();
+                    });
+                    out.close();
+                }
+                std::remove(path.c_str());
+                return r;
+            } });
+        }
+    }
+
+    /**
+     * Same log workload as file.<kind>.log, committed the way the consumer does
+     * with --durable; compare against the file.* cases for the cost of the
+     * checksums and the FlushFileBuffers calls.
+     */
+    void registerDurableCases(std::vector<BenchCase>& cases)
+    {
+        for (const auto kind : { FileWriterKind::Buffered, FileWriterKind::Mapped })
+        {
+            for (const uint32_t intervalMs : { 10u, 100u })
+            {
+                const std::string name = std::string("durable.") + FileWriterKindTraits::toString(kind) + "."
+                                       + std::to_string(intervalMs) + "ms";
+                cases.push_back({ name, [name, kind, intervalMs](const BenchOptions& opt) {
+                    const auto&              pool = packetPool();
+                    std::vector<std::string> payloads;
+                    for (const auto& pkt : pool)
+                    {
+                        payloads.push_back(formatData(pkt.data, OutputFormat::Ascii));
+                    }
+
+                    FileWriterOptions options;
+                    options.kind = kind;
+                    options.durableMs = intervalMs;
+
+                    const std::string path = "uart_bench_durable.tmp";
+                    BenchResult       r;
+                    {
+                        CaptureFile out;
+                        CaptureFile noRaw;
+                        out.open(path, options, true);
+                        GroupCommit commit(intervalMs, out, noRaw, noRaw);
+                        size_t      idx = 0;
+                        r = runTimed(name, opt, [&]() -> uint64_t {
+                            const size_t i = idx++ & (kPacketPoolSize - 1);
+                            writeLogLine(out, LogFormat::Text, true, pool[i], payloads[i]);
+
+                            const auto now = std::chrono::steady_clock::now();
+                            commit.written(now);
+                            commit.poll(now);
+                            return payloads[i].size();
+                        });
+                        commit.commit(true);
+                        out.close();
+                    }
+                    std::remove(path.c_str());
+                    return r;
+                } });
+            }
+        }
+    }
+
+    // ============================================================================
+    // Offline conversion scaling
+    // ============================================================================
+
+    BenchResult runConvert(const std::string& name, const BenchOptions& opt, unsigned threads)
+    {
+        // 32 MB raw dump made of the packet pool, converted to CSV with hex payload
+        static const std::vector<uint8_t> input = [] {
+            std::vector<uint8_t> bytes;
+            while (bytes.size() < 32u * 1024 * 1024)
+            {
+                for (const auto& pkt : packetPool())
+                {
+                    bytes.insert(bytes.end(), pkt.data.begin(), pkt.data.end());
+                }
+            }
+            return bytes;
+        }();
+
+        ConvertOptions options;
+        options.format = ConvertFormat::Csv;
+        options.payload = OutputFormat::Hex;
+        options.threads = threads;
+
+        BenchResult r;
+        r.name = name;
+
+        uint64_t   outputBytes = 0;
+        const auto start = std::chrono::steady_clock::now();
+        auto       now = start;
+        while (now - start < opt.minTime || r.iterations == 0)
+        {
+            convertBuffer(input.data(), input.size(), options, [&](const std::string& text) {
+                outputBytes += text.size();
+                return true;
+            });
+            ++r.iterations;
+            r.bytes += input.size();
+            now = std::chrono::steady_clock::now();
+        }
+        r.seconds = std::chrono::duration<double>(now - start).count();
+        return r;
+    }
+
+    void registerConvertCases(std::vector<BenchCase>& cases)
+    {
+        // Doubling thread counts up to all cores; MB/s should roughly double too
+        const unsigned cores = std::max(1u, std::thread::hardware_concurrency());
+        for (unsigned threads = 1;; threads = std::min(threads * 2, cores))
+        {
+            const std::string name = "convert.csv.hex." + std::to_string(threads) + "t";
+            cases.push_back({ name, [name, threads](const BenchOptions& opt) {
+                return runConvert(name, opt, threads);
+            } });
+            if (threads == cores)
+            {
+                break;
+            }
+        }
+    }
+
+    // ============================================================================
+    // Capture analysis
+    // ============================================================================
+
+    void registerAnalyzeCases(std::vector<BenchCase>& cases)
+    {
+        // 64 KB blocks: the offline path; one counter per byte as the baseline
+        static const std::vector<uint8_t> block = [] {
+            std::vector<uint8_t> bytes;
+            for (const auto& pkt : packetPool())
+            {
+                bytes.insert(bytes.end(), pkt.data.begin(), pkt.data.end());
+            }
+            bytes.resize(64 * 1024);
+            return bytes;
+        }();
+
+        cases.push_back({ "analyze.countBytes.naive", [](const BenchOptions& opt) {
+            ByteHistogram hist{};
+            return runTimed("analyze.countBytes.naive", opt, [&]() -> uint64_t {
+                for (uint8_t b : block)
+                {
+                    ++hist[b];
+                }
+                return block.size() + (hist[0] == UINT64_MAX ? 1 : 0);
+            });
+        } });
+        cases.push_back({ "analyze.countBytes", [](const BenchOptions& opt) {
+            ByteHistogram hist{};
+            return runTimed("analyze.countBytes", opt, [&]() -> uint64_t {
+                countBytes(block.data(), block.size(), hist);
+                return block.size() + (hist[0] == UINT64_MAX ? 1 : 0);
+            });
+        } });
+
+        // Live path: one packet into the channel and window statistics
+        cases.push_back({ "analyze.add", [](const BenchOptions& opt) {
+            const auto&     pool = packetPool();
+            CaptureAnalysis analysis(1000 * 1000, true);
+            size_t          idx = 0;
+            int64_t         time = 0;
+            return runTimed("analyze.add", opt, [&]() -> uint64_t {
+                const Packet& pkt = pool[idx++ & (kPacketPoolSize - 1)];
+                time += 50;
+                analysis.add(pkt.channel, time, pkt.data.data(), pkt.data.size());
+                return pkt.data.size();
+            });
+        } });
+    }
+
+    // ============================================================================
+    // Echo correlation
+    // ============================================================================
+
+    void registerEchoCases(std::vector<BenchCase>& cases)
+    {
+        // Every TX packet comes back on RX; one byte in 64 packets lost to force realignment
+        cases.push_back({ "echo.correlate", [](const BenchOptions& opt) {
+            const auto&      pool = packetPool();
+            PipelineCounters counters;
+            EchoOptions      options;
+            options.enabled = true;
+            EchoCorrelator correlator(options, counters);
+
+            size_t     idx = 0;
+            Packet     tx;
+            Packet     rx;
+            const auto start = std::chrono::steady_clock::now();
+            return runTimed("echo.correlate", opt, [&]() -> uint64_t {
+                const Packet& pkt = pool[idx & (kPacketPoolSize - 1)];
+                tx.channel = Channel::TX;
+                tx.data = pkt.data;
+                tx.readTime = start + std::chrono::microseconds(idx * 100);
+                rx.channel = Channel::RX;
+                rx.data = pkt.data;
+                rx.readTime = tx.readTime + std::chrono::microseconds(50);
+                if ((idx & 63) == 0 && !rx.data.empty())
+                {
+                    rx.data.pop_back();
+                }
+                ++idx;
+                correlator.feed(tx);
+                correlator.feed(rx);
+                return tx.data.size();
+            });
+        } });
+    }
+
+    // ============================================================================
+    // Transaction pairing (--txn)
+    // ============================================================================
+
+    void registerTransactionCases(std::vector<BenchCase>& cases)
+    {
+        // Requests with a one-byte ID, up to 64 in flight, answered out of order;
+        // every 128th request gets no answer and times out
+        cases.push_back({ "txn.pair.id", [](const BenchOptions& opt) {
+            PipelineCounters   counters;
+            TransactionOptions options;
+            options.enabled = true;
+            options.match = TxnMatch::IdBytes;
+            options.idOffset = 1;
+            options.typeLength = 1;
+            options.timeoutMs = 50;
+            TransactionTracker tracker(options, std::nullopt, counters);
+
+            uint32_t   idx = 0;
+            Packet     req;
+            Packet     resp;
+            const auto start = std::chrono::steady_clock::now();
+            req.channel = Channel::TX;
+            req.data = { 0x03, 0x00, 0x10, 0x00, 0x02, 0xC4, 0x0B, 0x00 };
+            resp.channel = Channel::RX;
+            resp.data = { 0x03, 0x00, 0x04, 0x12, 0x34, 0x56, 0x78, 0x00, 0x00 };
+            return runTimed("txn.pair.id", opt, [&]() -> uint64_t {
+                req.data[0] = static_cast<uint8_t>(idx & 7);
+                req.data[1] = static_cast<uint8_t>(idx & 63);
+                req.readTime = start + std::chrono::microseconds(idx * 100);
+                tracker.feed(req);
+
+                const uint32_t answered = idx - 32;   // 32 requests behind, swapped in pairs
+                if (idx >= 32 && (answered & 127) != 0)
+                {
+                    resp.data[1] = static_cast<uint8_t>((answered ^ 1) & 63);
+                    resp.readTime = req.readTime + std::chrono::microseconds(20);
+                    tracker.feed(resp);
+                }
+                ++idx;
+                return req.data.size() + resp.data.size();
+            });
+        } });
+    }
+
+    // ============================================================================
+    // Output pipeline: per-packet configuration branching vs. specialised
+    // ============================================================================
+
+    // Both cases build the console line (colored [RX] tag) and the text log line
+    // for every packet, as the consumer loop does with --rx-color / --tx-color
+    struct LoopConfig
+    {
+        OutputFormat format = OutputFormat::Ascii;
+        LogFormat    logFormat = LogFormat::Text;
+        bool         timestamps = true;
+        std::string  rxColor = "\033[32m";
+        std::string  txColor = "\033[31m";
+    };
+
+    void registerPipelineCases(std::vector<BenchCase>& cases)
+    {
+        // The consumer loop before OutputPipeline: stream per console line,
+        // format switch per packet, escape check per byte
+        cases.push_back({ "pipeline.branching", [](const BenchOptions& opt) {
+            const auto&        pool = packetPool();
+            const LoopConfig   cfg;
+            const std::string  ansiReset = "\033[0m";
+            std::ostringstream console;
+            std::ostringstream log;
+            size_t             idx = 0;
+            return runTimed("pipeline.branching", opt, [&]() -> uint64_t {
+                const size_t i = idx++ & (kPacketPoolSize - 1);
+                if (i == 0)
+                {
+                    console.str(std::string());
+                    log.str(std::string());
+                }
+                const Packet&     pkt = pool[i];
+                const std::string payload = formatData(pkt.data, cfg.format);
+                const char*       tag = channelTag(pkt.channel);
+
+                std::ostringstream consoleLine;
+                if (cfg.timestamps)
+                {
+                    consoleLine << pkt.timestamp << " ";
+                }
+                if (pkt.channel == Channel::RX && !cfg.rxColor.empty())
+                {
+                    consoleLine << cfg.rxColor << tag << ansiReset << " ";
+                }
+                else if (pkt.channel == Channel::TX && !cfg.txColor.empty())
+                {
+                    consoleLine << cfg.txColor << tag << ansiReset << " ";
+                }
+                else
+                {
+                    consoleLine << tag << " ";
+                }
+                consoleLine << payload;
+                console << consoleLine.str() << "\n";
+
+                writeLogLine(log, cfg.logFormat, cfg.timestamps, pkt, payload);
+                return pkt.data.size();
+            });
+        } });
+
+        cases.push_back({ "pipeline.specialized", [](const BenchOptions& opt) {
+            const auto&        pool = packetPool();
+            const LoopConfig   cfg;
+            OutputPipeline     output(cfg.format, cfg.logFormat, cfg.timestamps, cfg.rxColor, cfg.txColor);
+            std::ostringstream console;
+            std::ostringstream log;
+            size_t             idx = 0;
+            return runTimed("pipeline.specialized", opt, [&]() -> uint64_t {
+                const size_t i = idx++ & (kPacketPoolSize - 1);
+                if (i == 0)
+                {
+                    console.str(std::string());
+                    log.str(std::string());
+                }
+                const Packet& pkt = pool[i];
+                output.format(pkt, true, true);
+                console.write(output.consoleLine().data(), static_cast<std::streamsize>(output.consoleLine().size()));
+                log.write(output.logLine().data(), static_cast<std::streamsize>(output.logLine().size()));
+                return pkt.data.size();
+            });
+        } });
+    }
+
+    // ============================================================================
+    // Formatting worker pool (--format-threads)
+    // ============================================================================
+
+    void registerFormatPoolCases(std::vector<BenchCase>& cases)
+    {
+        // Hex console and log lines for every packet, written in order into
+        // memory; compare with pipeline.specialized (same work on one thread)
+        const unsigned cores = std::max(1u, std::thread::hardware_concurrency());
+        for (unsigned threads = 1;; threads = std::min(threads * 2, cores))
+        {
+            const std::string name = "pool.hex." + std::to_string(threads) + "t";
+            cases.push_back({ name, [name, threads](const BenchOptions& opt) {
+                std::vector<std::shared_ptr<const Packet>> shared;
+                for (const auto& pkt : packetPool())
+                {
+                    shared.push_back(std::make_shared<const Packet>(pkt));
+                }
+
+                FormatPool pool(threads, OutputFormat::Hex, LogFormat::Text, true, "\033[32m", "\033[31m", true);
+                uint64_t   written = 0;
+                const auto write = [&](const std::string& console, const std::string& log, size_t,
+                                       std::chrono::steady_clock::time_point) {
+                    written += console.size() + log.size();
+                };
+
+                size_t idx = 0;
+                BenchResult r = runTimed(name, opt, [&]() -> uint64_t {
+                    const auto& pkt = shared[idx++ & (kPacketPoolSize - 1)];
+                    pool.add(pkt, true, true);
+                    if (pool.batchFull())
+                    {
+                        pool.submit(write);
+                        pool.drain(write, false);
+                    }
+                    return pkt->data.size();
+                });
+                pool.submit(write);
+                pool.drain(write, true);
+                return r;
+            } });
+            if (threads == cores)
+            {
+                break;
+            }
+        }
+    }
+
+    // ============================================================================
+    // Repeated-frame collapsing (--collapse-repeats)
+    // ============================================================================
+
+    void registerCollapseCases(std::vector<BenchCase>& cases)
+    {
+        // A 32-byte heartbeat on RX, every 100th frame a pool packet instead;
+        // hex console and log lines written into memory
+        for (bool collapse : { false, true })
+        {
+            const std::string name = collapse ? "collapse.heartbeat.on" : "collapse.heartbeat.off";
+            cases.push_back({ name, [name, collapse](const BenchOptions& opt) {
+                const auto& pool = packetPool();
+                Packet      heartbeat;
+                heartbeat.channel = Channel::RX;
+                heartbeat.timestamp = "12:00:00.000";
+                for (uint8_t b = 0; b < 32; ++b)
+                {
+                    heartbeat.data.push_back(static_cast<uint8_t>(0xA0 + b));
+                }
+
+                CollapseOptions options;
+                options.enabled = true;
+                RepeatCollapser    collapser(options);
+                OutputPipeline     output(OutputFormat::Hex, LogFormat::Text, true, "\033[32m", "\033[31m");
+                std::ostringstream console;
+                std::ostringstream log;
+                const auto         write = [&]() {
+                    console.write(output.consoleLine().data(), static_cast<std::streamsize>(output.consoleLine().size()));
+                    log.write(output.logLine().data(), static_cast<std::streamsize>(output.logLine().size()));
+                };
+                const auto now = std::chrono::steady_clock::now();
+
+                size_t idx = 0;
+                return runTimed(name, opt, [&]() -> uint64_t {
+                    const size_t i = idx++;
+                    if ((i & (kPacketPoolSize - 1)) == 0)
+                    {
+                        console.str(std::string());
+                        log.str(std::string());
+                    }
+                    const Packet& pkt = (i % 100 == 99) ? pool[(i / 100) & (kPacketPoolSize - 1)] : heartbeat;
+                    if (collapse)
+                    {
+                        if (collapser.repeat(pkt, true, true, now))
+                        {
+                            return pkt.data.size();
+                        }
+                        RepeatRun run;
+                        while (collapser.takeRun(run))
+                        {
+                            output.formatRepeat(run, true, true);
+                            write();
+                        }
+                    }
+                    output.format(pkt, true, true);
+                    write();
+                    return pkt.data.size();
+                });
+            } });
+        }
+    }
+
+    // ============================================================================
+    // SQLite log (--log-format sqlite)
+    // ============================================================================
+
+    void registerSqliteCases(std::vector<BenchCase>& cases)
+    {
+        if (!sqliteAvailable())
+        {
+            return;
+        }
+
+        // Inserts as the sink thread does them: one transaction per kCommitRows
+        // rows here, per flush interval in the listener
+        cases.push_back({ "sqlite.insert", [](const BenchOptions& opt) {
+            const auto&       pool = packetPool();
+            const std::string path = "uart_bench_sqlite.tmp";
+            BenchResult       r;
+            {
+                SqliteLog db;
+                db.open(path, "RX COM1", SerialSettings(), "bench", {}, false);
+                size_t idx = 0;
+                r = runTimed("sqlite.insert", opt, [&]() -> uint64_t {
+                    const Packet& pkt = pool[idx++ & (kPacketPoolSize - 1)];
+                    db.append(pkt, std::string());
+                    if (db.pending() >= SqliteLog::kCommitRows)
+                    {
+                        db.commit();
+                    }
+                    return pkt.data.size();
+                });
+                db.close();
+            }
+            for (const char* suffix : { "", "-wal", "-shm" })
+            {
+                std::remove((path + suffix).c_str());
+            }
+            return r;
+        } });
+    }
+
+    void registerColumnarCases(std::vector<BenchCase>& cases)
+    {
+        // Appends as the col sink thread does them; full blocks are encoded and written inline
+        cases.push_back({ "columnar.append", [](const BenchOptions& opt) {
+            const auto&       pool = packetPool();
+            const std::string path = "uart_bench_columnar.tmp";
+            BenchResult       r;
+            {
+                ColumnarWriter writer;
+                writer.open(path, FileWriterOptions(), "RX COM1", SerialSettings(), "bench");
+                size_t idx = 0;
+                r = runTimed("columnar.append", opt, [&]() -> uint64_t {
+                    const Packet& pkt = pool[idx++ & (kPacketPoolSize - 1)];
+                    writer.append(pkt);
+                    return pkt.data.size();
+                });
+                writer.close();
+            }
+            std::remove(path.c_str());
+            return r;
+        } });
+
+        // What a --query-out count reads from a block inside the range: channel,
+        // kind and length columns, no times, no payload
+        cases.push_back({ "columnar.scan.count", [](const BenchOptions& opt) {
+            const auto&       pool = packetPool();
+            const std::string path = "uart_bench_columnar.tmp";
+            {
+                ColumnarWriter writer;
+                writer.open(path, FileWriterOptions(), "RX COM1", SerialSettings(), "bench");
+                for (size_t i = 0; i < 4 * ColumnarWriter::kBlockRows; ++i)
+                {
+                    writer.append(pool[i & (kPacketPoolSize - 1)]);
+                }
+                writer.close();
+            }
+            BenchResult r;
+            {
+                ColumnarReader reader;
+                reader.open(path);
+                const unsigned  columns = columnar::ChannelCol | columnar::Kind | columnar::Length;
+                columnar::Block block;
+                size_t          idx = 0;
+                r = runTimed("columnar.scan.count", opt, [&]() -> uint64_t {
+                    const auto& info = reader.blocks()[idx++ % reader.blocks().size()];
+                    reader.readBlock(info, columns, block);
+                    return reader.columnBytes(info, columns);
+                });
+            }
+            std::remove(path.c_str());
+            return r;
+        } });
+    }
+
+    // ============================================================================
+    // End-to-end loopback (virtual null-modem pair)
+    // ============================================================================
+
+    BenchResult runLoopback(const std::string& writePort, const std::string& readPort, uint32_t baudRate)
+    {
+        BenchResult r;
+        r.name = "e2e.loopback";
+
+        SerialSettings serial;
+        serial.baudRate = baudRate;
+
+        HANDLE hRead = openSerialPortReadOnly("\\\\.\\" + readPort, serial);
+        HANDLE hWrite = openSerialPortWriteOnly("\\\\.\\" + writePort, serial);
+        g_hStopEvent = CreateEvent(nullptr, TRUE, FALSE, nullptr);
+        if (hRead == INVALID_HANDLE_VALUE || hWrite == INVALID_HANDLE_VALUE || g_hStopEvent == NULL)
+        {
+            std::cerr << "Loopback: cannot open " << writePort << " -> " << readPort << "\n";
+            if (hRead != INVALID_HANDLE_VALUE) CloseHandle(hRead);
+            if (hWrite != INVALID_HANDLE_VALUE) CloseHandle(hWrite);
+            return r;
+        }
+
+        // 2 seconds of wire time, at least 64 KB
+        const size_t total = std::max<size_t>(65536, baudRate / 10 * 2);
+        std::vector<uint8_t> payload(total);
+        std::mt19937         rng(7);
+        for (auto& b : payload)
+        {
+            b = static_cast<uint8_t>(rng());
+        }
+
+        // The reader owns hRead; a lost port ends the run instead of reconnecting
+        ReaderOptions readerOptions;
+        readerOptions.serial = serial;
+        readerOptions.reconnectMaxMs = 0;
+        std::thread reader(serialReaderThread, hRead, Channel::RX, readerOptions);
+        const auto  start = std::chrono::steady_clock::now();
+
+        std::thread writer([&]() {
+            constexpr size_t kChunk = 4096;
+            for (size_t off = 0; off < total; off += kChunk)
+            {
+                DWORD written = 0;
+                const DWORD n = static_cast<DWORD>(std::min(kChunk, total - off));
+                if (!WriteFile(hWrite, payload.data() + off, n, &written, nullptr) || written != n)
+                {
+                    std::cerr << "Loopback: write error\n";
+                    break;
+                }
+            }
+        });
+
+        size_t received = 0;
+        size_t mismatches = 0;
+        auto   lastData = std::chrono::steady_clock::now();
+        Packet pkt;
+
+        while (received < total && std::chrono::steady_clock::now() - lastData < std::chrono::seconds(3))
+        {
+            if (!g_packetQueue.pop(pkt, std::chrono::milliseconds(100)))
+            {
+                continue;
+            }
+            if (pkt.kind != PacketKind::Data)
+            {
+                std::cerr << "Loopback: " << eventMessage(pkt) << "\n";
+                continue;
+            }
+            for (uint8_t b : pkt.data)
+            {
+                if (received < total && payload[received] != b)
+                {
+                    ++mismatches;
+                }
+                ++received;
+            }
+            ++r.iterations;
+            lastData = std::chrono::steady_clock::now();
+        }
+        const auto end = std::chrono::steady_clock::now();
+
+        writer.join();
+        g_stopRequested.store(true);
+        SetEvent(g_hStopEvent);
+        g_packetQueue.notifyStop();
+        reader.join();
+
+        CloseHandle(hWrite);
+        CloseHandle(g_hStopEvent);
+        g_hStopEvent = NULL;
+
+        r.bytes = received;
+        r.seconds = std::chrono::duration<double>(end - start).count();
+
+        if (received != total || mismatches != 0)
+        {
+            std::cerr << "Loopback: received " << received << " of " << total
+                      << " bytes, " << mismatches << " mismatches\n";
+        }
+        return r;
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    BenchOptions opt;
+    std::string  jsonPath;
+    std::string  loopWrite;
+    std::string  loopRead;
+    uint32_t     baudRate = 3000000;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        const std::string arg = toLower(argv[i]);
+        if (arg == "--json" && i + 1 < argc)
+        {
+            jsonPath = argv[++i];
+        }
+        else if (arg == "--filter" && i + 1 < argc)
+        {
+            opt.nameFilter = argv[++i];
+        }
+        else if (arg == "--min-time" && i + 1 < argc)
+        {
+            opt.minTime = std::chrono::milliseconds(std::stoul(argv[++i]));
+        }
+        else if (arg == "--loopback" && i + 2 < argc)
+        {
+            loopWrite = normalizePortToCOM(argv[++i]);
+            loopRead = normalizePortToCOM(argv[++i]);
+        }
+        else if (arg == "--baud" && i + 1 < argc)
+        {
+            baudRate = static_cast<uint32_t>(std::stoul(argv[++i]));
+        }
+        else
+        {
+            std::cerr << "Usage: uart_listener_bench [--json PATH|-] [--filter SUBSTR] [--min-time MS]\n"
+                      << "                           [--loopback WRITE_PORT READ_PORT [--baud RATE]]\n";
+            return 1;
+        }
+    }
+
+    std::vector<BenchCase> cases;
+    registerFormatCases(cases);
+    registerTimeCases(cases);
+    registerQueueCases(cases);
+    registerLogCases(cases);
+    registerFileWriterCases(cases);
+    registerDurableCases(cases);
+    registerConvertCases(cases);
+    registerAnalyzeCases(cases);
+    registerEchoCases(cases);
+    registerTransactionCases(cases);
+    registerPipelineCases(cases);
+    registerFormatPoolCases(cases);
+    registerCollapseCases(cases);
+    registerSqliteCases(cases);
+    registerColumnarCases(cases);
+
+    if (!loopWrite.empty())
+    {
+        cases.push_back({ "e2e.loopback", [&](const BenchOptions&) {
+            return runLoopback(loopWrite, loopRead, baudRate);
+        } });
+    }
+
+    std::vector<BenchResult> results;
+    std::cout << std::left << std::setw(36) << "benchmark" << std::right
+              << std::setw(14) << "ns/op" << std::setw(16) << "ops/s" << std::setw(12) << "MB/s" << "\n";
+
+    for (const auto& c : cases)
+    {
+        if (!opt.nameFilter.empty() && c.name.find(opt.nameFilter) == std::string::npos)
+        {
+            continue;
+        }
+
+        BenchResult r = c.run(opt);
+        std::cout << std::left << std::setw(36) << r.name << std::right << std::fixed
+                  << std::setprecision(1) << std::setw(14) << r.nsPerOp()
+                  << std::setprecision(0) << std::setw(16) << r.opsPerSec()
+                  << std::setprecision(2) << std::setw(12) << r.mbPerSec() << "\n";
+        results.push_back(std::move(r));
+    }
+
+    if (!jsonPath.empty())
+    {
+        const std::string timestamp = getTimestampFileSafe();
+        if (jsonPath == "-")
+        {
+            writeJson(std::cout, results, timestamp);
+        }
+        else
+        {
+            std::ofstream out(jsonPath);
+            if (!out.is_open())
+            {
+                std::cerr << "Cannot write " << jsonPath << "\n";
+                return 1;
+            }
+            writeJson(out, results, timestamp);
+            std::cout << "Results written to " << jsonPath << "\n";
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,137 @@
+/**
+ ****************************************************************************************
+ * @file   ShmClient.cpp
+ * @brief  Example client for the shared-memory packet ring (--shm).
+ *
+ *         Usage:
+ *           uart_shm_client NAME            print every record (hex)
+ *           uart_shm_client NAME --stats    print throughput once per second
+ *
+ *         Start the capture first, e.g. "uart_listener --rx-port 5 --shm bus1",
+ *         then run "uart_shm_client bus1". Any number of clients may attach.
+ *
+ * @author Patrik Neunteufel
+ * @date   Oct 2026
+ ****************************************************************************************
+ */
+
+#include "ShmRingReader.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <ctime>
+#include <iostream>
+#include <string>
+#include <vector>
+
+using namespace uart_listener;
+
+namespace
+{
+    const char* kindName(uint8_t kind)
+    {
+        switch (static_cast<shm::RecordKind>(kind))
+        {
+        case shm::RecordKind::Data:       return "DATA";
+        case shm::RecordKind::LineError:  return "LINE ERROR";
+        case shm::RecordKind::Disconnect: return "DISCONNECTED";
+        case shm::RecordKind::Reconnect:  return "RECONNECTED";
+        default:                          return "?";
+        }
+    }
+
+    void printRecord(const shm::RecordHeader& record, const std::vector<uint8_t>& payload)
+    {
+        const std::time_t seconds = static_cast<std::time_t>(record.unixTimeUs / 1000000);
+        std::tm           local{};
+        localtime_s(&local, &seconds);
+
+        char time[32];
+        std::strftime(time, sizeof(time), "%H:%M:%S", &local);
+        std::printf("%s.%06lld [%s] ", time, static_cast<long long>(record.unixTimeUs % 1000000),
+                    record.channel == 0 ? "RX" : "TX");
+
+        if (record.kind != static_cast<uint8_t>(shm::RecordKind::Data))
+        {
+            std::printf("!! %s (%u)\n", kindName(record.kind), record.info);
+            return;
+        }
+        for (uint8_t b : payload)
+        {
+            std::printf("%02X ", b);
+        }
+        std::printf("\n");
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    if (argc < 2 || (argc == 3 && std::string(argv[2]) != "--stats") || argc > 3)
+    {
+        std::cerr << "Usage: uart_shm_client NAME [--stats]\n";
+        return 1;
+    }
+    const std::string name = argv[1];
+    const bool        statsOnly = (argc == 3);
+
+    ShmRingReader reader;
+    if (!reader.open(name))
+    {
+        std::cerr << "No capture is exporting \"" << name << "\" (start uart_listener with --shm "
+                  << name << ")\n";
+        return 1;
+    }
+    std::cout << "Attached to " << shm::mappingName(name) << ": "
+              << reader.header()->capacity / 1024 << " KB ring, "
+              << reader.header()->baudRate << " baud\n";
+
+    shm::RecordHeader    record{};
+    std::vector<uint8_t> payload;
+    uint64_t             bytes[2] = {};
+    uint64_t             reportedLoss = 0;
+    auto                 lastReport = std::chrono::steady_clock::now();
+
+    for (;;)
+    {
+        const ShmReadStatus status = reader.next(record, payload);
+        if (status == ShmReadStatus::Closed)
+        {
+            std::cout << "Capture ended.\n";
+            break;
+        }
+        if (status == ShmReadStatus::Record)
+        {
+            bytes[record.channel & 1] += payload.size();
+            if (!statsOnly)
+            {
+                printRecord(record, payload);
+            }
+        }
+        else if (status == ShmReadStatus::Empty)
+        {
+            Sleep(1);
+        }
+
+        const auto now = std::chrono::steady_clock::now();
+        if (now - lastReport >= std::chrono::seconds(1))
+        {
+            if (statsOnly)
+            {
+                std::printf("RX %llu B/s  TX %llu B/s  lost %llu B\n",
+                            static_cast<unsigned long long>(bytes[0]),
+                            static_cast<unsigned long long>(bytes[1]),
+                            static_cast<unsigned long long>(reader.lostBytes()));
+                bytes[0] = bytes[1] = 0;
+            }
+            else if (reader.lostBytes() != reportedLoss)
+            {
+                std::printf("!! client too slow, %llu bytes skipped so far\n",
+                            static_cast<unsigned long long>(reader.lostBytes()));
+            }
+            reportedLoss = reader.lostBytes();
+            lastReport = now;
+        }
+    }
+
+    return 0;
+}
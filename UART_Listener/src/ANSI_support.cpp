@@ -27,4 +27,17 @@ bool enableVirtualTerminalProcessing()
 
     mode |= ENABLE_VIRTUAL_TERMINAL_PROCESSING;
     return SetConsoleMode(hOut, mode) != 0;
-}
\ No newline at end of file
+}
+
+bool getConsoleWindowSize(int& columns, int& rows)
+{
+    CONSOLE_SCREEN_BUFFER_INFO info{};
+    if (!GetConsoleScreenBufferInfo(GetStdHandle(STD_OUTPUT_HANDLE), &info))
+    {
+        return false;
+    }
+
+    columns = info.srWindow.Right - info.srWindow.Left + 1;
+    rows = info.srWindow.Bottom - info.srWindow.Top + 1;
+    return true;
+}
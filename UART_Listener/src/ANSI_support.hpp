@@ -9,4 +9,10 @@
  */
 #pragma once
 
-bool enableVirtualTerminalProcessing();
\ No newline at end of file
+bool enableVirtualTerminalProcessing();
+
+/**
+ * @brief Visible size of the console window in character cells.
+ * @return false if stdout is not a console (sizes unchanged)
+ */
+bool getConsoleWindowSize(int& columns, int& rows);
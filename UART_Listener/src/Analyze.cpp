@@ -0,0 +1,1120 @@
+/**
+ ****************************************************************************************
+ * @file   Analyze.cpp
+ * @brief  Single-pass statistical overview of a capture, live or offline.
+ *
+ * @author Patrik Neunteufel
+ * @date   Oct 2026
+ ****************************************************************************************
+ */
+#include "Analyze.hpp"
+#include "Convert.hpp"
+#include "FileWriter.hpp"
+#include "LogLine.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string_view>
+#include <thread>
+#include <utility>
+
+namespace uart_listener
+{
+    namespace
+    {
+        // Upper bounds (us) of all gap buckets but the last
+        constexpr int64_t kGapBounds[CaptureAnalysis::kGapBuckets - 1] = {
+            100, 1000, 10000, 100000, 1000000, 10000000
+        };
+        constexpr const char* kGapLabels[CaptureAnalysis::kGapBuckets] = {
+            "<100us", "<1ms", "<10ms", "<100ms", "<1s", "<10s", ">=10s"
+        };
+
+        constexpr int64_t kDayMs = 24LL * 3600 * 1000;
+        constexpr size_t  kHeadBytes = 64 * 1024;   // searched for the log header
+
+        int64_t floorDiv(int64_t value, int64_t divisor)
+        {
+            const int64_t q = value / divisor;
+            return (value % divisor != 0 && value < 0) ? q - 1 : q;
+        }
+
+        std::string formatSeconds(int64_t us)
+        {
+            std::ostringstream oss;
+            oss << std::fixed << std::setprecision(3) << static_cast<double>(us) / 1e6;
+            return oss.str();
+        }
+
+        void appendJsonString(std::ostream& out, const std::string& text)
+        {
+            out << '"';
+            for (char c : text)
+            {
+                if (c == '"' || c == '\\')
+                {
+                    out << '\\';
+                }
+                out << c;
+            }
+            out << '"';
+        }
+
+        // ---- Log parsing -------------------------------------------------------
+
+        struct LogLayout
+        {
+            bool         log = false;     // false = raw dump
+            bool         csv = false;
+            bool         timed = false;   // lines carry HH:MM:SS.mmm
+            OutputFormat payload = OutputFormat::Ascii;
+        };
+
+        struct LogRecord
+        {
+            Channel          channel = Channel::RX;
+            int64_t          clockMs = -1;   // time of day; < 0 = none
+            std::string_view payload;
+            uint64_t         repeats = 0;    // collapsed run: payload this many times
+            int64_t          firstMs = -1;   // time of day of the first repeat
+        };
+
+        int hexValue(char c)
+        {
+            if (c >= '0' && c <= '9') return c - '0';
+            if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+            if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+            return -1;
+        }
+
+        /** "HH:MM:SS.mmm" as milliseconds since midnight, or -1. */
+        int64_t parseClock(std::string_view text)
+        {
+            if (text.size() != 12 || text[2] != ':' || text[5] != ':' || text[8] != '.')
+            {
+                return -1;
+            }
+            int64_t fields[4] = { 0, 0, 0, 0 };
+            const size_t starts[4] = { 0, 3, 6, 9 };
+            const size_t lengths[4] = { 2, 2, 2, 3 };
+            for (size_t f = 0; f < 4; ++f)
+            {
+                for (size_t i = 0; i < lengths[f]; ++i)
+                {
+                    const char c = text[starts[f] + i];
+                    if (c < '0' || c > '9')
+                    {
+                        return -1;
+                    }
+                    fields[f] = fields[f] * 10 + (c - '0');
+                }
+            }
+            return ((fields[0] * 60 + fields[1]) * 60 + fields[2]) * 1000 + fields[3];
+        }
+
+        /** Collapsed run (--collapse-repeats): "== Nx HH:MM:SS.mmm .. HH:MM:SS.mmm | payload". */
+        bool parseRepeat(LogRecord& record)
+        {
+            std::string_view text = record.payload.substr(3);
+            uint64_t         count = 0;
+            size_t           i = 0;
+            for (; i < text.size() && text[i] >= '0' && text[i] <= '9'; ++i)
+            {
+                count = count * 10 + static_cast<uint64_t>(text[i] - '0');
+            }
+            // "x " FIRST " .. " LAST " | "
+            if (i == 0 || text.size() < i + 33 || text.substr(i, 2) != "x " || text.substr(i + 14, 4) != " .. "
+                || text.substr(i + 30, 3) != " | ")
+            {
+                return false;
+            }
+            record.repeats = count;
+            record.firstMs = parseClock(text.substr(i + 2, 12));
+            record.payload = text.substr(i + 33);
+            return count != 0;
+        }
+
+        /**
+         * One data line of a text ("[HH:MM:SS.mmm ][RX] payload") or CSV
+         * ("HH:MM:SS.mmm;RX;payload") log. Comments, the CSV column header and
+         * event lines ("!! ...") are not data; repeat lines ("== ...") are.
+         */
+        bool parseLine(std::string_view line, bool csv, LogRecord& record)
+        {
+            if (line.empty() || line[0] == '#')
+            {
+                return false;
+            }
+
+            std::string_view channel;
+            if (csv)
+            {
+                const size_t first = line.find(';');
+                const size_t second = (first == std::string_view::npos) ? first : line.find(';', first + 1);
+                if (second == std::string_view::npos)
+                {
+                    return false;
+                }
+                record.clockMs = parseClock(line.substr(0, first));
+                channel = line.substr(first + 1, second - first - 1);
+                record.payload = line.substr(second + 1);
+            }
+            else
+            {
+                record.clockMs = -1;
+                if (line.size() > 12 && line[12] == ' ')
+                {
+                    record.clockMs = parseClock(line.substr(0, 12));
+                    if (record.clockMs >= 0)
+                    {
+                        line.remove_prefix(13);
+                    }
+                }
+                if (line.size() < 4 || line[0] != '[' || line[3] != ']')
+                {
+                    return false;
+                }
+                channel = line.substr(1, 2);
+                record.payload = line.substr(std::min<size_t>(line.size(), 5));
+            }
+
+            if (channel == "RX")
+            {
+                record.channel = Channel::RX;
+            }
+            else if (channel == "TX")
+            {
+                record.channel = Channel::TX;
+            }
+            else
+            {
+                return false;
+            }
+            record.repeats = 0;
+            if (record.payload.substr(0, 3) == "== ")
+            {
+                return parseRepeat(record);
+            }
+            return record.payload.substr(0, 3) != "!! ";
+        }
+
+        /**
+         * Undo formatData(). Returns false for raw payloads ("<raw N bytes>"),
+         * where only the length is known.
+         */
+        bool decodePayload(std::string_view text, OutputFormat fmt, std::vector<uint8_t>& bytes, size_t& size)
+        {
+            bytes.clear();
+            switch (fmt)
+            {
+            case OutputFormat::Hex:
+                for (size_t i = 0; i + 1 < text.size(); ++i)
+                {
+                    const int hi = hexValue(text[i]);
+                    const int lo = hexValue(text[i + 1]);
+                    if (hi >= 0 && lo >= 0)
+                    {
+                        bytes.push_back(static_cast<uint8_t>(hi * 16 + lo));
+                        ++i;
+                    }
+                }
+                break;
+            case OutputFormat::Raw:
+                size = 0;
+                if (text.substr(0, 5) == "<raw ")
+                {
+                    for (size_t i = 5; i < text.size() && text[i] >= '0' && text[i] <= '9'; ++i)
+                    {
+                        size = size * 10 + static_cast<size_t>(text[i] - '0');
+                    }
+                }
+                return false;
+            default:
+                for (size_t i = 0; i < text.size(); ++i)
+                {
+                    const char c = text[i];
+                    if (c == '\\' && i + 1 < text.size())
+                    {
+                        const char e = text[i + 1];
+                        if (e == 'x' && i + 3 < text.size() && hexValue(text[i + 2]) >= 0 && hexValue(text[i + 3]) >= 0)
+                        {
+                            bytes.push_back(static_cast<uint8_t>(hexValue(text[i + 2]) * 16 + hexValue(text[i + 3])));
+                            i += 3;
+                            continue;
+                        }
+                        if (fmt == OutputFormat::CEscape && (e == 'r' || e == 'n' || e == 't' || e == '0'))
+                        {
+                            bytes.push_back(static_cast<uint8_t>(e == 'r' ? '\r' : e == 'n' ? '\n' : e == 't' ? '\t' : '\0'));
+                            ++i;
+                            continue;
+                        }
+                    }
+                    bytes.push_back(static_cast<uint8_t>(c));
+                }
+                break;
+            }
+            size = bytes.size();
+            return true;
+        }
+
+        /** Calls fn(line, offset) for each line in [begin, end), without the line end. */
+        template<typename Fn>
+        void forEachLine(const uint8_t* data, size_t begin, size_t end, Fn&& fn)
+        {
+            size_t pos = begin;
+            while (pos < end)
+            {
+                const void*  lf = std::memchr(data + pos, '\n', end - pos);
+                const size_t lineEnd = (lf != nullptr) ? static_cast<size_t>(static_cast<const uint8_t*>(lf) - data) : end;
+
+                std::string_view line(reinterpret_cast<const char*>(data + pos), lineEnd - pos);
+                if (!line.empty() && line.back() == '\r')
+                {
+                    line.remove_suffix(1);
+                }
+                if (!fn(line, pos))
+                {
+                    return;
+                }
+                pos = (lf != nullptr) ? lineEnd + 1 : end;
+            }
+        }
+
+        LogLayout detectLayout(const uint8_t* data, size_t size, OutputFormat payload)
+        {
+            LogLayout layout;
+            layout.payload = payload;
+
+            const size_t           headSize = std::min(size, kHeadBytes);
+            const std::string_view head(reinterpret_cast<const char*>(data), headSize);
+            if (head.substr(0, 31) != "# uart_listener capture started")
+            {
+                return layout;
+            }
+            layout.log = true;
+
+            forEachLine(data, 0, headSize, [&](std::string_view line, size_t) {
+                if (line.substr(0, 10) == "# Format: ")
+                {
+                    if (auto fmt = OutputFormatTraits::fromString(std::string(line.substr(10))))
+                    {
+                        layout.payload = *fmt;
+                    }
+                    return true;
+                }
+                if (line == "Timestamp;Channel;Data")
+                {
+                    layout.csv = true;
+                    return true;
+                }
+                LogRecord record;
+                if (!parseLine(line, layout.csv, record))
+                {
+                    return true;
+                }
+                layout.timed = (record.clockMs >= 0);
+                return false;
+            });
+            return layout;
+        }
+
+        /** Time of day of the first (or last) data line of a chunk, or -1. */
+        int64_t chunkClock(const uint8_t* data, const ChunkRange& chunk, const LogLayout& layout, bool last)
+        {
+            int64_t clock = -1;
+            if (!last)
+            {
+                forEachLine(data, chunk.first, chunk.second, [&](std::string_view line, size_t) {
+                    LogRecord record;
+                    if (parseLine(line, layout.csv, record) && record.clockMs >= 0)
+                    {
+                        clock = record.clockMs;
+                        return false;
+                    }
+                    return true;
+                });
+                return clock;
+            }
+
+            // Backwards line by line; the chunk ends after a '\n'
+            size_t end = chunk.second;
+            while (end > chunk.first && clock < 0)
+            {
+                size_t begin = end - 1;
+                while (begin > chunk.first && data[begin - 1] != '\n')
+                {
+                    --begin;
+                }
+                forEachLine(data, begin, end, [&](std::string_view line, size_t) {
+                    LogRecord record;
+                    if (parseLine(line, layout.csv, record) && record.clockMs >= 0)
+                    {
+                        clock = record.clockMs;
+                    }
+                    return false;
+                });
+                end = begin;
+            }
+            return clock;
+        }
+
+        /**
+         * Log timestamps are times of day. Every chunk gets the day it starts in,
+         * so that workers can count midnight wraps from there: a step back by
+         * more than half a day is taken as the next day.
+         */
+        std::vector<int64_t> chunkDays(const uint8_t* data, const std::vector<ChunkRange>& chunks,
+                                       const LogLayout& layout)
+        {
+            std::vector<int64_t> first(chunks.size());
+            std::vector<int64_t> last(chunks.size());
+            std::vector<std::thread> pool;
+            const unsigned threads = std::max(1u, std::thread::hardware_concurrency());
+            for (unsigned t = 0; t < threads; ++t)
+            {
+                pool.emplace_back([&, t]() {
+                    for (size_t k = t; k < chunks.size(); k += threads)
+                    {
+                        first[k] = chunkClock(data, chunks[k], layout, false);
+                        last[k] = chunkClock(data, chunks[k], layout, true);
+                    }
+                });
+            }
+            for (auto& thread : pool)
+            {
+                thread.join();
+            }
+
+            std::vector<int64_t> days(chunks.size(), 0);
+            int64_t day = 0;
+            int64_t previous = -1;
+            for (size_t k = 0; k < chunks.size(); ++k)
+            {
+                if (first[k] < 0)
+                {
+                    days[k] = day;
+                    continue;
+                }
+                if (previous >= 0 && first[k] < previous - kDayMs / 2)
+                {
+                    ++day;
+                }
+                days[k] = day;
+                if (last[k] < first[k] - kDayMs / 2)
+                {
+                    ++day;
+                }
+                previous = last[k];
+            }
+            return days;
+        }
+
+        void analyzeChunk(const uint8_t* data, const ChunkRange& chunk, const LogLayout& layout, int64_t day,
+                          Channel rawChannel, CaptureAnalysis& analysis)
+        {
+            if (!layout.log)
+            {
+                for (size_t pos = chunk.first; pos < chunk.second;)
+                {
+                    const size_t n = recordLength(data + pos, chunk.second - pos, 0);
+                    analysis.add(rawChannel, static_cast<int64_t>(pos), data + pos, n);
+                    pos += n;
+                }
+                return;
+            }
+
+            std::vector<uint8_t> bytes;
+            int64_t              dayMs = day * kDayMs;
+            int64_t              previous = -1;
+            forEachLine(data, chunk.first, chunk.second, [&](std::string_view line, size_t offset) {
+                LogRecord record;
+                if (!parseLine(line, layout.csv, record))
+                {
+                    return true;
+                }
+
+                int64_t time = static_cast<int64_t>(offset);
+                if (layout.timed)
+                {
+                    if (record.clockMs < 0)
+                    {
+                        return true;
+                    }
+                    if (previous >= 0 && record.clockMs < previous - kDayMs / 2)
+                    {
+                        dayMs += kDayMs;
+                    }
+                    previous = record.clockMs;
+                    time = (dayMs + record.clockMs) * 1000;
+                }
+
+                size_t     size = 0;
+                const bool known = decodePayload(record.payload, layout.payload, bytes, size);
+                if (record.repeats == 0)
+                {
+                    analysis.add(record.channel, time, known ? bytes.data() : nullptr, size);
+                    return true;
+                }
+
+                // A collapsed run: spread the repeats evenly between its first and last time
+                int64_t span = 0;
+                if (layout.timed && record.firstMs >= 0)
+                {
+                    span = (record.clockMs - record.firstMs + kDayMs) % kDayMs * 1000;
+                }
+                for (uint64_t k = 0; k < record.repeats; ++k)
+                {
+                    const int64_t offset = (record.repeats > 1)
+                                               ? span * static_cast<int64_t>(record.repeats - 1 - k)
+                                                     / static_cast<int64_t>(record.repeats - 1)
+                                               : 0;
+                    analysis.add(record.channel, time - offset, known ? bytes.data() : nullptr, size);
+                }
+                return true;
+            });
+        }
+    }
+
+    void countBytes(const uint8_t* data, size_t size, ByteHistogram& hist)
+    {
+        // Short packets: clearing the tables would cost more than they save
+        if (size < 64)
+        {
+            for (size_t i = 0; i < size; ++i)
+            {
+                ++hist[data[i]];
+            }
+            return;
+        }
+
+        while (size > 0)
+        {
+            // 32-bit counters; a block puts at most block / 4 into one of them
+            const size_t block = std::min<size_t>(size, size_t(1) << 30);
+            uint32_t     counts[4][256] = {};
+
+            size_t i = 0;
+            for (; i + 8 <= block; i += 8)
+            {
+                uint64_t word;
+                std::memcpy(&word, data + i, sizeof(word));
+                ++counts[0][word & 0xFF];
+                ++counts[1][(word >> 8) & 0xFF];
+                ++counts[2][(word >> 16) & 0xFF];
+                ++counts[3][(word >> 24) & 0xFF];
+                ++counts[0][(word >> 32) & 0xFF];
+                ++counts[1][(word >> 40) & 0xFF];
+                ++counts[2][(word >> 48) & 0xFF];
+                ++counts[3][word >> 56];
+            }
+            for (; i < block; ++i)
+            {
+                ++counts[0][data[i]];
+            }
+
+            for (size_t v = 0; v < 256; ++v)
+            {
+                hist[v] += static_cast<uint64_t>(counts[0][v]) + counts[1][v] + counts[2][v] + counts[3][v];
+            }
+            data += block;
+            size -= block;
+        }
+    }
+
+    double byteEntropy(const ByteHistogram& hist)
+    {
+        uint64_t total = 0;
+        for (uint64_t count : hist)
+        {
+            total += count;
+        }
+        if (total == 0)
+        {
+            return 0.0;
+        }
+
+        double entropy = 0.0;
+        for (uint64_t count : hist)
+        {
+            if (count != 0)
+            {
+                const double p = static_cast<double>(count) / static_cast<double>(total);
+                entropy -= p * std::log2(p);
+            }
+        }
+        return entropy;
+    }
+
+    CaptureAnalysis::CaptureAnalysis(int64_t windowUnits, bool timed)
+        : m_windowUnits(std::max<int64_t>(1, windowUnits))
+        , m_timed(timed)
+    {
+    }
+
+    void CaptureAnalysis::addGap(ChannelStats& ch, int64_t start, int64_t length)
+    {
+        size_t bucket = 0;
+        while (bucket < kGapBuckets - 1 && length >= kGapBounds[bucket])
+        {
+            ++bucket;
+        }
+        ++ch.gaps[bucket];
+        keepSilence(ch, Silence{ start, length });
+    }
+
+    void CaptureAnalysis::keepSilence(ChannelStats& ch, const Silence& silence)
+    {
+        if (ch.silences.size() == kSilences && silence.length <= ch.silences.back().length)
+        {
+            return;
+        }
+        auto pos = std::find_if(ch.silences.begin(), ch.silences.end(),
+                                [&](const Silence& s) { return s.length < silence.length; });
+        ch.silences.insert(pos, silence);
+        if (ch.silences.size() > kSilences)
+        {
+            ch.silences.pop_back();
+        }
+    }
+
+    void CaptureAnalysis::closeBack()
+    {
+        if (m_windows.empty())
+        {
+            return;
+        }
+        // The front window can still grow by a merge with a preceding part
+        if (m_windows.size() == 1)
+        {
+            m_frontHist = m_backHist;
+        }
+        else
+        {
+            m_windows.back().entropy = byteEntropy(m_backHist);
+        }
+        m_backHist.fill(0);
+    }
+
+    void CaptureAnalysis::add(Channel channel, int64_t time, const uint8_t* data, size_t size)
+    {
+        const size_t  c = static_cast<size_t>(channel);
+        ChannelStats& ch = m_ch[c];
+        if (!ch.seen)
+        {
+            ch.seen = true;
+            ch.first = time;
+            ch.last = time;
+        }
+        else if (time >= ch.last)
+        {
+            if (m_timed)
+            {
+                addGap(ch, ch.last, time - ch.last);
+            }
+            ch.last = time;
+        }
+        ++ch.packets;
+        ch.bytes += size;
+        if (data != nullptr)
+        {
+            countBytes(data, size, ch.hist);
+        }
+
+        const int64_t index = floorDiv(time, m_windowUnits);
+        if (m_windows.empty() || index > m_windows.back().index)
+        {
+            closeBack();
+            Window window;
+            window.index = index;
+            m_windows.push_back(window);
+        }
+
+        // A late packet (the other channel's reader was behind) counts for the
+        // newest window that does not start after it
+        size_t w = m_windows.size() - 1;
+        while (w > 0 && m_windows[w].index > index)
+        {
+            --w;
+        }
+        Window& window = m_windows[w];
+        ++window.packets[c];
+        window.bytes[c] += size;
+        if (data != nullptr)
+        {
+            if (w + 1 == m_windows.size())
+            {
+                countBytes(data, size, m_backHist);
+            }
+            else if (w == 0 && window.entropy < 0.0)
+            {
+                countBytes(data, size, m_frontHist);
+            }
+        }
+    }
+
+    void CaptureAnalysis::merge(CaptureAnalysis&& next)
+    {
+        for (size_t c = 0; c < 2; ++c)
+        {
+            ChannelStats&       a = m_ch[c];
+            const ChannelStats& b = next.m_ch[c];
+            if (!b.seen)
+            {
+                continue;
+            }
+
+            // The gap across the boundary belongs to neither part alone
+            if (a.seen && m_timed && b.first >= a.last)
+            {
+                addGap(a, a.last, b.first - a.last);
+            }
+            a.packets += b.packets;
+            a.bytes += b.bytes;
+            for (size_t v = 0; v < 256; ++v)
+            {
+                a.hist[v] += b.hist[v];
+            }
+            for (size_t g = 0; g < kGapBuckets; ++g)
+            {
+                a.gaps[g] += b.gaps[g];
+            }
+            for (const Silence& silence : b.silences)
+            {
+                keepSilence(a, silence);
+            }
+            if (!a.seen)
+            {
+                a.seen = true;
+                a.first = b.first;
+                a.last = b.last;
+            }
+            a.last = std::max(a.last, b.last);
+        }
+
+        if (next.m_windows.empty())
+        {
+            return;
+        }
+        if (m_windows.empty())
+        {
+            m_windows = std::move(next.m_windows);
+            m_frontHist = next.m_frontHist;
+            m_backHist = next.m_backHist;
+            return;
+        }
+
+        // Bytes of next's first window: still in m_backHist if it is its only one
+        const bool           single = (next.m_windows.size() == 1);
+        const ByteHistogram& nextFrontHist = single ? next.m_backHist : next.m_frontHist;
+        Window&              nextFront = next.m_windows.front();
+
+        if (m_windows.back().index == nextFront.index)
+        {
+            // One window cut in two by the chunk boundary
+            Window& back = m_windows.back();
+            for (size_t c = 0; c < 2; ++c)
+            {
+                back.packets[c] += nextFront.packets[c];
+                back.bytes[c] += nextFront.bytes[c];
+            }
+            for (size_t v = 0; v < 256; ++v)
+            {
+                m_backHist[v] += nextFrontHist[v];
+            }
+            if (single)
+            {
+                return;
+            }
+            closeBack();
+            m_windows.insert(m_windows.end(), next.m_windows.begin() + 1, next.m_windows.end());
+        }
+        else
+        {
+            closeBack();
+            if (!single)
+            {
+                nextFront.entropy = byteEntropy(nextFrontHist);
+            }
+            m_windows.insert(m_windows.end(), next.m_windows.begin(), next.m_windows.end());
+        }
+        m_backHist = next.m_backHist;
+    }
+
+    void CaptureAnalysis::finish()
+    {
+        if (m_finished || m_windows.empty())
+        {
+            m_finished = true;
+            return;
+        }
+        if (m_windows.size() == 1)
+        {
+            m_windows.front().entropy = byteEntropy(m_backHist);
+        }
+        else
+        {
+            if (m_windows.front().entropy < 0.0)
+            {
+                m_windows.front().entropy = byteEntropy(m_frontHist);
+            }
+            m_windows.back().entropy = byteEntropy(m_backHist);
+        }
+        m_finished = true;
+    }
+
+    int64_t CaptureAnalysis::origin() const noexcept
+    {
+        return m_windows.empty() ? 0 : m_windows.front().index * m_windowUnits;
+    }
+
+    void CaptureAnalysis::writeReport(std::ostream& stream, const std::string& source) const
+    {
+        // Built aside, so that the caller's stream keeps its number format
+        std::ostringstream out;
+        const int64_t      base = origin();
+        auto at = [&](int64_t time) {
+            return m_timed ? "+" + formatSeconds(time - base) + " s" : "offset " + std::to_string(time);
+        };
+
+        out << "=== Capture analysis: " << source << " ===\n";
+        if (m_windows.empty())
+        {
+            stream << out.str() << "No data packets.\n";
+            return;
+        }
+
+        int64_t first = INT64_MAX;
+        int64_t last = INT64_MIN;
+        for (const auto& ch : m_ch)
+        {
+            if (ch.seen)
+            {
+                first = std::min(first, ch.first);
+                last = std::max(last, ch.last);
+            }
+        }
+        const int64_t span = m_windows.back().index - m_windows.front().index + 1;
+        if (m_timed)
+        {
+            out << "Duration: " << formatSeconds(last - first) << " s, " << span << " windows of "
+                << formatSeconds(m_windowUnits) << " s\n";
+        }
+        else
+        {
+            out << "No timestamps: windows are blocks of " << m_windowUnits << " bytes (" << span << " blocks)\n";
+        }
+
+        const double windowSeconds = static_cast<double>(m_windowUnits) / 1e6;
+        bool         haveBytes = false;
+        for (size_t c = 0; c < 2; ++c)
+        {
+            const ChannelStats& ch = m_ch[c];
+            if (!ch.seen)
+            {
+                continue;
+            }
+            out << channelTag(static_cast<Channel>(c)) << " " << ch.packets << " packets, " << ch.bytes << " bytes";
+
+            if (m_timed)
+            {
+                const Window* peak = &m_windows.front();
+                for (const auto& window : m_windows)
+                {
+                    if (window.bytes[c] > peak->bytes[c])
+                    {
+                        peak = &window;
+                    }
+                }
+                const double seconds = static_cast<double>(ch.last - ch.first) / 1e6;
+                out << std::fixed << std::setprecision(1);
+                if (seconds > 0.0)
+                {
+                    out << ", avg " << static_cast<double>(ch.bytes) / seconds << " B/s ("
+                        << static_cast<double>(ch.packets) / seconds << " pkt/s)";
+                }
+                out << ", peak " << static_cast<double>(peak->bytes[c]) / windowSeconds << " B/s at "
+                    << at(peak->index * m_windowUnits) << "\n";
+
+                out << "     Idle gaps:";
+                for (size_t g = 0; g < kGapBuckets; ++g)
+                {
+                    out << " " << kGapLabels[g] << " " << ch.gaps[g];
+                }
+                out << "\n";
+
+                if (!ch.silences.empty())
+                {
+                    out << "     Longest silences:";
+                    for (size_t s = 0; s < ch.silences.size(); ++s)
+                    {
+                        out << (s == 0 ? " " : ", ") << formatSeconds(ch.silences[s].length) << " s at "
+                            << at(ch.silences[s].start);
+                    }
+                    out << "\n";
+                }
+            }
+            else
+            {
+                out << "\n";
+            }
+
+            // Most frequent byte values
+            uint64_t counted = 0;
+            std::vector<size_t> order;
+            for (size_t v = 0; v < 256; ++v)
+            {
+                counted += ch.hist[v];
+                if (ch.hist[v] != 0)
+                {
+                    order.push_back(v);
+                }
+            }
+            if (counted == 0)
+            {
+                continue;
+            }
+            const size_t top = std::min<size_t>(order.size(), 5);
+            std::partial_sort(order.begin(), order.begin() + top, order.end(),
+                              [&](size_t a, size_t b) { return ch.hist[a] > ch.hist[b]; });
+            out << "     Top bytes:";
+            for (size_t i = 0; i < top; ++i)
+            {
+                out << (i == 0 ? " " : ", ") << "0x" << std::hex << std::uppercase << std::setw(2) << std::setfill('0')
+                    << order[i] << std::dec << std::setfill(' ') << " " << std::fixed << std::setprecision(1)
+                    << 100.0 * static_cast<double>(ch.hist[order[i]]) / static_cast<double>(counted) << "%";
+            }
+            out << ", entropy " << std::setprecision(2) << byteEntropy(ch.hist) << " bits/byte\n";
+            haveBytes = true;
+        }
+
+        // Entropy over time; raw format logs only carry lengths
+        std::vector<const Window*> sorted;
+        for (const auto& window : m_windows)
+        {
+            if (haveBytes && window.bytes[0] + window.bytes[1] != 0)
+            {
+                sorted.push_back(&window);
+            }
+        }
+        if (!sorted.empty())
+        {
+            std::sort(sorted.begin(), sorted.end(),
+                      [](const Window* a, const Window* b) { return a->entropy < b->entropy; });
+            out << "Entropy per window: min " << std::fixed << std::setprecision(2) << sorted.front()->entropy
+                << " at " << at(sorted.front()->index * m_windowUnits)
+                << ", median " << std::setprecision(2) << sorted[sorted.size() / 2]->entropy
+                << ", max " << std::setprecision(2) << sorted.back()->entropy
+                << " at " << at(sorted.back()->index * m_windowUnits) << " (bits/byte)\n";
+        }
+        stream << out.str();
+    }
+
+    bool CaptureAnalysis::writeCsv(const std::string& path) const
+    {
+        std::ofstream out(path);
+        if (!out.is_open())
+        {
+            std::cerr << "Cannot create analysis CSV: " << path << "\n";
+            return false;
+        }
+
+        // Silent windows get a row as well, so that rates plot correctly
+        const int64_t base = origin();
+        out << (m_timed ? "Start_s" : "Offset") << ";RxPackets;RxBytes;TxPackets;TxBytes;Entropy\n";
+        size_t w = 0;
+        for (int64_t index = m_windows.empty() ? 0 : m_windows.front().index;
+             w < m_windows.size(); ++index)
+        {
+            const int64_t start = index * m_windowUnits;
+            if (m_timed)
+            {
+                out << std::fixed << std::setprecision(3) << static_cast<double>(start - base) / 1e6;
+            }
+            else
+            {
+                out << start;
+            }
+
+            if (m_windows[w].index == index)
+            {
+                const Window& window = m_windows[w++];
+                out << ";" << window.packets[0] << ";" << window.bytes[0] << ";" << window.packets[1] << ";"
+                    << window.bytes[1] << ";" << std::fixed << std::setprecision(3) << std::max(0.0, window.entropy)
+                    << "\n";
+            }
+            else
+            {
+                out << ";0;0;0;0;\n";
+            }
+        }
+        return out.good();
+    }
+
+    bool CaptureAnalysis::writeJson(const std::string& path, const std::string& source) const
+    {
+        std::ofstream out(path);
+        if (!out.is_open())
+        {
+            std::cerr << "Cannot create analysis JSON: " << path << "\n";
+            return false;
+        }
+
+        const int64_t base = origin();
+        auto time = [&](int64_t value) {
+            std::ostringstream oss;
+            if (m_timed)
+            {
+                oss << std::fixed << std::setprecision(6) << static_cast<double>(value - base) / 1e6;
+            }
+            else
+            {
+                oss << value;
+            }
+            return oss.str();
+        };
+
+        out << "{\n  \"source\": ";
+        appendJsonString(out, source);
+        out << ",\n  \"timed\": " << (m_timed ? "true" : "false")
+            << ",\n  \"window\": " << (m_timed ? time(base + m_windowUnits) : std::to_string(m_windowUnits))
+            << ",\n  \"channels\": {";
+
+        bool firstChannel = true;
+        for (size_t c = 0; c < 2; ++c)
+        {
+            const ChannelStats& ch = m_ch[c];
+            if (!ch.seen)
+            {
+                continue;
+            }
+            out << (firstChannel ? "\n" : ",\n") << "    \"" << channelName(static_cast<Channel>(c)) << "\": {"
+                << "\"packets\": " << ch.packets << ", \"bytes\": " << ch.bytes
+                << ", \"first\": " << time(ch.first) << ", \"last\": " << time(ch.last)
+                << ", \"entropy\": " << std::fixed << std::setprecision(4) << byteEntropy(ch.hist);
+            firstChannel = false;
+
+            if (m_timed)
+            {
+                out << ",\n      \"gaps\": {\"bounds_us\": [";
+                for (size_t g = 0; g + 1 < kGapBuckets; ++g)
+                {
+                    out << (g == 0 ? "" : ", ") << kGapBounds[g];
+                }
+                out << "], \"counts\": [";
+                for (size_t g = 0; g < kGapBuckets; ++g)
+                {
+                    out << (g == 0 ? "" : ", ") << ch.gaps[g];
+                }
+                out << "]},\n      \"silences\": [";
+                for (size_t s = 0; s < ch.silences.size(); ++s)
+                {
+                    out << (s == 0 ? "" : ", ") << "{\"start\": " << time(ch.silences[s].start)
+                        << ", \"length\": " << time(base + ch.silences[s].length) << "}";
+                }
+                out << "]";
+            }
+
+            out << ",\n      \"histogram\": [";
+            for (size_t v = 0; v < 256; ++v)
+            {
+                out << (v == 0 ? "" : ",") << ch.hist[v];
+            }
+            out << "]}";
+        }
+
+        out << "\n  },\n  \"windows\": [";
+        for (size_t w = 0; w < m_windows.size(); ++w)
+        {
+            const Window& window = m_windows[w];
+            out << (w == 0 ? "\n" : ",\n") << "    {\"start\": " << time(window.index * m_windowUnits)
+                << ", \"rx_packets\": " << window.packets[0] << ", \"rx_bytes\": " << window.bytes[0]
+                << ", \"tx_packets\": " << window.packets[1] << ", \"tx_bytes\": " << window.bytes[1]
+                << ", \"entropy\": " << std::fixed << std::setprecision(4) << std::max(0.0, window.entropy) << "}";
+        }
+        out << "\n  ]\n}\n";
+        return out.good();
+    }
+
+    int runAnalyze(const std::string& path, OutputFormat payload, const AnalyzeOptions& options)
+    {
+        MappedInput input;
+        if (!input.open(path))
+        {
+            return 1;
+        }
+        const uint8_t* data = input.data();
+        const size_t   size = static_cast<size_t>(input.size());
+
+        const auto      start = std::chrono::steady_clock::now();
+        const LogLayout layout = detectLayout(data, size, payload);
+        const int64_t   windowUnits = layout.timed ? static_cast<int64_t>(options.windowMs) * 1000
+                                                   : CaptureAnalysis::kRawWindowBytes;
+
+        const std::vector<ChunkRange> chunks = splitChunks(data, size, 0);
+        const std::vector<int64_t>    days = layout.timed ? chunkDays(data, chunks, layout) : std::vector<int64_t>();
+
+        // One part per thread, each a contiguous run of chunks
+        const unsigned threads = (options.threads != 0) ? options.threads : std::max(1u, std::thread::hardware_concurrency());
+        const size_t   parts = std::max<size_t>(1, std::min<size_t>(threads, chunks.size()));
+        std::vector<CaptureAnalysis> partials(parts, CaptureAnalysis(windowUnits, layout.timed));
+
+        std::vector<std::thread> pool;
+        for (size_t p = 0; p < parts; ++p)
+        {
+            pool.emplace_back([&, p]() {
+                const size_t firstChunk = chunks.size() * p / parts;
+                const size_t lastChunk = chunks.size() * (p + 1) / parts;
+                for (size_t k = firstChunk; k < lastChunk; ++k)
+                {
+                    analyzeChunk(data, chunks[k], layout, days.empty() ? 0 : days[k], options.rawChannel, partials[p]);
+                }
+            });
+        }
+        for (auto& thread : pool)
+        {
+            thread.join();
+        }
+
+        // Pairwise merge of neighbours, so the input order is kept
+        for (size_t step = 1; step < parts; step *= 2)
+        {
+            pool.clear();
+            for (size_t i = 0; i + step < parts; i += 2 * step)
+            {
+                pool.emplace_back([&partials, i, step]() { partials[i].merge(std::move(partials[i + step])); });
+            }
+            for (auto& thread : pool)
+            {
+                thread.join();
+            }
+        }
+
+        CaptureAnalysis& result = partials.front();
+        result.finish();
+        const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        result.writeReport(std::cout, path);
+        std::cout << "[ANALYZE] " << size << " bytes ("
+                  << (layout.log ? std::string(layout.csv ? "CSV log, " : "text log, ") + OutputFormatTraits::toString(layout.payload)
+                                 : std::string("raw dump"))
+                  << "), " << parts << " threads, "
+                  << std::fixed << std::setprecision(2) << seconds << " s\n";
+
+        bool ok = true;
+        if (options.csvPath.has_value())
+        {
+            ok = result.writeCsv(*options.csvPath) && ok;
+        }
+        if (options.jsonPath.has_value())
+        {
+            ok = result.writeJson(*options.jsonPath, path) && ok;
+        }
+        return ok ? 0 : 1;
+    }
+}
@@ -0,0 +1,147 @@
+/**
+ ****************************************************************************************
+ * @file   Analyze.hpp
+ * @brief  Single-pass statistical overview of a capture, live or offline.
+ *
+ *         Per channel: packet and byte rates per time window, idle gap
+ *         distribution, longest silences and byte value histogram; per window:
+ *         Shannon entropy of all bytes. --analyze collects this during a live
+ *         capture, --analyze-file over a recorded log or raw dump.
+ *
+ *         Offline files are cut into chunks that are analyzed in parallel; the
+ *         partial results are merged pairwise in input order, so gaps and
+ *         windows that span a chunk boundary come out the same as in a single
+ *         pass. Raw dumps carry no time: packets are line feed records as in
+ *         --convert, windows are byte blocks and the timing sections are left out.
+ *
+ * @author Patrik Neunteufel
+ * @date   Oct 2026
+ ****************************************************************************************
+ */
+#pragma once
+
+#include "Format.hpp"
+#include "UART.hpp"
+
+#include <array>
+#include <cstdint>
+#include <optional>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace uart_listener
+{
+    struct AnalyzeOptions
+    {
+        bool                       live = false;       // --analyze during a capture
+        uint32_t                   windowMs = 1000;    // rate / entropy window
+        std::optional<std::string> csvPath;            // per-window series
+        std::optional<std::string> jsonPath;           // complete result
+        uint32_t                   threads = 0;        // offline; 0 = all cores
+        Channel                    rawChannel = Channel::RX;   // channel of a raw dump
+    };
+
+    using ByteHistogram = std::array<uint64_t, 256>;
+
+    /**
+     * @brief Add the byte values of data[0, size) to 'hist'.
+     *
+     * Eight bytes per load, counted into four interleaved tables so that
+     * repeated values do not serialize on one counter.
+     */
+    void countBytes(const uint8_t* data, size_t size, ByteHistogram& hist);
+
+    /** @brief Shannon entropy in bits per byte (0 for an empty histogram). */
+    double byteEntropy(const ByteHistogram& hist);
+
+    class CaptureAnalysis
+    {
+    public:
+        /// Idle gap buckets: < 100 us, < 1 ms, < 10 ms, < 100 ms, < 1 s, < 10 s, longer
+        static constexpr size_t  kGapBuckets = 7;
+        static constexpr size_t  kSilences = 5;      // longest gaps kept per channel
+        static constexpr int64_t kRawWindowBytes = 64 * 1024;
+
+        /**
+         * @param windowUnits Window length in microseconds (timed) or bytes (untimed)
+         * @param timed       Times are microseconds; false = times are byte offsets
+         */
+        CaptureAnalysis(int64_t windowUnits, bool timed);
+
+        /**
+         * @brief Account one packet.
+         * @param data May be null if only the length is known (raw format logs)
+         */
+        void add(Channel channel, int64_t time, const uint8_t* data, size_t size);
+
+        /**
+         * @brief Append the analysis of the input that directly follows this one.
+         */
+        void merge(CaptureAnalysis&& next);
+
+        /** @brief Close the open windows; call once after the last add()/merge(). */
+        void finish();
+
+        uint64_t totalPackets() const noexcept { return m_ch[0].packets + m_ch[1].packets; }
+
+        /**
+         * @brief Compact human-readable report.
+         * @param source Shown in the title (port names or file path)
+         */
+        void writeReport(std::ostream& out, const std::string& source) const;
+
+        /** @brief One row per window, for plotting. */
+        bool writeCsv(const std::string& path) const;
+
+        /** @brief Everything, including the full histograms. */
+        bool writeJson(const std::string& path, const std::string& source) const;
+
+    private:
+        struct Silence
+        {
+            int64_t start = 0;
+            int64_t length = 0;
+        };
+
+        struct ChannelStats
+        {
+            uint64_t                            packets = 0;
+            uint64_t                            bytes = 0;
+            ByteHistogram                       hist{};
+            bool                                seen = false;
+            int64_t                             first = 0;
+            int64_t                             last = 0;
+            std::array<uint64_t, kGapBuckets>   gaps{};
+            std::vector<Silence>                silences;   // longest first
+        };
+
+        struct Window
+        {
+            int64_t  index = 0;
+            uint64_t packets[2] = { 0, 0 };
+            uint64_t bytes[2] = { 0, 0 };
+            double   entropy = -1.0;   // < 0 while the window may still grow
+        };
+
+        static void addGap(ChannelStats& ch, int64_t start, int64_t length);
+        static void keepSilence(ChannelStats& ch, const Silence& silence);
+        void closeBack();
+        int64_t origin() const noexcept;
+
+        int64_t             m_windowUnits;
+        bool                m_timed;
+        ChannelStats        m_ch[2];
+        std::vector<Window> m_windows;
+        ByteHistogram       m_frontHist{};   // bytes of m_windows.front() once it is closed
+        ByteHistogram       m_backHist{};    // bytes of m_windows.back()
+        bool                m_finished = false;
+    };
+
+    /**
+     * @brief --analyze-file PATH mode: a uart_listener log (text/CSV) or a raw dump.
+     * @param payload Payload format of the log if its header does not say
+     * @return Process exit code
+     */
+    int runAnalyze(const std::string& path, OutputFormat payload, const AnalyzeOptions& options);
+}
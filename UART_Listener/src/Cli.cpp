@@ -15,6 +15,7 @@
 #include <iostream>
 #include <string>
 #include <algorithm>
+#include <thread>
 
 namespace uart_listener
 {
@@ -36,24 +37,147 @@ Port Configuration:
   If ports are missing, the app asks interactively at startup.
 
 Serial Options:
-  --baud RATE             Baud rate (default: 115200)
+  --baud RATE             Baud rate, any value the adapter supports (default: 115200)
+  --data-bits N           Data bits: 5|6|7|8 (default: 8)
+  --parity P              none|odd|even|mark|space (default: none)
+  --stop-bits S           1|1.5|2 (default: 1)
+  --flow F                Flow control: none|rtscts|dtrdsr (default: none)
+  --driver-queue BYTES    Driver input queue size (default: 65536)
+  --coalesce BYTES:US     Merge fast consecutive reads into one packet until
+                          BYTES are pending or US microseconds have passed
+                          (default: 4096:2000)
+  --no-coalesce           One packet per driver read
+  --reconnect MAX_MS      Reopen a vanished port (USB unplug) with backoff up
+                          to MAX_MS between attempts (default: 200)
+  --no-reconnect          A vanished port ends the capture
 
 Output Format:
   --format FMT            Display format: ascii|hex|c-escape|raw (default: ascii)
+  --format-threads N|auto Format console/log lines on N worker threads, output
+                          order unchanged (default: on the capture thread)
 
 Logging:
-  --log-format FMT        Log container: text|csv (default: text)
+  --log-format FMT        Log container: text|csv|sqlite (default: text); sqlite
+                          stores one row per frame in an indexed table
   --log-file PATH         Log file path (default: auto-generated)
   --rx-raw-out PATH       Write raw RX bytes to file
   --tx-raw-out PATH       Write raw TX bytes to file
+  --sink SPEC             Further output file on its own thread, repeatable:
+                          log:PATH[,ch=rx|tx|both][,format=FMT]
+                              [,log-format=text|csv|sqlite][,decode=modbus]
+                          raw:PATH[,ch=rx|tx|both]
+                          col:PATH[,ch=rx|tx|both]  columnar file for --query
+  --file-writer W         File backend: stream|buffered|mmap (default: stream)
+  --prealloc MB           Preallocation step for buffered/mmap (default: 64)
+  --durable MS            Crash-safe log: checksummed commit frames, forced to
+                          disk at most MS ms after writing (implies buffered)
+  --recover PATH          Cut a durable log after its last intact commit and exit
+  --collapse-repeats      Write identical frames in a row once, then one line
+                          "== Nx FIRST .. LAST | payload" per run (console and log)
+  --collapse-hold MS      Longest run before its line is written (default: 1000)
+
+Offline Conversion:
+  --convert IN OUT        Convert a raw dump (--rx-raw-out) to text/CSV/JSONL on
+                          all cores; payload as selected with --format
+  --convert-to FMT        text|csv|jsonl (default: from the OUT extension)
+  --record lf|BYTES       Record per line feed (max 4096 bytes) or every BYTES
+                          (default: lf)
+  --channel rx|tx         Channel tag of the converted dump (default: rx)
+  --threads N             Worker threads (default: all cores)
+
+Analysis:
+  --analyze               Print capture statistics on exit: rates, idle gaps,
+                          longest silences, byte histogram, entropy per window
+  --analyze-file PATH     Same for a recorded log (text/CSV) or raw dump, on all
+                          cores (--threads, --channel for raw dumps), and exit
+  --analyze-window MS     Rate/entropy window (default: 1000)
+  --analyze-csv PATH      Write one row per window
+  --analyze-json PATH     Write the complete result including histograms
+
+Query:
+  --query PATH            Print the rows of a columnar file (--sink col:PATH) in
+                          a time range and exit; blocks outside it are skipped
+  --from T, --to T        Range limits (inclusive): +SEC[.fff] after the start,
+                          HH:MM[:SS[.mmm]] on the capture day or
+                          YYYY-MM-DD HH:MM[:SS[.mmm]]
+  --query-out OUT         text|csv|count (default: text); payload as --format
+  --channel rx|tx         Only this channel (default: both)
+
+Echo Latency:
+  --echo tx|rx            Match the bytes of this channel with their echo on the
+                          other one; latency percentiles in the status line,
+                          the metrics and on exit (dual mode)
+  --echo-window BYTES     Source history searched for the echo (default: 65536)
+  --echo-block N          Bytes per hashed block when realigning, 2-32 (default: 4)
+  --echo-wait MS          Give up on an echo byte after MS (default: 1000)
+
+Transactions:
+  --txn seq|id:OFFSET[:LEN]|regex:PATTERN
+                          Pair each TX request with its RX response: in order,
+                          by LEN ID bytes at OFFSET, or by the text PATTERN
+                          matches in both; latency per command type on exit
+  --txn-type OFFSET:LEN   Request bytes naming the command type (default: 0:8)
+  --txn-end BYTE          Frames end with BYTE (lf, cr, 0x7E, ...); default: one
+                          frame per read
+  --txn-timeout MS        Request without response counts as timeout (default: 1000)
+  --txn-csv PATH          Write every transaction, timeout and unsolicited frame
 
 Display:
   --rx-color COLOR        Color for [RX] tag (e.g., green, cyan, "\033[32m")
   --tx-color COLOR        Color for [TX] tag (e.g., red, yellow)
   --no-ts                 Disable timestamps
+  --tui                   Full-screen view with scrollback: arrows/PgUp/PgDn/
+                          Home/End scroll, Space freeze, H hex/text, / search,
+                          n/N next older/newer match
+  --tui-scrollback MB     Memory for the scrollback (default: 256)
+  --tui-fps N             Screen refresh rate, 1-60 (default: 20)
+  --console-max-rate N    Above N lines/s show a summary per channel instead of
+                          every packet; full output resumes when traffic drops
+                          (the log still records everything)
+  --console-every N       While above the rate, show every Nth frame instead
+  --console-summary MS    Summary interval (default: 1000)
+
+Filtering:
+  --filter EXPR           Only show/log packets matching EXPR
+  --log-filter EXPR       Separate filter for the log file (overrides --filter)
+                          EXPR examples: "channel==RX && len>8 && bytes[0]==0x7E"
+                                         "text ~ /ERR[0-9]+/"
+
+Export:
+  --shm NAME              Export packets to the shared-memory ring NAME for other
+                          processes (see examples/ShmClient.cpp)
+  --shm-size KB           Ring size in KB (default: 4096)
+  --stream-port PORT      Stream packets to any number of subscribers on
+                          127.0.0.1:PORT (a subscriber may send "raw rx\n" etc.)
+  --stream-format FMT     Default stream: jsonl|raw (default: jsonl)
+  --stream-drop POLICY    Full subscriber queue: oldest|newest|disconnect
+                          (default: oldest)
+  --stream-queue KB       Queue per subscriber in KB (default: 1024)
 
 Timing:
-  --flush-timeout MS      Flush log file interval in ms (default: 250)
+  --flush-timeout MS      Flush log file interval in ms (default: 250;
+                          --durable commits replace it)
+
+Metrics:
+  --status-interval MS    Print a status line (rates, bus load, queue, latency)
+  --metrics-file PATH     Write Prometheus text metrics to PATH every second
+  --metrics-port PORT     Serve metrics on http://127.0.0.1:PORT/metrics
+
+Diagnostics:
+  --trace-file PATH       Record hot-path trace spans; written as Chrome trace
+                          JSON on exit or when T is pressed
+
+Traffic Generator:
+  --generate N|COMx       Write synthetic traffic to a port instead of listening
+  --pattern P             random|prbs|text|modbus|burst (default: prbs)
+  --rate BYTES            Paced byte rate per second (default: line rate)
+  --gen-bytes N           Stop after N bytes
+  --duration SEC          Stop after SEC seconds
+  --seed N                Pattern seed (default: 1)
+  --burst BYTES:IDLE_MS   Burst pattern shape (default: 256:50)
+  --truth PATH            Record every byte sent (ground truth)
+  --verify TRUTH CAPTURE  Compare a raw capture against a ground-truth file and
+                          report lost, reordered and corrupted bytes
 
 Other:
   --help, -h              Show this help
@@ -66,11 +190,28 @@ Available Colors:
 Examples:
   uart_listener --rx-port 5 --tx-port 6
   uart_listener --rx-port COM5 --tx-port COM6 --baud 9600 --format hex
+  uart_listener --rx-port 5 --tx-port 6 --baud 3000000 --parity even --flow rtscts
   uart_listener --rx-port 5 --tx-port 6 --rx-color green --tx-color red
   uart_listener --rx-port 5 --dual-off                   (RX only)
   uart_listener --tx-port 6 --dual-off                   (TX only)
+  uart_listener --rx-port 5 --tx-port 6 --filter "channel==RX && bytes[0]==0x7E"
+  uart_listener --generate 7 --baud 921600 --pattern modbus --truth gen.bin
+  uart_listener --verify gen.bin rx.bin
+  uart_listener --rx-port 5 --dual-off --durable 100 --rx-raw-out rx.bin
+  uart_listener --convert rx.bin rx.csv --format hex --record 16
+  uart_listener --analyze-file capture.log --analyze-csv windows.csv
+  uart_listener --rx-port 5 --tx-port 6 --sink col:capture.col
+  uart_listener --query capture.col --from 14:02 --to 14:05 --format hex
+  uart_listener --rx-port 5 --tx-port 6 --tui --status-interval 1000
+  uart_listener --rx-port 5 --tx-port 6 --sink log:hex.log,format=hex --sink raw:rx.bin,ch=rx
+  uart_listener --rx-port 5 --tx-port 6 --baud 6000000 --format hex --format-threads auto
+  uart_listener --rx-port 5 --tx-port 6 --baud 3000000 --console-max-rate 200 --log-file all.log
+  uart_listener --rx-port 5 --tx-port 6 --format hex --collapse-repeats
+  uart_listener --rx-port 5 --tx-port 6 --log-format sqlite --log-file capture.db
+  uart_listener --rx-port 5 --tx-port 6 --echo tx --status-interval 1000
+  uart_listener --rx-port 5 --tx-port 6 --txn seq --txn-end lf --txn-type 0:7
 
-Press ESC or Q to quit during operation.
+Press ESC or Q to quit during operation (T dumps the trace with --trace-file).
 )";
     }
 
@@ -172,13 +313,126 @@ Press ESC or Q to quit during operation.
                     std::cerr << "--baud requires an argument\n";
                     return false;
                 }
-                cfg.baudRate = static_cast<uint32_t>(std::stoul(argv[++i]));
-                if (cfg.baudRate == 0)
+                cfg.serial.baudRate = static_cast<uint32_t>(std::stoul(argv[++i]));
+                if (cfg.serial.baudRate == 0)
                 {
                     std::cerr << "Invalid baud rate\n";
                     return false;
                 }
             }
+            else if (argLow == "--data-bits")
+            {
+                if (i + 1 >= argc)
+                {
+                    std::cerr << "--data-bits requires an argument\n";
+                    return false;
+                }
+                const std::string bits = argv[++i];
+                if (bits.size() != 1 || bits[0] < '5' || bits[0] > '8')
+                {
+                    std::cerr << "Invalid --data-bits: use 5|6|7|8\n";
+                    return false;
+                }
+                cfg.serial.dataBits = static_cast<uint8_t>(bits[0] - '0');
+            }
+            else if (argLow == "--parity")
+            {
+                if (i + 1 >= argc)
+                {
+                    std::cerr << "--parity requires an argument\n";
+                    return false;
+                }
+                auto parity = ParityTraits::fromString(argv[++i]);
+                if (!parity.has_value())
+                {
+                    std::cerr << "Invalid --parity: use none|odd|even|mark|space\n";
+                    return false;
+                }
+                cfg.serial.parity = *parity;
+            }
+            else if (argLow == "--stop-bits")
+            {
+                if (i + 1 >= argc)
+                {
+                    std::cerr << "--stop-bits requires an argument\n";
+                    return false;
+                }
+                auto stopBits = StopBitsTraits::fromString(argv[++i]);
+                if (!stopBits.has_value())
+                {
+                    std::cerr << "Invalid --stop-bits: use 1|1.5|2\n";
+                    return false;
+                }
+                cfg.serial.stopBits = *stopBits;
+            }
+            else if (argLow == "--flow")
+            {
+                if (i + 1 >= argc)
+                {
+                    std::cerr << "--flow requires an argument\n";
+                    return false;
+                }
+                auto flow = FlowControlTraits::fromString(argv[++i]);
+                if (!flow.has_value())
+                {
+                    std::cerr << "Invalid --flow: use none|rtscts|dtrdsr\n";
+                    return false;
+                }
+                cfg.serial.flowControl = *flow;
+            }
+            else if (argLow == "--driver-queue")
+            {
+                if (i + 1 >= argc)
+                {
+                    std::cerr << "--driver-queue requires an argument\n";
+                    return false;
+                }
+                cfg.serial.inQueueSize = static_cast<uint32_t>(std::stoul(argv[++i]));
+                if (cfg.serial.inQueueSize < 1024)
+                {
+                    std::cerr << "Invalid --driver-queue: minimum is 1024 bytes\n";
+                    return false;
+                }
+            }
+            else if (argLow == "--coalesce")
+            {
+                if (i + 1 >= argc)
+                {
+                    std::cerr << "--coalesce requires BYTES:US\n";
+                    return false;
+                }
+                const std::string spec = argv[++i];
+                const size_t      colon = spec.find(':');
+                if (colon == std::string::npos || !isNumber(spec.substr(0, colon)) || !isNumber(spec.substr(colon + 1)))
+                {
+                    std::cerr << "Invalid --coalesce: use BYTES:US (e.g. 4096:2000)\n";
+                    return false;
+                }
+                cfg.coalesce.maxBytes = static_cast<uint32_t>(std::stoul(spec.substr(0, colon)));
+                cfg.coalesce.budgetUs = static_cast<uint32_t>(std::stoul(spec.substr(colon + 1)));
+            }
+            else if (argLow == "--no-coalesce")
+            {
+                cfg.coalesce.maxBytes = 0;
+            }
+            else if (argLow == "--reconnect")
+            {
+                if (i + 1 >= argc)
+                {
+                    std::cerr << "--reconnect requires an argument\n";
+                    return false;
+                }
+                if (!isNumber(argv[i + 1]) || std::stoul(argv[i + 1]) == 0)
+                {
+                    std::cerr << "Invalid --reconnect: use a backoff limit in ms (1 or more)\n";
+                    return false;
+                }
+                cfg.reconnectMaxMs = static_cast<uint32_t>(std::stoul(argv[++i]));
+            }
+            else if (argLow == "--no-reconnect")
+            {
+                cfg.reconnectMaxMs = 0;
+            }
             else if (argLow == "--format")
             {
                 if (i + 1 >= argc)
@@ -194,6 +448,58 @@ Press ESC or Q to quit during operation.
                 }
                 cfg.outputFormat = *fmt;
             }
+            else if (argLow == "--file-writer")
+            {
+                if (i + 1 >= argc)
+                {
+                    std::cerr << "--file-writer requires an argument\n";
+                    return false;
+                }
+                auto kind = FileWriterKindTraits::fromString(argv[++i]);
+                if (!kind.has_value())
+                {
+                    std::cerr << "Invalid --file-writer: use stream|buffered|mmap\n";
+                    return false;
+                }
+                cfg.fileWriter.kind = *kind;
+            }
+            else if (argLow == "--prealloc")
+            {
+                if (i + 1 >= argc)
+                {
+                    std::cerr << "--prealloc requires an argument\n";
+                    return false;
+                }
+                cfg.fileWriter.extentMb = static_cast<uint32_t>(std::stoul(argv[++i]));
+                if (cfg.fileWriter.extentMb == 0 || cfg.fileWriter.extentMb > 4096)
+                {
+                    std::cerr << "Invalid --prealloc: use 1 to 4096 MB\n";
+                    return false;
+                }
+            }
+            else if (argLow == "--durable")
+            {
+                if (i + 1 >= argc)
+                {
+                    std::cerr << "--durable requires an argument\n";
+                    return false;
+                }
+                cfg.fileWriter.durableMs = static_cast<uint32_t>(std::stoul(argv[++i]));
+                if (cfg.fileWriter.durableMs == 0 || cfg.fileWriter.durableMs > 60000)
+                {
+                    std::cerr << "Invalid --durable: use 1 to 60000 ms\n";
+                    return false;
+                }
+            }
+            else if (argLow == "--recover")
+            {
+                if (i + 1 >= argc)
+                {
+                    std::cerr << "--recover requires a path\n";
+                    return false;
+                }
+                cfg.recoverPath = argv[++i];
+            }
             else if (argLow == "--log-format")
             {
                 if (i + 1 >= argc)
@@ -204,7 +510,12 @@ Press ESC or Q to quit during operation.
                 auto fmt = LogFormatTraits::fromString(argv[++i]);
                 if (!fmt.has_value())
                 {
-                    std::cerr << "Invalid --log-format: use text|csv\n";
+                    std::cerr << "Invalid --log-format: use text|csv|sqlite\n";
+                    return false;
+                }
+                if (*fmt == LogFormat::Sqlite && !sqliteAvailable())
+                {
+                    std::cerr << "Invalid --log-format: this build has no SQLite support\n";
                     return false;
                 }
                 cfg.logFormat = *fmt;
@@ -236,6 +547,50 @@ Press ESC or Q to quit during operation.
                 }
                 cfg.txRawOutPath = argv[++i];
             }
+            else if (argLow == "--format-threads")
+            {
+                if (i + 1 >= argc)
+                {
+                    std::cerr << "--format-threads requires an argument\n";
+                    return false;
+                }
+                const std::string value = toLower(argv[++i]);
+                if (value == "auto")
+                {
+                    cfg.formatThreads = std::max(1u, std::thread::hardware_concurrency());
+                }
+                else if (isNumber(value) && value.size() <= 3 && std::stoul(value) >= 1 && std::stoul(value) <= 64)
+                {
+                    cfg.formatThreads = static_cast<uint32_t>(std::stoul(value));
+                }
+                else
+                {
+                    std::cerr << "Invalid --format-threads: use 1 to 64 or auto\n";
+                    return false;
+                }
+            }
+            else if (argLow == "--sink")
+            {
+                if (i + 1 >= argc)
+                {
+                    std::cerr << "--sink requires a spec (e.g. log:hex.log,format=hex)\n";
+                    return false;
+                }
+                // The path keeps its case
+                SinkSpec    spec;
+                std::string error;
+                if (!parseSinkSpec(argv[++i], spec, error))
+                {
+                    std::cerr << "Invalid --sink: " << error << "\n";
+                    return false;
+                }
+                if (cfg.sinks.size() >= 16)
+                {
+                    std::cerr << "Invalid --sink: at most 16 sinks\n";
+                    return false;
+                }
+                cfg.sinks.push_back(spec);
+            }
             else if (argLow == "--rx-color")
             {
                 if (i + 1 >= argc)
@@ -279,16 +634,713 @@ Press ESC or Q to quit during operation.
                 }
                 cfg.flushTimeoutMs = static_cast<uint32_t>(std::stoul(argv[++i]));
             }
-            else if (argLow == "--dual-off")
+            else if (argLow == "--status-interval")
             {
-                cfg.dualMode = false;
+                if (i + 1 >= argc)
+                {
+                    std::cerr << "--status-interval requires an argument\n";
+                    return false;
+                }
+                cfg.statusIntervalMs = static_cast<uint32_t>(std::stoul(argv[++i]));
             }
-            else
+            else if (argLow == "--metrics-file")
             {
-                std::cerr << "Unknown argument: " << arg << "\n";
-                std::cerr << "Use --help for usage.\n";
-                return false;
+                if (i + 1 >= argc)
+                {
+                    std::cerr << "--metrics-file requires a path\n";
+                    return false;
+                }
+                cfg.metricsFilePath = argv[++i];
+            }
+            else if (argLow == "--metrics-port")
+            {
+                if (i + 1 >= argc)
+                {
+                    std::cerr << "--metrics-port requires an argument\n";
+                    return false;
+                }
+                const unsigned long port = std::stoul(argv[++i]);
+                if (port == 0 || port > 65535)
+                {
+                    std::cerr << "Invalid --metrics-port (1-65535)\n";
+                    return false;
+                }
+                cfg.metricsPort = static_cast<uint16_t>(port);
+            }
+            else if (argLow == "--trace-file")
+            {
+                if (i + 1 >= argc)
+                {
+                    std::cerr << "--trace-file requires a path\n";
+                    return false;
+                }
+                cfg.traceFilePath = argv[++i];
+            }
+            else if (argLow == "--shm")
+            {
+                if (i + 1 >= argc)
+                {
+                    std::cerr << "--shm requires a name\n";
+                    return false;
+                }
+                cfg.shmName = argv[++i];
+                if (cfg.shmName->empty() || cfg.shmName->find('\\') != std::string::npos)
+                {
+                    std::cerr << "Invalid --shm: name must not be empty or contain '\\'\n";
+                    return false;
+                }
+            }
+            else if (argLow == "--stream-port")
+            {
+                if (i + 1 >= argc)
+                {
+                    std::cerr << "--stream-port requires an argument\n";
+                    return false;
+                }
+                const unsigned long port = std::stoul(argv[++i]);
+                if (port == 0 || port > 65535)
+                {
+                    std::cerr << "Invalid --stream-port (1-65535)\n";
+                    return false;
+                }
+                cfg.stream.port = static_cast<uint16_t>(port);
+            }
+            else if (argLow == "--stream-format")
+            {
+                if (i + 1 >= argc)
+                {
+                    std::cerr << "--stream-format requires an argument\n";
+                    return false;
+                }
+                auto fmt = StreamFormatTraits::fromString(argv[++i]);
+                if (!fmt.has_value())
+                {
+                    std::cerr << "Invalid --stream-format: use jsonl|raw\n";
+                    return false;
+                }
+                cfg.stream.format = *fmt;
+            }
+            else if (argLow == "--stream-drop")
+            {
+                if (i + 1 >= argc)
+                {
+                    std::cerr << "--stream-drop requires an argument\n";
+                    return false;
+                }
+                auto policy = StreamDropPolicyTraits::fromString(argv[++i]);
+                if (!policy.has_value())
+                {
+                    std::cerr << "Invalid --stream-drop: use oldest|newest|disconnect\n";
+                    return false;
+                }
+                cfg.stream.dropPolicy = *policy;
+            }
+            else if (argLow == "--stream-queue")
+            {
+                if (i + 1 >= argc)
+                {
+                    std::cerr << "--stream-queue requires an argument\n";
+                    return false;
+                }
+                cfg.stream.queueKb = static_cast<uint32_t>(std::stoul(argv[++i]));
+                if (cfg.stream.queueKb < 16)
+                {
+                    std::cerr << "Invalid --stream-queue: minimum is 16 KB\n";
+                    return false;
+                }
+            }
+            else if (argLow == "--shm-size")
+            {
+                if (i + 1 >= argc)
+                {
+                    std::cerr << "--shm-size requires an argument\n";
+                    return false;
+                }
+                cfg.shmSizeKb = static_cast<uint32_t>(std::stoul(argv[++i]));
+                if (cfg.shmSizeKb < 64 || cfg.shmSizeKb > 1024 * 1024)
+                {
+                    std::cerr << "Invalid --shm-size: use 64 to 1048576 KB\n";
+                    return false;
+                }
+            }
+            else if (argLow == "--filter")
+            {
+                if (i + 1 >= argc)
+                {
+                    std::cerr << "--filter requires an expression\n";
+                    return false;
+                }
+                cfg.filterExpr = argv[++i];
+            }
+            else if (argLow == "--log-filter")
+            {
+                if (i + 1 >= argc)
+                {
+                    std::cerr << "--log-filter requires an expression\n";
+                    return false;
+                }
+                cfg.logFilterExpr = argv[++i];
+            }
+            else if (argLow == "--generate")
+            {
+                if (i + 1 >= argc)
+                {
+                    std::cerr << "--generate requires a port\n";
+                    return false;
+                }
+                cfg.generatePort = normalizePortToCOM(argv[++i]);
+            }
+            else if (argLow == "--pattern")
+            {
+                if (i + 1 >= argc)
+                {
+                    std::cerr << "--pattern requires an argument\n";
+                    return false;
+                }
+                auto pattern = TrafficPatternTraits::fromString(argv[++i]);
+                if (!pattern.has_value())
+                {
+                    std::cerr << "Invalid --pattern: use random|prbs|text|modbus|burst\n";
+                    return false;
+                }
+                cfg.generator.pattern = *pattern;
+            }
+            else if (argLow == "--rate")
+            {
+                if (i + 1 >= argc)
+                {
+                    std::cerr << "--rate requires an argument\n";
+                    return false;
+                }
+                cfg.generator.bytesPerSecond = static_cast<uint32_t>(std::stoul(argv[++i]));
             }
+            else if (argLow == "--gen-bytes")
+            {
+                if (i + 1 >= argc)
+                {
+                    std::cerr << "--gen-bytes requires an argument\n";
+                    return false;
+                }
+                cfg.generator.totalBytes = std::stoull(argv[++i]);
+            }
+            else if (argLow == "--duration")
+            {
+                if (i + 1 >= argc)
+                {
+                    std::cerr << "--duration requires an argument\n";
+                    return false;
+                }
+                cfg.generator.durationSec = static_cast<uint32_t>(std::stoul(argv[++i]));
+            }
+            else if (argLow == "--seed")
+            {
+                if (i + 1 >= argc)
+                {
+                    std::cerr << "--seed requires an argument\n";
+                    return false;
+                }
+                cfg.generator.seed = static_cast<uint32_t>(std::stoul(argv[++i]));
+            }
+            else if (argLow == "--burst")
+            {
+                if (i + 1 >= argc)
+                {
+                    std::cerr << "--burst requires BYTES:IDLE_MS\n";
+                    return false;
+                }
+                const std::string spec = argv[++i];
+                const size_t      colon = spec.find(':');
+                if (colon == std::string::npos || !isNumber(spec.substr(0, colon)) || !isNumber(spec.substr(colon + 1)))
+                {
+                    std::cerr << "Invalid --burst: use BYTES:IDLE_MS (e.g. 256:50)\n";
+                    return false;
+                }
+                cfg.generator.burstBytes = static_cast<uint32_t>(std::stoul(spec.substr(0, colon)));
+                cfg.generator.burstIdleMs = static_cast<uint32_t>(std::stoul(spec.substr(colon + 1)));
+            }
+            else if (argLow == "--truth")
+            {
+                if (i + 1 >= argc)
+                {
+                    std::cerr << "--truth requires a path\n";
+                    return false;
+                }
+                cfg.generator.truthFilePath = argv[++i];
+            }
+            else if (argLow == "--verify")
+            {
+                if (i + 2 >= argc)
+                {
+                    std::cerr << "--verify requires TRUTH and CAPTURE paths\n";
+                    return false;
+                }
+                cfg.verifyTruthPath = argv[++i];
+                cfg.verifyCapturePath = argv[++i];
+            }
+            else if (argLow == "--convert")
+            {
+                if (i + 2 >= argc)
+                {
+                    std::cerr << "--convert requires IN and OUT paths\n";
+                    return false;
+                }
+                cfg.convertInputPath = argv[++i];
+                cfg.convertOutputPath = argv[++i];
+            }
+            else if (argLow == "--convert-to")
+            {
+                if (i + 1 >= argc)
+                {
+                    std::cerr << "--convert-to requires an argument\n";
+                    return false;
+                }
+                auto fmt = ConvertFormatTraits::fromString(argv[++i]);
+                if (!fmt.has_value())
+                {
+                    std::cerr << "Invalid --convert-to: use text|csv|jsonl\n";
+                    return false;
+                }
+                cfg.convert.format = *fmt;
+                cfg.convertFormatSet = true;
+            }
+            else if (argLow == "--record")
+            {
+                if (i + 1 >= argc)
+                {
+                    std::cerr << "--record requires an argument\n";
+                    return false;
+                }
+                const std::string spec = toLower(argv[++i]);
+                if (spec == "lf")
+                {
+                    cfg.convert.recordBytes = 0;
+                }
+                else if (isNumber(spec) && std::stoul(spec) >= 1 && std::stoul(spec) <= 65536)
+                {
+                    cfg.convert.recordBytes = static_cast<uint32_t>(std::stoul(spec));
+                }
+                else
+                {
+                    std::cerr << "Invalid --record: use lf or 1 to 65536 bytes\n";
+                    return false;
+                }
+            }
+            else if (argLow == "--channel")
+            {
+                if (i + 1 >= argc)
+                {
+                    std::cerr << "--channel requires an argument\n";
+                    return false;
+                }
+                const std::string channel = toLower(argv[++i]);
+                if (channel != "rx" && channel != "tx")
+                {
+                    std::cerr << "Invalid --channel: use rx|tx\n";
+                    return false;
+                }
+                cfg.convert.channel = (channel == "tx") ? Channel::TX : Channel::RX;
+                cfg.query.channel = cfg.convert.channel;
+            }
+            else if (argLow == "--threads")
+            {
+                if (i + 1 >= argc)
+                {
+                    std::cerr << "--threads requires an argument\n";
+                    return false;
+                }
+                cfg.convert.threads = static_cast<uint32_t>(std::stoul(argv[++i]));
+                if (cfg.convert.threads == 0 || cfg.convert.threads > 256)
+                {
+                    std::cerr << "Invalid --threads: use 1 to 256\n";
+                    return false;
+                }
+            }
+            else if (argLow == "--analyze")
+            {
+                cfg.analyze.live = true;
+            }
+            else if (argLow == "--analyze-file")
+            {
+                if (i + 1 >= argc)
+                {
+                    std::cerr << "--analyze-file requires an argument\n";
+                    return false;
+                }
+                cfg.analyzeInputPath = argv[++i];
+            }
+            else if (argLow == "--analyze-window")
+            {
+                if (i + 1 >= argc)
+                {
+                    std::cerr << "--analyze-window requires an argument\n";
+                    return false;
+                }
+                cfg.analyze.windowMs = static_cast<uint32_t>(std::stoul(argv[++i]));
+                if (cfg.analyze.windowMs == 0 || cfg.analyze.windowMs > 3600000)
+                {
+                    std::cerr << "Invalid --analyze-window: use 1 to 3600000 ms\n";
+                    return false;
+                }
+            }
+            else if (argLow == "--analyze-csv")
+            {
+                if (i + 1 >= argc)
+                {
+                    std::cerr << "--analyze-csv requires an argument\n";
+                    return false;
+                }
+                cfg.analyze.csvPath = argv[++i];
+            }
+            else if (argLow == "--analyze-json")
+            {
+                if (i + 1 >= argc)
+                {
+                    std::cerr << "--analyze-json requires an argument\n";
+                    return false;
+                }
+                cfg.analyze.jsonPath = argv[++i];
+            }
+            else if (argLow == "--query")
+            {
+                if (i + 1 >= argc)
+                {
+                    std::cerr << "--query requires an argument\n";
+                    return false;
+                }
+                cfg.queryInputPath = argv[++i];
+            }
+            else if (argLow == "--from" || argLow == "--to")
+            {
+                if (i + 1 >= argc)
+                {
+                    std::cerr << argLow << " requires an argument\n";
+                    return false;
+                }
+                // Checked against the capture start in runQuery()
+                (argLow == "--from" ? cfg.query.from : cfg.query.to) = argv[++i];
+            }
+            else if (argLow == "--query-out")
+            {
+                if (i + 1 >= argc)
+                {
+                    std::cerr << "--query-out requires an argument\n";
+                    return false;
+                }
+                const auto output = QueryOutputTraits::fromString(argv[++i]);
+                if (!output.has_value())
+                {
+                    std::cerr << "Invalid --query-out: use text|csv|count\n";
+                    return false;
+                }
+                cfg.query.output = *output;
+            }
+            else if (argLow == "--echo")
+            {
+                if (i + 1 >= argc)
+                {
+                    std::cerr << "--echo requires an argument\n";
+                    return false;
+                }
+                const std::string source = toLower(argv[++i]);
+                if (source != "rx" && source != "tx")
+                {
+                    std::cerr << "Invalid --echo: use tx (TX echoed on RX) or rx\n";
+                    return false;
+                }
+                cfg.echo.enabled = true;
+                cfg.echo.source = (source == "rx") ? Channel::RX : Channel::TX;
+            }
+            else if (argLow == "--echo-window")
+            {
+                if (i + 1 >= argc)
+                {
+                    std::cerr << "--echo-window requires an argument\n";
+                    return false;
+                }
+                cfg.echo.windowBytes = static_cast<uint32_t>(std::stoul(argv[++i]));
+                if (cfg.echo.windowBytes < 1024 || cfg.echo.windowBytes > 16 * 1024 * 1024)
+                {
+                    std::cerr << "Invalid --echo-window: use 1024 to 16777216 bytes\n";
+                    return false;
+                }
+            }
+            else if (argLow == "--echo-block")
+            {
+                if (i + 1 >= argc)
+                {
+                    std::cerr << "--echo-block requires an argument\n";
+                    return false;
+                }
+                cfg.echo.blockBytes = static_cast<uint32_t>(std::stoul(argv[++i]));
+                if (cfg.echo.blockBytes < 2 || cfg.echo.blockBytes > 32)
+                {
+                    std::cerr << "Invalid --echo-block: use 2 to 32 bytes\n";
+                    return false;
+                }
+            }
+            else if (argLow == "--echo-wait")
+            {
+                if (i + 1 >= argc)
+                {
+                    std::cerr << "--echo-wait requires an argument\n";
+                    return false;
+                }
+                cfg.echo.maxWaitMs = static_cast<uint32_t>(std::stoul(argv[++i]));
+                if (cfg.echo.maxWaitMs == 0 || cfg.echo.maxWaitMs > 60000)
+                {
+                    std::cerr << "Invalid --echo-wait: use 1 to 60000 ms\n";
+                    return false;
+                }
+            }
+            else if (argLow == "--txn")
+            {
+                if (i + 1 >= argc)
+                {
+                    std::cerr << "--txn requires an argument\n";
+                    return false;
+                }
+                // The pattern keeps its case; only the mode name is compared lowercase
+                const std::string spec = argv[++i];
+                const size_t      colon = spec.find(':');
+                const std::string mode = toLower(spec.substr(0, colon));
+                const std::string rest = (colon == std::string::npos) ? std::string() : spec.substr(colon + 1);
+                if (mode == "seq" && colon == std::string::npos)
+                {
+                    cfg.txn.match = TxnMatch::Sequence;
+                }
+                else if (mode == "id" && colon != std::string::npos)
+                {
+                    const size_t second = rest.find(':');
+                    const std::string offset = rest.substr(0, second);
+                    const std::string length = (second == std::string::npos) ? "1" : rest.substr(second + 1);
+                    if (!isNumber(offset) || !isNumber(length) || std::stoul(length) == 0
+                        || std::stoul(length) > TransactionTracker::kMaxKeyBytes || std::stoul(offset) > 4095)
+                    {
+                        std::cerr << "Invalid --txn id: use id:OFFSET or id:OFFSET:LEN (LEN 1-32)\n";
+                        return false;
+                    }
+                    cfg.txn.match = TxnMatch::IdBytes;
+                    cfg.txn.idOffset = static_cast<uint32_t>(std::stoul(offset));
+                    cfg.txn.idLength = static_cast<uint32_t>(std::stoul(length));
+                }
+                else if (mode == "regex" && !rest.empty())
+                {
+                    cfg.txn.match = TxnMatch::Pattern;
+                    cfg.txn.pattern = rest;
+                }
+                else
+                {
+                    std::cerr << "Invalid --txn: use seq, id:OFFSET[:LEN] or regex:PATTERN\n";
+                    return false;
+                }
+                cfg.txn.enabled = true;
+            }
+            else if (argLow == "--txn-type")
+            {
+                if (i + 1 >= argc)
+                {
+                    std::cerr << "--txn-type requires OFFSET:LEN\n";
+                    return false;
+                }
+                const std::string spec = argv[++i];
+                const size_t      colon = spec.find(':');
+                if (colon == std::string::npos || !isNumber(spec.substr(0, colon)) || !isNumber(spec.substr(colon + 1))
+                    || std::stoul(spec.substr(colon + 1)) > 64 || std::stoul(spec.substr(0, colon)) > 4095)
+                {
+                    std::cerr << "Invalid --txn-type: use OFFSET:LEN (e.g. 1:1 for a Modbus function code, LEN up to 64)\n";
+                    return false;
+                }
+                cfg.txn.typeOffset = static_cast<uint32_t>(std::stoul(spec.substr(0, colon)));
+                cfg.txn.typeLength = static_cast<uint32_t>(std::stoul(spec.substr(colon + 1)));
+            }
+            else if (argLow == "--txn-end")
+            {
+                if (i + 1 >= argc)
+                {
+                    std::cerr << "--txn-end requires an argument\n";
+                    return false;
+                }
+                const std::string value = toLower(argv[++i]);
+                unsigned long     byte = 256;
+                if (value == "lf")
+                {
+                    byte = 0x0A;
+                }
+                else if (value == "cr")
+                {
+                    byte = 0x0D;
+                }
+                else if (isNumber(value))
+                {
+                    byte = std::stoul(value);
+                }
+                else if (value.size() > 2 && value.size() <= 4 && value.rfind("0x", 0) == 0
+                         && value.find_first_not_of("0123456789abcdef", 2) == std::string::npos)
+                {
+                    byte = std::stoul(value.substr(2), nullptr, 16);
+                }
+                if (byte > 255)
+                {
+                    std::cerr << "Invalid --txn-end: use lf, cr or a byte value (0-255, 0x00-0xFF)\n";
+                    return false;
+                }
+                cfg.txn.frameEnd = static_cast<uint8_t>(byte);
+            }
+            else if (argLow == "--txn-timeout")
+            {
+                if (i + 1 >= argc)
+                {
+                    std::cerr << "--txn-timeout requires an argument\n";
+                    return false;
+                }
+                cfg.txn.timeoutMs = static_cast<uint32_t>(std::stoul(argv[++i]));
+                if (cfg.txn.timeoutMs == 0 || cfg.txn.timeoutMs > 600000)
+                {
+                    std::cerr << "Invalid --txn-timeout: use 1 to 600000 ms\n";
+                    return false;
+                }
+            }
+            else if (argLow == "--txn-csv")
+            {
+                if (i + 1 >= argc)
+                {
+                    std::cerr << "--txn-csv requires an argument\n";
+                    return false;
+                }
+                cfg.txn.csvPath = argv[++i];
+            }
+            else if (argLow == "--tui")
+            {
+                cfg.tui.enabled = true;
+            }
+            else if (argLow == "--tui-scrollback")
+            {
+                if (i + 1 >= argc)
+                {
+                    std::cerr << "--tui-scrollback requires an argument\n";
+                    return false;
+                }
+                cfg.tui.scrollbackMb = static_cast<uint32_t>(std::stoul(argv[++i]));
+                if (cfg.tui.scrollbackMb < 1 || cfg.tui.scrollbackMb > 16384)
+                {
+                    std::cerr << "Invalid --tui-scrollback: use 1 to 16384 MB\n";
+                    return false;
+                }
+            }
+            else if (argLow == "--tui-fps")
+            {
+                if (i + 1 >= argc)
+                {
+                    std::cerr << "--tui-fps requires an argument\n";
+                    return false;
+                }
+                cfg.tui.fps = static_cast<uint32_t>(std::stoul(argv[++i]));
+                if (cfg.tui.fps < 1 || cfg.tui.fps > 60)
+                {
+                    std::cerr << "Invalid --tui-fps: use 1 to 60\n";
+                    return false;
+                }
+            }
+            else if (argLow == "--collapse-repeats")
+            {
+                cfg.collapse.enabled = true;
+            }
+            else if (argLow == "--collapse-hold")
+            {
+                if (i + 1 >= argc)
+                {
+                    std::cerr << "--collapse-hold requires an argument\n";
+                    return false;
+                }
+                cfg.collapse.holdMs = static_cast<uint32_t>(std::stoul(argv[++i]));
+                if (cfg.collapse.holdMs < 10 || cfg.collapse.holdMs > 3600000)
+                {
+                    std::cerr << "Invalid --collapse-hold: use 10 to 3600000 ms\n";
+                    return false;
+                }
+                cfg.collapse.enabled = true;
+            }
+            else if (argLow == "--console-max-rate")
+            {
+                if (i + 1 >= argc)
+                {
+                    std::cerr << "--console-max-rate requires an argument\n";
+                    return false;
+                }
+                cfg.console.maxLinesPerSec = static_cast<uint32_t>(std::stoul(argv[++i]));
+            }
+            else if (argLow == "--console-every")
+            {
+                if (i + 1 >= argc)
+                {
+                    std::cerr << "--console-every requires an argument\n";
+                    return false;
+                }
+                cfg.console.everyNth = static_cast<uint32_t>(std::stoul(argv[++i]));
+                if (cfg.console.everyNth < 2)
+                {
+                    std::cerr << "Invalid --console-every: use 2 or more\n";
+                    return false;
+                }
+            }
+            else if (argLow == "--console-summary")
+            {
+                if (i + 1 >= argc)
+                {
+                    std::cerr << "--console-summary requires an argument\n";
+                    return false;
+                }
+                cfg.console.summaryMs = static_cast<uint32_t>(std::stoul(argv[++i]));
+                if (cfg.console.summaryMs < 100 || cfg.console.summaryMs > 60000)
+                {
+                    std::cerr << "Invalid --console-summary: use 100 to 60000 ms\n";
+                    return false;
+                }
+            }
+            else if (argLow == "--dual-off")
+            {
+                cfg.dualMode = false;
+            }
+            else
+            {
+                std::cerr << "Unknown argument: " << arg << "\n";
+                std::cerr << "Use --help for usage.\n";
+                return false;
+            }
+        }
+
+        // Durable files are synced through their handle, which std::filebuf does not expose
+        if (cfg.fileWriter.durableMs != 0 && cfg.fileWriter.kind == FileWriterKind::Stream)
+        {
+            cfg.fileWriter.kind = FileWriterKind::Buffered;
+        }
+
+        // Conversion output format follows the file extension unless given
+        if (cfg.convertOutputPath.has_value() && !cfg.convertFormatSet)
+        {
+            const std::string out = toLower(*cfg.convertOutputPath);
+            const auto        endsWith = [&out](const std::string& ext) {
+                return out.size() >= ext.size() && out.compare(out.size() - ext.size(), ext.size(), ext) == 0;
+            };
+            if (endsWith(".csv"))
+            {
+                cfg.convert.format = ConvertFormat::Csv;
+            }
+            else if (endsWith(".jsonl") || endsWith(".json"))
+            {
+                cfg.convert.format = ConvertFormat::Jsonl;
+            }
+        }
+
+        // The offline modes share --threads and --channel
+        cfg.analyze.threads = cfg.convert.threads;
+        cfg.analyze.rawChannel = cfg.convert.channel;
+
+        // Generator, verify, recover, convert, analyze-file and query modes do not listen on any port
+        if (cfg.generatePort.has_value() || cfg.verifyTruthPath.has_value() || cfg.recoverPath.has_value()
+            || cfg.convertInputPath.has_value() || cfg.analyzeInputPath.has_value() || cfg.queryInputPath.has_value())
+        {
+            return true;
         }
 
         // Interactive fallback for missing ports
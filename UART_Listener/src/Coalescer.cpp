@@ -0,0 +1,74 @@
+/**
+ ****************************************************************************************
+ * @file   Coalescer.cpp
+ * @brief  Adaptive merging of consecutive driver reads into one Packet.
+ *
+ * @author Patrik Neunteufel
+ * @date   Oct 2026
+ ****************************************************************************************
+ */
+
+#include "Coalescer.hpp"
+#include "Time.hpp"
+
+#include <algorithm>
+
+namespace uart_listener
+{
+    ReadCoalescer::ReadCoalescer(Channel channel, const CoalesceOptions& options)
+        : m_channel(channel),
+          m_options(options),
+          m_budget(options.budgetUs),
+          m_avgGapUs(2 * static_cast<int64_t>(options.budgetUs))  // start in pass-through
+    {
+    }
+
+    bool ReadCoalescer::append(const uint8_t* data, size_t size, Clock::time_point now)
+    {
+        // Track the read rate; gaps are clamped so a burst after idle adapts within a few reads
+        const int64_t budgetUs = static_cast<int64_t>(m_options.budgetUs);
+        const int64_t gapUs = std::min<int64_t>(
+            std::chrono::duration_cast<std::chrono::microseconds>(now - m_lastRead).count(), 2 * budgetUs);
+        m_avgGapUs += (gapUs - m_avgGapUs) / 8;
+        m_lastRead = now;
+
+        const bool holding = m_options.enabled() && m_avgGapUs < budgetUs;
+
+        m_started = m_pending.data.empty();
+        if (m_started)
+        {
+            m_pending.channel = m_channel;
+            m_pending.readTime = now;
+            m_pending.timestamp = getTimestampWithMs();
+            if (holding)
+            {
+                m_pending.data.reserve(m_options.maxBytes + size);
+            }
+        }
+        else
+        {
+            if (m_pending.segments.empty())
+            {
+                m_pending.segments.push_back({ 0, 0 });
+            }
+            m_pending.segments.push_back({
+                static_cast<uint32_t>(m_pending.data.size()),
+                static_cast<uint32_t>(std::chrono::duration_cast<std::chrono::microseconds>(
+                    now - m_pending.readTime).count()) });
+        }
+
+        m_pending.data.insert(m_pending.data.end(), data, data + size);
+
+        return !holding
+            || m_pending.data.size() >= m_options.maxBytes
+            || now >= deadline();
+    }
+
+    Packet ReadCoalescer::take()
+    {
+        Packet out = std::move(m_pending);
+        m_pending = Packet{};
+        m_started = false;
+        return out;
+    }
+}
@@ -0,0 +1,66 @@
+/**
+ ****************************************************************************************
+ * @file   Coalescer.hpp
+ * @brief  Adaptive merging of consecutive driver reads into one Packet.
+ *
+ *         At high rates USB-serial drivers return many small chunks; each one
+ *         would otherwise cost a queue operation, a formatting call and a log line.
+ *         Reads are merged until a byte threshold or a latency budget is reached.
+ *         Merging only kicks in while reads arrive faster than the budget, so
+ *         interactive traffic at low rates is passed through immediately.
+ *
+ * @author Patrik Neunteufel
+ * @date   Oct 2026
+ ****************************************************************************************
+ */
+#pragma once
+
+#include "UART.hpp"
+
+#include <chrono>
+#include <cstdint>
+
+namespace uart_listener
+{
+    struct CoalesceOptions
+    {
+        uint32_t maxBytes = 4096;  // flush once this many bytes are pending (0 = coalescing off)
+        uint32_t budgetUs = 2000;  // flush at the latest this long after the first read
+
+        bool enabled() const noexcept { return maxBytes > 0 && budgetUs > 0; }
+    };
+
+    class ReadCoalescer
+    {
+    public:
+        using Clock = std::chrono::steady_clock;
+
+        ReadCoalescer(Channel channel, const CoalesceOptions& options);
+
+        /**
+         * @brief Append one driver read.
+         * @return true if the pending packet should be flushed now
+         */
+        bool append(const uint8_t* data, size_t size, Clock::time_point now);
+
+        bool hasPending() const noexcept { return !m_pending.data.empty(); }
+
+        /** @brief Latest flush time for the pending packet. */
+        Clock::time_point deadline() const noexcept { return m_pending.readTime + m_budget; }
+
+        /** @brief True if the pending packet was just started (arm the flush timer). */
+        bool startedPacket() const noexcept { return m_started; }
+
+        /** @brief Hand out the pending packet and start over. */
+        Packet take();
+
+    private:
+        Channel                   m_channel;
+        CoalesceOptions           m_options;
+        std::chrono::microseconds m_budget;
+        Packet                    m_pending;
+        bool                      m_started = false;
+        Clock::time_point         m_lastRead{};
+        int64_t                   m_avgGapUs;  // EWMA of the gap between reads
+    };
+}
@@ -0,0 +1,803 @@
+/**
+ ****************************************************************************************
+ * @file   Columnar.cpp
+ * @brief  Columnar capture files for analytics (--sink col:PATH, --query PATH).
+ *
+ * @author Patrik Neunteufel
+ * @date   Oct 2026
+ ****************************************************************************************
+ */
+
+#include "Columnar.hpp"
+#include "DataFormat.hpp"
+#include "DurableLog.hpp"
+#include "LogLine.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <iomanip>
+#include <iostream>
+#include <tuple>
+
+namespace uart_listener
+{
+    namespace
+    {
+        constexpr char     kFileMagic[8] = { 'U', 'A', 'R', 'T', 'C', 'O', 'L', '1' };
+        constexpr char     kIndexMagic[8] = { 'U', 'C', 'O', 'L', 'I', 'D', 'X', '1' };
+        constexpr uint32_t kBlockMagic = 0x31424355;   // "UCB1"
+        constexpr uint32_t kVersion = 1;
+        constexpr size_t   kFileHeader = 8 + 4 + 4 + 8;          // + info text
+        constexpr size_t   kBlockHeader = 4 + 4 + 8 + 8 + 4 * columnar::kColumns * 2;
+        constexpr size_t   kIndexEntry = 8 + 4 + 8 + 8;
+        constexpr size_t   kIndexTrailer = 8 + 4 + 8;
+
+        template<typename T>
+        void put(std::string& out, T value)
+        {
+            char bytes[sizeof(T)];
+            std::memcpy(bytes, &value, sizeof(T));   // x86/x64: already little-endian
+            out.append(bytes, sizeof(T));
+        }
+
+        template<typename T>
+        T get(const uint8_t* p)
+        {
+            T value;
+            std::memcpy(&value, p, sizeof(T));
+            return value;
+        }
+
+        void putVarint(std::string& out, uint64_t value)
+        {
+            while (value >= 0x80)
+            {
+                out.push_back(static_cast<char>((value & 0x7F) | 0x80));
+                value >>= 7;
+            }
+            out.push_back(static_cast<char>(value));
+        }
+
+        /** @return false past the end or for an overlong value */
+        bool getVarint(const uint8_t*& p, const uint8_t* end, uint64_t& value)
+        {
+            value = 0;
+            for (unsigned shift = 0; shift < 64; shift += 7)
+            {
+                if (p == end)
+                {
+                    return false;
+                }
+                const uint8_t byte = *p++;
+                value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+                if ((byte & 0x80) == 0)
+                {
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        uint64_t zigzag(int64_t value)
+        {
+            return (static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63);
+        }
+
+        int64_t unzigzag(uint64_t value)
+        {
+            return static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1);
+        }
+
+        void putRuns(std::string& out, const std::vector<uint8_t>& values)
+        {
+            for (size_t i = 0; i < values.size();)
+            {
+                size_t j = i + 1;
+                while (j < values.size() && values[j] == values[i])
+                {
+                    ++j;
+                }
+                out.push_back(static_cast<char>(values[i]));
+                putVarint(out, j - i);
+                i = j;
+            }
+        }
+
+        bool getRuns(const uint8_t* p, const uint8_t* end, uint32_t rows, std::vector<uint8_t>& values)
+        {
+            values.clear();
+            values.reserve(rows);
+            while (p != end)
+            {
+                const uint8_t value = *p++;
+                uint64_t      run = 0;
+                if (!getVarint(p, end, run) || run > rows - values.size())
+                {
+                    return false;
+                }
+                values.insert(values.end(), static_cast<size_t>(run), value);
+            }
+            return values.size() == rows;
+        }
+
+        int64_t nowUs()
+        {
+            return std::chrono::duration_cast<std::chrono::microseconds>(
+                       std::chrono::system_clock::now().time_since_epoch())
+                .count();
+        }
+
+        /** @brief "HH:MM:SS.mmm" in local time, like the capture timestamps. */
+        class TimeText
+        {
+        public:
+            const char* operator()(int64_t us)
+            {
+                const int64_t sec = (us >= 0) ? us / 1000000 : (us - 999999) / 1000000;
+                if (sec != m_sec)
+                {
+                    m_sec = sec;
+                    const time_t t = static_cast<time_t>(sec);
+                    tm           local{};
+                    localtime_s(&local, &t);
+                    std::strftime(m_text, sizeof(m_text), "%H:%M:%S", &local);
+                }
+                std::snprintf(m_text + 8, sizeof(m_text) - 8, ".%03d", static_cast<int>((us - sec * 1000000) / 1000));
+                return m_text;
+            }
+
+        private:
+            int64_t m_sec = INT64_MIN;
+            char    m_text[16] = {};
+        };
+    }
+
+    // ------------------------------------------------------------------------------------
+    // Writer
+    // ------------------------------------------------------------------------------------
+
+    ColumnarWriter::~ColumnarWriter()
+    {
+        close();
+    }
+
+    bool ColumnarWriter::open(const std::string& path, const FileWriterOptions& writer, const std::string& ports,
+                              const SerialSettings& serial, const std::string& startTime)
+    {
+        close();
+        if (!m_file.open(path, writer, false))
+        {
+            std::cerr << "Error creating columnar file: " << path << "\n";
+            return false;
+        }
+
+        m_steadyStart = std::chrono::steady_clock::now();
+        m_wallStartUs = nowUs();
+
+        // Same information as the '#' header of a text log
+        const std::string info = "started=" + startTime + "\nports=" + ports + "\nline=" + serial.describe() + "\n";
+        std::string       header(kFileMagic, sizeof(kFileMagic));
+        put<uint32_t>(header, static_cast<uint32_t>(kFileHeader + info.size()));
+        put<uint32_t>(header, kVersion);
+        put<int64_t>(header, m_wallStartUs);
+        header += info;
+
+        m_file.write(header.data(), static_cast<std::streamsize>(header.size()));
+        m_offset = header.size();
+        m_index.clear();
+        return true;
+    }
+
+    void ColumnarWriter::append(const Packet& pkt)
+    {
+        if (!m_file.is_open())
+        {
+            return;
+        }
+        if (m_time.empty())
+        {
+            m_blockStart = std::chrono::steady_clock::now();
+        }
+
+        const auto readTime = (pkt.readTime == std::chrono::steady_clock::time_point{})
+                                  ? std::chrono::steady_clock::now()
+                                  : pkt.readTime;
+        m_time.push_back(m_wallStartUs
+                         + std::chrono::duration_cast<std::chrono::microseconds>(readTime - m_steadyStart).count());
+        m_channel.push_back(static_cast<uint8_t>(pkt.channel));
+        m_kind.push_back(static_cast<uint8_t>(pkt.kind));
+
+        if (pkt.kind == PacketKind::Data)
+        {
+            m_payload.insert(m_payload.end(), pkt.data.begin(), pkt.data.end());
+            m_length.push_back(static_cast<uint32_t>(pkt.data.size()));
+        }
+        else
+        {
+            const std::string message = eventMessage(pkt);
+            m_payload.insert(m_payload.end(), message.begin(), message.end());
+            m_length.push_back(static_cast<uint32_t>(message.size()));
+        }
+
+        if (m_time.size() >= kBlockRows || m_payload.size() >= kBlockPayload)
+        {
+            writeBlock();
+        }
+    }
+
+    bool ColumnarWriter::flush(std::chrono::steady_clock::time_point now)
+    {
+        if (!m_file.is_open())
+        {
+            return true;
+        }
+        // Small blocks would waste the per-block header and compress worse; a
+        // young block waits for more rows
+        if (!m_time.empty() && now - m_blockStart >= std::chrono::milliseconds(kBlockAgeMs))
+        {
+            writeBlock();
+        }
+        m_file.flush();
+        return m_time.empty();
+    }
+
+    void ColumnarWriter::close()
+    {
+        if (!m_file.is_open())
+        {
+            return;
+        }
+        writeBlock();
+
+        std::string index;
+        index.reserve(m_index.size() * kIndexEntry + kIndexTrailer);
+        for (const auto& block : m_index)
+        {
+            put<uint64_t>(index, block.offset);
+            put<uint32_t>(index, block.rows);
+            put<int64_t>(index, block.minUs);
+            put<int64_t>(index, block.maxUs);
+        }
+        put<uint64_t>(index, m_offset);
+        put<uint32_t>(index, static_cast<uint32_t>(m_index.size()));
+        index.append(kIndexMagic, sizeof(kIndexMagic));
+
+        m_file.write(index.data(), static_cast<std::streamsize>(index.size()));
+        m_file.close();
+        m_index.clear();
+    }
+
+    void ColumnarWriter::writeBlock()
+    {
+        if (m_time.empty())
+        {
+            return;
+        }
+        const auto [minIt, maxIt] = std::minmax_element(m_time.begin(), m_time.end());
+        columnar::BlockInfo info;
+        info.offset = m_offset;
+        info.rows = static_cast<uint32_t>(m_time.size());
+        info.minUs = *minIt;
+        info.maxUs = *maxIt;
+
+        for (auto& column : m_encoded)
+        {
+            column.clear();
+        }
+        // Both channels share one clock, so deltas stay small; an RX/TX
+        // interleave may step back by a few microseconds (zigzag)
+        int64_t previous = info.minUs;
+        for (const int64_t t : m_time)
+        {
+            putVarint(m_encoded[0], zigzag(t - previous));
+            previous = t;
+        }
+        putRuns(m_encoded[1], m_channel);
+        putRuns(m_encoded[2], m_kind);
+        for (const uint32_t length : m_length)
+        {
+            putVarint(m_encoded[3], length);
+        }
+        m_encoded[4].assign(reinterpret_cast<const char*>(m_payload.data()), m_payload.size());
+
+        std::string header;
+        header.reserve(kBlockHeader);
+        put<uint32_t>(header, kBlockMagic);
+        put<uint32_t>(header, info.rows);
+        put<int64_t>(header, info.minUs);
+        put<int64_t>(header, info.maxUs);
+        for (const auto& column : m_encoded)
+        {
+            put<uint32_t>(header, static_cast<uint32_t>(column.size()));
+        }
+        for (const auto& column : m_encoded)
+        {
+            put<uint32_t>(header, crc32Update(0, column.data(), column.size()));
+        }
+
+        m_file.write(header.data(), static_cast<std::streamsize>(header.size()));
+        m_offset += header.size();
+        for (const auto& column : m_encoded)
+        {
+            m_file.write(column.data(), static_cast<std::streamsize>(column.size()));
+            m_offset += column.size();
+        }
+        m_index.push_back(info);
+
+        m_time.clear();
+        m_channel.clear();
+        m_kind.clear();
+        m_length.clear();
+        m_payload.clear();
+    }
+
+    // ------------------------------------------------------------------------------------
+    // Reader
+    // ------------------------------------------------------------------------------------
+
+    bool ColumnarReader::open(const std::string& path)
+    {
+        if (!m_input.open(path))
+        {
+            return false;
+        }
+        const uint8_t* data = m_input.data();
+        const uint64_t size = m_input.size();
+        if (size < kFileHeader || std::memcmp(data, kFileMagic, sizeof(kFileMagic)) != 0)
+        {
+            std::cerr << "Error: " << path << " is not a columnar capture file\n";
+            return false;
+        }
+        const uint32_t headerSize = get<uint32_t>(data + 8);
+        const uint32_t version = get<uint32_t>(data + 12);
+        if (version != kVersion || headerSize < kFileHeader || headerSize > size)
+        {
+            std::cerr << "Error: " << path << ": unsupported columnar file version " << version << "\n";
+            return false;
+        }
+        m_baseUs = get<int64_t>(data + 16);
+        m_info.assign(reinterpret_cast<const char*>(data + kFileHeader), headerSize - kFileHeader);
+        m_dataStart = headerSize;
+
+        m_blocks.clear();
+        m_recovered = !readIndex();
+        if (m_recovered)
+        {
+            scanBlocks();
+            std::cerr << "Warning: " << path << " has no block index (capture not closed), found "
+                      << m_blocks.size() << " complete blocks by scanning\n";
+        }
+        return true;
+    }
+
+    bool ColumnarReader::readIndex()
+    {
+        const uint8_t* data = m_input.data();
+        const uint64_t size = m_input.size();
+        if (size < m_dataStart + kIndexTrailer
+            || std::memcmp(data + size - sizeof(kIndexMagic), kIndexMagic, sizeof(kIndexMagic)) != 0)
+        {
+            return false;
+        }
+        const uint8_t* trailer = data + size - kIndexTrailer;
+        const uint64_t indexOffset = get<uint64_t>(trailer);
+        const uint32_t count = get<uint32_t>(trailer + 8);
+        if (indexOffset < m_dataStart || indexOffset + uint64_t(count) * kIndexEntry + kIndexTrailer != size)
+        {
+            return false;
+        }
+
+        m_blocks.resize(count);
+        const uint8_t* entry = data + indexOffset;
+        for (auto& block : m_blocks)
+        {
+            block.offset = get<uint64_t>(entry);
+            block.rows = get<uint32_t>(entry + 8);
+            block.minUs = get<int64_t>(entry + 12);
+            block.maxUs = get<int64_t>(entry + 20);
+            entry += kIndexEntry;
+            if (block.offset + kBlockHeader > indexOffset)
+            {
+                m_blocks.clear();
+                return false;
+            }
+        }
+        return true;
+    }
+
+    void ColumnarReader::scanBlocks()
+    {
+        const uint8_t* data = m_input.data();
+        const uint64_t size = m_input.size();
+        uint64_t       offset = m_dataStart;
+
+        // Up to the first torn or foreign block: with the mmap backend the tail
+        // of a crashed capture is preallocated zeros
+        while (offset + kBlockHeader <= size)
+        {
+            const uint8_t* header = data + offset;
+            if (get<uint32_t>(header) != kBlockMagic)
+            {
+                break;
+            }
+            uint64_t end = offset + kBlockHeader;
+            for (size_t c = 0; c < columnar::kColumns; ++c)
+            {
+                end += get<uint32_t>(header + 24 + 4 * c);
+            }
+            if (end > size)
+            {
+                break;
+            }
+            columnar::BlockInfo block;
+            block.offset = offset;
+            block.rows = get<uint32_t>(header + 4);
+            block.minUs = get<int64_t>(header + 8);
+            block.maxUs = get<int64_t>(header + 16);
+            m_blocks.push_back(block);
+            offset = end;
+        }
+    }
+
+    const uint8_t* ColumnarReader::blockHeader(const columnar::BlockInfo& info) const
+    {
+        if (info.offset + kBlockHeader > m_input.size())
+        {
+            return nullptr;
+        }
+        const uint8_t* header = m_input.data() + info.offset;
+        return (get<uint32_t>(header) == kBlockMagic && get<uint32_t>(header + 4) == info.rows) ? header : nullptr;
+    }
+
+    uint64_t ColumnarReader::columnBytes(const columnar::BlockInfo& info, unsigned columns) const
+    {
+        const uint8_t* header = blockHeader(info);
+        uint64_t       bytes = 0;
+        for (size_t c = 0; header != nullptr && c < columnar::kColumns; ++c)
+        {
+            if ((columns & (1u << c)) != 0)
+            {
+                bytes += get<uint32_t>(header + 24 + 4 * c);
+            }
+        }
+        return bytes;
+    }
+
+    bool ColumnarReader::readBlock(const columnar::BlockInfo& info, unsigned columns, columnar::Block& block) const
+    {
+        const uint8_t* header = blockHeader(info);
+        if (header == nullptr)
+        {
+            return false;
+        }
+
+        uint64_t end = info.offset + kBlockHeader;
+        for (size_t c = 0; c < columnar::kColumns; ++c)
+        {
+            end += get<uint32_t>(header + 24 + 4 * c);
+        }
+        if (end > m_input.size())
+        {
+            return false;
+        }
+        const uint8_t* column[columnar::kColumns + 1];
+        column[0] = header + kBlockHeader;
+        for (size_t c = 0; c < columnar::kColumns; ++c)
+        {
+            column[c + 1] = column[c] + get<uint32_t>(header + 24 + 4 * c);
+        }
+        for (size_t c = 0; c < columnar::kColumns; ++c)
+        {
+            if ((columns & (1u << c)) != 0
+                && crc32Update(0, column[c], static_cast<size_t>(column[c + 1] - column[c]))
+                       != get<uint32_t>(header + 24 + 4 * columnar::kColumns + 4 * c))
+            {
+                return false;
+            }
+        }
+
+        const uint32_t rows = info.rows;
+        block.timeUs.clear();
+        block.channel.clear();
+        block.kind.clear();
+        block.length.clear();
+        block.payload = nullptr;
+
+        if ((columns & columnar::Time) != 0)
+        {
+            block.timeUs.resize(rows);
+            const uint8_t* p = column[0];
+            int64_t        t = info.minUs;
+            for (uint32_t i = 0; i < rows; ++i)
+            {
+                uint64_t delta = 0;
+                if (!getVarint(p, column[1], delta))
+                {
+                    return false;
+                }
+                t += unzigzag(delta);
+                block.timeUs[i] = t;
+            }
+        }
+        if ((columns & columnar::ChannelCol) != 0 && !getRuns(column[1], column[2], rows, block.channel))
+        {
+            return false;
+        }
+        if ((columns & columnar::Kind) != 0 && !getRuns(column[2], column[3], rows, block.kind))
+        {
+            return false;
+        }
+        if ((columns & (columnar::Length | columnar::Payload)) != 0)
+        {
+            block.length.resize(rows);
+            const uint8_t* p = column[3];
+            const uint64_t payloadSize = static_cast<uint64_t>(column[5] - column[4]);
+            uint64_t       total = 0;
+            for (uint32_t i = 0; i < rows; ++i)
+            {
+                uint64_t length = 0;
+                if (!getVarint(p, column[4], length) || length > payloadSize - total)
+                {
+                    return false;
+                }
+                block.length[i] = static_cast<uint32_t>(length);
+                total += length;
+            }
+            if (total != payloadSize)
+            {
+                return false;
+            }
+        }
+        if ((columns & columnar::Payload) != 0)
+        {
+            block.payload = column[4];
+        }
+        return true;
+    }
+
+    // ------------------------------------------------------------------------------------
+    // Query
+    // ------------------------------------------------------------------------------------
+
+    std::optional<int64_t> parseQueryTime(const std::string& text, int64_t baseUs, int64_t endUs)
+    {
+        // Fraction digits after '.', as microseconds
+        auto fraction = [](const char* p, int64_t& us) {
+            us = 0;
+            int digits = 0;
+            for (; *p >= '0' && *p <= '9'; ++p, ++digits)
+            {
+                if (digits < 6)
+                {
+                    us = us * 10 + (*p - '0');
+                }
+            }
+            for (int d = digits; d < 6; ++d)
+            {
+                us *= 10;
+            }
+            return *p == '\0' && digits > 0;
+        };
+
+        if (!text.empty() && text[0] == '+')
+        {
+            // Seconds since the capture start
+            char*         end = nullptr;
+            const int64_t sec = std::strtoll(text.c_str() + 1, &end, 10);
+            if (end == text.c_str() + 1 || sec < 0)
+            {
+                return std::nullopt;
+            }
+            int64_t us = 0;
+            if (*end == '.' ? !fraction(end + 1, us) : *end != '\0')
+            {
+                return std::nullopt;
+            }
+            return baseUs + sec * 1000000 + us;
+        }
+
+        const time_t start = static_cast<time_t>(baseUs / 1000000);
+        tm           local{};
+        localtime_s(&local, &start);
+        const tm     startLocal = local;
+
+        int  year = 0, month = 0, day = 0, hour = 0, minute = 0, second = 0, used = 0;
+        bool dated = false;
+        if (std::sscanf(text.c_str(), "%4d-%2d-%2d%*1[ T]%2d:%2d%n", &year, &month, &day, &hour, &minute, &used) == 5)
+        {
+            dated = true;
+        }
+        else if (std::sscanf(text.c_str(), "%2d:%2d%n", &hour, &minute, &used) != 2)
+        {
+            return std::nullopt;
+        }
+        const char* rest = text.c_str() + used;
+        if (*rest == ':')
+        {
+            int n = 0;
+            if (std::sscanf(rest + 1, "%2d%n", &second, &n) != 1)
+            {
+                return std::nullopt;
+            }
+            rest += 1 + n;
+        }
+        int64_t us = 0;
+        if ((*rest == '.' ? !fraction(rest + 1, us) : *rest != '\0') || hour > 23 || minute > 59 || second > 60)
+        {
+            return std::nullopt;
+        }
+
+        if (dated)
+        {
+            local.tm_year = year - 1900;
+            local.tm_mon = month - 1;
+            local.tm_mday = day;
+        }
+        local.tm_hour = hour;
+        local.tm_min = minute;
+        local.tm_sec = second;
+        local.tm_isdst = -1;
+        time_t t = std::mktime(&local);
+        if (t == static_cast<time_t>(-1))
+        {
+            return std::nullopt;
+        }
+        // A time of day before the start refers to the day after, if the capture got there
+        const time_t last = static_cast<time_t>(endUs / 1000000);
+        tm           lastLocal{};
+        localtime_s(&lastLocal, &last);
+        const bool   acrossMidnight = lastLocal.tm_year != startLocal.tm_year || lastLocal.tm_yday != startLocal.tm_yday;
+        if (!dated && t < start && acrossMidnight)
+        {
+            ++local.tm_mday;
+            local.tm_isdst = -1;
+            t = std::mktime(&local);
+        }
+        return static_cast<int64_t>(t) * 1000000 + us;
+    }
+
+    int runQuery(const std::string& path, OutputFormat payload, const QueryOptions& options)
+    {
+        ColumnarReader reader;
+        if (!reader.open(path))
+        {
+            return 1;
+        }
+
+        const int64_t endUs = reader.blocks().empty() ? reader.baseUs() : reader.blocks().back().maxUs;
+        int64_t       fromUs = INT64_MIN;
+        int64_t       toUs = INT64_MAX;
+        for (const auto& [text, limit, name] : { std::tuple(options.from, &fromUs, "--from"),
+                                                 std::tuple(options.to, &toUs, "--to") })
+        {
+            if (!text.has_value())
+            {
+                continue;
+            }
+            const auto us = parseQueryTime(*text, reader.baseUs(), endUs);
+            if (!us.has_value())
+            {
+                std::cerr << "Invalid " << name << ": " << *text
+                          << " (use +SEC[.fff], HH:MM[:SS[.mmm]] or YYYY-MM-DD HH:MM[:SS[.mmm]])\n";
+                return 1;
+            }
+            *limit = *us;
+        }
+        if (fromUs > toUs)
+        {
+            std::cerr << "Warning: --from is after --to; no rows match\n";
+        }
+
+        const auto start = std::chrono::steady_clock::now();
+        const bool count = options.output == QueryOutput::Count;
+        const bool csv = options.output == QueryOutput::Csv;
+        if (csv)
+        {
+            std::cout << "Timestamp;Channel;Data\n";
+        }
+
+        // Counting needs no payload; a block entirely inside the range needs no times either
+        const unsigned columns = count ? (columnar::ChannelCol | columnar::Kind | columnar::Length) : columnar::All;
+
+        columnar::Block block;
+        TimeText        timeText;
+        std::string     out;
+        uint64_t        rows = 0;
+        uint64_t        rowsPerChannel[2] = {};
+        uint64_t        bytesPerChannel[2] = {};
+        uint64_t        blocksRead = 0;
+        uint64_t        bytesRead = 0;
+        uint64_t        badBlocks = 0;
+
+        for (const auto& info : reader.blocks())
+        {
+            if (info.maxUs < fromUs || info.minUs > toUs || info.rows == 0)
+            {
+                continue;
+            }
+            const bool     inside = info.minUs >= fromUs && info.maxUs <= toUs;
+            const unsigned need = (inside ? columns : (columns | columnar::Time)) | columnar::ChannelCol;
+            ++blocksRead;
+            bytesRead += reader.columnBytes(info, need);
+            if (!reader.readBlock(info, need, block))
+            {
+                ++badBlocks;
+                continue;
+            }
+
+            const uint8_t* data = block.payload;
+            for (uint32_t i = 0; i < info.rows; ++i)
+            {
+                const uint32_t length = block.length.empty() ? 0 : block.length[i];
+                const uint8_t* bytes = data;
+                if (data != nullptr)
+                {
+                    data += length;
+                }
+                if ((!inside && (block.timeUs[i] < fromUs || block.timeUs[i] > toUs))
+                    || (options.channel.has_value() && block.channel[i] != static_cast<uint8_t>(*options.channel)))
+                {
+                    continue;
+                }
+
+                const size_t ch = block.channel[i] & 1;
+                const bool   event = block.kind[i] != static_cast<uint8_t>(PacketKind::Data);
+                ++rows;
+                ++rowsPerChannel[ch];
+                if (!event)
+                {
+                    bytesPerChannel[ch] += length;
+                }
+                if (count)
+                {
+                    continue;
+                }
+                const Channel channel = static_cast<Channel>(ch);
+                out += timeText(block.timeUs[i]);
+                out += csv ? ";" : " ";
+                out += csv ? channelName(channel) : channelTag(channel);
+                out += csv ? ";" : " ";
+                if (event)
+                {
+                    out.append(reinterpret_cast<const char*>(bytes), length);
+                }
+                else
+                {
+                    out += formatData(bytes, length, payload);
+                }
+                out += '\n';
+                if (out.size() >= 1 << 20)
+                {
+                    std::cout.write(out.data(), static_cast<std::streamsize>(out.size()));
+                    out.clear();
+                }
+            }
+        }
+        std::cout.write(out.data(), static_cast<std::streamsize>(out.size()));
+
+        if (count)
+        {
+            std::cout << "rows " << rows << " (RX " << rowsPerChannel[0] << ", TX " << rowsPerChannel[1]
+                      << "), bytes RX " << bytesPerChannel[0] << ", TX " << bytesPerChannel[1] << "\n";
+        }
+        std::cout.flush();
+
+        uint64_t fileBytes = 0;
+        for (const auto& info : reader.blocks())
+        {
+            fileBytes += reader.columnBytes(info, columnar::All);
+        }
+        const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        std::cerr << "[QUERY] " << rows << " rows from " << blocksRead << " of " << reader.blocks().size()
+                  << " blocks (read " << bytesRead << " of " << fileBytes << " column bytes), " << std::fixed
+                  << std::setprecision(2) << seconds << " s\n";
+        if (badBlocks != 0)
+        {
+            std::cerr << "Warning: " << badBlocks << " blocks failed their CRC check and were skipped\n";
+            return 1;
+        }
+        return 0;
+    }
+}
@@ -0,0 +1,224 @@
+/**
+ ****************************************************************************************
+ * @file   Columnar.hpp
+ * @brief  Columnar capture files for analytics (--sink col:PATH, --query PATH).
+ *
+ *         Text logs have to be parsed line by line to answer "what happened
+ *         between 14:02 and 14:05". A columnar file stores frames in blocks of
+ *         up to kBlockRows rows. Each block keeps its columns apart and encoded
+ *         on their own:
+ *
+ *             time     read time, microseconds since the Unix epoch: zigzag
+ *                      varint deltas
+ *             channel  run-length (value, count)
+ *             kind     run-length; events carry their message as payload
+ *             length   varint per row; payload offsets are their prefix sums
+ *             payload  the bytes of all rows, back to back
+ *
+ *         The block header holds min/max time, the column sizes and a CRC-32
+ *         per column. A time-range query skips whole blocks by their header
+ *         and reads only the columns it needs. On close, an index of all blocks
+ *         is appended. A file without one (capture killed) is scanned block by
+ *         block up to the last complete block.
+ *
+ *         File:   "UARTCOL1" u32 headerSize u32 version i64 baseUs info-text
+ *                 block*  [index entry* u64 indexOffset u32 blocks "UCOLIDX1"]
+ *         Block:  u32 'UCB1' u32 rows i64 minUs i64 maxUs u32 size[5] u32 crc[5]
+ *                 column bytes in the order above
+ *         Index:  u64 offset u32 rows i64 minUs i64 maxUs per block
+ *         All integers little-endian.
+ *
+ * @author Patrik Neunteufel
+ * @date   Oct 2026
+ ****************************************************************************************
+ */
+#pragma once
+
+#include "FileWriter.hpp"
+#include "Format.hpp"
+#include "SerialSettings.hpp"
+#include "UART.hpp"
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace uart_listener
+{
+    namespace columnar
+    {
+        enum Column : unsigned
+        {
+            Time = 1u << 0,
+            ChannelCol = 1u << 1,
+            Kind = 1u << 2,
+            Length = 1u << 3,
+            Payload = 1u << 4,
+            All = 0x1F
+        };
+
+        constexpr size_t kColumns = 5;
+
+        struct BlockInfo
+        {
+            uint64_t offset = 0;   // of the block header
+            uint32_t rows = 0;
+            int64_t  minUs = 0;
+            int64_t  maxUs = 0;
+        };
+
+        /** @brief Decoded columns of one block; columns not asked for stay empty. */
+        struct Block
+        {
+            std::vector<int64_t>  timeUs;
+            std::vector<uint8_t>  channel;   // Channel
+            std::vector<uint8_t>  kind;      // PacketKind
+            std::vector<uint32_t> length;
+            const uint8_t*        payload = nullptr;   // into the mapped file
+        };
+    }
+
+    class ColumnarWriter
+    {
+    public:
+        static constexpr size_t   kBlockRows = 65536;
+        static constexpr size_t   kBlockPayload = 4 * 1024 * 1024;   // bytes; a block is closed at either limit
+        static constexpr uint32_t kBlockAgeMs = 5000;                // flush() closes older blocks
+
+        ColumnarWriter() = default;
+        ~ColumnarWriter();
+
+        ColumnarWriter(const ColumnarWriter&) = delete;
+        ColumnarWriter& operator=(const ColumnarWriter&) = delete;
+
+        /** @return false with a message on std::cerr */
+        bool open(const std::string& path, const FileWriterOptions& writer, const std::string& ports,
+                  const SerialSettings& serial, const std::string& startTime);
+
+        bool is_open() const noexcept { return m_file.is_open(); }
+
+        /** @brief Add a frame or event (its message as payload) to the open block. */
+        void append(const Packet& pkt);
+
+        /**
+         * @brief Write the open block if it is older than kBlockAgeMs, then flush the file.
+         * @return false if rows are still waiting in a younger block
+         */
+        bool flush(std::chrono::steady_clock::time_point now);
+
+        /** @brief Write the open block and the index, then close. */
+        void close();
+
+    private:
+        void writeBlock();
+
+        CaptureFile                      m_file;
+        uint64_t                         m_offset = 0;   // bytes written so far
+        std::vector<columnar::BlockInfo> m_index;
+
+        // Open block
+        std::vector<int64_t>                  m_time;
+        std::vector<uint8_t>                  m_channel;
+        std::vector<uint8_t>                  m_kind;
+        std::vector<uint32_t>                 m_length;
+        std::vector<uint8_t>                  m_payload;
+        std::chrono::steady_clock::time_point m_blockStart{};
+
+        std::string m_encoded[columnar::kColumns];   // reused per block
+
+        // Read times are steady_clock; stored as wall-clock microseconds
+        std::chrono::steady_clock::time_point m_steadyStart{};
+        int64_t                               m_wallStartUs = 0;
+    };
+
+    class ColumnarReader
+    {
+    public:
+        /** @return false with a message on std::cerr */
+        bool open(const std::string& path);
+
+        /** @brief Wall-clock microseconds at capture start. */
+        int64_t baseUs() const noexcept { return m_baseUs; }
+
+        /** @brief "key=value" lines: started, ports, line. */
+        const std::string& info() const noexcept { return m_info; }
+
+        const std::vector<columnar::BlockInfo>& blocks() const noexcept { return m_blocks; }
+
+        /** @brief true if the index was missing and the blocks were found by scanning. */
+        bool recovered() const noexcept { return m_recovered; }
+
+        /**
+         * @brief Decode the given columns of a block.
+         * @param columns columnar::Column bits
+         * @return false if a column fails its CRC check
+         */
+        bool readBlock(const columnar::BlockInfo& info, unsigned columns, columnar::Block& block) const;
+
+        /** @brief Bytes of the given columns of a block, as read by readBlock(). */
+        uint64_t columnBytes(const columnar::BlockInfo& info, unsigned columns) const;
+
+    private:
+        bool           readIndex();
+        void           scanBlocks();
+        const uint8_t* blockHeader(const columnar::BlockInfo& info) const;
+
+        MappedInput                      m_input;
+        int64_t                          m_baseUs = 0;
+        std::string                      m_info;
+        uint64_t                         m_dataStart = 0;
+        std::vector<columnar::BlockInfo> m_blocks;
+        bool                             m_recovered = false;
+    };
+
+    enum class QueryOutput
+    {
+        Text = 0,   ///< Lines like the text log, payload as --format
+        Csv,        ///< Timestamp;Channel;Data
+        Count,      ///< Rows and bytes per channel only
+        COUNT
+    };
+
+    template<>
+    struct FormatMetaTraits<QueryOutput>
+    {
+        static constexpr size_t count = static_cast<size_t>(QueryOutput::COUNT);
+
+        // clang-format off
+        static constexpr std::array<const char*, count> names =
+        {{
+            "text",
+            "csv",
+            "count"
+        }};
+        // clang-format on
+    };
+
+    using QueryOutputTraits = FormatTraitsBase<QueryOutput>;
+
+    struct QueryOptions
+    {
+        std::optional<std::string> from;      // "+SEC", "HH:MM[:SS[.mmm]]" or "YYYY-MM-DD HH:MM[:SS[.mmm]]"
+        std::optional<std::string> to;
+        std::optional<Channel>     channel;   // --channel; unset = both
+        QueryOutput                output = QueryOutput::Text;
+    };
+
+    /**
+     * @brief Parse a query time against the capture start.
+     * @param endUs Last row time; a time of day before the start means the next
+     *              day only if the capture runs past midnight
+     * @return Wall-clock microseconds, or nothing for an invalid text
+     */
+    std::optional<int64_t> parseQueryTime(const std::string& text, int64_t baseUs, int64_t endUs);
+
+    /**
+     * @brief --query PATH mode: rows of a columnar file in a time range, to stdout.
+     * @param payload Payload format of text and CSV output (--format)
+     * @return Process exit code
+     */
+    int runQuery(const std::string& path, OutputFormat payload, const QueryOptions& options);
+}
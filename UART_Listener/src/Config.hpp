@@ -9,7 +9,21 @@
  */
 #pragma once
 
+#include "Analyze.hpp"
+#include "Coalescer.hpp"
+#include "Columnar.hpp"
+#include "ConsoleThrottle.hpp"
+#include "Convert.hpp"
+#include "Echo.hpp"
+#include "FileWriter.hpp"
 #include "Format.hpp"
+#include "Generator.hpp"
+#include "RepeatCollapser.hpp"
+#include "SerialSettings.hpp"
+#include "SinkGraph.hpp"
+#include "StreamServer.hpp"
+#include "Transaction.hpp"
+#include "Tui.hpp"
 
 namespace uart_listener
 {
@@ -17,17 +31,59 @@ namespace uart_listener
     {
         std::string rxPort;
         std::string txPort;
-        uint32_t    baudRate = 115200;
+        SerialSettings serial;  // baud, framing, flow control, driver queue
+        CoalesceOptions coalesce;  // merging of small driver reads
+        uint32_t    reconnectMaxMs = 200;  // reopen backoff cap after unplug; 0 = stop capture
         OutputFormat outputFormat = OutputFormat::Ascii;
         LogFormat   logFormat = LogFormat::Text;
+        FileWriterOptions fileWriter;  // backend for log and raw files
         bool        timestampsEnabled = true;
         uint32_t    flushTimeoutMs = 250;
+        uint32_t    formatThreads = 0;     // 0 = format on the consumer thread (--format-threads)
         bool        dualMode = true;  // false = single port mode (--dual-off)
+        uint32_t    statusIntervalMs = 0;  // 0 = no periodic status line
+        uint16_t    metricsPort = 0;       // 0 = HTTP endpoint disabled
+        EchoOptions echo;                  // echo latency between the channels (--echo)
+        TransactionOptions txn;            // request/response pairing (--txn)
+        TuiOptions  tui;                   // full-screen view with scrollback (--tui)
+        ConsoleThrottleOptions console;    // decimation above a line rate (--console-max-rate)
+        CollapseOptions collapse;          // identical frames in a row as one line (--collapse-repeats)
+        std::vector<SinkSpec> sinks;       // further output files (--sink)
 
         std::optional<std::string> rxColor;
         std::optional<std::string> txColor;
         std::optional<std::string> logFilePath;
         std::optional<std::string> rxRawOutPath;
         std::optional<std::string> txRawOutPath;
+        std::optional<std::string> filterExpr;     // console (and log, unless logFilterExpr set)
+        std::optional<std::string> logFilterExpr;  // log only
+        std::optional<std::string> metricsFilePath;
+        std::optional<std::string> traceFilePath;
+
+        // Live export to other processes
+        std::optional<std::string> shmName;       // shared-memory ring "Local\uart_listener.NAME"
+        uint32_t                   shmSizeKb = 4096;
+        StreamServerOptions        stream;        // localhost TCP fan-out (port 0 = off)
+
+        // Generator / verify modes (replace the listener when set)
+        std::optional<std::string> generatePort;
+        GeneratorOptions           generator;
+        std::optional<std::string> verifyTruthPath;
+        std::optional<std::string> verifyCapturePath;
+        std::optional<std::string> recoverPath;    // --recover: repair a durable log and exit
+
+        // Offline conversion of a raw dump (--convert IN OUT)
+        std::optional<std::string> convertInputPath;
+        std::optional<std::string> convertOutputPath;
+        ConvertOptions             convert;
+        bool                       convertFormatSet = false;  // else chosen by output extension
+
+        // Capture statistics (--analyze live, --analyze-file PATH offline)
+        AnalyzeOptions             analyze;
+        std::optional<std::string> analyzeInputPath;
+
+        // Time-range query of a columnar file (--query PATH)
+        std::optional<std::string> queryInputPath;
+        QueryOptions               query;
     };
 }
\ No newline at end of file
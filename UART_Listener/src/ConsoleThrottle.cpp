@@ -0,0 +1,157 @@
+/**
+ ****************************************************************************************
+ * @file   ConsoleThrottle.cpp
+ * @brief  Console decimation for high-rate streams (--console-max-rate).
+ *
+ * @author Patrik Neunteufel
+ * @date   Oct 2026
+ ****************************************************************************************
+ */
+
+#include "ConsoleThrottle.hpp"
+#include "DataFormat.hpp"
+#include "LogLine.hpp"
+#include "Metrics.hpp"
+#include "Time.hpp"
+
+#include <algorithm>
+#include <iomanip>
+#include <sstream>
+
+namespace uart_listener
+{
+    ConsoleThrottle::ConsoleThrottle(const ConsoleThrottleOptions& options, OutputFormat format, bool timestamps,
+                                     const std::string& rxColor, const std::string& txColor)
+        : m_options(options),
+          m_format(format),
+          m_timestamps(timestamps),
+          m_limit(std::max<uint64_t>(1, uint64_t{ options.maxLinesPerSec } * options.summaryMs / 1000)),
+          m_windowStart(Clock::now())
+    {
+        const std::string* colors[2] = { &rxColor, &txColor };
+        for (Channel channel : { Channel::RX, Channel::TX })
+        {
+            const std::string& color = *colors[static_cast<size_t>(channel)];
+            m_tags[static_cast<size_t>(channel)] = color.empty() ? channelTag(channel)
+                                                                 : color + channelTag(channel) + "\033[0m";
+        }
+    }
+
+    bool ConsoleThrottle::admit(const Packet& pkt)
+    {
+        ChannelWindow& ch = m_channels[static_cast<size_t>(pkt.channel)];
+        ++ch.frames;
+        ch.bytes += pkt.data.size();
+        ++m_lines;
+
+        if (!m_decimating && m_lines > m_limit)
+        {
+            m_decimating = true;
+            m_switched = true;
+        }
+
+        bool print = !m_decimating;
+        if (m_decimating && m_options.everyNth != 0)
+        {
+            print = (++ch.nth % m_options.everyNth) == 0;
+        }
+
+        if (!print)
+        {
+            ++ch.suppressed;
+            // Only the head of the last frame is kept; formatted when the summary is due
+            ch.lastTimestamp = pkt.timestamp;
+            ch.lastLength = pkt.data.size();
+            ch.last.assign(pkt.data.begin(), pkt.data.begin() + std::min(pkt.data.size(), kLastFrameBytes));
+        }
+        return print;
+    }
+
+    void ConsoleThrottle::event(const Packet& pkt)
+    {
+        if (pkt.kind == PacketKind::LineError || pkt.kind == PacketKind::Disconnect)
+        {
+            ++m_channels[static_cast<size_t>(pkt.channel)].errors;
+        }
+    }
+
+    std::string ConsoleThrottle::poll(Clock::time_point now)
+    {
+        // Called on every main loop turn; most turns have nothing to say
+        const auto elapsed = now - m_windowStart;
+        const bool due = elapsed >= std::chrono::milliseconds(m_options.summaryMs);
+        if (!m_switched && !due)
+        {
+            return std::string();
+        }
+
+        std::ostringstream out;
+        if (m_switched)
+        {
+            m_switched = false;
+            out << "[INFO] Console: more than " << m_options.maxLinesPerSec << " lines/s, showing ";
+            if (m_options.everyNth != 0)
+            {
+                out << "every " << m_options.everyNth << ". frame";
+            }
+            else
+            {
+                out << "a summary every " << m_options.summaryMs << " ms";
+            }
+            out << " (the log records everything)\n";
+        }
+
+        if (!due)
+        {
+            return out.str();
+        }
+        const double seconds = std::chrono::duration<double>(elapsed).count();
+
+        if (m_decimating && m_options.everyNth == 0)
+        {
+            for (size_t c = 0; c < 2; ++c)
+            {
+                ChannelWindow& ch = m_channels[c];
+                if (ch.suppressed == 0)
+                {
+                    continue;   // everything was printed, or the channel was idle
+                }
+                if (m_timestamps)
+                {
+                    out << getTimestampWithMs() << " ";
+                }
+                out << m_tags[c] << " ~ " << std::fixed << std::setprecision(0)
+                    << static_cast<double>(ch.frames) / seconds << " frames/s, "
+                    << formatRate(static_cast<double>(ch.bytes) / seconds) << ", " << ch.errors << " errors";
+                if (!ch.lastTimestamp.empty())
+                {
+                    out << " | last " << ch.lastTimestamp << " " << formatData(ch.last, m_format);
+                    if (ch.lastLength > ch.last.size())
+                    {
+                        out << " ... (" << ch.lastLength << " bytes)";
+                    }
+                }
+                out << "\n";
+            }
+        }
+
+        // Back to full output after a whole interval well below the limit
+        if (m_decimating && m_lines <= m_limit / 2)
+        {
+            m_decimating = false;
+            out << "[INFO] Console: back to full output\n";
+        }
+
+        m_lines = 0;
+        m_windowStart = now;
+        for (auto& ch : m_channels)
+        {
+            ch.frames = 0;
+            ch.bytes = 0;
+            ch.suppressed = 0;
+            ch.nth = 0;
+            ch.lastTimestamp.clear();
+        }
+        return out.str();
+    }
+}
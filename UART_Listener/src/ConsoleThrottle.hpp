@@ -0,0 +1,94 @@
+/**
+ ****************************************************************************************
+ * @file   ConsoleThrottle.hpp
+ * @brief  Console decimation for high-rate streams (--console-max-rate).
+ *
+ *         Above the configured line rate the console stops printing every
+ *         packet. It shows a summary per channel every --console-summary ms
+ *         (frame and byte rate, errors, last frame) or, with --console-every N,
+ *         every Nth frame. Dropped lines are never formatted, which is where
+ *         the CPU goes at full rate. Once a whole interval stays below half the
+ *         limit, the console switches back to full output. The log, sinks and
+ *         exports are not affected; events (line errors, disconnects) are
+ *         always printed.
+ *
+ * @author Patrik Neunteufel
+ * @date   Oct 2026
+ ****************************************************************************************
+ */
+#pragma once
+
+#include "Format.hpp"
+#include "UART.hpp"
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace uart_listener
+{
+    struct ConsoleThrottleOptions
+    {
+        uint32_t maxLinesPerSec = 0;   // 0 = print every line
+        uint32_t everyNth = 0;         // 0 = summary while decimating
+        uint32_t summaryMs = 1000;     // summary and rate measurement interval
+    };
+
+    class ConsoleThrottle
+    {
+    public:
+        using Clock = std::chrono::steady_clock;
+
+        static constexpr size_t kLastFrameBytes = 32;   // shown in the summary
+
+        /**
+         * @param format  Payload format of the last frame in the summary (--format)
+         * @param rxColor ANSI sequence for the [RX] tag, may be empty
+         */
+        ConsoleThrottle(const ConsoleThrottleOptions& options, OutputFormat format, bool timestamps,
+                        const std::string& rxColor, const std::string& txColor);
+
+        bool enabled() const noexcept { return m_options.maxLinesPerSec != 0; }
+        bool decimating() const noexcept { return m_decimating; }
+
+        /**
+         * @brief A data packet would go to the console.
+         * @return true if its line is printed
+         */
+        bool admit(const Packet& pkt);
+
+        /** @brief Count an event packet (always printed). */
+        void event(const Packet& pkt);
+
+        /**
+         * @brief Close the interval when it is over.
+         * @return Text to print: mode changes and, while decimating, the summary
+         */
+        std::string poll(Clock::time_point now);
+
+    private:
+        struct ChannelWindow
+        {
+            uint64_t             frames = 0;
+            uint64_t             bytes = 0;
+            uint64_t             errors = 0;       // whole run
+            uint64_t             suppressed = 0;   // frames not printed in this interval
+            uint64_t             nth = 0;
+            std::string          lastTimestamp;
+            std::vector<uint8_t> last;
+            size_t               lastLength = 0;
+        };
+
+        ConsoleThrottleOptions m_options;
+        OutputFormat           m_format;
+        bool                   m_timestamps;
+        std::string            m_tags[2];
+        uint64_t               m_limit;               // lines per interval
+        bool                   m_decimating = false;
+        bool                   m_switched = false;    // entered decimation, notice pending
+        uint64_t               m_lines = 0;           // console lines wanted in this interval
+        Clock::time_point      m_windowStart;
+        ChannelWindow          m_channels[2];
+    };
+}
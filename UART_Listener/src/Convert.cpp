@@ -0,0 +1,287 @@
+/**
+ ****************************************************************************************
+ * @file   Convert.cpp
+ * @brief  Parallel offline conversion of raw captures to text, CSV or JSON Lines.
+ *
+ * @author Patrik Neunteufel
+ * @date   Oct 2026
+ ****************************************************************************************
+ */
+#include "Convert.hpp"
+#include "DataFormat.hpp"
+#include "LogLine.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace uart_listener
+{
+    namespace
+    {
+        constexpr size_t kChunkBytes = 1024 * 1024;   // input per work item
+        constexpr size_t kChunksPerThread = 4;        // formatted chunks in flight per worker
+
+        void appendJsonString(std::string& out, const std::string& text)
+        {
+            for (char c : text)
+            {
+                if (c == '"' || c == '\\')
+                {
+                    out += '\\';
+                }
+                out += c;
+            }
+        }
+
+        /** Format one chunk; line ends are CRLF like the live logs. */
+        uint64_t formatChunk(const uint8_t* data, const ChunkRange& range, const ConvertOptions& options, std::string& out)
+        {
+            const char* channel = channelName(options.channel);
+            const char* tag = channelTag(options.channel);
+            uint64_t    records = 0;
+
+            out.clear();
+            out.reserve((range.second - range.first) * ((options.payload == OutputFormat::Hex) ? 3 : 1) + 4096);
+
+            for (size_t pos = range.first; pos < range.second;)
+            {
+                const size_t      n = recordLength(data + pos, range.second - pos, options.recordBytes);
+                const std::string payload = formatData(data + pos, n, options.payload);
+
+                switch (options.format)
+                {
+                case ConvertFormat::Csv:
+                    out += std::to_string(pos);
+                    out += ';';
+                    out += channel;
+                    out += ';';
+                    out += payload;
+                    break;
+                case ConvertFormat::Jsonl:
+                    out += "{\"off\":";
+                    out += std::to_string(pos);
+                    out += ",\"ch\":\"";
+                    out += channel;
+                    out += "\",\"len\":";
+                    out += std::to_string(n);
+                    out += ",\"data\":\"";
+                    appendJsonString(out, payload);
+                    out += "\"}";
+                    break;
+                default:
+                    out += tag;
+                    out += ' ';
+                    out += payload;
+                    break;
+                }
+                out += "\r\n";
+
+                pos += n;
+                ++records;
+            }
+            return records;
+        }
+    }
+
+    size_t recordLength(const uint8_t* data, size_t size, uint32_t recordBytes)
+    {
+        if (recordBytes != 0)
+        {
+            return std::min<size_t>(size, recordBytes);
+        }
+        const size_t limit = std::min<size_t>(size, kMaxLineRecord);
+        const void*  lf = std::memchr(data, '\n', limit);
+        return (lf != nullptr) ? static_cast<size_t>(static_cast<const uint8_t*>(lf) - data) + 1 : limit;
+    }
+
+    std::vector<ChunkRange> splitChunks(const uint8_t* data, size_t size, uint32_t recordBytes)
+    {
+        std::vector<ChunkRange> chunks;
+        const size_t            step = (recordBytes != 0) ? std::max<size_t>(1, kChunkBytes / recordBytes) * recordBytes
+                                                          : kChunkBytes;
+
+        size_t begin = 0;
+        while (begin < size)
+        {
+            size_t end = begin + step;
+            if (end >= size)
+            {
+                end = size;
+            }
+            else if (recordBytes == 0)
+            {
+                // After the last '\n' in the chunk; without one, records are
+                // kMaxLineRecord long from 'begin' on
+                size_t p = end;
+                while (p > begin && data[p - 1] != '\n')
+                {
+                    --p;
+                }
+                end = (p > begin) ? p : begin + (end - begin) / kMaxLineRecord * kMaxLineRecord;
+            }
+            chunks.emplace_back(begin, end);
+            begin = end;
+        }
+        return chunks;
+    }
+
+    ConvertStats convertBuffer(const uint8_t* data, size_t size, const ConvertOptions& options,
+                               const std::function<bool(const std::string&)>& sink)
+    {
+        ConvertStats stats;
+        stats.threads = (options.threads != 0) ? options.threads : std::max(1u, std::thread::hardware_concurrency());
+
+        const std::vector<ChunkRange> chunks = splitChunks(data, size, options.recordBytes);
+        const size_t             window = stats.threads * kChunksPerThread;
+
+        struct Slot
+        {
+            std::string text;
+            uint64_t    records = 0;
+            bool        ready = false;
+        };
+        std::vector<Slot> slots(window);
+
+        // Workers claim chunk 'next' only while it is within 'window' of the
+        // writer, so memory stays bounded however fast the formatting is
+        std::mutex              mutex;
+        std::condition_variable cv;
+        size_t                  next = 0;
+        size_t                  written = 0;
+        bool                    aborted = false;
+
+        auto worker = [&]() {
+            std::string text;
+            for (;;)
+            {
+                size_t index;
+                {
+                    std::unique_lock<std::mutex> lock(mutex);
+                    cv.wait(lock, [&] { return aborted || next >= chunks.size() || next < written + window; });
+                    if (aborted || next >= chunks.size())
+                    {
+                        return;
+                    }
+                    index = next++;
+                }
+
+                const uint64_t records = formatChunk(data, chunks[index], options, text);
+
+                {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    Slot& slot = slots[index % window];
+                    slot.text.swap(text);
+                    slot.records = records;
+                    slot.ready = true;
+                }
+                cv.notify_all();
+            }
+        };
+
+        std::vector<std::thread> pool;
+        for (unsigned i = 0; i < stats.threads; ++i)
+        {
+            pool.emplace_back(worker);
+        }
+
+        // Writer: this thread, strictly in input order
+        std::string text;
+        for (size_t index = 0; index < chunks.size(); ++index)
+        {
+            uint64_t records;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                Slot& slot = slots[index % window];
+                cv.wait(lock, [&] { return slot.ready; });
+                text.swap(slot.text);
+                records = slot.records;
+                slot.ready = false;
+                ++written;
+            }
+            cv.notify_all();
+
+            if (!sink(text))
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                aborted = true;
+                break;
+            }
+            stats.inputBytes += chunks[index].second - chunks[index].first;
+            stats.outputBytes += text.size();
+            stats.records += records;
+        }
+        cv.notify_all();
+
+        for (auto& t : pool)
+        {
+            t.join();
+        }
+        return stats;
+    }
+
+    int runConvert(const std::string& inputPath, const std::string& outputPath,
+                   const ConvertOptions& options, const FileWriterOptions& writer)
+    {
+        MappedInput input;
+        if (!input.open(inputPath))
+        {
+            return 1;
+        }
+        const uint8_t* data = input.data();
+        const uint64_t size = input.size();
+
+        // Workers produce the final bytes (CRLF included); the file is binary
+        FileWriterOptions outputWriter = writer;
+        outputWriter.durableMs = 0;
+
+        CaptureFile out;
+        if (!out.open(outputPath, outputWriter, false))
+        {
+            std::cerr << "Cannot create output: " << outputPath << "\n";
+            return 1;
+        }
+
+        if (options.format != ConvertFormat::Jsonl)
+        {
+            out << "# uart_listener convert " << inputPath << " ("
+                << OutputFormatTraits::toString(options.payload) << ", records: "
+                << (options.recordBytes != 0 ? std::to_string(options.recordBytes) + " bytes" : std::string("line feed"))
+                << ")\r\n";
+            if (options.format == ConvertFormat::Csv)
+            {
+                out << "Offset;Channel;Data\r\n";
+            }
+        }
+
+        const auto   start = std::chrono::steady_clock::now();
+        ConvertStats stats = convertBuffer(data, static_cast<size_t>(size), options, [&](const std::string& text) {
+            out.write(text.data(), static_cast<std::streamsize>(text.size()));
+            return out.good();
+        });
+        out.close();
+        const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        std::cout << "[CONVERT] Input:   " << stats.inputBytes << " bytes (" << inputPath << ")\n"
+                  << "[CONVERT] Output:  " << stats.outputBytes << " bytes (" << outputPath << ", "
+                  << ConvertFormatTraits::toString(options.format) << ")\n"
+                  << "[CONVERT] Records: " << stats.records << "\n"
+                  << "[CONVERT] Threads: " << stats.threads << "\n"
+                  << "[CONVERT] Time:    " << std::fixed << std::setprecision(2) << seconds << " s ("
+                  << (seconds > 0.0 ? static_cast<double>(stats.inputBytes) / seconds / 1e6 : 0.0) << " MB/s)\n";
+
+        if (stats.inputBytes != size)
+        {
+            std::cerr << "Error writing output: " << outputPath << "\n";
+            return 1;
+        }
+        return 0;
+    }
+}
@@ -0,0 +1,108 @@
+/**
+ ****************************************************************************************
+ * @file   Convert.hpp
+ * @brief  Parallel offline conversion of raw captures to text, CSV or JSON Lines.
+ *
+ *         Field captures are often recorded with --rx-raw-out / --tx-raw-out only
+ *         and converted later (--convert IN OUT). The input is mapped, cut into
+ *         chunks at record boundaries, formatted on all cores with formatData()
+ *         and written in input order.
+ *
+ *         A raw dump has no packet boundaries or timestamps. Records are cut
+ *         after each line feed (at most kMaxLineRecord bytes) or every N bytes
+ *         (--record N); the byte offset in the input takes the place of the
+ *         timestamp.
+ *
+ * @author Patrik Neunteufel
+ * @date   Oct 2026
+ ****************************************************************************************
+ */
+#pragma once
+
+#include "FileWriter.hpp"
+#include "Format.hpp"
+#include "UART.hpp"
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace uart_listener
+{
+    enum class ConvertFormat
+    {
+        Text = 0,   ///< "[RX] payload"
+        Csv,        ///< "Offset;Channel;Data"
+        Jsonl,      ///< {"off":N,"ch":"RX","len":N,"data":"payload"}
+        COUNT
+    };
+
+    template<>
+    struct FormatMetaTraits<ConvertFormat>
+    {
+        static constexpr size_t count = static_cast<size_t>(ConvertFormat::COUNT);
+
+        // clang-format off
+        static constexpr std::array<const char*, count> names =
+        {{
+            "text",
+            "csv",
+            "jsonl"
+        }};
+        // clang-format on
+    };
+
+    using ConvertFormatTraits = FormatTraitsBase<ConvertFormat>;
+
+    /// Longest record in line feed mode; longer runs without '\n' are cut here
+    constexpr uint32_t kMaxLineRecord = 4096;
+
+    struct ConvertOptions
+    {
+        ConvertFormat format = ConvertFormat::Text;
+        OutputFormat  payload = OutputFormat::Ascii;   // --format
+        Channel       channel = Channel::RX;           // tag of the converted dump
+        uint32_t      recordBytes = 0;                 // 0 = cut after '\n'
+        uint32_t      threads = 0;                     // 0 = all cores
+    };
+
+    struct ConvertStats
+    {
+        uint64_t inputBytes = 0;
+        uint64_t outputBytes = 0;
+        uint64_t records = 0;
+        unsigned threads = 0;
+    };
+
+    using ChunkRange = std::pair<size_t, size_t>;   // [first, second)
+
+    /** @brief Length of the record starting at 'data' (at most 'size'). */
+    size_t recordLength(const uint8_t* data, size_t size, uint32_t recordBytes);
+
+    /**
+     * @brief Cut the input into work chunks of about 1 MB that end on record
+     *        boundaries, so that every chunk can be processed without knowing
+     *        its predecessor.
+     */
+    std::vector<ChunkRange> splitChunks(const uint8_t* data, size_t size, uint32_t recordBytes);
+
+    /**
+     * @brief Format a byte range in parallel.
+     *
+     * @param sink Receives the output chunk by chunk, in input order, on the
+     *             calling thread; returning false aborts the conversion
+     * @return Statistics; stats.inputBytes < size after an abort
+     */
+    ConvertStats convertBuffer(const uint8_t* data, size_t size, const ConvertOptions& options,
+                               const std::function<bool(const std::string&)>& sink);
+
+    /**
+     * @brief --convert IN OUT mode.
+     * @param writer Output file backend (--file-writer, --prealloc)
+     * @return Process exit code
+     */
+    int runConvert(const std::string& inputPath, const std::string& outputPath,
+                   const ConvertOptions& options, const FileWriterOptions& writer);
+}
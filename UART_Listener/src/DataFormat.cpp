@@ -9,81 +9,150 @@
  */
 
 #include "DataFormat.hpp"
+#include "Trace.hpp"
 
-#include <iomanip>
-#include <sstream>
+#include <string>
 
 namespace uart_listener
 {
-
-    std::string bytesToHex(const std::vector<uint8_t>& data)
+    namespace
     {
-        std::ostringstream oss;
-        oss << std::hex << std::uppercase << std::setfill('0');
+        // Plain appends instead of std::ostringstream: every stream construction
+        // touches the shared global locale, which serializes parallel formatting
+        constexpr char kHexDigits[] = "0123456789ABCDEF";
 
-        for (size_t i = 0; i < data.size(); ++i)
+        void appendHexByte(std::string& out, uint8_t b)
         {
-            oss << std::setw(2) << static_cast<int>(data[i]);
-            if (i + 1 < data.size())
-            {
-                oss << " ";
-            }
+            out += kHexDigits[b >> 4];
+            out += kHexDigits[b & 0x0F];
         }
-        return oss.str();
-    }
-
-    std::string bytesToAscii(const std::vector<uint8_t>& data, bool cEscape)
-    {
-        std::ostringstream oss;
 
-        for (uint8_t b : data)
+        void appendHex(std::string& out, const uint8_t* data, size_t size)
         {
-            char c = static_cast<char>(b);
-
-            if (cEscape)
+            for (size_t i = 0; i < size; ++i)
             {
-                switch (c)
+                appendHexByte(out, data[i]);
+                if (i + 1 < size)
                 {
-                case '\r': oss << "\\r"; continue;
-                case '\n': oss << "\\n"; continue;
-                case '\t': oss << "\\t"; continue;
-                case '\0': oss << "\\0"; continue;
-                default: break;
+                    out += ' ';
                 }
             }
+        }
 
-            if (b >= 32 && b <= 126)
-            {
-                oss << c;
-            }
-            else
+        template<bool CEscape>
+        void appendText(std::string& out, const uint8_t* data, size_t size)
+        {
+            for (size_t i = 0; i < size; ++i)
             {
-                oss << "\\x" << std::hex << std::uppercase
-                    << std::setw(2) << std::setfill('0')
-                    << static_cast<int>(b) << std::dec;
+                const uint8_t b = data[i];
+                const char    c = static_cast<char>(b);
+
+                if constexpr (CEscape)
+                {
+                    switch (c)
+                    {
+                    case '\r': out += "\\r"; continue;
+                    case '\n': out += "\\n"; continue;
+                    case '\t': out += "\\t"; continue;
+                    case '\0': out += "\\0"; continue;
+                    default: break;
+                    }
+                }
+
+                if (b >= 32 && b <= 126)
+                {
+                    out += c;
+                }
+                else
+                {
+                    out += "\\x";
+                    appendHexByte(out, b);
+                }
             }
         }
-        return oss.str();
     }
 
-    std::string formatData(const std::vector<uint8_t>& data, OutputFormat fmt)
+    template<OutputFormat F>
+    void appendPayload(std::string& out, const uint8_t* data, size_t size)
+    {
+        if constexpr (F == OutputFormat::Ascii)
+        {
+            appendText<false>(out, data, size);
+        }
+        else if constexpr (F == OutputFormat::CEscape)
+        {
+            appendText<true>(out, data, size);
+        }
+        else if constexpr (F == OutputFormat::Raw)
+        {
+            out += "<raw ";
+            out += std::to_string(size);
+            out += " bytes>";
+        }
+        else
+        {
+            appendHex(out, data, size);
+        }
+    }
+
+    template void appendPayload<OutputFormat::Ascii>(std::string&, const uint8_t*, size_t);
+    template void appendPayload<OutputFormat::Hex>(std::string&, const uint8_t*, size_t);
+    template void appendPayload<OutputFormat::CEscape>(std::string&, const uint8_t*, size_t);
+    template void appendPayload<OutputFormat::Raw>(std::string&, const uint8_t*, size_t);
+
+    std::string bytesToHex(const uint8_t* data, size_t size)
+    {
+        std::string out;
+        out.reserve(size * 3);
+        appendHex(out, data, size);
+        return out;
+    }
+
+    std::string bytesToAscii(const uint8_t* data, size_t size, bool cEscape)
+    {
+        std::string out;
+        out.reserve(size);
+        if (cEscape)
+        {
+            appendText<true>(out, data, size);
+        }
+        else
+        {
+            appendText<false>(out, data, size);
+        }
+        return out;
+    }
+
+    std::string formatData(const uint8_t* data, size_t size, OutputFormat fmt)
     {
+        UART_TRACE_SCOPE("formatData");
         switch (fmt)
         {
         case OutputFormat::Ascii:
-            return bytesToAscii(data, false);
+            return bytesToAscii(data, size, false);
         case OutputFormat::Hex:
-            return bytesToHex(data);
+            return bytesToHex(data, size);
         case OutputFormat::CEscape:
-            return bytesToAscii(data, true);
+            return bytesToAscii(data, size, true);
         case OutputFormat::Raw:
-        {
-            std::ostringstream oss;
-            oss << "<raw " << data.size() << " bytes>";
-            return oss.str();
-        }
+            return "<raw " + std::to_string(size) + " bytes>";
         default:
-            return bytesToHex(data);
+            return bytesToHex(data, size);
         }
     }
-}
\ No newline at end of file
+
+    std::string bytesToHex(const std::vector<uint8_t>& data)
+    {
+        return bytesToHex(data.data(), data.size());
+    }
+
+    std::string bytesToAscii(const std::vector<uint8_t>& data, bool cEscape)
+    {
+        return bytesToAscii(data.data(), data.size(), cEscape);
+    }
+
+    std::string formatData(const std::vector<uint8_t>& data, OutputFormat fmt)
+    {
+        return formatData(data.data(), data.size(), fmt);
+    }
+}
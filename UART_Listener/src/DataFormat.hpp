@@ -19,4 +19,15 @@ namespace uart_listener
 	std::string bytesToHex(const std::vector<uint8_t>& data);
 	std::string bytesToAscii(const std::vector<uint8_t>& data, bool cEscape);
 	std::string formatData(const std::vector<uint8_t>& data, OutputFormat fmt);
+
+	// Same output for a byte range (offline conversion works on a mapped file)
+	std::string bytesToHex(const uint8_t* data, size_t size);
+	std::string bytesToAscii(const uint8_t* data, size_t size, bool cEscape);
+	std::string formatData(const uint8_t* data, size_t size, OutputFormat fmt);
+
+	// Appends the formatted bytes to 'out'; the format is fixed at compile time
+	// so the output pipeline reuses one buffer and takes no branch per byte.
+	// Instantiated for every OutputFormat in DataFormat.cpp.
+	template<OutputFormat F>
+	void appendPayload(std::string& out, const uint8_t* data, size_t size);
 }
\ No newline at end of file
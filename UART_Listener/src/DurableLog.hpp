@@ -0,0 +1,149 @@
+/**
+ ****************************************************************************************
+ * @file   DurableLog.hpp
+ * @brief  Crash-safe logging: checksummed commit frames, group commit and recovery.
+ *
+ *         With --durable MS the log is cut into frames. Every commit appends one
+ *         marker line that closes the frame written since the previous marker:
+ *
+ *           #commit <seq> <length> <crc32> [rx=<bytes>:<head>] [tx=<bytes>:<head>] [end]
+ *
+ *         <length> and <crc32> cover the bytes of the frame as they are on disk;
+ *         rx/tx are the raw dump sizes at that commit and the CRC-32 of their
+ *         first 4 KB, which identifies the dump. The marker is written
+ *         before FlushFileBuffers, so a frame is either complete on disk with its
+ *         marker or it is treated as lost. Parsers that skip '#' comment lines
+ *         (the capture header uses them too) read durable logs unchanged.
+ *
+ *         Recovery cuts a log after its last intact marker, cuts the raw dumps
+ *         to the sizes recorded there (only if their head still matches) and
+ *         appends a closing frame with a note. A log without any marker is cut
+ *         back to its header.
+ *
+ * @author Patrik Neunteufel
+ * @date   Oct 2026
+ ****************************************************************************************
+ */
+#pragma once
+
+#include "FileWriter.hpp"
+
+#include <chrono>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace uart_listener
+{
+    /**
+     * @brief CRC-32 (IEEE 802.3, reflected, poly 0xEDB88320), incremental.
+     *
+     * Start with crc = 0; feed the result back in for the next chunk.
+     */
+    uint32_t crc32Update(uint32_t crc, const void* data, size_t size);
+
+    /**
+     * @brief '#' comment lines that mark a log as durable (for writeLogHeader).
+     *
+     * Raw dump paths are stored absolute so that recovery finds them later.
+     */
+    std::vector<std::string> durableHeaderNotes(uint32_t intervalMs,
+                                                const std::optional<std::string>& rxRawPath,
+                                                const std::optional<std::string>& txRawPath);
+
+    /**
+     * @brief Group commit for the log and raw files (consumer thread).
+     *
+     * Lines are written as usual; the first write after a commit arms a
+     * deadline, and poll() commits once it has passed. One FlushFileBuffers
+     * per file therefore covers every line of the interval, and nothing
+     * written longer than the interval ago can be lost.
+     */
+    class GroupCommit
+    {
+    public:
+        using Clock = std::chrono::steady_clock;
+
+        /**
+         * @param log   Text or CSV log; not open = raw files only
+         * @param rxRaw Raw RX dump; may be closed
+         * @param txRaw Raw TX dump; may be closed
+         */
+        GroupCommit(uint32_t intervalMs, CaptureFile& log, CaptureFile& rxRaw, CaptureFile& txRaw);
+
+        /** @brief Something was written at 'now'; arms the deadline if idle. */
+        void written(Clock::time_point now) noexcept
+        {
+            if (!m_pending)
+            {
+                m_pending = true;
+                m_deadline = now + m_interval;
+            }
+        }
+
+        /** @brief Commit if the deadline has passed. */
+        void poll(Clock::time_point now)
+        {
+            if (m_pending && now >= m_deadline)
+            {
+                commit(false);
+            }
+        }
+
+        /** @brief Time until the next commit is due, capped at 'idle'. */
+        std::chrono::milliseconds timeout(Clock::time_point now, std::chrono::milliseconds idle) const noexcept;
+
+        /**
+         * @brief Close the current frame and force all files to disk.
+         * @param closing Mark the frame as the clean end of the capture
+         * @return false if a file could not be synced (reported once)
+         */
+        bool commit(bool closing);
+
+        uint64_t commits() const noexcept { return m_seq; }
+        double   maxCommitMs() const noexcept { return m_maxCommitMs; }
+
+    private:
+        std::chrono::milliseconds m_interval;
+        CaptureFile&              m_log;
+        CaptureFile&              m_rxRaw;
+        CaptureFile&              m_txRaw;
+        bool                      m_pending = false;
+        Clock::time_point         m_deadline{};
+        uint64_t                  m_seq = 0;
+        uint64_t                  m_frameStart = 0;   // log offset after the last marker
+        double                    m_maxCommitMs = 0.0;
+        bool                      m_errorReported = false;
+    };
+
+    struct RecoveryReport
+    {
+        bool     durable = false;       // file carries the durable header
+        bool     clean = false;         // last frame is an intact end frame
+        bool     repaired = false;      // file (or a raw dump) was cut
+        uint64_t lastSequence = 0;      // last intact commit
+        uint64_t droppedBytes = 0;      // log bytes after that commit
+        std::string error;
+    };
+
+    /**
+     * @brief Check one log and repair a torn tail.
+     *
+     * Fails without touching anything if another process has the file open
+     * (a running durable capture holds it without write sharing).
+     */
+    RecoveryReport recoverDurableLog(const std::string& path);
+
+    /**
+     * @brief Startup step: recover every durable *.log / *.csv in 'directory'.
+     * @return Number of files that were repaired
+     */
+    size_t recoverDurableLogs(const std::string& directory);
+
+    /**
+     * @brief --recover PATH mode.
+     * @return Process exit code
+     */
+    int runRecover(const std::string& path);
+}
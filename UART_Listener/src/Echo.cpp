@@ -0,0 +1,236 @@
+/**
+ ****************************************************************************************
+ * @file   Echo.cpp
+ * @brief  Online correlation of one channel with its echo on the other channel.
+ *
+ * @author Patrik Neunteufel
+ * @date   Oct 2026
+ ****************************************************************************************
+ */
+#include "Echo.hpp"
+
+#include <algorithm>
+
+namespace uart_listener
+{
+    namespace
+    {
+        constexpr uint32_t kHashBase = 0x01000193;   // FNV prime; arithmetic mod 2^32
+        constexpr uint32_t kBucketBits = 16;
+        constexpr size_t   kMaxChain = 64;           // candidates tried per lookup
+        constexpr uint64_t kNearScan = 256;          // positions tried directly after the last match
+
+        size_t bucketOf(uint32_t hash) noexcept
+        {
+            return static_cast<size_t>((hash * 0x9E3779B1u) >> (32 - kBucketBits));
+        }
+    }
+
+    EchoCorrelator::EchoCorrelator(const EchoOptions& options, PipelineCounters& counters)
+        : m_options(options)
+        , m_counters(counters)
+    {
+        m_options.blockBytes = std::clamp<uint32_t>(m_options.blockBytes, 2, 32);
+
+        uint64_t capacity = 1024;
+        while (capacity < m_options.windowBytes)
+        {
+            capacity *= 2;
+        }
+        m_mask = capacity - 1;
+        m_bytes.resize(capacity);
+        m_times.resize(capacity);
+        m_chain.resize(capacity);
+        m_heads.assign(size_t(1) << kBucketBits, 0);
+
+        for (uint32_t i = 0; i < m_options.blockBytes; ++i)
+        {
+            m_dropFactor *= kHashBase;
+        }
+    }
+
+    void EchoCorrelator::feed(const Packet& pkt)
+    {
+        if (pkt.kind != PacketKind::Data || pkt.data.empty())
+        {
+            return;
+        }
+
+        const bool   isSource = (pkt.channel == m_options.source);
+        const size_t segments = pkt.segments.empty() ? 1 : pkt.segments.size();
+        for (size_t s = 0; s < segments; ++s)
+        {
+            // Bytes of one driver read share its read time
+            const size_t begin = pkt.segments.empty() ? 0 : pkt.segments[s].offset;
+            const size_t end = (s + 1 < pkt.segments.size()) ? pkt.segments[s + 1].offset : pkt.data.size();
+            const auto   time = pkt.readTime
+                              + std::chrono::microseconds(pkt.segments.empty() ? 0 : pkt.segments[s].deltaUs);
+            for (size_t i = begin; i < end; ++i)
+            {
+                if (isSource)
+                {
+                    addSource(pkt.data[i], time);
+                }
+                else
+                {
+                    m_pending.push_back({ pkt.data[i], time });
+                }
+            }
+        }
+        drain(pkt.readTime, false);
+    }
+
+    void EchoCorrelator::poll(Clock::time_point now, bool final)
+    {
+        drain(now, final);
+    }
+
+    void EchoCorrelator::addSource(uint8_t value, Clock::time_point time)
+    {
+        const uint64_t pos = m_end++;
+        const uint64_t block = m_options.blockBytes;
+        const uint8_t  leaving = (pos >= block) ? m_bytes[(pos - block) & m_mask] : 0;
+
+        m_hash = m_hash * kHashBase + value - leaving * m_dropFactor;
+        m_bytes[pos & m_mask] = value;
+        m_times[pos & m_mask] = time;
+        m_lastSource = time;
+
+        if (pos + 1 >= block)
+        {
+            const size_t bucket = bucketOf(m_hash);
+            m_chain[pos & m_mask] = m_heads[bucket];
+            m_heads[bucket] = pos + 1;
+        }
+
+        // Source bytes pushed out of the window never got their echo
+        const uint64_t begin = sourceBegin();
+        if (m_next < begin)
+        {
+            bumpCounter(m_counters.echoDropped, begin - m_next);
+            m_next = begin;
+            m_locked = false;
+        }
+    }
+
+    int64_t EchoCorrelator::findBlock() const
+    {
+        const size_t block = m_options.blockBytes;
+        if (m_pending.size() < block)
+        {
+            return -1;
+        }
+
+        auto matches = [&](uint64_t start) {
+            size_t k = 0;
+            while (k < block && m_bytes[(start + k) & m_mask] == m_pending[k].value)
+            {
+                ++k;
+            }
+            return k == block;
+        };
+
+        // A few dropped or inserted bytes: the block is right after the last match.
+        // Checked directly, since repeated commands fill the hash chains quickly
+        const uint64_t first = std::max(sourceBegin(), m_next);
+        for (uint64_t start = first; start + block <= m_end && start < first + kNearScan; ++start)
+        {
+            if (matches(start))
+            {
+                return static_cast<int64_t>(start);
+            }
+        }
+
+        uint32_t hash = 0;
+        for (size_t k = 0; k < block; ++k)
+        {
+            hash = hash * kHashBase + m_pending[k].value;
+        }
+
+        // Chains run from the newest block backwards; keep the earliest match
+        // that is not already taken
+        int64_t        found = -1;
+        uint64_t       link = m_heads[bucketOf(hash)];
+        for (size_t steps = 0; link != 0 && steps < kMaxChain; ++steps)
+        {
+            const uint64_t last = link - 1;
+            if (last + 1 < first + block)
+            {
+                break;
+            }
+            const uint64_t start = last + 1 - block;
+            if (matches(start))
+            {
+                found = static_cast<int64_t>(start);
+            }
+            link = m_chain[last & m_mask];
+        }
+        return found;
+    }
+
+    void EchoCorrelator::drain(Clock::time_point now, bool final)
+    {
+        const auto maxWait = std::chrono::milliseconds(m_options.maxWaitMs);
+
+        while (!m_pending.empty())
+        {
+            // Each channel arrives in read order: once a source byte read after
+            // this echo byte is in, its own source is in as well
+            const EchoByte& echo = m_pending.front();
+            const bool      stale = final || (m_end > 0 && m_lastSource >= echo.time)
+                               || now - echo.time > maxWait || m_pending.size() > m_mask + 1;
+
+            if (m_locked)
+            {
+                if (m_next < m_end)
+                {
+                    if (m_bytes[m_next & m_mask] == echo.value)
+                    {
+                        m_counters.echoLatency.record(echo.time - m_times[m_next & m_mask]);
+                        bumpCounter(m_counters.echoMatched, 1);
+                        ++m_next;
+                        m_pending.pop_front();
+                        continue;
+                    }
+                    m_locked = false;
+                    bumpCounter(m_counters.echoResyncs, 1);
+                    continue;
+                }
+                // The echo is ahead of its source (the other reader is behind)
+                if (!stale)
+                {
+                    break;
+                }
+                m_locked = false;
+                continue;
+            }
+
+            const int64_t start = findBlock();
+            if (start >= 0)
+            {
+                const uint64_t begin = static_cast<uint64_t>(start);
+                if (begin > m_next)
+                {
+                    bumpCounter(m_counters.echoDropped, begin - m_next);
+                }
+                for (uint64_t k = 0; k < m_options.blockBytes; ++k)
+                {
+                    m_counters.echoLatency.record(m_pending.front().time - m_times[(begin + k) & m_mask]);
+                    m_pending.pop_front();
+                }
+                bumpCounter(m_counters.echoMatched, m_options.blockBytes);
+                m_next = begin + m_options.blockBytes;
+                m_locked = true;
+                continue;
+            }
+
+            // No source for this byte yet; it may still arrive
+            if (!stale)
+            {
+                break;
+            }
+            bumpCounter(m_counters.echoInserted, 1);
+            m_pending.pop_front();
+        }
+    }
+}
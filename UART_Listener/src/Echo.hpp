@@ -0,0 +1,98 @@
+/**
+ ****************************************************************************************
+ * @file   Echo.hpp
+ * @brief  Online correlation of one channel with its echo on the other channel.
+ *
+ *         With --echo tx the TX bytes are the source and the same bytes are
+ *         expected back on RX (loopback, modem echo, a device that repeats its
+ *         commands); --echo rx the other way round. Every echoed byte gives
+ *         one latency sample: read time of the echo minus read time of the
+ *         source byte.
+ *
+ *         The source history is a fixed ring of --echo-window bytes. Blocks of
+ *         --echo-block bytes are indexed by a rolling hash with bounded hash
+ *         chains, as in LZ77 matchers. While locked, echo bytes are compared
+ *         one by one; on a mismatch the next echo block is looked up in the
+ *         index, which skips inserted echo bytes and dropped source bytes.
+ *         Memory is fixed by the window; nothing grows with the capture.
+ *
+ * @author Patrik Neunteufel
+ * @date   Oct 2026
+ ****************************************************************************************
+ */
+#pragma once
+
+#include "Metrics.hpp"
+#include "UART.hpp"
+
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <vector>
+
+namespace uart_listener
+{
+    struct EchoOptions
+    {
+        bool     enabled = false;
+        Channel  source = Channel::TX;   // channel whose bytes come back on the other one
+        uint32_t windowBytes = 65536;    // source history (rounded up to a power of two)
+        uint32_t blockBytes = 4;         // bytes per hashed block
+        uint32_t maxWaitMs = 1000;       // give up on an echo byte after this long while the source is idle
+    };
+
+    class EchoCorrelator
+    {
+    public:
+        using Clock = std::chrono::steady_clock;
+
+        /**
+         * @param counters Receives the latency samples and match counters
+         *                 (consumer thread, like the other pipeline counters)
+         */
+        EchoCorrelator(const EchoOptions& options, PipelineCounters& counters);
+
+        /** @brief Feed a data packet of either channel, in queue order. */
+        void feed(const Packet& pkt);
+
+        /**
+         * @brief Settle echo bytes that waited longer than maxWaitMs.
+         * Called when the queue is idle; at the end of the capture with
+         * 'final' set, every pending byte is settled.
+         */
+        void poll(Clock::time_point now, bool final = false);
+
+    private:
+        struct EchoByte
+        {
+            uint8_t           value;
+            Clock::time_point time;
+        };
+
+        void addSource(uint8_t value, Clock::time_point time);
+        void drain(Clock::time_point now, bool final);
+
+        /** Earliest unmatched source position where the pending echo block starts, or -1. */
+        int64_t findBlock() const;
+
+        uint64_t sourceBegin() const noexcept { return (m_end > m_mask + 1) ? m_end - (m_mask + 1) : 0; }
+
+        EchoOptions       m_options;
+        PipelineCounters& m_counters;
+
+        // Source ring, indexed by position & m_mask
+        uint64_t                       m_mask;
+        std::vector<uint8_t>           m_bytes;
+        std::vector<Clock::time_point> m_times;
+        std::vector<uint64_t>          m_chain;   // previous block ending in the same bucket, + 1
+        std::vector<uint64_t>          m_heads;   // newest block end per bucket, + 1
+        uint64_t                       m_end = 0;        // next source position
+        uint32_t                       m_hash = 0;       // rolling hash of the last block
+        uint32_t                       m_dropFactor = 1; // kHashBase ^ blockBytes
+        Clock::time_point              m_lastSource{};   // read time of the newest source byte
+
+        uint64_t             m_next = 0;   // first source byte not yet matched or skipped
+        bool                 m_locked = false;
+        std::deque<EchoByte> m_pending;    // echo bytes not yet matched
+    };
+}
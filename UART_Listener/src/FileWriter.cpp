@@ -0,0 +1,539 @@
+/**
+ ****************************************************************************************
+ * @file   FileWriter.cpp
+ * @brief  Output file backends for the log and raw capture files.
+ *
+ * @author Patrik Neunteufel
+ * @date   Oct 2026
+ ****************************************************************************************
+ */
+#include "FileWriter.hpp"
+#include "DurableLog.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <windows.h>
+
+namespace uart_listener
+{
+    namespace
+    {
+        constexpr size_t kBufferSize = 1024 * 1024;      // buffered: one WriteFile per MB
+        constexpr size_t kWindowSize = 4 * 1024 * 1024;  // mmap: multiple of the 64 KB granularity
+
+        /**
+         * Common part of the preallocating backends: CRLF translation into the
+         * current block [m_cur, m_end) and extent management. No put area is
+         * used, so every write passes through xsputn(), which also keeps the
+         * byte count and, for durable files, the running checksum.
+         */
+        class BlockFileBuf : public std::streambuf
+        {
+        public:
+            BlockFileBuf(HANDLE file, const std::string& path, bool text, bool durable, uint64_t extent)
+                : m_file(file), m_path(path), m_text(text), m_durable(durable), m_extent(extent)
+            {
+            }
+
+            ~BlockFileBuf() override
+            {
+                if (m_file != INVALID_HANDLE_VALUE)
+                {
+                    CloseHandle(m_file);
+                }
+            }
+
+            /** @brief Write everything out, cut the file to its real size and close it. */
+            virtual void finish() = 0;
+
+            /** @brief Write everything out and force it to disk. */
+            virtual bool syncToDisk() = 0;
+
+            uint64_t written() const noexcept { return m_written; }
+
+            uint32_t takeChecksum() noexcept
+            {
+                const uint32_t crc = m_crc;
+                m_crc = 0;
+                return crc;
+            }
+
+            uint32_t headChecksum() const noexcept { return m_headCrc; }
+
+        protected:
+            /** @brief Provide a new non-empty block in [m_cur, m_end). */
+            virtual bool nextBlock() = 0;
+
+            std::streamsize xsputn(const char* s, std::streamsize n) override
+            {
+                std::streamsize done = 0;
+                while (done < n)
+                {
+                    const char* segEnd = s + n;
+                    if (m_text)
+                    {
+                        segEnd = static_cast<const char*>(std::memchr(s + done, '\n', static_cast<size_t>(n - done)));
+                        if (segEnd == nullptr)
+                        {
+                            segEnd = s + n;
+                        }
+                    }
+
+                    // Plain bytes up to the next line feed
+                    while (s + done < segEnd)
+                    {
+                        if (m_cur == m_end && !nextBlock())
+                        {
+                            return done;
+                        }
+                        const size_t chunk = std::min<size_t>(static_cast<size_t>(segEnd - (s + done)),
+                                                              static_cast<size_t>(m_end - m_cur));
+                        std::memcpy(m_cur, s + done, chunk);
+                        account(m_cur, chunk);
+                        m_cur += chunk;
+                        done += static_cast<std::streamsize>(chunk);
+                    }
+
+                    if (done < n)
+                    {
+                        // Line feed in text mode
+                        for (char c : { '\r', '\n' })
+                        {
+                            if (m_cur == m_end && !nextBlock())
+                            {
+                                return done;
+                            }
+                            *m_cur = c;
+                            account(m_cur++, 1);
+                        }
+                        ++done;
+                    }
+                }
+                return done;
+            }
+
+            int_type overflow(int_type ch) override
+            {
+                if (traits_type::eq_int_type(ch, traits_type::eof()))
+                {
+                    return traits_type::not_eof(ch);
+                }
+                const char c = traits_type::to_char_type(ch);
+                return xsputn(&c, 1) == 1 ? ch : traits_type::eof();
+            }
+
+            void account(const char* data, size_t size) noexcept
+            {
+                if (m_durable)
+                {
+                    m_crc = crc32Update(m_crc, data, size);
+                }
+                if (m_written < CaptureFile::kHeadBytes)
+                {
+                    m_headCrc = crc32Update(m_headCrc, data,
+                                            std::min<size_t>(size, static_cast<size_t>(CaptureFile::kHeadBytes - m_written)));
+                }
+                m_written += size;
+            }
+
+            /** @brief Make sure the file reaches at least 'size' bytes (whole extents). */
+            bool reserve(uint64_t size)
+            {
+                if (size <= m_allocated)
+                {
+                    return true;
+                }
+                const uint64_t target = (size + m_extent - 1) / m_extent * m_extent;
+                if (!setFileSize(target))
+                {
+                    return false;
+                }
+                m_allocated = target;
+                return true;
+            }
+
+            bool setFileSize(uint64_t size)
+            {
+                LARGE_INTEGER pos;
+                pos.QuadPart = static_cast<LONGLONG>(size);
+                return SetFilePointerEx(m_file, pos, nullptr, FILE_BEGIN) && SetEndOfFile(m_file);
+            }
+
+            void reportError(const char* what)
+            {
+                if (!m_errorReported)
+                {
+                    std::cerr << "Error " << what << " " << m_path << " (Error code: " << GetLastError() << ")\n";
+                    m_errorReported = true;
+                }
+            }
+
+            HANDLE      m_file;
+            std::string m_path;
+            bool        m_text;
+            bool        m_durable;
+            uint64_t    m_extent;
+            uint64_t    m_allocated = 0;
+            char*       m_cur = nullptr;
+            char*       m_end = nullptr;
+            bool        m_errorReported = false;
+            uint64_t    m_written = 0;
+            uint32_t    m_crc = 0;
+            uint32_t    m_headCrc = 0;   // of the first kHeadBytes
+        };
+
+        /**
+         * Large page aligned buffer, written with positional WriteFile into
+         * preallocated extents; sync() (periodic flush) writes the partial buffer.
+         */
+        class BufferedFileBuf final : public BlockFileBuf
+        {
+        public:
+            BufferedFileBuf(HANDLE file, const std::string& path, bool text, bool durable, uint64_t extent)
+                : BlockFileBuf(file, path, text, durable, extent)
+            {
+                m_buffer = static_cast<char*>(VirtualAlloc(nullptr, kBufferSize, MEM_COMMIT | MEM_RESERVE, PAGE_READWRITE));
+                m_cur = m_buffer;
+                m_end = m_buffer ? m_buffer + kBufferSize : nullptr;
+            }
+
+            ~BufferedFileBuf() override
+            {
+                finish();
+            }
+
+            void finish() override
+            {
+                if (m_file == INVALID_HANDLE_VALUE)
+                {
+                    return;
+                }
+                writeOut();
+                setFileSize(m_fileSize);
+                if (m_durable)
+                {
+                    // Persist the trimmed size too; otherwise a power loss brings the zero tail back
+                    FlushFileBuffers(m_file);
+                }
+                CloseHandle(m_file);
+                m_file = INVALID_HANDLE_VALUE;
+                if (m_buffer != nullptr)
+                {
+                    VirtualFree(m_buffer, 0, MEM_RELEASE);
+                    m_buffer = nullptr;
+                }
+            }
+
+            bool syncToDisk() override
+            {
+                if (!writeOut() || !FlushFileBuffers(m_file))
+                {
+                    reportError("syncing");
+                    return false;
+                }
+                return true;
+            }
+
+        protected:
+            bool nextBlock() override
+            {
+                return m_buffer != nullptr && writeOut();
+            }
+
+            int sync() override
+            {
+                return writeOut() ? 0 : -1;
+            }
+
+        private:
+            bool writeOut()
+            {
+                const DWORD pending = static_cast<DWORD>(m_cur - m_buffer);
+                if (pending == 0)
+                {
+                    return true;
+                }
+                if (!reserve(m_fileSize + pending))
+                {
+                    reportError("preallocating");
+                    return false;
+                }
+
+                OVERLAPPED at{};
+                at.Offset = static_cast<DWORD>(m_fileSize & 0xFFFFFFFF);
+                at.OffsetHigh = static_cast<DWORD>(m_fileSize >> 32);
+
+                DWORD written = 0;
+                if (!WriteFile(m_file, m_buffer, pending, &written, &at) || written != pending)
+                {
+                    reportError("writing");
+                    return false;
+                }
+                m_fileSize += pending;
+                m_cur = m_buffer;
+                return true;
+            }
+
+            char*    m_buffer = nullptr;
+            uint64_t m_fileSize = 0;
+        };
+
+        /**
+         * Sliding mapped window. Writes are plain memory copies; the cache manager
+         * writes pages back in the background. A new mapping object is only needed
+         * when the file grows by another extent.
+         */
+        class MappedFileBuf final : public BlockFileBuf
+        {
+        public:
+            MappedFileBuf(HANDLE file, const std::string& path, bool text, bool durable, uint64_t extent)
+                : BlockFileBuf(file, path, text, durable, std::max<uint64_t>(extent, kWindowSize) / kWindowSize * kWindowSize)
+            {
+            }
+
+            ~MappedFileBuf() override
+            {
+                finish();
+            }
+
+            void finish() override
+            {
+                if (m_file == INVALID_HANDLE_VALUE)
+                {
+                    return;
+                }
+                const uint64_t size = written();
+                unmap();
+                if (m_mapping != NULL)
+                {
+                    CloseHandle(m_mapping);
+                    m_mapping = NULL;
+                }
+                setFileSize(size);
+                if (m_durable)
+                {
+                    FlushFileBuffers(m_file);
+                }
+                CloseHandle(m_file);
+                m_file = INVALID_HANDLE_VALUE;
+            }
+
+            bool syncToDisk() override
+            {
+                const size_t used = (m_view != nullptr) ? static_cast<size_t>(m_cur - m_view) : 0;
+                if ((used != 0 && !FlushViewOfFile(m_view, used)) || !FlushFileBuffers(m_file))
+                {
+                    reportError("syncing");
+                    return false;
+                }
+                return true;
+            }
+
+        protected:
+            bool nextBlock() override
+            {
+                const uint64_t offset = (m_view != nullptr) ? m_viewOffset + kWindowSize : 0;
+                unmap();
+
+                if (offset + kWindowSize > m_allocated || m_mapping == NULL)
+                {
+                    if (m_mapping != NULL)
+                    {
+                        CloseHandle(m_mapping);
+                        m_mapping = NULL;   // reserve() may fail; finish() must not close it twice
+                    }
+                    if (!reserve(offset + kWindowSize))
+                    {
+                        reportError("preallocating");
+                        return false;
+                    }
+                    m_mapping = CreateFileMappingA(m_file, nullptr, PAGE_READWRITE, 0, 0, nullptr);
+                    if (m_mapping == NULL)
+                    {
+                        reportError("mapping");
+                        return false;
+                    }
+                }
+
+                void* view = MapViewOfFile(m_mapping, FILE_MAP_WRITE, static_cast<DWORD>(offset >> 32),
+                                           static_cast<DWORD>(offset & 0xFFFFFFFF), kWindowSize);
+                if (view == nullptr)
+                {
+                    reportError("mapping");
+                    return false;
+                }
+
+                m_view = static_cast<char*>(view);
+                m_viewOffset = offset;
+                m_cur = m_view;
+                m_end = m_view + kWindowSize;
+                return true;
+            }
+
+            // Mapped pages are already visible to readers of the file
+            int sync() override { return 0; }
+
+        private:
+            void unmap()
+            {
+                if (m_view != nullptr)
+                {
+                    if (m_durable)
+                    {
+                        // Pages of an unmapped view are out of reach for the next syncToDisk()
+                        FlushViewOfFile(m_view, 0);
+                    }
+                    UnmapViewOfFile(m_view);
+                    m_view = nullptr;
+                    m_cur = m_end = nullptr;
+                }
+            }
+
+            HANDLE   m_mapping = NULL;
+            char*    m_view = nullptr;
+            uint64_t m_viewOffset = 0;  // file offset of m_view
+        };
+    }
+
+    CaptureFile::CaptureFile()
+        : std::ostream(nullptr)
+    {
+    }
+
+    CaptureFile::~CaptureFile()
+    {
+        close();
+    }
+
+    bool CaptureFile::open(const std::string& path, const FileWriterOptions& options, bool text)
+    {
+        close();
+
+        if (options.kind == FileWriterKind::Stream)
+        {
+            auto buf = std::make_unique<std::filebuf>();
+            const auto mode = std::ios::out | std::ios::trunc | (text ? std::ios::openmode{} : std::ios::binary);
+            if (buf->open(path, mode) == nullptr)
+            {
+                return false;
+            }
+            m_buf = std::move(buf);
+        }
+        else
+        {
+            // GENERIC_READ is required for the read/write file mapping
+            HANDLE file = CreateFileA(path.c_str(), GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ, nullptr,
+                                      CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+            if (file == INVALID_HANDLE_VALUE)
+            {
+                return false;
+            }
+
+            const uint64_t extent = uint64_t{ std::max<uint32_t>(options.extentMb, 1) } * 1024 * 1024;
+            const bool     durable = (options.durableMs != 0);
+            if (options.kind == FileWriterKind::Buffered)
+            {
+                m_buf = std::make_unique<BufferedFileBuf>(file, path, text, durable, extent);
+            }
+            else
+            {
+                m_buf = std::make_unique<MappedFileBuf>(file, path, text, durable, extent);
+            }
+        }
+
+        rdbuf(m_buf.get());
+        clear();
+        return true;
+    }
+
+    void CaptureFile::close()
+    {
+        if (!m_buf)
+        {
+            return;
+        }
+
+        flush();
+        if (auto* block = dynamic_cast<BlockFileBuf*>(m_buf.get()))
+        {
+            block->finish();
+        }
+        else if (auto* file = dynamic_cast<std::filebuf*>(m_buf.get()))
+        {
+            file->close();
+        }
+
+        rdbuf(nullptr);
+        m_buf.reset();
+    }
+
+    uint64_t CaptureFile::bytesWritten() const noexcept
+    {
+        const auto* block = dynamic_cast<const BlockFileBuf*>(m_buf.get());
+        return (block != nullptr) ? block->written() : 0;
+    }
+
+    uint32_t CaptureFile::takeChecksum() noexcept
+    {
+        auto* block = dynamic_cast<BlockFileBuf*>(m_buf.get());
+        return (block != nullptr) ? block->takeChecksum() : 0;
+    }
+
+    uint32_t CaptureFile::headChecksum() const noexcept
+    {
+        const auto* block = dynamic_cast<const BlockFileBuf*>(m_buf.get());
+        return (block != nullptr) ? block->headChecksum() : 0;
+    }
+
+    bool CaptureFile::syncToDisk()
+    {
+        auto* block = dynamic_cast<BlockFileBuf*>(m_buf.get());
+        if (block == nullptr)
+        {
+            flush();
+            return false;
+        }
+        return block->syncToDisk();
+    }
+
+    MappedInput::~MappedInput()
+    {
+        if (m_data != nullptr) UnmapViewOfFile(m_data);
+        if (m_mapping != nullptr) CloseHandle(m_mapping);
+        if (m_file != nullptr) CloseHandle(m_file);
+    }
+
+    bool MappedInput::open(const std::string& path)
+    {
+        HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE, nullptr,
+                                  OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+        if (file == INVALID_HANDLE_VALUE)
+        {
+            std::cerr << "Cannot open input: " << path << " (Error code: " << GetLastError() << ")\n";
+            return false;
+        }
+        m_file = file;
+
+        LARGE_INTEGER fileSize{};
+        GetFileSizeEx(file, &fileSize);
+        m_size = static_cast<uint64_t>(fileSize.QuadPart);
+        if (m_size == 0)
+        {
+            return true;
+        }
+
+        m_mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (m_mapping != nullptr)
+        {
+            m_data = static_cast<const uint8_t*>(MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0));
+        }
+        if (m_data == nullptr)
+        {
+            std::cerr << "Cannot map input: " << path << " (Error code: " << GetLastError() << ")\n";
+            return false;
+        }
+        return true;
+    }
+}
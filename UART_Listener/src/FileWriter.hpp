@@ -0,0 +1,143 @@
+/**
+ ****************************************************************************************
+ * @file   FileWriter.hpp
+ * @brief  Output file backends for the log and raw capture files.
+ *
+ *         std::ofstream with periodic flush() issues many small WriteFile calls,
+ *         each of which may also extend the file. On slow flash this shows up as
+ *         latency spikes in the consumer thread. The alternative backends
+ *         reserve the file in large extents up front, write through a large
+ *         aligned buffer or a sliding mapped window, and cut the file to its
+ *         real size on close.
+ *
+ *         After a crash a preallocated file ends in zero bytes up to the next
+ *         extent boundary.
+ *
+ * @author Patrik Neunteufel
+ * @date   Oct 2026
+ ****************************************************************************************
+ */
+#pragma once
+
+#include "Format.hpp"
+
+#include <cstdint>
+#include <memory>
+#include <ostream>
+#include <string>
+
+namespace uart_listener
+{
+    enum class FileWriterKind
+    {
+        Stream = 0,   ///< std::filebuf (previous behaviour)
+        Buffered,     ///< 1 MB aligned buffer, preallocated extents
+        Mapped,       ///< Sliding 4 MB mapped window, preallocated extents
+        COUNT
+    };
+
+    template<>
+    struct FormatMetaTraits<FileWriterKind>
+    {
+        static constexpr size_t count = static_cast<size_t>(FileWriterKind::COUNT);
+
+        // clang-format off
+        static constexpr std::array<const char*, count> names =
+        {{
+            "stream",
+            "buffered",
+            "mmap"
+        }};
+        // clang-format on
+    };
+
+    using FileWriterKindTraits = FormatTraitsBase<FileWriterKind>;
+
+    struct FileWriterOptions
+    {
+        FileWriterKind kind = FileWriterKind::Stream;
+        uint32_t       extentMb = 64;   // preallocation step (buffered, mmap)
+        uint32_t       durableMs = 0;   // group commit interval (--durable), 0 = off
+    };
+
+    /**
+     * @brief Output stream over the selected backend.
+     *
+     * Drop-in for the std::ofstream members in main(): operator<<, write(),
+     * flush(), is_open(), close(). Text files get CRLF line ends like a text
+     * mode ofstream.
+     */
+    class CaptureFile : public std::ostream
+    {
+    public:
+        static constexpr size_t kHeadBytes = 4096;   // covered by headChecksum()
+
+        CaptureFile();
+        ~CaptureFile() override;
+
+        CaptureFile(const CaptureFile&) = delete;
+        CaptureFile& operator=(const CaptureFile&) = delete;
+
+        /**
+         * @param text Translate '\n' to "\r\n" (log files); raw dumps are binary
+         */
+        bool open(const std::string& path, const FileWriterOptions& options, bool text);
+
+        bool is_open() const noexcept { return m_buf != nullptr; }
+
+        /** @brief Flush, trim preallocated space and close; safe to call twice. */
+        void close();
+
+        /** @brief Bytes in the file so far, after CRLF translation (buffered, mmap). */
+        uint64_t bytesWritten() const noexcept;
+
+        /**
+         * @brief CRC-32 of the bytes written since the previous call (durable files).
+         */
+        uint32_t takeChecksum() noexcept;
+
+        /**
+         * @brief CRC-32 of the first min(bytesWritten(), kHeadBytes) bytes (buffered, mmap).
+         *
+         * Identifies the file's content for durable recovery: a later capture
+         * that reuses the path starts with different bytes.
+         */
+        uint32_t headChecksum() const noexcept;
+
+        /**
+         * @brief Push everything to the OS and force it to disk.
+         * @return false on error or for the stream backend (no file handle)
+         */
+        bool syncToDisk();
+
+    private:
+        std::unique_ptr<std::streambuf> m_buf;
+    };
+
+    /**
+     * @brief Read-only view of a whole file for the offline modes.
+     *
+     * Empty files are not mapped: data() is then null and size() 0.
+     */
+    class MappedInput
+    {
+    public:
+        MappedInput() = default;
+        ~MappedInput();
+
+        MappedInput(const MappedInput&) = delete;
+        MappedInput& operator=(const MappedInput&) = delete;
+
+        /** @return false with a message on std::cerr */
+        bool open(const std::string& path);
+
+        const uint8_t* data() const noexcept { return m_data; }
+        uint64_t       size() const noexcept { return m_size; }
+
+    private:
+        void*          m_file = nullptr;      // HANDLE; windows.h stays out of the header
+        void*          m_mapping = nullptr;
+        const uint8_t* m_data = nullptr;
+        uint64_t       m_size = 0;
+    };
+}
@@ -0,0 +1,579 @@
+/**
+ ****************************************************************************************
+ * @file   Filter.cpp
+ * @brief  Packet filter tokenizer, compiler and bytecode interpreter.
+ *
+ * @author Patrik Neunteufel
+ * @date   Oct 2026
+ ****************************************************************************************
+ */
+
+#include "Filter.hpp"
+
+#include <algorithm>
+#include <cctype>
+
+namespace uart_listener
+{
+    namespace
+    {
+        constexpr size_t kMaxFilterStack = 64;
+        constexpr size_t kMaxFilterNesting = 256;   // '(' and '!' levels; bounds the parser's recursion
+
+        enum class Tok
+        {
+            End,
+            Ident,
+            Number,
+            String,   // "..." or /.../ regex literal
+            LParen, RParen, LBracket, RBracket,
+            And, Or, Not,
+            Eq, Ne, Lt, Le, Gt, Ge,
+            Match, NotMatch,
+            Minus
+        };
+
+        struct Token
+        {
+            Tok         type = Tok::End;
+            std::string text;
+            int64_t     value = 0;
+            size_t      pos = 0;
+        };
+
+        bool tokenize(const std::string& src, std::vector<Token>& out, std::string& error)
+        {
+            size_t i = 0;
+            while (i < src.size())
+            {
+                const char c = src[i];
+                if (std::isspace(static_cast<unsigned char>(c)))
+                {
+                    ++i;
+                    continue;
+                }
+
+                Token t;
+                t.pos = i;
+
+                auto two = [&](char next) { return i + 1 < src.size() && src[i + 1] == next; };
+
+                if (std::isalpha(static_cast<unsigned char>(c)) || c == '_')
+                {
+                    size_t j = i;
+                    while (j < src.size() && (std::isalnum(static_cast<unsigned char>(src[j])) || src[j] == '_'))
+                    {
+                        ++j;
+                    }
+                    t.type = Tok::Ident;
+                    t.text = src.substr(i, j - i);
+                    std::transform(t.text.begin(), t.text.end(), t.text.begin(),
+                        [](unsigned char ch) { return static_cast<char>(std::tolower(ch)); });
+                    i = j;
+                }
+                else if (std::isdigit(static_cast<unsigned char>(c)))
+                {
+                    size_t j = i;
+                    int    base = 10;
+                    if (c == '0' && i + 1 < src.size() && (src[i + 1] == 'x' || src[i + 1] == 'X'))
+                    {
+                        base = 16;
+                        j += 2;
+                    }
+                    const size_t digitsStart = j;
+                    while (j < src.size() && std::isxdigit(static_cast<unsigned char>(src[j])))
+                    {
+                        if (base == 10 && !std::isdigit(static_cast<unsigned char>(src[j])))
+                        {
+                            break;
+                        }
+                        ++j;
+                    }
+                    if (j == digitsStart || j - digitsStart > 15)
+                    {
+                        error = "invalid number at position " + std::to_string(i);
+                        return false;
+                    }
+                    t.type = Tok::Number;
+                    t.value = static_cast<int64_t>(std::stoll(src.substr(digitsStart, j - digitsStart), nullptr, base));
+                    i = j;
+                }
+                else if (c == '"' || c == '/')
+                {
+                    // Regex literal: backslash escapes are kept for the regex parser,
+                    // only an escaped delimiter is unescaped.
+                    size_t j = i + 1;
+                    while (j < src.size() && src[j] != c)
+                    {
+                        if (src[j] == '\\' && j + 1 < src.size())
+                        {
+                            if (src[j + 1] == c)
+                            {
+                                t.text += c;
+                                j += 2;
+                                continue;
+                            }
+                            t.text += src[j++];
+                        }
+                        t.text += src[j++];
+                    }
+                    if (j >= src.size())
+                    {
+                        error = "unterminated pattern at position " + std::to_string(i);
+                        return false;
+                    }
+                    t.type = Tok::String;
+                    i = j + 1;
+                }
+                else if (c == '(') { t.type = Tok::LParen;   ++i; }
+                else if (c == ')') { t.type = Tok::RParen;   ++i; }
+                else if (c == '[') { t.type = Tok::LBracket; ++i; }
+                else if (c == ']') { t.type = Tok::RBracket; ++i; }
+                else if (c == '-') { t.type = Tok::Minus;    ++i; }
+                else if (c == '~') { t.type = Tok::Match;    ++i; }
+                else if (c == '&' && two('&')) { t.type = Tok::And; i += 2; }
+                else if (c == '|' && two('|')) { t.type = Tok::Or;  i += 2; }
+                else if (c == '=' && two('=')) { t.type = Tok::Eq;  i += 2; }
+                else if (c == '!' && two('=')) { t.type = Tok::Ne;  i += 2; }
+                else if (c == '!' && two('~')) { t.type = Tok::NotMatch; i += 2; }
+                else if (c == '!') { t.type = Tok::Not; ++i; }
+                else if (c == '<' && two('=')) { t.type = Tok::Le; i += 2; }
+                else if (c == '>' && two('=')) { t.type = Tok::Ge; i += 2; }
+                else if (c == '<') { t.type = Tok::Lt; ++i; }
+                else if (c == '>') { t.type = Tok::Gt; ++i; }
+                else
+                {
+                    error = "unexpected character '" + std::string(1, c) + "' at position " + std::to_string(i);
+                    return false;
+                }
+
+                out.push_back(std::move(t));
+            }
+
+            Token end;
+            end.pos = src.size();
+            out.push_back(end);
+            return true;
+        }
+    }
+
+    // ============================================================================
+    // Compiler
+    // ============================================================================
+
+    class FilterCompiler
+    {
+    public:
+        FilterCompiler(std::vector<Token>& tokens, PacketFilter& prog)
+            : m_tokens(tokens), m_prog(prog)
+        {
+        }
+
+        bool compile(std::string& error)
+        {
+            if (!parseOr())
+            {
+                error = m_error;
+                return false;
+            }
+            if (cur().type != Tok::End)
+            {
+                error = "unexpected token at position " + std::to_string(cur().pos);
+                return false;
+            }
+            emit(PacketFilter::Op::Bool);
+            return true;
+        }
+
+    private:
+        using Op = PacketFilter::Op;
+
+        std::vector<Token>& m_tokens;
+        PacketFilter&       m_prog;
+        size_t              m_idx = 0;
+        size_t              m_depth = 0;
+        size_t              m_nesting = 0;
+        std::string         m_error;
+
+        const Token& cur() const { return m_tokens[m_idx]; }
+
+        bool accept(Tok t)
+        {
+            if (cur().type == t)
+            {
+                ++m_idx;
+                return true;
+            }
+            return false;
+        }
+
+        bool fail(const std::string& msg)
+        {
+            if (m_error.empty())
+            {
+                m_error = msg + " at position " + std::to_string(cur().pos);
+            }
+            return false;
+        }
+
+        size_t emit(Op op, int64_t arg = 0)
+        {
+            m_prog.m_code.push_back({ op, arg });
+
+            // Track stack depth for the interpreter bounds check
+            switch (op)
+            {
+            case Op::PushConst:
+            case Op::PushChannel:
+            case Op::PushLen:
+            case Op::PushByte:
+            case Op::Regex:
+                ++m_depth;
+                break;
+            case Op::Eq: case Op::Ne: case Op::Lt: case Op::Le: case Op::Gt: case Op::Ge:
+            case Op::JumpIfFalse:
+            case Op::JumpIfTrue:
+                --m_depth;
+                break;
+            default:
+                break;
+            }
+            m_prog.m_maxStack = std::max(m_prog.m_maxStack, m_depth);
+            return m_prog.m_code.size() - 1;
+        }
+
+        void patch(size_t at)
+        {
+            m_prog.m_code[at].arg = static_cast<int64_t>(m_prog.m_code.size());
+        }
+
+        bool parseOr()
+        {
+            if (!parseAnd())
+            {
+                return false;
+            }
+            while (accept(Tok::Or))
+            {
+                emit(Op::Bool);
+                const size_t jump = emit(Op::JumpIfTrue);
+                if (!parseAnd())
+                {
+                    return false;
+                }
+                emit(Op::Bool);
+                patch(jump);
+            }
+            return true;
+        }
+
+        bool parseAnd()
+        {
+            if (!parseUnary())
+            {
+                return false;
+            }
+            while (accept(Tok::And))
+            {
+                emit(Op::Bool);
+                const size_t jump = emit(Op::JumpIfFalse);
+                if (!parseUnary())
+                {
+                    return false;
+                }
+                emit(Op::Bool);
+                patch(jump);
+            }
+            return true;
+        }
+
+        bool parseUnary()
+        {
+            if (accept(Tok::Not))
+            {
+                if (++m_nesting > kMaxFilterNesting)
+                {
+                    return fail("expression nested too deeply");
+                }
+                if (!parseUnary())
+                {
+                    return false;
+                }
+                --m_nesting;
+                emit(Op::Not);
+                return true;
+            }
+            return parsePrimary();
+        }
+
+        bool emitRegex(const std::string& pattern, bool negate)
+        {
+            std::string reError;
+            auto        re = DfaRegex::compile(pattern, reError);
+            if (!re.has_value())
+            {
+                return fail("invalid regex \"" + pattern + "\": " + reError);
+            }
+            m_prog.m_regexes.push_back(std::move(*re));
+            emit(Op::Regex, static_cast<int64_t>(m_prog.m_regexes.size() - 1));
+            if (negate)
+            {
+                emit(Op::Not);
+            }
+            return true;
+        }
+
+        bool parsePrimary()
+        {
+            if (accept(Tok::LParen))
+            {
+                if (++m_nesting > kMaxFilterNesting)
+                {
+                    return fail("expression nested too deeply");
+                }
+                if (!parseOr())
+                {
+                    return false;
+                }
+                if (!accept(Tok::RParen))
+                {
+                    return fail("expected ')'");
+                }
+                --m_nesting;
+                return true;
+            }
+
+            // Bare /regex/ or "regex" matches the payload text
+            if (cur().type == Tok::String)
+            {
+                const std::string pattern = cur().text;
+                ++m_idx;
+                return emitRegex(pattern, false);
+            }
+
+            if (cur().type == Tok::Ident && cur().text == "text")
+            {
+                ++m_idx;
+                bool negate = false;
+                if (accept(Tok::NotMatch))
+                {
+                    negate = true;
+                }
+                else if (!accept(Tok::Match))
+                {
+                    return fail("expected '~' or '!~' after 'text'");
+                }
+                if (cur().type != Tok::String)
+                {
+                    return fail("expected pattern");
+                }
+                const std::string pattern = cur().text;
+                ++m_idx;
+                return emitRegex(pattern, negate);
+            }
+
+            if (!parseOperand())
+            {
+                return false;
+            }
+
+            Op cmp{};
+            switch (cur().type)
+            {
+            case Tok::Eq: cmp = Op::Eq; break;
+            case Tok::Ne: cmp = Op::Ne; break;
+            case Tok::Lt: cmp = Op::Lt; break;
+            case Tok::Le: cmp = Op::Le; break;
+            case Tok::Gt: cmp = Op::Gt; break;
+            case Tok::Ge: cmp = Op::Ge; break;
+            default:
+                return true; // operand used as boolean
+            }
+            ++m_idx;
+
+            if (!parseOperand())
+            {
+                return false;
+            }
+            emit(cmp);
+            return true;
+        }
+
+        bool parseSignedNumber(int64_t& value)
+        {
+            const bool negative = accept(Tok::Minus);
+            if (cur().type != Tok::Number)
+            {
+                return fail("expected number");
+            }
+            value = negative ? -cur().value : cur().value;
+            ++m_idx;
+            return true;
+        }
+
+        bool parseOperand()
+        {
+            const Token& t = cur();
+
+            if (t.type == Tok::Number || t.type == Tok::Minus)
+            {
+                int64_t value = 0;
+                if (!parseSignedNumber(value))
+                {
+                    return false;
+                }
+                emit(Op::PushConst, value);
+                return true;
+            }
+
+            if (t.type != Tok::Ident)
+            {
+                return fail("expected operand");
+            }
+
+            const std::string name = t.text;
+            ++m_idx;
+
+            if (name == "channel" || name == "ch")
+            {
+                emit(Op::PushChannel);
+            }
+            else if (name == "len" || name == "length")
+            {
+                emit(Op::PushLen);
+            }
+            else if (name == "rx")
+            {
+                emit(Op::PushConst, static_cast<int64_t>(Channel::RX));
+            }
+            else if (name == "tx")
+            {
+                emit(Op::PushConst, static_cast<int64_t>(Channel::TX));
+            }
+            else if (name == "true" || name == "false")
+            {
+                emit(Op::PushConst, name == "true" ? 1 : 0);
+            }
+            else if (name == "bytes" || name == "b")
+            {
+                if (!accept(Tok::LBracket))
+                {
+                    return fail("expected '[' after 'bytes'");
+                }
+                int64_t index = 0;
+                if (!parseSignedNumber(index))
+                {
+                    return false;
+                }
+                if (!accept(Tok::RBracket))
+                {
+                    return fail("expected ']'");
+                }
+                emit(Op::PushByte, index);
+            }
+            else
+            {
+                --m_idx;
+                return fail("unknown identifier '" + name + "'");
+            }
+            return true;
+        }
+    };
+
+    std::optional<PacketFilter> PacketFilter::compile(const std::string& expr, std::string& error)
+    {
+        std::vector<Token> tokens;
+        if (!tokenize(expr, tokens, error))
+        {
+            return std::nullopt;
+        }
+        if (tokens.size() == 1)
+        {
+            error = "empty filter expression";
+            return std::nullopt;
+        }
+
+        PacketFilter   prog;
+        FilterCompiler compiler(tokens, prog);
+        if (!compiler.compile(error))
+        {
+            return std::nullopt;
+        }
+        if (prog.m_maxStack > kMaxFilterStack)
+        {
+            error = "filter expression too deeply nested";
+            return std::nullopt;
+        }
+
+        prog.m_expr = expr;
+        return prog;
+    }
+
+    bool PacketFilter::matches(const Packet& pkt) const
+    {
+        int64_t stack[kMaxFilterStack];
+        size_t  sp = 0;
+
+        const size_t codeSize = m_code.size();
+        for (size_t pc = 0; pc < codeSize; ++pc)
+        {
+            const Instr& in = m_code[pc];
+            switch (in.op)
+            {
+            case Op::PushConst:
+                stack[sp++] = in.arg;
+                break;
+            case Op::PushChannel:
+                stack[sp++] = static_cast<int64_t>(pkt.channel);
+                break;
+            case Op::PushLen:
+                stack[sp++] = static_cast<int64_t>(pkt.data.size());
+                break;
+            case Op::PushByte:
+            {
+                const int64_t size = static_cast<int64_t>(pkt.data.size());
+                const int64_t idx = (in.arg < 0) ? size + in.arg : in.arg;
+                stack[sp++] = (idx >= 0 && idx < size) ? pkt.data[static_cast<size_t>(idx)] : -1;
+                break;
+            }
+            case Op::Eq: --sp; stack[sp - 1] = stack[sp - 1] == stack[sp]; break;
+            case Op::Ne: --sp; stack[sp - 1] = stack[sp - 1] != stack[sp]; break;
+            case Op::Lt: --sp; stack[sp - 1] = stack[sp - 1] <  stack[sp]; break;
+            case Op::Le: --sp; stack[sp - 1] = stack[sp - 1] <= stack[sp]; break;
+            case Op::Gt: --sp; stack[sp - 1] = stack[sp - 1] >  stack[sp]; break;
+            case Op::Ge: --sp; stack[sp - 1] = stack[sp - 1] >= stack[sp]; break;
+            case Op::Not:
+                stack[sp - 1] = (stack[sp - 1] == 0);
+                break;
+            case Op::Bool:
+                stack[sp - 1] = (stack[sp - 1] != 0);
+                break;
+            case Op::JumpIfFalse:
+                if (stack[sp - 1] == 0)
+                {
+                    pc = static_cast<size_t>(in.arg) - 1;
+                }
+                else
+                {
+                    --sp;
+                }
+                break;
+            case Op::JumpIfTrue:
+                if (stack[sp - 1] != 0)
+                {
+                    pc = static_cast<size_t>(in.arg) - 1;
+                }
+                else
+                {
+                    --sp;
+                }
+                break;
+            case Op::Regex:
+                stack[sp++] = m_regexes[static_cast<size_t>(in.arg)].search(pkt.data.data(), pkt.data.size());
+                break;
+            }
+        }
+
+        return sp > 0 && stack[sp - 1] != 0;
+    }
+}
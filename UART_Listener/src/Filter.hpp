@@ -0,0 +1,89 @@
+/**
+ ****************************************************************************************
+ * @file   Filter.hpp
+ * @brief  Packet filter expressions compiled to bytecode.
+ *
+ *         Grammar:
+ *           expr    := or
+ *           or      := and ( '||' and )*
+ *           and     := unary ( '&&' unary )*
+ *           unary   := '!' unary | primary
+ *           primary := '(' expr ')' | match | operand [ cmp operand ]
+ *           match   := 'text' ( '~' | '!~' ) ( "regex" | /regex/ ) | /regex/
+ *           operand := 'channel' | 'len' | 'bytes' '[' [-]N ']' | 'rx' | 'tx' | number
+ *           cmp     := '==' | '!=' | '<' | '<=' | '>' | '>='
+ *
+ *         Example: channel==RX && len>8 && bytes[0]==0x7E
+ *
+ * @author Patrik Neunteufel
+ * @date   Oct 2026
+ ****************************************************************************************
+ */
+#pragma once
+
+#include "Regex.hpp"
+#include "UART.hpp"
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace uart_listener
+{
+    /**
+     * @brief Filter expression compiled once into a flat stack-machine program.
+     *
+     * Evaluation works on the raw packet bytes only, so filtered-out packets never
+     * pay for formatting. Out-of-range byte reads (e.g. bytes[9] on a 4-byte packet)
+     * evaluate to -1; negative indices count from the end (bytes[-1] = last byte).
+     */
+    class PacketFilter
+    {
+    public:
+        /**
+         * @brief Compile a filter expression.
+         * @param expr  Expression source
+         * @param error Receives a description if compilation fails
+         * @return Compiled filter, nullopt on syntax error
+         */
+        static std::optional<PacketFilter> compile(const std::string& expr, std::string& error);
+
+        /**
+         * @brief Evaluate the filter against a packet.
+         * @param pkt Packet to test
+         * @return true if the packet passes
+         */
+        bool matches(const Packet& pkt) const;
+
+        const std::string& expression() const noexcept { return m_expr; }
+
+    private:
+        friend class FilterCompiler;
+
+        enum class Op : uint8_t
+        {
+            PushConst,     ///< push arg
+            PushChannel,   ///< push packet channel (RX=0, TX=1)
+            PushLen,       ///< push payload length
+            PushByte,      ///< push bytes[arg] or -1
+            Eq, Ne, Lt, Le, Gt, Ge,
+            Not,           ///< logical negation of top
+            Bool,          ///< normalise top to 0/1
+            JumpIfFalse,   ///< if top == 0 jump to arg (keep), else pop
+            JumpIfTrue,    ///< if top != 0 jump to arg (keep), else pop
+            Regex          ///< push regexes[arg].search(payload)
+        };
+
+        struct Instr
+        {
+            Op      op;
+            int64_t arg;
+        };
+
+        std::string           m_expr;
+        std::vector<Instr>    m_code;
+        std::vector<DfaRegex> m_regexes;
+        size_t                m_maxStack = 0;
+    };
+}
@@ -37,6 +37,7 @@ enum class LogFormat
 {
     Text = 0, ///< Plain text log
     Csv,      ///< CSV format with separator
+    Sqlite,   ///< SQLite database, one row per frame (see SqliteLog.hpp)
     COUNT
 };
 
@@ -69,7 +70,8 @@ struct FormatMetaTraits<LogFormat>
     static constexpr std::array<const char*, count> names =
     {{
         "text",
-        "csv"
+        "csv",
+        "sqlite"
     }};
     // clang-format on
 };
@@ -0,0 +1,202 @@
+/**
+ ****************************************************************************************
+ * @file   FormatPool.cpp
+ * @brief  Order-preserving parallel formatting of console and log lines (--format-threads).
+ *
+ * @author Patrik Neunteufel
+ * @date   Oct 2026
+ ****************************************************************************************
+ */
+
+#include "FormatPool.hpp"
+#include "LogLine.hpp"
+#include "OutputPipeline.hpp"
+#include "Trace.hpp"
+
+#include <algorithm>
+
+namespace uart_listener
+{
+    FormatPool::FormatPool(unsigned workers, OutputFormat format, LogFormat logFormat, bool timestamps,
+                           const std::string& rxColor, const std::string& txColor, bool ansi)
+        : m_format(format),
+          m_logFormat(logFormat),
+          m_timestamps(timestamps),
+          m_rxColor(rxColor),
+          m_txColor(txColor),
+          m_ansi(ansi)
+    {
+        workers = std::max(1u, workers);
+        m_slots.resize(size_t{ workers } * kBatchesPerWorker);
+        m_open.reserve(kBatchPackets);
+        for (unsigned i = 0; i < workers; ++i)
+        {
+            m_threads.emplace_back(&FormatPool::worker, this);
+        }
+    }
+
+    FormatPool::~FormatPool()
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stopping = true;
+        }
+        m_cv.notify_all();
+        for (auto& t : m_threads)
+        {
+            t.join();
+        }
+    }
+
+    void FormatPool::add(std::shared_ptr<const Packet> pkt, bool console, bool log)
+    {
+        m_open.push_back({ std::move(pkt), nullptr, console, log });
+    }
+
+    void FormatPool::addRepeat(RepeatRun run)
+    {
+        const bool console = run.console;
+        const bool log = run.log;
+        m_open.push_back({ nullptr, std::make_shared<const RepeatRun>(std::move(run)), console, log });
+    }
+
+    void FormatPool::submit(const Writer& write)
+    {
+        if (m_open.empty())
+        {
+            return;
+        }
+
+        UART_TRACE_SCOPE("pool.submit");
+        for (;;)
+        {
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                if (m_submitted < m_written + m_slots.size())
+                {
+                    Slot& slot = m_slots[m_submitted % m_slots.size()];
+                    slot.items.swap(m_open);
+                    slot.ready = false;
+                    slot.submitted = std::chrono::steady_clock::now();
+                    ++m_submitted;
+                    break;
+                }
+            }
+            // Window full: the oldest batch has to be written before a new one fits
+            writeHead(write, true);
+        }
+        m_cv.notify_all();
+        m_open.clear();
+        m_open.reserve(kBatchPackets);
+    }
+
+    void FormatPool::drain(const Writer& write, bool all)
+    {
+        while (writeHead(write, all))
+        {
+        }
+    }
+
+    bool FormatPool::writeHead(const Writer& write, bool wait)
+    {
+        size_t                                logLines = 0;
+        std::chrono::steady_clock::time_point submitted;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            if (m_written == m_submitted)
+            {
+                return false;
+            }
+            Slot& slot = m_slots[m_written % m_slots.size()];
+            if (!slot.ready)
+            {
+                if (!wait)
+                {
+                    return false;
+                }
+                m_cv.wait(lock, [&] { return slot.ready; });
+            }
+            m_console.swap(slot.console);
+            m_log.swap(slot.log);
+            logLines = slot.logLines;
+            submitted = slot.submitted;
+            slot.ready = false;
+            ++m_written;
+        }
+        m_cv.notify_all();
+
+        UART_TRACE_SCOPE("pool.write");
+        write(m_console, m_log, logLines, submitted);
+        m_console.clear();
+        m_log.clear();
+        return true;
+    }
+
+    void FormatPool::worker()
+    {
+        UART_TRACE_THREAD_NAME("formatter");
+        OutputPipeline    output(m_format, m_logFormat, m_timestamps, m_rxColor, m_txColor);
+        std::vector<Item> items;
+        std::string       console;
+        std::string       log;
+
+        for (;;)
+        {
+            uint64_t index;
+            {
+                std::unique_lock<std::mutex> lock(m_mutex);
+                m_cv.wait(lock, [&] { return m_stopping || m_claimed < m_submitted; });
+                if (m_claimed == m_submitted)
+                {
+                    return;   // stopping with nothing left
+                }
+                index = m_claimed++;
+                Slot& slot = m_slots[index % m_slots.size()];
+                items.swap(slot.items);
+            }
+            console.clear();
+            log.clear();
+
+            size_t logLines = 0;
+            {
+                UART_TRACE_SCOPE("pool.format");
+                for (const Item& item : items)
+                {
+                    if (item.repeat)
+                    {
+                        output.formatRepeat(*item.repeat, item.console, item.log);
+                    }
+                    else if (item.pkt->kind == PacketKind::Data)
+                    {
+                        output.format(*item.pkt, item.console, item.log);
+                    }
+                    else
+                    {
+                        output.formatEvent(*item.pkt, eventMessage(*item.pkt), m_ansi, item.console, item.log);
+                    }
+                    if (item.console)
+                    {
+                        console += output.consoleLine();
+                    }
+                    if (item.log)
+                    {
+                        log += output.logLine();
+                        ++logLines;
+                    }
+                }
+            }
+
+            items.clear();   // the packets are released here, not on the consumer
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                Slot& slot = m_slots[index % m_slots.size()];
+                slot.items.swap(items);
+                slot.console.swap(console);
+                slot.log.swap(log);
+                slot.logLines = logLines;
+                slot.ready = true;
+            }
+            m_cv.notify_all();
+        }
+    }
+}
@@ -0,0 +1,132 @@
+/**
+ ****************************************************************************************
+ * @file   FormatPool.hpp
+ * @brief  Order-preserving parallel formatting of console and log lines (--format-threads).
+ *
+ *         At several Mbaud with --format hex or c-escape one consumer thread
+ *         cannot format as fast as the readers deliver. With a pool, the
+ *         consumer collects packets into batches numbered in queue order and
+ *         hands them to the workers; any idle worker claims the next waiting
+ *         batch. Each batch is formatted into its own console and log buffers,
+ *         and the consumer writes the finished batches strictly by number, so
+ *         the output is the same as without the pool.
+ *
+ *         At most kBatchesPerWorker batches per worker are in flight; beyond
+ *         that the consumer waits, which keeps memory bounded and leaves the
+ *         backlog in the packet queue where --status-interval shows it.
+ *
+ * @author Patrik Neunteufel
+ * @date   Oct 2026
+ ****************************************************************************************
+ */
+#pragma once
+
+#include "Format.hpp"
+#include "RepeatCollapser.hpp"
+#include "UART.hpp"
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace uart_listener
+{
+    class FormatPool
+    {
+    public:
+        static constexpr size_t kBatchPackets = 256;      // a batch is handed over when full or the queue is empty
+        static constexpr size_t kBatchesPerWorker = 4;
+
+        /**
+         * @brief Receives a finished batch, in order (consumer thread).
+         * @param logLines  Number of log lines in 'log'
+         * @param submitted When the batch was handed to the workers
+         */
+        using Writer = std::function<void(const std::string& console, const std::string& log, size_t logLines,
+                                          std::chrono::steady_clock::time_point submitted)>;
+
+        /**
+         * @param workers Number of formatting threads (at least 1)
+         * @param ansi    Highlight event lines on the console
+         */
+        FormatPool(unsigned workers, OutputFormat format, LogFormat logFormat, bool timestamps,
+                   const std::string& rxColor, const std::string& txColor, bool ansi);
+        ~FormatPool();
+
+        FormatPool(const FormatPool&) = delete;
+        FormatPool& operator=(const FormatPool&) = delete;
+
+        /** @brief Add a data or event packet to the open batch. */
+        void add(std::shared_ptr<const Packet> pkt, bool console, bool log);
+
+        /** @brief Add the line of a collapsed run (--collapse-repeats). */
+        void addRepeat(RepeatRun run);
+
+        bool batchFull() const noexcept { return m_open.size() >= kBatchPackets; }
+
+        /**
+         * @brief Hand the open batch to the workers.
+         * While the window is full, the oldest batch is waited for and written first.
+         */
+        void submit(const Writer& write);
+
+        /**
+         * @brief Write the finished batches at the head of the sequence.
+         * @param all Wait until every submitted batch is written
+         */
+        void drain(const Writer& write, bool all);
+
+        unsigned workers() const noexcept { return static_cast<unsigned>(m_threads.size()); }
+
+    private:
+        struct Item
+        {
+            std::shared_ptr<const Packet>    pkt;      // null for a repeat line
+            std::shared_ptr<const RepeatRun> repeat;
+            bool                             console = false;
+            bool                             log = false;
+        };
+
+        struct Slot
+        {
+            std::vector<Item> items;
+            std::string       console;
+            std::string       log;
+            size_t            logLines = 0;
+            bool              ready = false;
+
+            std::chrono::steady_clock::time_point submitted{};
+        };
+
+        void worker();
+        bool writeHead(const Writer& write, bool wait);
+
+        OutputFormat m_format;
+        LogFormat    m_logFormat;
+        bool         m_timestamps;
+        std::string  m_rxColor;
+        std::string  m_txColor;
+        bool         m_ansi;
+
+        // Consumer only: batch being collected, text being written
+        std::vector<Item> m_open;
+        std::string       m_console;
+        std::string       m_log;
+
+        std::mutex              m_mutex;
+        std::condition_variable m_cv;
+        std::vector<Slot>       m_slots;           // batch n lives in m_slots[n % size]
+        uint64_t                m_submitted = 0;   // batches handed over
+        uint64_t                m_claimed = 0;     // batches taken by a worker
+        uint64_t                m_written = 0;     // batches passed to the writer
+        bool                    m_stopping = false;
+
+        std::vector<std::thread> m_threads;
+    };
+}
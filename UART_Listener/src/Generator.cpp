@@ -0,0 +1,547 @@
+/**
+ ****************************************************************************************
+ * @file   Generator.cpp
+ * @brief  Synthetic UART traffic generator and capture verification.
+ *
+ * @author Patrik Neunteufel
+ * @date   Oct 2026
+ ****************************************************************************************
+ */
+
+#include "Generator.hpp"
+#include "Globals.hpp"
+#include "UART.hpp"
+#include "Worker.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <iterator>
+#include <thread>
+#include <unordered_map>
+
+namespace uart_listener
+{
+    namespace
+    {
+        using Clock = std::chrono::steady_clock;
+
+        constexpr size_t kBlockSize = 64;      // unit size for random / PRBS
+        constexpr size_t kVerifyWindow = 32;   // bytes compared per resync lookup
+        constexpr size_t kVerifyStride = 8;    // truth positions indexed every N bytes
+
+        /**
+         * Sleeps until a deadline with sub-millisecond accuracy. Uses a high
+         * resolution waitable timer (Windows 10 1803+) and falls back to a short
+         * spin when the default timer granularity is all we get.
+         */
+        class DeadlineSleeper
+        {
+        public:
+            DeadlineSleeper()
+                : m_timer(CreateWaitableTimerExW(nullptr, nullptr,
+                      CREATE_WAITABLE_TIMER_HIGH_RESOLUTION, TIMER_ALL_ACCESS))
+            {
+            }
+
+            ~DeadlineSleeper()
+            {
+                if (m_timer != NULL)
+                {
+                    CloseHandle(m_timer);
+                }
+            }
+
+            DeadlineSleeper(const DeadlineSleeper&) = delete;
+            DeadlineSleeper& operator=(const DeadlineSleeper&) = delete;
+
+            void sleepUntil(Clock::time_point deadline)
+            {
+                const auto remaining = deadline - Clock::now();
+                if (remaining <= Clock::duration::zero())
+                {
+                    return;
+                }
+
+                if (m_timer != NULL)
+                {
+                    // Relative due time in 100 ns units (negative = relative)
+                    LARGE_INTEGER due;
+                    due.QuadPart = -static_cast<LONGLONG>(
+                        std::chrono::duration_cast<std::chrono::nanoseconds>(remaining).count() / 100);
+                    if (SetWaitableTimer(m_timer, &due, 0, nullptr, nullptr, FALSE))
+                    {
+                        WaitForSingleObject(m_timer, INFINITE);
+                        return;
+                    }
+                }
+
+                if (remaining > std::chrono::milliseconds(2))
+                {
+                    std::this_thread::sleep_for(remaining - std::chrono::milliseconds(2));
+                }
+                while (Clock::now() < deadline)
+                {
+                    std::this_thread::yield();
+                }
+            }
+
+        private:
+            HANDLE m_timer;
+        };
+
+        uint64_t hashWindow(const uint8_t* p)
+        {
+            // FNV-1a over one verify window
+            uint64_t h = 0xcbf29ce484222325ull;
+            for (size_t i = 0; i < kVerifyWindow; ++i)
+            {
+                h = (h ^ p[i]) * 0x100000001b3ull;
+            }
+            return h;
+        }
+
+        bool readWholeFile(const std::string& path, std::vector<uint8_t>& out)
+        {
+            std::ifstream in(path, std::ios::binary);
+            if (!in.is_open())
+            {
+                return false;
+            }
+            out.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+            return true;
+        }
+    }
+
+    // ============================================================================
+    // TrafficGenerator
+    // ============================================================================
+
+    TrafficGenerator::TrafficGenerator(const GeneratorOptions& options, uint32_t baudRate)
+        : m_options(options),
+          m_rng(options.seed),
+          m_lfsr(options.seed & 0x7FFFFFFF ? options.seed & 0x7FFFFFFF : 1)
+    {
+        // Modbus RTU: 3.5 character times (11 bit frames), fixed 1750 us above 19200 baud
+        m_frameGap = (baudRate > 19200)
+                         ? std::chrono::microseconds(1750)
+                         : std::chrono::microseconds(35ull * 11 * 1'000'000 / 10 / baudRate);
+    }
+
+    void TrafficGenerator::nextUnit(std::vector<uint8_t>& out, std::chrono::microseconds& gapAfter)
+    {
+        out.clear();
+        gapAfter = std::chrono::microseconds(0);
+
+        switch (m_options.pattern)
+        {
+            case TrafficPattern::Random:
+                fillRandom(out, kBlockSize);
+                break;
+            case TrafficPattern::Prbs:
+                fillPrbs(out, kBlockSize);
+                break;
+            case TrafficPattern::Text:
+                makeTextLine(out);
+                break;
+            case TrafficPattern::Modbus:
+                makeModbusFrame(out);
+                gapAfter = m_frameGap;
+                break;
+            case TrafficPattern::Burst:
+                fillRandom(out, std::max<uint32_t>(m_options.burstBytes, 1));
+                gapAfter = std::chrono::milliseconds(m_options.burstIdleMs);
+                break;
+            default:
+                break;
+        }
+        ++m_sequence;
+    }
+
+    void TrafficGenerator::fillRandom(std::vector<uint8_t>& out, size_t n)
+    {
+        for (size_t i = 0; i < n; ++i)
+        {
+            out.push_back(static_cast<uint8_t>(m_rng()));
+        }
+    }
+
+    void TrafficGenerator::fillPrbs(std::vector<uint8_t>& out, size_t n)
+    {
+        // PRBS-31, LSB first on the wire like the UART itself
+        for (size_t i = 0; i < n; ++i)
+        {
+            uint8_t byte = 0;
+            for (int bit = 0; bit < 8; ++bit)
+            {
+                const uint32_t fb = ((m_lfsr >> 30) ^ (m_lfsr >> 27)) & 1u;
+                m_lfsr = ((m_lfsr << 1) | fb) & 0x7FFFFFFFu;
+                byte |= static_cast<uint8_t>(fb << bit);
+            }
+            out.push_back(byte);
+        }
+    }
+
+    void TrafficGenerator::makeTextLine(std::vector<uint8_t>& out)
+    {
+        static constexpr char kAlphabet[] =
+            "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789 =:,.-_";
+
+        char header[16];
+        std::snprintf(header, sizeof(header), "#%08u ", m_sequence);
+        out.insert(out.end(), header, header + std::strlen(header));
+
+        std::uniform_int_distribution<size_t> length(16, 64);
+        std::uniform_int_distribution<size_t> pick(0, sizeof(kAlphabet) - 2);
+        const size_t n = length(m_rng);
+        for (size_t i = 0; i < n; ++i)
+        {
+            out.push_back(static_cast<uint8_t>(kAlphabet[pick(m_rng)]));
+        }
+        out.push_back('\r');
+        out.push_back('\n');
+    }
+
+    void TrafficGenerator::makeModbusFrame(std::vector<uint8_t>& out)
+    {
+        std::uniform_int_distribution<int> addr(1, 247);
+        std::uniform_int_distribution<int> kind(0, 2);
+        std::uniform_int_distribution<int> count(1, 16);
+
+        const uint16_t seq = static_cast<uint16_t>(m_sequence);
+        out.push_back(static_cast<uint8_t>(addr(m_rng)));
+
+        switch (kind(m_rng))
+        {
+            case 0:
+            {
+                // Read Holding Registers response: first register carries the sequence
+                const int regs = count(m_rng);
+                out.push_back(0x03);
+                out.push_back(static_cast<uint8_t>(regs * 2));
+                out.push_back(static_cast<uint8_t>(seq >> 8));
+                out.push_back(static_cast<uint8_t>(seq));
+                fillRandom(out, static_cast<size_t>(regs - 1) * 2);
+                break;
+            }
+            case 1:
+            {
+                // Write Single Register: register address = sequence
+                out.push_back(0x06);
+                out.push_back(static_cast<uint8_t>(seq >> 8));
+                out.push_back(static_cast<uint8_t>(seq));
+                fillRandom(out, 2);
+                break;
+            }
+            default:
+            {
+                // Write Multiple Registers request
+                const int regs = count(m_rng);
+                out.push_back(0x10);
+                out.push_back(static_cast<uint8_t>(seq >> 8));
+                out.push_back(static_cast<uint8_t>(seq));
+                out.push_back(0x00);
+                out.push_back(static_cast<uint8_t>(regs));
+                out.push_back(static_cast<uint8_t>(regs * 2));
+                fillRandom(out, static_cast<size_t>(regs) * 2);
+                break;
+            }
+        }
+
+        const uint16_t crc = modbusCrc16(out.data(), out.size());
+        out.push_back(static_cast<uint8_t>(crc & 0xFF));
+        out.push_back(static_cast<uint8_t>(crc >> 8));
+    }
+
+    uint16_t modbusCrc16(const uint8_t* data, size_t size)
+    {
+        uint16_t crc = 0xFFFF;
+        for (size_t i = 0; i < size; ++i)
+        {
+            crc ^= data[i];
+            for (int bit = 0; bit < 8; ++bit)
+            {
+                crc = (crc & 1) ? static_cast<uint16_t>((crc >> 1) ^ 0xA001) : static_cast<uint16_t>(crc >> 1);
+            }
+        }
+        return crc;
+    }
+
+    // ============================================================================
+    // Verification
+    // ============================================================================
+
+    VerifyReport verifyCapture(const std::vector<uint8_t>& truth, const std::vector<uint8_t>& capture)
+    {
+        VerifyReport r;
+        r.truthBytes = truth.size();
+        r.captureBytes = capture.size();
+
+        // Index every kVerifyStride-th truth window (first occurrence wins)
+        std::unordered_map<uint64_t, size_t> index;
+        index.reserve(truth.size() / kVerifyStride + 1);
+        for (size_t p = 0; p + kVerifyWindow <= truth.size(); p += kVerifyStride)
+        {
+            index.emplace(hashWindow(truth.data() + p), p);
+        }
+
+        size_t i = 0;  // truth position
+        size_t j = 0;  // capture position
+
+        while (j < capture.size())
+        {
+            if (i < truth.size() && truth[i] == capture[j])
+            {
+                ++r.matched;
+                ++i;
+                ++j;
+                continue;
+            }
+
+            if (!r.firstErrorOffset.has_value())
+            {
+                r.firstErrorOffset = j;
+            }
+
+            // Resync: one of the next kVerifyStride capture windows hits an indexed truth window
+            bool synced = false;
+            for (size_t d = 0; d < kVerifyStride && j + d + kVerifyWindow <= capture.size(); ++d)
+            {
+                const auto it = index.find(hashWindow(capture.data() + j + d));
+                if (it == index.end() ||
+                    std::memcmp(truth.data() + it->second, capture.data() + j + d, kVerifyWindow) != 0)
+                {
+                    continue;
+                }
+
+                size_t p = it->second;
+                size_t skip = d;
+
+                // Extend the match backwards over bytes that are fine after all
+                while (skip > 0 && p > 0 && p > i && truth[p - 1] == capture[j + skip - 1])
+                {
+                    --skip;
+                    --p;
+                }
+
+                if (p >= i)
+                {
+                    // Forward: truth bytes in between never arrived (or arrived damaged)
+                    const size_t skippedTruth = p - i;
+                    const size_t substituted = std::min(skip, skippedTruth);
+                    r.corrupted += substituted;
+                    r.lost += skippedTruth - substituted;
+                    r.extra += skip - substituted;
+                    i = p;
+                    j += skip;
+                }
+                else
+                {
+                    // Backward: data we already counted as lost shows up late
+                    r.extra += skip;
+                    size_t run = 0;
+                    while (j + skip + run < capture.size() && p + run < i &&
+                           truth[p + run] == capture[j + skip + run])
+                    {
+                        ++run;
+                    }
+                    r.reordered += run;
+                    r.lost -= std::min<uint64_t>(r.lost, run);
+                    j += skip + run;
+                }
+
+                synced = true;
+                break;
+            }
+
+            if (!synced)
+            {
+                if (i < truth.size())
+                {
+                    ++r.corrupted;
+                    ++i;
+                }
+                else
+                {
+                    ++r.extra;
+                }
+                ++j;
+            }
+        }
+
+        r.lost += truth.size() - i;
+        return r;
+    }
+
+    int runVerify(const std::string& truthPath, const std::string& capturePath)
+    {
+        std::vector<uint8_t> truth;
+        std::vector<uint8_t> capture;
+
+        if (!readWholeFile(truthPath, truth))
+        {
+            std::cerr << "Cannot read truth file: " << truthPath << "\n";
+            return 1;
+        }
+        if (!readWholeFile(capturePath, capture))
+        {
+            std::cerr << "Cannot read capture file: " << capturePath << "\n";
+            return 1;
+        }
+
+        const VerifyReport r = verifyCapture(truth, capture);
+
+        std::cout << "[VERIFY] Truth:     " << r.truthBytes << " bytes (" << truthPath << ")\n"
+                  << "[VERIFY] Capture:   " << r.captureBytes << " bytes (" << capturePath << ")\n"
+                  << "[VERIFY] Matched:   " << r.matched << "\n"
+                  << "[VERIFY] Lost:      " << r.lost << "\n"
+                  << "[VERIFY] Reordered: " << r.reordered << "\n"
+                  << "[VERIFY] Corrupted: " << r.corrupted << "\n"
+                  << "[VERIFY] Extra:     " << r.extra << "\n";
+
+        if (r.clean())
+        {
+            std::cout << "[VERIFY] Result:    PASS\n";
+            return 0;
+        }
+
+        std::cout << "[VERIFY] Result:    FAIL (first error at capture offset "
+                  << r.firstErrorOffset.value_or(r.captureBytes) << ")\n";
+        return 1;
+    }
+
+    // ============================================================================
+    // Generator mode
+    // ============================================================================
+
+    int runGenerator(const std::string& port, const SerialSettings& serial, const GeneratorOptions& options)
+    {
+        const uint32_t lineRate = std::max<uint32_t>(serial.baudRate / serial.bitsPerChar(), 1);
+        const uint32_t rate = options.bytesPerSecond ? options.bytesPerSecond : lineRate;
+
+        if (rate > lineRate)
+        {
+            std::cerr << "Warning: --rate " << rate << " B/s exceeds the line rate of "
+                      << lineRate << " B/s; the driver will throttle.\n";
+        }
+
+        std::cout << "[INFO] Opening " << port << " for generator... " << std::flush;
+        HANDLE hPort = openSerialPortWriteOnly("\\\\.\\" + port, serial);
+        if (hPort == INVALID_HANDLE_VALUE)
+        {
+            std::cout << "FAILED\n";
+            return 1;
+        }
+        std::cout << "OK\n";
+
+        std::ofstream truthFile;
+        if (options.truthFilePath.has_value())
+        {
+            truthFile.open(*options.truthFilePath, std::ios::binary | std::ios::trunc);
+            if (!truthFile.is_open())
+            {
+                std::cerr << "Cannot create truth file: " << *options.truthFilePath << "\n";
+                CloseHandle(hPort);
+                return 1;
+            }
+            std::cout << "Truth file: " << *options.truthFilePath << "\n";
+        }
+
+        g_hStopEvent = CreateEvent(nullptr, TRUE, FALSE, nullptr);
+        std::thread keyThread(keyboardMonitorThread, KeyHandler());
+
+        std::cout << "[GEN] Pattern " << TrafficPatternTraits::toString(options.pattern)
+                  << ", " << rate << " B/s, seed " << options.seed << ", line " << serial.describe() << "\n"
+                  << "Press ESC or Q to stop.\n"
+                  << "----------------------------------------\n";
+
+        TrafficGenerator          gen(options, serial.baudRate);
+        DeadlineSleeper           sleeper;
+        std::vector<uint8_t>      unit;
+        std::chrono::microseconds gap{ 0 };
+        std::chrono::microseconds idleTotal{ 0 };
+
+        // Write about 1 ms of traffic per call so pacing stays smooth at any rate
+        const size_t chunkBytes = std::max<size_t>(rate / 1000, 1);
+
+        uint64_t   sent = 0;
+        bool       failed = false;
+        const auto start = Clock::now();
+        auto       nextStatus = start + std::chrono::seconds(1);
+
+        while (!g_stopRequested.load() && !failed)
+        {
+            gen.nextUnit(unit, gap);
+
+            if (options.totalBytes != 0)
+            {
+                unit.resize(static_cast<size_t>(std::min<uint64_t>(unit.size(), options.totalBytes - sent)));
+            }
+
+            for (size_t off = 0; off < unit.size() && !g_stopRequested.load(); off += chunkBytes)
+            {
+                // Byte 'sent' is due at start + sent / rate (+ all idle gaps so far)
+                const auto due = start + idleTotal +
+                                 std::chrono::microseconds(sent * 1'000'000 / rate);
+                sleeper.sleepUntil(due);
+
+                const DWORD n = static_cast<DWORD>(std::min(chunkBytes, unit.size() - off));
+                DWORD       written = 0;
+                if (!WriteFile(hPort, unit.data() + off, n, &written, nullptr) || written != n)
+                {
+                    std::cerr << "\nSerial write error (code: " << GetLastError() << ")\n";
+                    failed = true;
+                    break;
+                }
+
+                if (truthFile.is_open())
+                {
+                    truthFile.write(reinterpret_cast<const char*>(unit.data() + off), n);
+                }
+                sent += n;
+            }
+
+            idleTotal += gap;
+
+            const auto now = Clock::now();
+            if (now >= nextStatus)
+            {
+                const double secs = std::chrono::duration<double>(now - start).count();
+                std::cout << "\r[GEN] " << sent << " bytes sent, "
+                          << static_cast<uint64_t>(sent / secs) << " B/s    " << std::flush;
+                nextStatus += std::chrono::seconds(1);
+            }
+
+            if ((options.totalBytes != 0 && sent >= options.totalBytes) ||
+                (options.durationSec != 0 && now - start >= std::chrono::seconds(options.durationSec)))
+            {
+                break;
+            }
+        }
+
+        // Let the driver drain its transmit queue before closing
+        FlushFileBuffers(hPort);
+        const double secs = std::chrono::duration<double>(Clock::now() - start).count();
+
+        g_stopRequested.store(true);
+        if (g_hStopEvent != NULL)
+        {
+            SetEvent(g_hStopEvent);
+        }
+        keyThread.join();
+
+        CloseHandle(hPort);
+        if (g_hStopEvent != NULL)
+        {
+            CloseHandle(g_hStopEvent);
+        }
+        truthFile.close();
+
+        std::cout << "\n[GEN] Sent " << sent << " bytes in " << std::fixed << std::setprecision(2)
+                  << secs << " s (" << static_cast<uint64_t>(secs > 0 ? sent / secs : 0) << " B/s)\n";
+
+        return failed ? 1 : 0;
+    }
+}
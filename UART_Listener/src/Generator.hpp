@@ -0,0 +1,147 @@
+/**
+ ****************************************************************************************
+ * @file   Generator.hpp
+ * @brief  Synthetic UART traffic generator and capture verification.
+ *
+ *         Generator mode (--generate PORT) writes a paced traffic pattern to a COM
+ *         port and records every byte sent to a ground-truth file. Verify mode
+ *         (--verify TRUTH CAPTURE) compares that file against a raw capture
+ *         (--rx-raw-out / --tx-raw-out) and reports lost, reordered and corrupted
+ *         bytes.
+ *
+ * @author Patrik Neunteufel
+ * @date   Oct 2026
+ ****************************************************************************************
+ */
+#pragma once
+
+#include "Format.hpp"
+#include "SerialSettings.hpp"
+
+#include <chrono>
+#include <cstdint>
+#include <optional>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace uart_listener
+{
+    /**
+     * @brief Traffic patterns produced by the generator.
+     */
+    enum class TrafficPattern
+    {
+        Random = 0,  ///< Uniform random bytes
+        Prbs,        ///< PRBS-31 bit stream (x^31 + x^28 + 1)
+        Text,        ///< Numbered ASCII lines terminated with CRLF
+        Modbus,      ///< Modbus RTU style frames with CRC and 3.5 char gaps
+        Burst,       ///< Random bursts separated by idle gaps
+        COUNT
+    };
+
+    template<>
+    struct FormatMetaTraits<TrafficPattern>
+    {
+        static constexpr size_t count = static_cast<size_t>(TrafficPattern::COUNT);
+
+        // clang-format off
+        static constexpr std::array<const char*, count> names =
+        {{
+            "random",
+            "prbs",
+            "text",
+            "modbus",
+            "burst"
+        }};
+        // clang-format on
+    };
+
+    using TrafficPatternTraits = FormatTraitsBase<TrafficPattern>;
+
+    struct GeneratorOptions
+    {
+        TrafficPattern pattern = TrafficPattern::Prbs;
+        uint32_t       bytesPerSecond = 0;   // 0 = line rate (baud / bits per char)
+        uint64_t       totalBytes = 0;       // 0 = until duration / ESC
+        uint32_t       durationSec = 0;      // 0 = until totalBytes / ESC
+        uint32_t       seed = 1;
+        uint32_t       burstBytes = 256;
+        uint32_t       burstIdleMs = 50;
+        std::optional<std::string> truthFilePath;
+    };
+
+    /**
+     * @brief Deterministic pattern source.
+     *
+     * Produces the stream in units (a block, a text line, a frame or a burst);
+     * each unit may be followed by an idle gap on the wire.
+     */
+    class TrafficGenerator
+    {
+    public:
+        TrafficGenerator(const GeneratorOptions& options, uint32_t baudRate);
+
+        /**
+         * @brief Produce the next unit.
+         * @param out     Receives the unit bytes (replaced)
+         * @param gapAfter Idle time to leave after the unit
+         */
+        void nextUnit(std::vector<uint8_t>& out, std::chrono::microseconds& gapAfter);
+
+    private:
+        void fillRandom(std::vector<uint8_t>& out, size_t n);
+        void fillPrbs(std::vector<uint8_t>& out, size_t n);
+        void makeTextLine(std::vector<uint8_t>& out);
+        void makeModbusFrame(std::vector<uint8_t>& out);
+
+        GeneratorOptions          m_options;
+        std::chrono::microseconds m_frameGap;
+        std::mt19937              m_rng;
+        uint32_t                  m_lfsr;
+        uint32_t                  m_sequence = 0;
+    };
+
+    /**
+     * @brief Modbus RTU CRC-16 (poly 0xA001, init 0xFFFF).
+     */
+    uint16_t modbusCrc16(const uint8_t* data, size_t size);
+
+    /**
+     * @brief Result of comparing a capture against the generator's ground truth.
+     */
+    struct VerifyReport
+    {
+        uint64_t truthBytes = 0;
+        uint64_t captureBytes = 0;
+        uint64_t matched = 0;     ///< bytes received in order and intact
+        uint64_t lost = 0;        ///< sent but never received
+        uint64_t reordered = 0;   ///< received intact, but after later data
+        uint64_t corrupted = 0;   ///< received with a different value
+        uint64_t extra = 0;       ///< received, but not part of the truth
+        std::optional<uint64_t> firstErrorOffset;  ///< capture offset of first problem
+
+        bool clean() const { return lost == 0 && reordered == 0 && corrupted == 0 && extra == 0; }
+    };
+
+    /**
+     * @brief Align a capture to the ground truth.
+     *
+     * Resynchronises after every mismatch by looking up the next 32 captured
+     * bytes in an index of the truth: a later match means the bytes in between
+     * were lost, an earlier match means reordering, no match means corruption.
+     */
+    VerifyReport verifyCapture(const std::vector<uint8_t>& truth, const std::vector<uint8_t>& capture);
+
+    /**
+     * @brief Generator mode entry point.
+     * @return process exit code
+     */
+    int runGenerator(const std::string& port, const SerialSettings& serial, const GeneratorOptions& options);
+
+    /**
+     * @brief Verify mode entry point; prints the report.
+     * @return 0 if the capture matches the truth, 1 otherwise
+     */
+    int runVerify(const std::string& truthPath, const std::string& capturePath);
+}
@@ -15,4 +15,5 @@ namespace uart_listener
     std::atomic<bool> g_stopRequested{ false };
     HANDLE g_hStopEvent = NULL;  // Manual-reset event to signal stop
     PacketQueue g_packetQueue;
+    Metrics g_metrics;
 }
\ No newline at end of file
@@ -9,6 +9,7 @@
  */
 #pragma once
 
+#include "Metrics.hpp"
 #include "UART.hpp"
 
 #include <atomic>
@@ -23,4 +24,5 @@ namespace uart_listener
     extern std::atomic<bool> g_stopRequested;
     extern HANDLE g_hStopEvent;  // Manual-reset event to signal stop
     extern PacketQueue g_packetQueue;
+    extern Metrics g_metrics;
 }
\ No newline at end of file
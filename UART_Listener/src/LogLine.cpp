@@ -0,0 +1,68 @@
+/**
+ ****************************************************************************************
+ * @file   LogLine.cpp
+ * @brief  Log line emission for the text and CSV log containers.
+ *
+ * @author Patrik Neunteufel
+ * @date   Oct 2026
+ ****************************************************************************************
+ */
+
+#include "LogLine.hpp"
+
+namespace uart_listener
+{
+    void writeLogHeader(std::ostream& out, LogFormat fmt, const std::string& ports,
+                        const SerialSettings& serial, const std::string& startTime,
+                        const std::vector<std::string>& notes)
+    {
+        out << "# uart_listener capture started " << startTime << "\n"
+            << "# Ports: " << ports << "\n"
+            << "# Line: " << serial.describe() << " (driver queue " << serial.inQueueSize << " bytes)\n";
+
+        for (const auto& note : notes)
+        {
+            out << "# " << note << "\n";
+        }
+
+        if (fmt == LogFormat::Csv)
+        {
+            out << "Timestamp;Channel;Data\n";
+        }
+    }
+
+    std::string eventMessage(const Packet& pkt)
+    {
+        switch (pkt.kind)
+        {
+        case PacketKind::LineError:
+            return "!! LINE ERROR: " + describeLineErrors(pkt.lineErrors)
+                 + " (within " + std::to_string(pkt.errorWindowMs) + " ms)";
+        case PacketKind::Disconnect:
+            return "!! DISCONNECTED (Error code: " + std::to_string(pkt.systemError) + "), reconnecting";
+        case PacketKind::Reconnect:
+            return "!! RECONNECTED after " + std::to_string(pkt.outageMs) + " ms";
+        default:
+            return std::string();
+        }
+    }
+
+    void writeLogLine(std::ostream& out, LogFormat fmt, bool timestampsEnabled,
+                      const Packet& pkt, const std::string& payload)
+    {
+        if (fmt == LogFormat::Csv)
+        {
+            // CSV: Timestamp;Channel;Data
+            out << pkt.timestamp << ";" << channelName(pkt.channel) << ";" << payload << "\n";
+        }
+        else
+        {
+            // Text format
+            if (timestampsEnabled)
+            {
+                out << pkt.timestamp << " ";
+            }
+            out << channelTag(pkt.channel) << " " << payload << "\n";
+        }
+    }
+}
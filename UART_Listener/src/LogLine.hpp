@@ -0,0 +1,63 @@
+/**
+ ****************************************************************************************
+ * @file   LogLine.hpp
+ * @brief  Log line emission for the text and CSV log containers.
+ *
+ * @author Patrik Neunteufel
+ * @date   Oct 2026
+ ****************************************************************************************
+ */
+#pragma once
+
+#include "Format.hpp"
+#include "SerialSettings.hpp"
+#include "UART.hpp"
+
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace uart_listener
+{
+    /**
+     * @brief Channel tag used in console and text log lines.
+     */
+    inline const char* channelTag(Channel channel)
+    {
+        return (channel == Channel::RX) ? "[RX]" : "[TX]";
+    }
+
+    /**
+     * @brief Channel name used in CSV logs.
+     */
+    inline const char* channelName(Channel channel)
+    {
+        return (channel == Channel::RX) ? "RX" : "TX";
+    }
+
+    /**
+     * @brief Write the capture settings as '#' comment lines (plus the CSV column header).
+     * @param ports     e.g. "RX COM5, TX COM6"
+     * @param startTime Capture start timestamp
+     * @param notes     Additional comment lines (without "# ")
+     */
+    void writeLogHeader(std::ostream& out, LogFormat fmt, const std::string& ports,
+                        const SerialSettings& serial, const std::string& startTime,
+                        const std::vector<std::string>& notes = {});
+
+    /**
+     * @brief Console/log text for an event packet (line error, disconnect, reconnect).
+     */
+    std::string eventMessage(const Packet& pkt);
+
+    /**
+     * @brief Write one log line for a packet.
+     * @param out               Log stream
+     * @param fmt               Log container format
+     * @param timestampsEnabled Prefix text lines with the capture timestamp
+     * @param pkt               Captured packet (channel, timestamp)
+     * @param payload           Already formatted payload
+     */
+    void writeLogLine(std::ostream& out, LogFormat fmt, bool timestampsEnabled,
+                      const Packet& pkt, const std::string& payload);
+}
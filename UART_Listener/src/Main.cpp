@@ -10,6 +10,11 @@
  *         - Text or CSV log output
  *         - Optional raw binary dump files
  *         - Timestamps with millisecond precision
+ *         - Compiled packet filters for console and log
+ *         - Live metrics (status line, Prometheus file, localhost HTTP)
+ *         - Optional hot-path tracing (Chrome trace JSON)
+ *         - Traffic generator and capture verification modes
+ *         - Driver overrun/framing/parity error accounting
  *
  * @author Patrik Neunteufel
  * @date   Jan 2026
@@ -18,20 +23,42 @@
 
 #define _CRT_SECURE_NO_WARNINGS
 
+#include "Analyze.hpp"
+#include "Columnar.hpp"
 #include "Color.hpp"
 #include "Config.hpp"
+#include "ConsoleThrottle.hpp"
+#include "Convert.hpp"
 #include "Cli.hpp"
 #include "Format.hpp"
+#include "FormatPool.hpp"
 #include "Time.hpp"
 #include "UART.hpp"
 #include"DataFormat.hpp"
 #include "Worker.hpp"
 #include "ANSI_support.hpp"
 #include "Globals.hpp"
+#include "DurableLog.hpp"
+#include "Echo.hpp"
+#include "FileWriter.hpp"
+#include "Filter.hpp"
+#include "Generator.hpp"
+#include "LogLine.hpp"
+#include "Metrics.hpp"
+#include "MetricsServer.hpp"
+#include "OutputPipeline.hpp"
+#include "RepeatCollapser.hpp"
+#include "ShmRing.hpp"
+#include "SinkGraph.hpp"
+#include "StreamServer.hpp"
+#include "Trace.hpp"
+#include "Transaction.hpp"
+#include "Tui.hpp"
 
 #include <algorithm>
 #include <atomic>
 #include <chrono>
+#include <cmath>
 #include <condition_variable>
 #include <conio.h>
 #include <cstdint>
@@ -40,6 +67,7 @@
 #include <fstream>
 #include <iomanip>
 #include <iostream>
+#include <memory>
 #include <mutex>
 #include <optional>
 #include <sstream>
@@ -61,6 +89,78 @@ int main(int argc, char* argv[])
                    : 1;
     }
 
+    if (cfg.verifyTruthPath.has_value())
+    {
+        return runVerify(*cfg.verifyTruthPath, *cfg.verifyCapturePath);
+    }
+
+    if (cfg.generatePort.has_value())
+    {
+        return runGenerator(*cfg.generatePort, cfg.serial, cfg.generator);
+    }
+
+    if (cfg.recoverPath.has_value())
+    {
+        return runRecover(*cfg.recoverPath);
+    }
+
+    if (cfg.convertInputPath.has_value())
+    {
+        ConvertOptions convert = cfg.convert;
+        convert.payload = cfg.outputFormat;
+        return runConvert(*cfg.convertInputPath, *cfg.convertOutputPath, convert, cfg.fileWriter);
+    }
+
+    if (cfg.analyzeInputPath.has_value())
+    {
+        return runAnalyze(*cfg.analyzeInputPath, cfg.outputFormat, cfg.analyze);
+    }
+
+    if (cfg.queryInputPath.has_value())
+    {
+        return runQuery(*cfg.queryInputPath, cfg.outputFormat, cfg.query);
+    }
+
+    // Compile packet filters once; --log-filter overrides --filter for the log
+    std::optional<PacketFilter> consoleFilter;
+    std::optional<PacketFilter> logFilter;
+
+    if (cfg.filterExpr.has_value())
+    {
+        std::string error;
+        consoleFilter = PacketFilter::compile(*cfg.filterExpr, error);
+        if (!consoleFilter.has_value())
+        {
+            std::cerr << "Invalid --filter: " << error << "\n";
+            return 1;
+        }
+        logFilter = consoleFilter;
+    }
+
+    if (cfg.logFilterExpr.has_value())
+    {
+        std::string error;
+        logFilter = PacketFilter::compile(*cfg.logFilterExpr, error);
+        if (!logFilter.has_value())
+        {
+            std::cerr << "Invalid --log-filter: " << error << "\n";
+            return 1;
+        }
+    }
+
+    // --txn regex: the pattern locates the transaction ID in both directions
+    std::optional<DfaRegex> txnPattern;
+    if (cfg.txn.enabled && cfg.txn.match == TxnMatch::Pattern)
+    {
+        std::string error;
+        txnPattern = DfaRegex::compile(cfg.txn.pattern, error, true);
+        if (!txnPattern.has_value())
+        {
+            std::cerr << "Invalid --txn pattern: " << error << "\n";
+            return 1;
+        }
+    }
+
     // Enable ANSI colors on Windows
     bool ansiEnabled = enableVirtualTerminalProcessing();
     if (!ansiEnabled)
@@ -92,7 +192,7 @@ int main(int argc, char* argv[])
     {
         const std::string rxWinPort = "\\\\.\\" + cfg.rxPort;
         std::cout << "[INFO] Opening " << cfg.rxPort << " for RX... " << std::flush;
-        hRx = openSerialPortReadOnly(rxWinPort, cfg.baudRate);
+        hRx = openSerialPortReadOnly(rxWinPort, cfg.serial);
         if (hRx == INVALID_HANDLE_VALUE)
         {
             std::cout << "FAILED\n";
@@ -106,7 +206,7 @@ int main(int argc, char* argv[])
     {
         const std::string txWinPort = "\\\\.\\" + cfg.txPort;
         std::cout << "[INFO] Opening " << cfg.txPort << " for TX... " << std::flush;
-        hTx = openSerialPortReadOnly(txWinPort, cfg.baudRate);
+        hTx = openSerialPortReadOnly(txWinPort, cfg.serial);
         if (hTx == INVALID_HANDLE_VALUE)
         {
             std::cout << "FAILED\n";
@@ -130,7 +230,8 @@ int main(int argc, char* argv[])
     else
     {
         std::string ts       = getTimestampFileSafe();
-        std::string ext      = (cfg.logFormat == LogFormat::Csv) ? ".csv" : ".log";
+        std::string ext      = (cfg.logFormat == LogFormat::Csv) ? ".csv"
+                             : (cfg.logFormat == LogFormat::Sqlite) ? ".db" : ".log";
         std::string portPart;
         if (!cfg.rxPort.empty() && !cfg.txPort.empty())
         {
@@ -148,11 +249,45 @@ int main(int argc, char* argv[])
         logPath = (exeDir / fileName).string();
     }
 
-    // Open log file
-    std::ofstream logFile(logPath, std::ios::out);
-    bool          loggingEnabled = true;
+    // Repair durable logs of a previous run that did not exit cleanly
+    if (cfg.fileWriter.durableMs != 0)
+    {
+        const fs::path logDir = fs::absolute(fs::path(logPath)).parent_path();
+        recoverDurableLogs(logDir.string());
+    }
+
+    // Ports as named in the file headers
+    std::string ports;
+    if (!cfg.rxPort.empty())
+    {
+        ports = "RX " + cfg.rxPort;
+    }
+    if (!cfg.txPort.empty())
+    {
+        ports += (ports.empty() ? "" : ", ") + std::string("TX ") + cfg.txPort;
+    }
+
+    // Open log file; a SQLite log is written by a sink thread instead
+    CaptureFile           logFile;
+    bool                  loggingEnabled = true;
+    std::vector<SinkSpec> sinkSpecs = cfg.sinks;
+    if (cfg.logFormat == LogFormat::Sqlite)
+    {
+        SinkSpec spec;
+        spec.path = logPath;
+        spec.logFormat = LogFormat::Sqlite;
+        spec.filter = logFilter;
+        spec.commitMs = cfg.fileWriter.durableMs;   // --durable bounds the commit delay like for a text log
+        sinkSpecs.insert(sinkSpecs.begin(), spec);
+        loggingEnabled = false;
+        std::cout << "Log file: " << logPath << " (SQLite)\n";
+    }
+    else
+    {
+        logFile.open(logPath, cfg.fileWriter, true);
+    }
 
-    if (!logFile.is_open())
+    if (cfg.logFormat != LogFormat::Sqlite && !logFile.is_open())
     {
         std::cerr << "Error creating log file: " << logPath << "\n";
         std::cerr << "System error: " << strerror(errno) << "\n";
@@ -169,24 +304,28 @@ int main(int argc, char* argv[])
         }
         loggingEnabled = false;
     }
-    else
+    else if (logFile.is_open())
     {
         std::cout << "Log file: " << logPath << "\n";
 
-        // Write CSV header if needed
-        if (cfg.logFormat == LogFormat::Csv)
+        // Capture settings as '#' comments, then the CSV column header
+        // The payload format lets --analyze-file decode the log later
+        std::vector<std::string> notes = { std::string("Format: ") + OutputFormatTraits::toString(cfg.outputFormat) };
+        if (cfg.fileWriter.durableMs != 0)
         {
-            logFile << "Timestamp;Channel;Data\n";
+            const auto durable = durableHeaderNotes(cfg.fileWriter.durableMs, cfg.rxRawOutPath, cfg.txRawOutPath);
+            notes.insert(notes.end(), durable.begin(), durable.end());
         }
+        writeLogHeader(logFile, cfg.logFormat, ports, cfg.serial, getTimestampFileSafe(), notes);
     }
 
     // Open raw output files (optional)
-    std::ofstream rxRawFile;
-    std::ofstream txRawFile;
+    CaptureFile rxRawFile;
+    CaptureFile txRawFile;
 
     if (cfg.rxRawOutPath.has_value())
     {
-        rxRawFile.open(*cfg.rxRawOutPath, std::ios::binary);
+        rxRawFile.open(*cfg.rxRawOutPath, cfg.fileWriter, false);
         if (!rxRawFile.is_open())
         {
             std::cerr << "Warning: Failed to open RX raw output: "
@@ -201,7 +340,7 @@ int main(int argc, char* argv[])
 
     if (cfg.txRawOutPath.has_value())
     {
-        txRawFile.open(*cfg.txRawOutPath, std::ios::binary);
+        txRawFile.open(*cfg.txRawOutPath, cfg.fileWriter, false);
         if (!txRawFile.is_open())
         {
             std::cerr << "Warning: Failed to open TX raw output: "
@@ -214,19 +353,108 @@ int main(int argc, char* argv[])
         }
     }
 
+    // Tracing must be enabled before any thread starts (sinks, readers, formatters)
+    if (cfg.traceFilePath.has_value())
+    {
+        trace::enable(*cfg.traceFilePath);
+        UART_TRACE_THREAD_NAME("consumer");
+        std::cout << "Trace file: " << *cfg.traceFilePath << " (press T to dump)\n";
+    }
+
+    // Further output files, each on its own thread (optional)
+    SinkGraph sinks(sinkSpecs, cfg.outputFormat, cfg.logFormat, cfg.timestampsEnabled, cfg.fileWriter,
+                    cfg.flushTimeoutMs);
+    if (!sinks.empty())
+    {
+        if (!sinks.start(ports, cfg.serial, getTimestampFileSafe()))
+        {
+            CloseHandle(hRx);
+            CloseHandle(hTx);
+            return 1;
+        }
+        for (const auto& sink : cfg.sinks)
+        {
+            std::cout << "Sink: " << SinkKindTraits::toString(sink.kind) << " " << sink.path << "\n";
+        }
+    }
+
+    // Shared-memory export for other processes (optional)
+    ShmRingWriter shmRing;
+    if (cfg.shmName.has_value())
+    {
+        if (shmRing.create(*cfg.shmName, size_t{ cfg.shmSizeKb } * 1024, cfg.serial))
+        {
+            std::cout << "Shared memory: " << shm::mappingName(*cfg.shmName) << "\n";
+        }
+        else
+        {
+            std::cerr << "Warning: Shared memory export disabled.\n";
+        }
+    }
+
+    // Streaming server for additional viewers (optional)
+    StreamServer streamServer(cfg.stream);
+    if (cfg.stream.port != 0)
+    {
+        if (streamServer.start())
+        {
+            std::cout << "Stream: 127.0.0.1:" << cfg.stream.port << " ("
+                      << StreamFormatTraits::toString(cfg.stream.format) << ", drop "
+                      << StreamDropPolicyTraits::toString(cfg.stream.dropPolicy) << ")\n";
+        }
+        else
+        {
+            std::cerr << "Warning: Streaming server disabled.\n";
+            cfg.stream.port = 0;
+        }
+    }
+
     // Start worker threads (conditionally)
     std::thread rxThread;
     std::thread txThread;
     
+    // The reader threads own their port handles from here on (they may reopen them)
+    ReaderOptions readerOptions;
+    readerOptions.serial = cfg.serial;
+    readerOptions.coalesce = cfg.coalesce;
+    readerOptions.reconnectMaxMs = cfg.reconnectMaxMs;
+
     if (hRx != INVALID_HANDLE_VALUE)
     {
-        rxThread = std::thread(serialReaderThread, hRx, Channel::RX);
+        readerOptions.portName = "\\\\.\\" + cfg.rxPort;
+        rxThread = std::thread(serialReaderThread, hRx, Channel::RX, readerOptions);
     }
     if (hTx != INVALID_HANDLE_VALUE)
     {
-        txThread = std::thread(serialReaderThread, hTx, Channel::TX);
+        readerOptions.portName = "\\\\.\\" + cfg.txPort;
+        txThread = std::thread(serialReaderThread, hTx, Channel::TX, readerOptions);
     }
-    std::thread kbThread(keyboardMonitorThread);  // Use conio.h version
+
+    // Full-screen view; created before the keyboard thread, which forwards keys to it
+    std::optional<Tui> tui;
+    if (cfg.tui.enabled)
+    {
+        if (ansiEnabled)
+        {
+            std::string title = cfg.rxPort.empty() ? std::string() : "RX " + cfg.rxPort;
+            if (!cfg.txPort.empty())
+            {
+                title += (title.empty() ? "" : " / ") + std::string("TX ") + cfg.txPort;
+            }
+            tui.emplace(cfg.tui, cfg.outputFormat, cfg.timestampsEnabled, cfg.rxColor.value_or(""),
+                        cfg.txColor.value_or(""), title);
+        }
+        else
+        {
+            std::cerr << "Warning: --tui needs ANSI support, using the plain console.\n";
+        }
+    }
+    KeyHandler onKey;
+    if (tui.has_value())
+    {
+        onKey = [&tui](int key, bool extended) { return tui->onKey(key, extended); };
+    }
+    std::thread kbThread(keyboardMonitorThread, onKey);  // Use conio.h version
 
     // Display info
     std::cout << "\n"
@@ -247,10 +475,32 @@ int main(int argc, char* argv[])
         std::cout << "Mode: Single (TX only)\n"
                   << "TX Port: " << cfg.txPort << "\n";
     }
-    std::cout << "Baud: " << cfg.baudRate << "\n"
+    std::cout << "Line: " << cfg.serial.describe() << "\n"
               << "Format: " << OutputFormatTraits::toString(cfg.outputFormat) << "\n"
-              << "Log format: " << LogFormatTraits::toString(cfg.logFormat) << "\n"
-              << "========================================\n";
+              << "Log format: " << LogFormatTraits::toString(cfg.logFormat) << "\n";
+    if (cfg.fileWriter.kind != FileWriterKind::Stream)
+    {
+        std::cout << "File writer: " << FileWriterKindTraits::toString(cfg.fileWriter.kind)
+                  << " (" << cfg.fileWriter.extentMb << " MB extents)\n";
+    }
+    if (cfg.fileWriter.durableMs != 0)
+    {
+        std::cout << "Durable: commit every " << cfg.fileWriter.durableMs << " ms\n";
+    }
+    if (cfg.coalesce.enabled())
+    {
+        std::cout << "Coalescing: up to " << cfg.coalesce.maxBytes << " bytes / "
+                  << cfg.coalesce.budgetUs << " us\n";
+    }
+    if (consoleFilter.has_value())
+    {
+        std::cout << "Filter: " << consoleFilter->expression() << "\n";
+    }
+    if (cfg.logFilterExpr.has_value())
+    {
+        std::cout << "Log filter: " << logFilter->expression() << "\n";
+    }
+    std::cout << "========================================\n";
 
     // Show colored port status as first "messages"
     const std::string ansiReset = "\033[0m";
@@ -285,92 +535,438 @@ int main(int argc, char* argv[])
     std::cout << "\nPress ESC or Q to quit.\n"
               << "----------------------------------------\n" << std::flush;
 
+    // Metrics reporting (status line, Prometheus file, HTTP endpoint)
+    MetricsPublication metricsPublication;
+    MetricsServer      metricsServer(metricsPublication);
+
+    MetricsReporterOptions reporterOptions;
+    reporterOptions.baudRate = cfg.serial.baudRate;
+    reporterOptions.bitsPerChar = cfg.serial.bitsPerChar();
+    reporterOptions.statusIntervalMs = cfg.statusIntervalMs;
+    reporterOptions.filePath = cfg.metricsFilePath;
+    reporterOptions.publish = (cfg.metricsPort != 0);
+    reporterOptions.rxActive = (hRx != INVALID_HANDLE_VALUE);
+    reporterOptions.txActive = (hTx != INVALID_HANDLE_VALUE);
+    if (tui.has_value())
+    {
+        reporterOptions.statusSink = [&tui](const std::string& line) { tui->setStatus(line); };
+    }
+
+    if (cfg.metricsPort != 0)
+    {
+        if (metricsServer.start(cfg.metricsPort))
+        {
+            std::cout << "[INFO] Metrics endpoint: http://127.0.0.1:" << cfg.metricsPort << "/metrics\n";
+        }
+        else
+        {
+            std::cerr << "Warning: Metrics endpoint disabled.\n";
+        }
+    }
+
+    MetricsReporter   metricsReporter(g_metrics, g_packetQueue, reporterOptions, metricsPublication);
+    PipelineCounters& pipelineCounters = g_metrics.pipeline();
+
     // Flush timing
     auto lastFlush = std::chrono::steady_clock::now();
 
+    // Formats, timestamps and raw outputs are fixed from here on; resolve them
+    // once instead of branching on cfg for every packet
+    OutputPipeline output(cfg.outputFormat, cfg.logFormat, cfg.timestampsEnabled, rxTagColor, txTagColor);
+    CaptureFile*   rawOut[2] = {
+        (cfg.rxRawOutPath.has_value() && rxRawFile.is_open()) ? &rxRawFile : nullptr,
+        (cfg.txRawOutPath.has_value() && txRawFile.is_open()) ? &txRawFile : nullptr
+    };
+
+    // Durable mode: group commit replaces the periodic flush; the header is committed right away
+    std::optional<GroupCommit> groupCommit;
+    if (cfg.fileWriter.durableMs != 0)
+    {
+        groupCommit.emplace(cfg.fileWriter.durableMs, logFile, rxRawFile, txRawFile);
+        groupCommit->commit(false);
+    }
+
+    // Formatting on worker threads (--format-threads); the batches come back in
+    // queue order and are written here
+    std::optional<FormatPool> formatPool;
+    if (cfg.formatThreads != 0)
+    {
+        formatPool.emplace(cfg.formatThreads, cfg.outputFormat, cfg.logFormat, cfg.timestampsEnabled, rxTagColor,
+                           txTagColor, ansiEnabled);
+    }
+    const auto writeBatch = [&](const std::string& console, const std::string& log, size_t logLines,
+                                std::chrono::steady_clock::time_point submitted) {
+        if (!console.empty())
+        {
+            UART_TRACE_SCOPE("console.write");
+            std::cout.write(console.data(), static_cast<std::streamsize>(console.size()));
+        }
+        if (log.empty())
+        {
+            return;
+        }
+        {
+            UART_TRACE_SCOPE("log.write");
+            logFile.write(log.data(), static_cast<std::streamsize>(log.size()));
+        }
+
+        const auto now = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < logLines; ++i)
+        {
+            pipelineCounters.formatToDisk.record(now - submitted);
+        }
+        if (groupCommit.has_value())
+        {
+            groupCommit->written(now);
+        }
+        else if (now - lastFlush >= std::chrono::milliseconds(cfg.flushTimeoutMs))
+        {
+            UART_TRACE_SCOPE("log.flush");
+            logFile.flush();
+            lastFlush = now;
+        }
+    };
+
+    // Above --console-max-rate the console shows summaries; the TUI has its own view
+    std::optional<ConsoleThrottle> throttle;
+    if (cfg.console.maxLinesPerSec != 0 && !tui.has_value())
+    {
+        throttle.emplace(cfg.console, cfg.outputFormat, cfg.timestampsEnabled, rxTagColor, txTagColor);
+    }
+
+    // Identical frames in a row become one line per run (--collapse-repeats)
+    std::optional<RepeatCollapser> collapser;
+    if (cfg.collapse.enabled)
+    {
+        collapser.emplace(cfg.collapse);
+    }
+    const auto writeRuns = [&]() {
+        RepeatRun run;
+        bool      logged = false;
+        while (collapser->takeRun(run))
+        {
+            if (formatPool.has_value())
+            {
+                formatPool->addRepeat(std::move(run));
+                continue;
+            }
+            output.formatRepeat(run, run.console, run.log);
+            if (run.console)
+            {
+                std::cout.write(output.consoleLine().data(), static_cast<std::streamsize>(output.consoleLine().size()));
+            }
+            if (run.log)
+            {
+                logFile.write(output.logLine().data(), static_cast<std::streamsize>(output.logLine().size()));
+                logged = true;
+            }
+        }
+        // Runs flushed by the hold timeout arrive without a packet; arm the commit here
+        if (logged && groupCommit.has_value())
+        {
+            groupCommit->written(std::chrono::steady_clock::now());
+        }
+    };
+
+    // Capture statistics (--analyze); packet times are read times since here
+    std::optional<CaptureAnalysis> analysis;
+    const auto                     analysisStart = std::chrono::steady_clock::now();
+    if (cfg.analyze.live)
+    {
+        analysis.emplace(static_cast<int64_t>(cfg.analyze.windowMs) * 1000, true);
+    }
+
+    // Echo latency needs both directions
+    std::optional<EchoCorrelator> echo;
+    if (cfg.echo.enabled)
+    {
+        if (hRx != INVALID_HANDLE_VALUE && hTx != INVALID_HANDLE_VALUE)
+        {
+            echo.emplace(cfg.echo, pipelineCounters);
+        }
+        else
+        {
+            std::cerr << "Warning: --echo needs both RX and TX ports, echo latency disabled.\n";
+        }
+    }
+
+    // Requests go out on TX, responses come back on RX
+    std::optional<TransactionTracker> txn;
+    if (cfg.txn.enabled)
+    {
+        if (hRx != INVALID_HANDLE_VALUE && hTx != INVALID_HANDLE_VALUE)
+        {
+            txn.emplace(cfg.txn, std::move(txnPattern), pipelineCounters);
+            if (!txn->open())
+            {
+                txn.reset();
+            }
+        }
+        else
+        {
+            std::cerr << "Warning: --txn needs both RX and TX ports, transaction pairing disabled.\n";
+        }
+    }
+
+    // The banner above stays on the normal screen
+    if (tui.has_value())
+    {
+        tui->start();
+    }
+
     // Main processing loop
     while (!g_stopRequested.load())
     {
-        Packet pkt;
-        if (!g_packetQueue.pop(pkt, std::chrono::milliseconds(100)))
+        metricsReporter.poll();
+
+        // Batches go to the workers when full or when the queue runs dry; with
+        // nothing left to read, wait until everything handed over is written
+        if (formatPool.has_value())
+        {
+            const bool idle = (g_packetQueue.depth() == 0);
+            if (idle || formatPool->batchFull())
+            {
+                formatPool->submit(writeBatch);
+            }
+            formatPool->drain(writeBatch, idle);
+        }
+
+        if (collapser.has_value())
+        {
+            collapser->poll(std::chrono::steady_clock::now());
+            writeRuns();
+        }
+
+        if (throttle.has_value())
+        {
+            const std::string summary = throttle->poll(std::chrono::steady_clock::now());
+            if (!summary.empty())
+            {
+                // Lines still with the workers belong before the summary
+                if (formatPool.has_value())
+                {
+                    formatPool->submit(writeBatch);
+                    formatPool->drain(writeBatch, true);
+                }
+                std::cout.write(summary.data(), static_cast<std::streamsize>(summary.size()));
+            }
+        }
+
+        auto popTimeout = std::chrono::milliseconds(100);
+        if (groupCommit.has_value())
+        {
+            const auto now = std::chrono::steady_clock::now();
+            groupCommit->poll(now);
+            popTimeout = groupCommit->timeout(now, popTimeout);
+        }
+
+        Packet popped;
+        if (!g_packetQueue.pop(popped, popTimeout))
+        {
+            if (echo.has_value())
+            {
+                echo->poll(std::chrono::steady_clock::now());
+            }
+            if (txn.has_value())
+            {
+                txn->poll(std::chrono::steady_clock::now());
+            }
+            continue;
+        }
+
+        // Sinks and formatting workers share the packet read-only with this
+        // thread; no copy per reader
+        std::shared_ptr<const Packet> shared;
+        if (!sinks.empty() || formatPool.has_value())
+        {
+            shared = std::make_shared<const Packet>(std::move(popped));
+        }
+        const Packet& pkt = shared ? *shared : popped;
+
+        const auto popTime = std::chrono::steady_clock::now();
+        pipelineCounters.enqueueToFormat.record(popTime - pkt.enqueueTime);
+
+        // Whatever this packet adds to the files is on disk within the interval
+        if (groupCommit.has_value())
+        {
+            groupCommit->written(popTime);
+        }
+
+        // Export everything, unfiltered; readers apply their own filters
+        if (!sinks.empty())
+        {
+            sinks.publish(shared);
+        }
+        if (shmRing.isOpen())
+        {
+            UART_TRACE_SCOPE("shm.publish");
+            shmRing.publish(pkt);
+        }
+        if (cfg.stream.port != 0)
+        {
+            UART_TRACE_SCOPE("stream.publish");
+            streamServer.publish(pkt);
+        }
+
+        // Line errors and port events bypass filters and raw dumps; a lossy
+        // capture must never go unnoticed
+        if (pkt.kind != PacketKind::Data)
         {
+            const std::string message = eventMessage(pkt);
+            const bool        toConsole = !tui.has_value();
+            const bool        toLog = loggingEnabled && logFile.is_open();
+
+            if (tui.has_value())
+            {
+                tui->append(pkt, message);
+            }
+            if (throttle.has_value())
+            {
+                throttle->event(pkt);
+            }
+            if (collapser.has_value())
+            {
+                collapser->close(pkt.channel);
+                writeRuns();
+            }
+
+            if (formatPool.has_value())
+            {
+                formatPool->add(shared, toConsole, toLog);
+                continue;
+            }
+            output.formatEvent(pkt, message, ansiEnabled, toConsole, toLog);
+            if (toConsole)
+            {
+                std::cout.write(output.consoleLine().data(), static_cast<std::streamsize>(output.consoleLine().size()));
+            }
+            if (toLog)
+            {
+                logFile.write(output.logLine().data(), static_cast<std::streamsize>(output.logLine().size()));
+            }
             continue;
         }
 
         // Write raw bytes if enabled
-        if (pkt.channel == Channel::RX && cfg.rxRawOutPath.has_value() && rxRawFile.is_open())
+        if (CaptureFile* raw = rawOut[static_cast<size_t>(pkt.channel)])
         {
-            rxRawFile.write(
+            raw->write(
                 reinterpret_cast<const char*>(pkt.data.data()),
                 static_cast<std::streamsize>(pkt.data.size()));
         }
-        else if (pkt.channel == Channel::TX && cfg.txRawOutPath.has_value() && txRawFile.is_open())
+
+        // Statistics cover everything received, independent of the filters
+        if (echo.has_value())
         {
-            txRawFile.write(
-                reinterpret_cast<const char*>(pkt.data.data()),
-                static_cast<std::streamsize>(pkt.data.size()));
+            UART_TRACE_SCOPE("echo.feed");
+            echo->feed(pkt);
+        }
+        if (txn.has_value())
+        {
+            UART_TRACE_SCOPE("txn.feed");
+            txn->feed(pkt);
+        }
+        if (analysis.has_value())
+        {
+            UART_TRACE_SCOPE("analyze.add");
+            analysis->add(pkt.channel,
+                          std::chrono::duration_cast<std::chrono::microseconds>(pkt.readTime - analysisStart).count(),
+                          pkt.data.data(), pkt.data.size());
         }
 
-        // Format data
-        std::string payload = formatData(pkt.data, cfg.outputFormat);
-        const char* tag     = (pkt.channel == Channel::RX) ? "[RX]" : "[TX]";
+        // Apply filters before formatting; packets nobody wants are never formatted
+        const bool showOnConsole = !consoleFilter.has_value() || consoleFilter->matches(pkt);
+        const bool writeToLog    = loggingEnabled && logFile.is_open()
+                                   && (!logFilter.has_value() || logFilter->matches(pkt));
+        if (!showOnConsole && !writeToLog)
+        {
+            continue;
+        }
 
-        // Build console line (with colors)
-        std::ostringstream consoleLine;
-        if (cfg.timestampsEnabled)
+        // The TUI keeps the raw bytes and formats only what is on screen
+        if (showOnConsole && tui.has_value())
         {
-            consoleLine << pkt.timestamp << " ";
+            UART_TRACE_SCOPE("tui.append");
+            tui->append(pkt);
+            if (!writeToLog)
+            {
+                continue;
+            }
         }
 
-        if (pkt.channel == Channel::RX && !rxTagColor.empty())
+        if (collapser.has_value())
         {
-            consoleLine << rxTagColor << tag << ansiReset << " ";
+            UART_TRACE_SCOPE("collapse");
+            if (collapser->repeat(pkt, showOnConsole && !tui.has_value(), writeToLog, pkt.readTime))
+            {
+                continue;
+            }
+            writeRuns();
         }
-        else if (pkt.channel == Channel::TX && !txTagColor.empty())
+
+        const bool toConsole = showOnConsole && !tui.has_value() && (!throttle.has_value() || throttle->admit(pkt));
+        if (!toConsole && !writeToLog)
         {
-            consoleLine << txTagColor << tag << ansiReset << " ";
+            continue;
         }
-        else
+        if (formatPool.has_value())
         {
-            consoleLine << tag << " ";
+            formatPool->add(shared, toConsole, writeToLog);
+            continue;
         }
-        consoleLine << payload;
 
-        std::cout << consoleLine.str() << "\n";
+        // Format data
+        const auto formatStart = std::chrono::steady_clock::now();
+        output.format(pkt, toConsole, writeToLog);
 
-        // Build log line (no colors)
-        if (loggingEnabled && logFile.is_open())
+        if (toConsole)
+        {
+            UART_TRACE_SCOPE("console.write");
+            const std::string& line = output.consoleLine();
+            std::cout.write(line.data(), static_cast<std::streamsize>(line.size()));
+        }
+
+        // Log line (no colors)
+        if (writeToLog)
         {
-            if (cfg.logFormat == LogFormat::Csv)
-            {
-                // CSV: Timestamp;Channel;Data
-                logFile << pkt.timestamp << ";"
-                        << (pkt.channel == Channel::RX ? "RX" : "TX") << ";"
-                        << payload << "\n";
-            }
-            else
             {
-                // Text format
-                if (cfg.timestampsEnabled)
-                {
-                    logFile << pkt.timestamp << " ";
-                }
-                logFile << tag << " " << payload << "\n";
+                UART_TRACE_SCOPE("log.write");
+                const std::string& line = output.logLine();
+                logFile.write(line.data(), static_cast<std::streamsize>(line.size()));
             }
 
             // Periodic flush
             auto now = std::chrono::steady_clock::now();
+            pipelineCounters.formatToDisk.record(now - formatStart);
+
             auto dt  = std::chrono::duration_cast<std::chrono::milliseconds>(
                           now - lastFlush).count();
 
-            if (dt >= static_cast<long long>(cfg.flushTimeoutMs))
+            if (!groupCommit.has_value() && dt >= static_cast<long long>(cfg.flushTimeoutMs))
             {
+                UART_TRACE_SCOPE("log.flush");
                 logFile.flush();
                 lastFlush = now;
             }
         }
     }
 
+    // Open runs, then whatever is still with the formatting workers
+    if (collapser.has_value())
+    {
+        collapser->poll(std::chrono::steady_clock::now(), true);
+        writeRuns();
+    }
+    if (formatPool.has_value())
+    {
+        formatPool->submit(writeBatch);
+        formatPool->drain(writeBatch, true);
+    }
+
+    if (tui.has_value())
+    {
+        tui->stop();
+    }
     std::cout << "\n\n[INFO] Shutting down...\n" << std::flush;
 
     // Signal stop to all threads
@@ -397,6 +993,149 @@ int main(int argc, char* argv[])
     if (kbThread.joinable()) kbThread.join();
     std::cout << " done\n" << std::flush;
 
+    metricsServer.stop();
+    shmRing.close();
+    if (!sinks.empty())
+    {
+        sinks.stop();
+        sinks.writeSummary(std::cout);
+    }
+    if (collapser.has_value())
+    {
+        std::cout << "[INFO] Collapse: " << collapser->framesCollapsed() << " repeated frame(s) written as "
+                  << collapser->runsWritten() << " line(s)\n";
+    }
+    if (cfg.stream.port != 0)
+    {
+        streamServer.stop();
+        std::cout << "[INFO] Stream: " << streamServer.subscribersServed() << " subscriber(s), "
+                  << streamServer.messagesDropped() << " message(s) dropped for slow subscribers\n";
+    }
+
+    // Echo bytes still waiting for their source will not get one now
+    if (echo.has_value())
+    {
+        echo->poll(std::chrono::steady_clock::now(), true);
+    }
+    if (txn.has_value())
+    {
+        txn->poll(std::chrono::steady_clock::now(), true);
+        txn->writeReport(std::cout);
+    }
+
+    // Line error summary: tells whether this capture can be trusted
+    {
+        MetricsSnapshot finalStats;
+        g_metrics.snapshot(finalStats, g_packetQueue);
+
+        if (echo.has_value())
+        {
+            const char*                       direction = (cfg.echo.source == Channel::TX) ? "TX->RX" : "RX->TX";
+            const LatencyHistogram::Snapshot& h = finalStats.echoLatency;
+            if (finalStats.echoMatched == 0)
+            {
+                std::cerr << "Warning: Echo " << direction << ": no echoed bytes found ("
+                          << finalStats.echoInserted << " bytes without a source)\n";
+            }
+            else
+            {
+                std::cout << "[INFO] Echo " << direction << ": " << finalStats.echoMatched
+                          << " bytes matched, latency p50 " << formatDurationNs(h.percentile(0.5))
+                          << " p90 " << formatDurationNs(h.percentile(0.9))
+                          << " p99 " << formatDurationNs(h.percentile(0.99))
+                          << " max " << formatDurationNs(h.maxNs) << "\n"
+                          << "[INFO] Echo " << direction << ": " << finalStats.echoDropped
+                          << " bytes without echo, " << finalStats.echoInserted << " unexpected, "
+                          << finalStats.echoResyncs << " resync(s)\n";
+            }
+        }
+
+        const HANDLE handles[2] = { hRx, hTx };
+        for (size_t ch = 0; ch < 2; ++ch)
+        {
+            if (handles[ch] == INVALID_HANDLE_VALUE)
+            {
+                continue;
+            }
+
+            const auto& stats = finalStats.channels[ch];
+            const char* name = channelName(static_cast<Channel>(ch));
+            if (stats.disconnects > 0)
+            {
+                std::cerr << "Warning: " << name << " port was disconnected " << stats.disconnects
+                          << " time(s) - data sent while it was away is missing\n";
+                if (loggingEnabled && logFile.is_open() && cfg.logFormat == LogFormat::Text)
+                {
+                    logFile << "# " << name << " disconnects: " << stats.disconnects << "\n";
+                }
+            }
+            if (stats.lineErrorTotal() == 0)
+            {
+                std::cout << "[INFO] " << name << " line errors: none (driver queue peak "
+                          << stats.driverQueueHighWater << " bytes)\n";
+                continue;
+            }
+
+            std::ostringstream summary;
+            for (size_t i = 0; i < line_error::kTypes; ++i)
+            {
+                if (stats.lineErrors[i] > 0)
+                {
+                    summary << " " << lineErrorName(i) << "=" << stats.lineErrors[i];
+                }
+            }
+            std::cerr << "Warning: " << name << " line errors:" << summary.str()
+                      << " - capture is lossy\n";
+            if (loggingEnabled && logFile.is_open() && cfg.logFormat == LogFormat::Text)
+            {
+                logFile << "# " << name << " line errors:" << summary.str() << "\n";
+            }
+        }
+    }
+
+    if (analysis.has_value())
+    {
+        std::string source;
+        if (hRx != INVALID_HANDLE_VALUE)
+        {
+            source = "RX " + cfg.rxPort;
+        }
+        if (hTx != INVALID_HANDLE_VALUE)
+        {
+            source += (source.empty() ? "" : ", ") + std::string("TX ") + cfg.txPort;
+        }
+        analysis->finish();
+        analysis->writeReport(std::cout, source);
+        if (cfg.analyze.csvPath.has_value() && analysis->writeCsv(*cfg.analyze.csvPath))
+        {
+            std::cout << "[INFO] Analysis windows written to " << *cfg.analyze.csvPath << "\n";
+        }
+        if (cfg.analyze.jsonPath.has_value() && analysis->writeJson(*cfg.analyze.jsonPath, source))
+        {
+            std::cout << "[INFO] Analysis written to " << *cfg.analyze.jsonPath << "\n";
+        }
+    }
+
+    if (trace::isEnabled())
+    {
+        if (trace::dump())
+        {
+            std::cout << "[INFO] Trace written to " << trace::outputPath() << "\n";
+        }
+        else
+        {
+            std::cerr << "Warning: Failed to write trace file: " << trace::outputPath() << "\n";
+        }
+    }
+
+    // Final frame marks the clean end; recovery leaves such logs alone
+    if (groupCommit.has_value())
+    {
+        groupCommit->commit(true);
+        std::cout << "[INFO] Durable log: " << groupCommit->commits() << " commits, slowest "
+                  << std::llround(groupCommit->maxCommitMs()) << " ms\n";
+    }
+
     // Close files
     if (rxRawFile.is_open()) rxRawFile.close();
     if (txRawFile.is_open()) txRawFile.close();
@@ -407,10 +1146,6 @@ int main(int argc, char* argv[])
         logFile.close();
     }
 
-    // Close serial ports
-    if (hRx != INVALID_HANDLE_VALUE) CloseHandle(hRx);
-    if (hTx != INVALID_HANDLE_VALUE) CloseHandle(hTx);
-
     // Close stop event
     if (g_hStopEvent != NULL)
     {
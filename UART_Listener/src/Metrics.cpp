@@ -0,0 +1,526 @@
+/**
+ ****************************************************************************************
+ * @file   Metrics.cpp
+ * @brief  Metrics snapshots, histogram math and report formatting.
+ *
+ * @author Patrik Neunteufel
+ * @date   Oct 2026
+ ****************************************************************************************
+ */
+
+#include "Metrics.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+
+namespace uart_listener
+{
+    // ============================================================================
+    // LatencyHistogram
+    // ============================================================================
+
+    size_t LatencyHistogram::bucketIndex(uint64_t value) noexcept
+    {
+        if (value < kSubCount)
+        {
+            return static_cast<size_t>(value);
+        }
+
+        const uint32_t exponent = static_cast<uint32_t>(std::bit_width(value)) - 1;
+        if (exponent > kMaxExponent)
+        {
+            return kBucketCount - 1;
+        }
+
+        const uint32_t shift = exponent - kSubBits;
+        const uint64_t sub = (value >> shift) - kSubCount;
+        return static_cast<size_t>((exponent - kSubBits + 1) * kSubCount + sub);
+    }
+
+    uint64_t LatencyHistogram::bucketUpperBound(size_t index) noexcept
+    {
+        if (index < kSubCount)
+        {
+            return index;
+        }
+
+        const uint64_t group = index / kSubCount;
+        const uint64_t sub = index % kSubCount;
+        const uint64_t shift = group - 1;
+        const uint64_t lower = (kSubCount + sub) << shift;
+        return lower + (uint64_t{ 1 } << shift) - 1;
+    }
+
+    void LatencyHistogram::snapshot(Snapshot& out) const
+    {
+        out.total = 0;
+        for (size_t i = 0; i < kBucketCount; ++i)
+        {
+            out.counts[i] = m_counts[i].load(std::memory_order_relaxed);
+            out.total += out.counts[i];
+        }
+        out.maxNs = m_max.load(std::memory_order_relaxed);
+    }
+
+    uint64_t LatencyHistogram::Snapshot::percentile(double q) const
+    {
+        if (total == 0)
+        {
+            return 0;
+        }
+
+        const double   clamped = std::clamp(q, 0.0, 1.0);
+        const uint64_t rank = std::max<uint64_t>(1, static_cast<uint64_t>(clamped * static_cast<double>(total) + 0.5));
+
+        uint64_t seen = 0;
+        for (size_t i = 0; i < kBucketCount; ++i)
+        {
+            seen += counts[i];
+            if (seen >= rank)
+            {
+                return std::min(bucketUpperBound(i), maxNs);
+            }
+        }
+        return maxNs;
+    }
+
+    // ============================================================================
+    // Counters
+    // ============================================================================
+
+    void ChannelCounters::recordChunk(size_t size) noexcept
+    {
+        bumpCounter(bytes, size);
+        bumpCounter(packets, 1);
+
+        size_t bucket = size > 0 ? static_cast<size_t>(std::bit_width(size)) - 1 : 0;
+        if (bucket >= kChunkBuckets)
+        {
+            bucket = kChunkBuckets - 1;
+        }
+        bumpCounter(chunkSizes[bucket], 1);
+    }
+
+    void ChannelCounters::recordLineStatus(const LineStatus& status) noexcept
+    {
+        for (size_t i = 0; i < line_error::kTypes; ++i)
+        {
+            if (status.errors & (1u << i))
+            {
+                bumpCounter(lineErrors[i], 1);
+            }
+        }
+        if (status.queuedBytes > driverQueueHighWater.load(std::memory_order_relaxed))
+        {
+            driverQueueHighWater.store(status.queuedBytes, std::memory_order_relaxed);
+        }
+    }
+
+    void ChannelCounters::recordDisconnect() noexcept
+    {
+        bumpCounter(disconnects, 1);
+        connected.store(false, std::memory_order_relaxed);
+    }
+
+    void ChannelCounters::recordReconnect() noexcept
+    {
+        connected.store(true, std::memory_order_relaxed);
+    }
+
+    void Metrics::snapshot(MetricsSnapshot& out, const PacketQueue& queue) const
+    {
+        out.time = std::chrono::steady_clock::now();
+
+        for (size_t ch = 0; ch < m_channels.size(); ++ch)
+        {
+            const ChannelCounters& src = m_channels[ch];
+            auto&                  dst = out.channels[ch];
+
+            dst.bytes = src.bytes.load(std::memory_order_relaxed);
+            dst.packets = src.packets.load(std::memory_order_relaxed);
+            for (size_t i = 0; i < ChannelCounters::kChunkBuckets; ++i)
+            {
+                dst.chunkSizes[i] = src.chunkSizes[i].load(std::memory_order_relaxed);
+            }
+            src.readToEnqueue.snapshot(dst.readToEnqueue);
+            for (size_t i = 0; i < line_error::kTypes; ++i)
+            {
+                dst.lineErrors[i] = src.lineErrors[i].load(std::memory_order_relaxed);
+            }
+            dst.driverQueueHighWater = src.driverQueueHighWater.load(std::memory_order_relaxed);
+            dst.disconnects = src.disconnects.load(std::memory_order_relaxed);
+            dst.connected = src.connected.load(std::memory_order_relaxed);
+        }
+
+        out.queueDepth = queue.depth();
+        out.queueHighWater = queue.highWater();
+        m_pipeline.enqueueToFormat.snapshot(out.enqueueToFormat);
+        m_pipeline.formatToDisk.snapshot(out.formatToDisk);
+        m_pipeline.echoLatency.snapshot(out.echoLatency);
+        out.echoMatched = m_pipeline.echoMatched.load(std::memory_order_relaxed);
+        out.echoDropped = m_pipeline.echoDropped.load(std::memory_order_relaxed);
+        out.echoInserted = m_pipeline.echoInserted.load(std::memory_order_relaxed);
+        out.echoResyncs = m_pipeline.echoResyncs.load(std::memory_order_relaxed);
+        m_pipeline.txnLatency.snapshot(out.txnLatency);
+        out.txnCompleted = m_pipeline.txnCompleted.load(std::memory_order_relaxed);
+        out.txnTimeouts = m_pipeline.txnTimeouts.load(std::memory_order_relaxed);
+        out.txnUnsolicited = m_pipeline.txnUnsolicited.load(std::memory_order_relaxed);
+    }
+
+    // ============================================================================
+    // Reports
+    // ============================================================================
+
+    MetricsReport makeReport(const MetricsSnapshot& prev, const MetricsSnapshot& cur,
+                             uint32_t baudRate, uint32_t bitsPerChar)
+    {
+        MetricsReport report;
+        report.current = &cur;
+        report.seconds = std::chrono::duration<double>(cur.time - prev.time).count();
+
+        if (report.seconds <= 0.0)
+        {
+            return report;
+        }
+
+        const double charsPerSec = (baudRate > 0 && bitsPerChar > 0)
+                                       ? static_cast<double>(baudRate) / bitsPerChar
+                                       : 0.0;
+
+        for (size_t ch = 0; ch < 2; ++ch)
+        {
+            const double bytes = static_cast<double>(cur.channels[ch].bytes - prev.channels[ch].bytes);
+            const double packets = static_cast<double>(cur.channels[ch].packets - prev.channels[ch].packets);
+
+            report.bytesPerSec[ch] = bytes / report.seconds;
+            report.packetsPerSec[ch] = packets / report.seconds;
+            report.busUtilisation[ch] = (charsPerSec > 0.0) ? report.bytesPerSec[ch] / charsPerSec : 0.0;
+        }
+        return report;
+    }
+
+    std::string formatDurationNs(uint64_t ns)
+    {
+        std::ostringstream oss;
+        oss << std::fixed << std::setprecision(0);
+        if (ns < 10'000)
+        {
+            oss << ns << "ns";
+        }
+        else if (ns < 10'000'000)
+        {
+            oss << static_cast<double>(ns) / 1e3 << "us";
+        }
+        else
+        {
+            oss << static_cast<double>(ns) / 1e6 << "ms";
+        }
+        return oss.str();
+    }
+
+    std::string formatRate(double bytesPerSec)
+    {
+        std::ostringstream oss;
+        oss << std::fixed << std::setprecision(1);
+        if (bytesPerSec >= 1024.0 * 1024.0)
+        {
+            oss << bytesPerSec / (1024.0 * 1024.0) << " MB/s";
+        }
+        else if (bytesPerSec >= 1024.0)
+        {
+            oss << bytesPerSec / 1024.0 << " KB/s";
+        }
+        else
+        {
+            oss << bytesPerSec << " B/s";
+        }
+        return oss.str();
+    }
+
+    namespace
+    {
+        void writeQuantiles(std::ostringstream& oss, const char* labels, const LatencyHistogram::Snapshot& h)
+        {
+            static constexpr double kQuantiles[] = { 0.5, 0.9, 0.99, 0.999 };
+            for (double q : kQuantiles)
+            {
+                oss << "uart_latency_seconds{" << labels << ",quantile=\"" << q << "\"} "
+                    << static_cast<double>(h.percentile(q)) / 1e9 << "\n";
+            }
+            oss << "uart_latency_seconds{" << labels << ",quantile=\"1\"} "
+                << static_cast<double>(h.maxNs) / 1e9 << "\n";
+            oss << "uart_latency_seconds_count{" << labels << "} " << h.total << "\n";
+        }
+    }
+
+    std::string formatStatusLine(const MetricsReport& report, bool rxActive, bool txActive)
+    {
+        const MetricsSnapshot& cur = *report.current;
+
+        std::ostringstream oss;
+        oss << "[STAT]";
+
+        const bool active[2] = { rxActive, txActive };
+        const char* names[2] = { "RX", "TX" };
+        for (size_t ch = 0; ch < 2; ++ch)
+        {
+            if (!active[ch])
+            {
+                continue;
+            }
+            oss << " " << names[ch] << " " << formatRate(report.bytesPerSec[ch])
+                << " " << std::fixed << std::setprecision(0) << report.packetsPerSec[ch] << " pkt/s"
+                << " bus " << std::setprecision(1) << report.busUtilisation[ch] * 100.0 << "%";
+
+            // Any line error makes the capture lossy; show it until the end of the run
+            const auto& stats = cur.channels[ch];
+            if (!stats.connected)
+            {
+                oss << " DISCONNECTED";
+            }
+            else if (stats.disconnects > 0)
+            {
+                oss << " reconnects=" << stats.disconnects;
+            }
+            if (stats.lineErrorTotal() > 0)
+            {
+                oss << " ERR";
+                for (size_t i = 0; i < line_error::kTypes; ++i)
+                {
+                    if (stats.lineErrors[i] > 0)
+                    {
+                        oss << " " << lineErrorName(i) << "=" << stats.lineErrors[i];
+                    }
+                }
+            }
+            oss << " |";
+        }
+
+        oss << " queue " << cur.queueDepth << " (hw " << cur.queueHighWater << ")"
+            << " | p99 read>enq " << formatDurationNs(std::max(cur.channels[0].readToEnqueue.percentile(0.99),
+                                                               cur.channels[1].readToEnqueue.percentile(0.99)))
+            << " enq>fmt " << formatDurationNs(cur.enqueueToFormat.percentile(0.99))
+            << " fmt>disk " << formatDurationNs(cur.formatToDisk.percentile(0.99));
+        if (cur.echoLatency.total > 0)
+        {
+            oss << " | echo p50 " << formatDurationNs(cur.echoLatency.percentile(0.5))
+                << " p99 " << formatDurationNs(cur.echoLatency.percentile(0.99));
+        }
+        if (cur.txnCompleted + cur.txnTimeouts > 0)
+        {
+            oss << " | txn p50 " << formatDurationNs(cur.txnLatency.percentile(0.5))
+                << " p99 " << formatDurationNs(cur.txnLatency.percentile(0.99))
+                << " timeouts " << cur.txnTimeouts;
+        }
+        return oss.str();
+    }
+
+    std::string formatPrometheus(const MetricsReport& report, uint32_t baudRate)
+    {
+        const MetricsSnapshot& cur = *report.current;
+        const char*            names[2] = { "rx", "tx" };
+
+        std::ostringstream oss;
+
+        oss << "# HELP uart_bytes_total Bytes captured per channel.\n"
+            << "# TYPE uart_bytes_total counter\n";
+        for (size_t ch = 0; ch < 2; ++ch)
+        {
+            oss << "uart_bytes_total{channel=\"" << names[ch] << "\"} " << cur.channels[ch].bytes << "\n";
+        }
+
+        oss << "# HELP uart_packets_total Driver reads (packets) per channel.\n"
+            << "# TYPE uart_packets_total counter\n";
+        for (size_t ch = 0; ch < 2; ++ch)
+        {
+            oss << "uart_packets_total{channel=\"" << names[ch] << "\"} " << cur.channels[ch].packets << "\n";
+        }
+
+        oss << "# HELP uart_chunk_size_bytes Bytes returned per driver read.\n"
+            << "# TYPE uart_chunk_size_bytes histogram\n";
+        for (size_t ch = 0; ch < 2; ++ch)
+        {
+            uint64_t cumulative = 0;
+            for (size_t i = 0; i < ChannelCounters::kChunkBuckets - 1; ++i)
+            {
+                cumulative += cur.channels[ch].chunkSizes[i];
+                oss << "uart_chunk_size_bytes_bucket{channel=\"" << names[ch] << "\",le=\""
+                    << ((uint64_t{ 2 } << i) - 1) << "\"} " << cumulative << "\n";
+            }
+            cumulative += cur.channels[ch].chunkSizes[ChannelCounters::kChunkBuckets - 1];
+            oss << "uart_chunk_size_bytes_bucket{channel=\"" << names[ch] << "\",le=\"+Inf\"} " << cumulative << "\n"
+                << "uart_chunk_size_bytes_sum{channel=\"" << names[ch] << "\"} " << cur.channels[ch].bytes << "\n"
+                << "uart_chunk_size_bytes_count{channel=\"" << names[ch] << "\"} " << cur.channels[ch].packets << "\n";
+        }
+
+        oss << "# HELP uart_bus_utilisation_ratio Wire utilisation relative to the baud rate.\n"
+            << "# TYPE uart_bus_utilisation_ratio gauge\n";
+        for (size_t ch = 0; ch < 2; ++ch)
+        {
+            oss << "uart_bus_utilisation_ratio{channel=\"" << names[ch] << "\"} " << report.busUtilisation[ch] << "\n";
+        }
+
+        oss << "# HELP uart_line_errors_total Driver line error events (ClearCommError polls reporting the error).\n"
+            << "# TYPE uart_line_errors_total counter\n";
+        for (size_t ch = 0; ch < 2; ++ch)
+        {
+            for (size_t i = 0; i < line_error::kTypes; ++i)
+            {
+                oss << "uart_line_errors_total{channel=\"" << names[ch] << "\",type=\"" << lineErrorName(i) << "\"} "
+                    << cur.channels[ch].lineErrors[i] << "\n";
+            }
+        }
+
+        oss << "# HELP uart_driver_queue_high_water_bytes Maximum bytes seen waiting in the driver input queue.\n"
+            << "# TYPE uart_driver_queue_high_water_bytes gauge\n";
+        for (size_t ch = 0; ch < 2; ++ch)
+        {
+            oss << "uart_driver_queue_high_water_bytes{channel=\"" << names[ch] << "\"} "
+                << cur.channels[ch].driverQueueHighWater << "\n";
+        }
+
+        oss << "# HELP uart_disconnects_total Times the port vanished (adapter unplugged).\n"
+            << "# TYPE uart_disconnects_total counter\n";
+        for (size_t ch = 0; ch < 2; ++ch)
+        {
+            oss << "uart_disconnects_total{channel=\"" << names[ch] << "\"} " << cur.channels[ch].disconnects << "\n";
+        }
+
+        oss << "# HELP uart_port_connected 1 while the port is open, 0 while reconnecting.\n"
+            << "# TYPE uart_port_connected gauge\n";
+        for (size_t ch = 0; ch < 2; ++ch)
+        {
+            oss << "uart_port_connected{channel=\"" << names[ch] << "\"} " << (cur.channels[ch].connected ? 1 : 0) << "\n";
+        }
+
+        oss << "# HELP uart_baud_rate Configured baud rate.\n"
+            << "# TYPE uart_baud_rate gauge\n"
+            << "uart_baud_rate " << baudRate << "\n"
+            << "# HELP uart_queue_depth Packets waiting in the packet queue.\n"
+            << "# TYPE uart_queue_depth gauge\n"
+            << "uart_queue_depth " << cur.queueDepth << "\n"
+            << "# HELP uart_queue_high_water Maximum packet queue depth since start.\n"
+            << "# TYPE uart_queue_high_water gauge\n"
+            << "uart_queue_high_water " << cur.queueHighWater << "\n";
+
+        oss << "# HELP uart_latency_seconds Pipeline stage latency.\n"
+            << "# TYPE uart_latency_seconds summary\n";
+        for (size_t ch = 0; ch < 2; ++ch)
+        {
+            const std::string labels = std::string("stage=\"read_to_enqueue\",channel=\"") + names[ch] + "\"";
+            writeQuantiles(oss, labels.c_str(), cur.channels[ch].readToEnqueue);
+        }
+        writeQuantiles(oss, "stage=\"enqueue_to_format\"", cur.enqueueToFormat);
+        writeQuantiles(oss, "stage=\"format_to_disk\"", cur.formatToDisk);
+
+        // Echo correlation only when --echo has seen traffic
+        if (cur.echoMatched + cur.echoDropped + cur.echoInserted > 0)
+        {
+            writeQuantiles(oss, "stage=\"echo\"", cur.echoLatency);
+            oss << "# HELP uart_echo_bytes_total Echo correlation byte accounting.\n"
+                << "# TYPE uart_echo_bytes_total counter\n"
+                << "uart_echo_bytes_total{result=\"matched\"} " << cur.echoMatched << "\n"
+                << "uart_echo_bytes_total{result=\"dropped\"} " << cur.echoDropped << "\n"
+                << "uart_echo_bytes_total{result=\"inserted\"} " << cur.echoInserted << "\n"
+                << "# HELP uart_echo_resyncs_total Echo mismatches after which the stream was realigned.\n"
+                << "# TYPE uart_echo_resyncs_total counter\n"
+                << "uart_echo_resyncs_total " << cur.echoResyncs << "\n";
+        }
+
+        // Transactions only when --txn has seen traffic
+        if (cur.txnCompleted + cur.txnTimeouts + cur.txnUnsolicited > 0)
+        {
+            writeQuantiles(oss, "stage=\"transaction\"", cur.txnLatency);
+            oss << "# HELP uart_transactions_total Request/response pairing results.\n"
+                << "# TYPE uart_transactions_total counter\n"
+                << "uart_transactions_total{result=\"completed\"} " << cur.txnCompleted << "\n"
+                << "uart_transactions_total{result=\"timeout\"} " << cur.txnTimeouts << "\n"
+                << "uart_transactions_total{result=\"unsolicited\"} " << cur.txnUnsolicited << "\n";
+        }
+
+        return oss.str();
+    }
+
+    bool writeFileAtomic(const std::string& path, const std::string& content)
+    {
+        const std::string tmpPath = path + ".tmp";
+        {
+            std::ofstream out(tmpPath, std::ios::binary | std::ios::trunc);
+            if (!out.is_open())
+            {
+                return false;
+            }
+            out.write(content.data(), static_cast<std::streamsize>(content.size()));
+            if (!out.good())
+            {
+                return false;
+            }
+        }
+
+        std::error_code ec;
+        std::filesystem::rename(tmpPath, path, ec);
+        return !ec;
+    }
+
+    // ============================================================================
+    // MetricsReporter
+    // ============================================================================
+
+    MetricsReporter::MetricsReporter(const Metrics& metrics, const PacketQueue& queue,
+                                     MetricsReporterOptions options, MetricsPublication& publication)
+        : m_metrics(metrics),
+          m_queue(queue),
+          m_options(std::move(options)),
+          m_publication(publication),
+          m_prev(std::make_unique<MetricsSnapshot>()),
+          m_cur(std::make_unique<MetricsSnapshot>())
+    {
+        m_enabled = m_options.statusIntervalMs > 0 || m_options.filePath.has_value() || m_options.publish;
+        m_interval = std::chrono::milliseconds(m_options.statusIntervalMs > 0 ? m_options.statusIntervalMs : 1000);
+        m_metrics.snapshot(*m_prev, m_queue);
+    }
+
+    void MetricsReporter::poll()
+    {
+        if (!m_enabled || std::chrono::steady_clock::now() - m_prev->time < m_interval)
+        {
+            return;
+        }
+
+        m_metrics.snapshot(*m_cur, m_queue);
+        const MetricsReport report = makeReport(*m_prev, *m_cur, m_options.baudRate, m_options.bitsPerChar);
+
+        if (m_options.statusIntervalMs > 0)
+        {
+            const std::string line = formatStatusLine(report, m_options.rxActive, m_options.txActive);
+            if (m_options.statusSink)
+            {
+                m_options.statusSink(line);
+            }
+            else
+            {
+                std::cout << line << "\n";
+            }
+        }
+
+        if (m_options.filePath.has_value() || m_options.publish)
+        {
+            std::string text = formatPrometheus(report, m_options.baudRate);
+            if (m_options.filePath.has_value() && !writeFileAtomic(*m_options.filePath, text))
+            {
+                std::cerr << "Warning: Failed to write metrics file: " << *m_options.filePath << "\n";
+            }
+            if (m_options.publish)
+            {
+                m_publication.publish(std::move(text));
+            }
+        }
+
+        std::swap(m_prev, m_cur);
+    }
+}
@@ -0,0 +1,304 @@
+/**
+ ****************************************************************************************
+ * @file   Metrics.hpp
+ * @brief  Live capture metrics: per-channel counters, queue depth and latency histograms.
+ *
+ *         Every counter block has exactly one writer thread (the RX reader, the TX
+ *         reader or the consumer) and is cache-line aligned, so the hot path only does
+ *         relaxed load/store pairs on memory no other writer touches. Reporting threads
+ *         read the same atomics and may see slightly torn totals across fields, which
+ *         is fine for monitoring.
+ *
+ * @author Patrik Neunteufel
+ * @date   Oct 2026
+ ****************************************************************************************
+ */
+#pragma once
+
+#include "UART.hpp"
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+
+namespace uart_listener
+{
+    constexpr size_t kCacheLineSize = 64;
+
+    /**
+     * @brief Add to a single-writer counter without a locked instruction.
+     */
+    inline void bumpCounter(std::atomic<uint64_t>& counter, uint64_t delta) noexcept
+    {
+        counter.store(counter.load(std::memory_order_relaxed) + delta, std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Log-linear (HDR style) latency histogram in nanoseconds.
+     *
+     * Values below 2^kSubBits are recorded exactly; above that each power of two is
+     * split into 2^kSubBits sub-buckets, giving ~3% relative precision from
+     * nanoseconds up to several hours with a fixed 10 KB footprint.
+     */
+    class LatencyHistogram
+    {
+    public:
+        static constexpr uint32_t kSubBits = 5;
+        static constexpr uint32_t kSubCount = 1u << kSubBits;
+        static constexpr uint32_t kMaxExponent = 43;
+        static constexpr size_t   kBucketCount = (kMaxExponent - kSubBits + 2) * kSubCount;
+
+        struct Snapshot
+        {
+            std::array<uint64_t, kBucketCount> counts{};
+            uint64_t                           total = 0;
+            uint64_t                           maxNs = 0;
+
+            /**
+             * @brief Value at the given quantile (0..1), upper bound of its bucket.
+             */
+            uint64_t percentile(double q) const;
+        };
+
+        void record(uint64_t ns) noexcept
+        {
+            bumpCounter(m_counts[bucketIndex(ns)], 1);
+            bumpCounter(m_total, 1);
+            if (ns > m_max.load(std::memory_order_relaxed))
+            {
+                m_max.store(ns, std::memory_order_relaxed);
+            }
+        }
+
+        void record(std::chrono::steady_clock::duration d) noexcept
+        {
+            const auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(d).count();
+            record(ns > 0 ? static_cast<uint64_t>(ns) : 0);
+        }
+
+        void snapshot(Snapshot& out) const;
+
+        static size_t   bucketIndex(uint64_t value) noexcept;
+        static uint64_t bucketUpperBound(size_t index) noexcept;
+
+    private:
+        std::array<std::atomic<uint64_t>, kBucketCount> m_counts{};
+        std::atomic<uint64_t>                           m_total{ 0 };
+        std::atomic<uint64_t>                           m_max{ 0 };
+    };
+
+    /**
+     * @brief Counters owned by one serial reader thread.
+     */
+    struct alignas(kCacheLineSize) ChannelCounters
+    {
+        /// Chunk size buckets: [0]=1, [1]=2-3, [2]=4-7 ... [16]=65536+
+        static constexpr size_t kChunkBuckets = 17;
+
+        std::atomic<uint64_t>                           bytes{ 0 };
+        std::atomic<uint64_t>                           packets{ 0 };
+        std::array<std::atomic<uint64_t>, kChunkBuckets> chunkSizes{};
+        LatencyHistogram                                readToEnqueue;
+
+        /// Error events per line_error type (one per poll that reported the flag)
+        std::array<std::atomic<uint64_t>, line_error::kTypes> lineErrors{};
+        std::atomic<uint64_t>                           driverQueueHighWater{ 0 };
+
+        /// Port lost (adapter unplugged) and currently reconnecting
+        std::atomic<uint64_t>                           disconnects{ 0 };
+        std::atomic<bool>                               connected{ true };
+
+        void recordChunk(size_t size) noexcept;
+        void recordLineStatus(const LineStatus& status) noexcept;
+        void recordDisconnect() noexcept;
+        void recordReconnect() noexcept;
+    };
+
+    /**
+     * @brief Counters owned by the consumer (main) thread.
+     */
+    struct alignas(kCacheLineSize) PipelineCounters
+    {
+        LatencyHistogram enqueueToFormat;
+        LatencyHistogram formatToDisk;
+
+        // --echo: source byte read to echo byte read, and the byte accounting
+        LatencyHistogram      echoLatency;
+        std::atomic<uint64_t> echoMatched{ 0 };
+        std::atomic<uint64_t> echoDropped{ 0 };    // source bytes that never came back
+        std::atomic<uint64_t> echoInserted{ 0 };   // echo bytes without a source byte
+        std::atomic<uint64_t> echoResyncs{ 0 };    // mismatches while in step
+
+        // --txn: end of request to start of response, all command types
+        LatencyHistogram      txnLatency;
+        std::atomic<uint64_t> txnCompleted{ 0 };
+        std::atomic<uint64_t> txnTimeouts{ 0 };
+        std::atomic<uint64_t> txnUnsolicited{ 0 };   // responses without an open request
+    };
+
+    /**
+     * @brief Point-in-time copy of all metrics, taken by a reporting thread.
+     */
+    struct MetricsSnapshot
+    {
+        struct ChannelStats
+        {
+            uint64_t                                         bytes = 0;
+            uint64_t                                         packets = 0;
+            std::array<uint64_t, ChannelCounters::kChunkBuckets> chunkSizes{};
+            LatencyHistogram::Snapshot                       readToEnqueue;
+            std::array<uint64_t, line_error::kTypes>         lineErrors{};
+            uint64_t                                         driverQueueHighWater = 0;
+            uint64_t                                         disconnects = 0;
+            bool                                             connected = true;
+
+            uint64_t lineErrorTotal() const noexcept
+            {
+                uint64_t total = 0;
+                for (uint64_t n : lineErrors)
+                {
+                    total += n;
+                }
+                return total;
+            }
+        };
+
+        std::chrono::steady_clock::time_point time{};
+        std::array<ChannelStats, 2>           channels{};
+        size_t                                queueDepth = 0;
+        size_t                                queueHighWater = 0;
+        LatencyHistogram::Snapshot            enqueueToFormat;
+        LatencyHistogram::Snapshot            formatToDisk;
+        LatencyHistogram::Snapshot            echoLatency;
+        uint64_t                              echoMatched = 0;
+        uint64_t                              echoDropped = 0;
+        uint64_t                              echoInserted = 0;
+        uint64_t                              echoResyncs = 0;
+        LatencyHistogram::Snapshot            txnLatency;
+        uint64_t                              txnCompleted = 0;
+        uint64_t                              txnTimeouts = 0;
+        uint64_t                              txnUnsolicited = 0;
+    };
+
+    class Metrics
+    {
+    public:
+        ChannelCounters& channel(Channel ch) noexcept
+        {
+            return m_channels[static_cast<size_t>(ch)];
+        }
+
+        PipelineCounters& pipeline() noexcept { return m_pipeline; }
+
+        void snapshot(MetricsSnapshot& out, const PacketQueue& queue) const;
+
+    private:
+        std::array<ChannelCounters, 2> m_channels;
+        PipelineCounters               m_pipeline;
+    };
+
+    /**
+     * @brief Derived rates between two snapshots plus the latest absolute values.
+     */
+    struct MetricsReport
+    {
+        const MetricsSnapshot* current = nullptr;
+        double                 seconds = 0.0;
+        std::array<double, 2>  bytesPerSec{};
+        std::array<double, 2>  packetsPerSec{};
+        std::array<double, 2>  busUtilisation{};  // 0..1 relative to baud rate
+    };
+
+    /**
+     * @brief Compute rates and bus utilisation between two snapshots.
+     * @param bitsPerChar Bits on the wire per byte (start + data + parity + stop)
+     */
+    MetricsReport makeReport(const MetricsSnapshot& prev, const MetricsSnapshot& cur,
+                             uint32_t baudRate, uint32_t bitsPerChar);
+
+    /** @brief Compact duration: ns below 10 us, us below 10 ms, else ms. */
+    std::string formatDurationNs(uint64_t ns);
+
+    /** @brief Byte rate with one decimal: B/s, KB/s or MB/s. */
+    std::string formatRate(double bytesPerSec);
+
+    /** @brief One-line console status summary. */
+    std::string formatStatusLine(const MetricsReport& report, bool rxActive, bool txActive);
+
+    /** @brief Prometheus text exposition format (version 0.0.4). */
+    std::string formatPrometheus(const MetricsReport& report, uint32_t baudRate);
+
+    /**
+     * @brief Replace a file atomically (write temp file, then rename).
+     * @return true on success
+     */
+    bool writeFileAtomic(const std::string& path, const std::string& content);
+
+    /**
+     * @brief Latest rendered Prometheus text, shared with the HTTP endpoint.
+     */
+    class MetricsPublication
+    {
+    public:
+        void publish(std::string text)
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_text = std::move(text);
+        }
+
+        std::string get() const
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            return m_text;
+        }
+
+    private:
+        mutable std::mutex m_mutex;
+        std::string        m_text;
+    };
+
+    struct MetricsReporterOptions
+    {
+        uint32_t                   baudRate = 115200;
+        uint32_t                   bitsPerChar = 10;
+        uint32_t                   statusIntervalMs = 0;  // 0 = no status line
+        std::optional<std::string> filePath;
+        bool                       publish = false;       // feed MetricsPublication
+        bool                       rxActive = false;
+        bool                       txActive = false;
+        std::function<void(const std::string&)> statusSink;   // status line goes here instead of stdout (--tui)
+    };
+
+    /**
+     * @brief Periodically turns snapshots into a status line, file and publication.
+     *
+     * poll() is called from the consumer loop and returns immediately unless the
+     * report interval has elapsed (status interval, or 1 s for file/HTTP only).
+     */
+    class MetricsReporter
+    {
+    public:
+        MetricsReporter(const Metrics& metrics, const PacketQueue& queue,
+                        MetricsReporterOptions options, MetricsPublication& publication);
+
+        bool enabled() const noexcept { return m_enabled; }
+
+        void poll();
+
+    private:
+        const Metrics&                     m_metrics;
+        const PacketQueue&                 m_queue;
+        MetricsReporterOptions             m_options;
+        MetricsPublication&                m_publication;
+        bool                               m_enabled = false;
+        std::chrono::steady_clock::duration m_interval{};
+        std::unique_ptr<MetricsSnapshot>   m_prev;
+        std::unique_ptr<MetricsSnapshot>   m_cur;
+    };
+}
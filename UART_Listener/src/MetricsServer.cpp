@@ -0,0 +1,180 @@
+/**
+ ****************************************************************************************
+ * @file   MetricsServer.cpp
+ * @brief  Minimal localhost HTTP endpoint serving Prometheus metrics.
+ *
+ * @author Patrik Neunteufel
+ * @date   Oct 2026
+ ****************************************************************************************
+ */
+
+// Winsock2 must be included before windows.h (pulled in via UART.hpp)
+#include <winsock2.h>
+#include <ws2tcpip.h>
+
+#include "MetricsServer.hpp"
+
+#include <cstring>
+#include <iostream>
+#include <string>
+
+#pragma comment(lib, "Ws2_32.lib")
+
+namespace uart_listener
+{
+    MetricsServer::MetricsServer(const MetricsPublication& publication)
+        : m_publication(publication), m_listenSocket(INVALID_SOCKET)
+    {
+    }
+
+    MetricsServer::~MetricsServer()
+    {
+        stop();
+    }
+
+    bool MetricsServer::start(uint16_t port)
+    {
+        WSADATA wsaData{};
+        if (WSAStartup(MAKEWORD(2, 2), &wsaData) != 0)
+        {
+            std::cerr << "Metrics server: WSAStartup failed\n";
+            return false;
+        }
+        m_wsaStarted = true;
+
+        SOCKET s = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+        if (s == INVALID_SOCKET)
+        {
+            std::cerr << "Metrics server: socket() failed (code: " << WSAGetLastError() << ")\n";
+            stop();
+            return false;
+        }
+
+        sockaddr_in addr{};
+        addr.sin_family = AF_INET;
+        addr.sin_port = htons(port);
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+        if (bind(s, reinterpret_cast<const sockaddr*>(&addr), sizeof(addr)) == SOCKET_ERROR
+            || listen(s, 4) == SOCKET_ERROR)
+        {
+            std::cerr << "Metrics server: cannot listen on 127.0.0.1:" << port
+                      << " (code: " << WSAGetLastError() << ")\n";
+            closesocket(s);
+            stop();
+            return false;
+        }
+
+        m_listenSocket = static_cast<uintptr_t>(s);
+        m_running.store(true);
+        m_thread = std::thread(&MetricsServer::run, this);
+        return true;
+    }
+
+    void MetricsServer::stop()
+    {
+        m_running.store(false);
+        if (m_thread.joinable())
+        {
+            m_thread.join();
+        }
+        if (m_listenSocket != static_cast<uintptr_t>(INVALID_SOCKET))
+        {
+            closesocket(static_cast<SOCKET>(m_listenSocket));
+            m_listenSocket = static_cast<uintptr_t>(INVALID_SOCKET);
+        }
+        if (m_wsaStarted)
+        {
+            WSACleanup();
+            m_wsaStarted = false;
+        }
+    }
+
+    void MetricsServer::run()
+    {
+        const SOCKET listenSocket = static_cast<SOCKET>(m_listenSocket);
+
+        while (m_running.load())
+        {
+            // Poll so stop() is honoured within 200 ms
+            fd_set readSet;
+            FD_ZERO(&readSet);
+            FD_SET(listenSocket, &readSet);
+            timeval tv{ 0, 200'000 };
+
+            const int ready = select(0, &readSet, nullptr, nullptr, &tv);
+            if (ready <= 0)
+            {
+                continue;
+            }
+
+            SOCKET client = accept(listenSocket, nullptr, nullptr);
+            if (client == INVALID_SOCKET)
+            {
+                continue;
+            }
+            handleClient(static_cast<uintptr_t>(client));
+            closesocket(client);
+        }
+    }
+
+    void MetricsServer::handleClient(uintptr_t clientHandle)
+    {
+        const SOCKET client = static_cast<SOCKET>(clientHandle);
+
+        // Bound the time a client can hold the (single) server thread
+        DWORD timeoutMs = 1000;
+        setsockopt(client, SOL_SOCKET, SO_RCVTIMEO, reinterpret_cast<const char*>(&timeoutMs), sizeof(timeoutMs));
+        setsockopt(client, SOL_SOCKET, SO_SNDTIMEO, reinterpret_cast<const char*>(&timeoutMs), sizeof(timeoutMs));
+
+        char request[1024];
+        const int received = recv(client, request, sizeof(request) - 1, 0);
+        if (received <= 0)
+        {
+            return;
+        }
+        request[received] = '\0';
+
+        const std::string line(request, strcspn(request, "\r\n"));
+        const bool        isGet = line.rfind("GET ", 0) == 0;
+
+        // Path "/metrics" or "/", ending at ' ', a query or the line end (not "/metricsXYZ")
+        const auto servesPath = [&line](const std::string& path) {
+            const size_t end = 4 + path.size();
+            return line.compare(4, path.size(), path) == 0
+                && (end == line.size() || line[end] == ' ' || line[end] == '?');
+        };
+        const bool isMetrics = isGet && (servesPath("/metrics") || servesPath("/"));
+
+        std::string body;
+        std::string status;
+        if (isGet && isMetrics)
+        {
+            status = "200 OK";
+            body = m_publication.get();
+        }
+        else
+        {
+            status = "404 Not Found";
+            body = "Not found. Use /metrics\n";
+        }
+
+        const std::string response =
+            "HTTP/1.1 " + status + "\r\n"
+            "Content-Type: text/plain; version=0.0.4; charset=utf-8\r\n"
+            "Content-Length: " + std::to_string(body.size()) + "\r\n"
+            "Connection: close\r\n\r\n" + body;
+
+        size_t sent = 0;
+        while (sent < response.size())
+        {
+            const int n = send(client, response.data() + sent, static_cast<int>(response.size() - sent), 0);
+            if (n <= 0)
+            {
+                break;
+            }
+            sent += static_cast<size_t>(n);
+        }
+        shutdown(client, SD_SEND);
+    }
+}
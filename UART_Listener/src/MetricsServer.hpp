@@ -0,0 +1,53 @@
+/**
+ ****************************************************************************************
+ * @file   MetricsServer.hpp
+ * @brief  Minimal localhost HTTP endpoint serving Prometheus metrics.
+ *
+ * @author Patrik Neunteufel
+ * @date   Oct 2026
+ ****************************************************************************************
+ */
+#pragma once
+
+#include "Metrics.hpp"
+
+#include <atomic>
+#include <cstdint>
+#include <thread>
+
+namespace uart_listener
+{
+    /**
+     * @brief Serves the latest MetricsPublication on http://127.0.0.1:PORT/metrics.
+     *
+     * The server runs on its own thread and only ever copies the pre-rendered text,
+     * so a slow or stuck scraper cannot delay capture.
+     */
+    class MetricsServer
+    {
+    public:
+        explicit MetricsServer(const MetricsPublication& publication);
+        ~MetricsServer();
+
+        MetricsServer(const MetricsServer&) = delete;
+        MetricsServer& operator=(const MetricsServer&) = delete;
+
+        /**
+         * @brief Bind to 127.0.0.1:port and start the server thread.
+         * @return false if Winsock init, bind or listen failed
+         */
+        bool start(uint16_t port);
+
+        void stop();
+
+    private:
+        void run();
+        void handleClient(uintptr_t client);
+
+        const MetricsPublication& m_publication;
+        uintptr_t                 m_listenSocket;
+        std::atomic<bool>         m_running{ false };
+        bool                      m_wsaStarted = false;
+        std::thread               m_thread;
+    };
+}
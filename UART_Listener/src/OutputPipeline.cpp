@@ -0,0 +1,211 @@
+/**
+ ****************************************************************************************
+ * @file   OutputPipeline.cpp
+ * @brief  Console and log line formatting, specialised once for the configuration.
+ *
+ * @author Patrik Neunteufel
+ * @date   Oct 2026
+ ****************************************************************************************
+ */
+
+#include "OutputPipeline.hpp"
+#include "DataFormat.hpp"
+#include "LogLine.hpp"
+#include "Trace.hpp"
+
+#include <type_traits>
+
+namespace uart_listener
+{
+    namespace
+    {
+        const char* const kLogTag[2] = { "[RX] ", "[TX] " };
+        const char* const kCsvTag[2] = { ";RX;", ";TX;" };
+    }
+
+    OutputPipeline::OutputPipeline(OutputFormat format, LogFormat logFormat, bool timestamps,
+                                   const std::string& rxColor, const std::string& txColor)
+        : m_format(select(format, logFormat, timestamps)),
+          m_outputFormat(format),
+          m_logFormat(logFormat),
+          m_timestamps(timestamps)
+    {
+        const std::string* colors[2] = { &rxColor, &txColor };
+        for (Channel channel : { Channel::RX, Channel::TX })
+        {
+            const std::string& color = *colors[static_cast<size_t>(channel)];
+            std::string&       tag = m_consoleTag[static_cast<size_t>(channel)];
+            tag = color.empty() ? channelTag(channel) : color + channelTag(channel) + "\033[0m";
+            tag += ' ';
+        }
+
+        // Typical lines fit without growing the buffers
+        m_payload.reserve(4096);
+        m_console.reserve(4096);
+        m_log.reserve(4096);
+    }
+
+    template<OutputFormat F, LogFormat L, bool Timestamps>
+    void OutputPipeline::formatPacket(OutputPipeline& self, const Packet& pkt, bool console, bool log)
+    {
+        UART_TRACE_SCOPE("formatData");
+        const size_t channel = static_cast<size_t>(pkt.channel);
+
+        self.m_payload.clear();
+        appendPayload<F>(self.m_payload, pkt.data.data(), pkt.data.size());
+
+        if (console)
+        {
+            std::string& out = self.m_console;
+            out.clear();
+            if constexpr (Timestamps)
+            {
+                out += pkt.timestamp;
+                out += ' ';
+            }
+            out += self.m_consoleTag[channel];
+            out += self.m_payload;
+            out += '\n';
+        }
+
+        if (log)
+        {
+            std::string& out = self.m_log;
+            out.clear();
+            if constexpr (L == LogFormat::Csv)
+            {
+                // CSV: Timestamp;Channel;Data, always with the timestamp
+                out += pkt.timestamp;
+                out += kCsvTag[channel];
+            }
+            else
+            {
+                if constexpr (Timestamps)
+                {
+                    out += pkt.timestamp;
+                    out += ' ';
+                }
+                out += kLogTag[channel];
+            }
+            out += self.m_payload;
+            out += '\n';
+        }
+    }
+
+    void OutputPipeline::formatEvent(const Packet& pkt, const std::string& message, bool ansi, bool console,
+                                     bool log)
+    {
+        // Rare; not worth a specialisation
+        const size_t channel = static_cast<size_t>(pkt.channel);
+        if (console)
+        {
+            m_console.clear();
+            if (m_timestamps)
+            {
+                m_console += pkt.timestamp;
+                m_console += ' ';
+            }
+            if (ansi)
+            {
+                m_console += (pkt.kind == PacketKind::Reconnect) ? "\033[93m" : "\033[91m";
+            }
+            m_console += kLogTag[channel];
+            m_console += message;
+            m_console += ansi ? "\033[0m\n" : "\n";
+        }
+
+        if (log)
+        {
+            m_log.clear();
+            if (m_logFormat == LogFormat::Csv)
+            {
+                m_log += pkt.timestamp;
+                m_log += kCsvTag[channel];
+            }
+            else
+            {
+                if (m_timestamps)
+                {
+                    m_log += pkt.timestamp;
+                    m_log += ' ';
+                }
+                m_log += kLogTag[channel];
+            }
+            m_log += message;
+            m_log += '\n';
+        }
+    }
+
+    void OutputPipeline::formatRepeat(const RepeatRun& run, bool console, bool log)
+    {
+        // At most one line per run and hold time; not worth a specialisation
+        const size_t channel = static_cast<size_t>(run.channel);
+        m_payload.clear();
+        if (run.count > 1)
+        {
+            // A single repeat is shorter as a plain line
+            m_payload = "== " + std::to_string(run.count) + "x " + run.first + " .. " + run.last + " | ";
+        }
+        m_payload += formatData(run.data.data(), run.data.size(), m_outputFormat);
+
+        if (console)
+        {
+            m_console.clear();
+            if (m_timestamps)
+            {
+                m_console += run.last;
+                m_console += ' ';
+            }
+            m_console += m_consoleTag[channel];
+            m_console += m_payload;
+            m_console += '\n';
+        }
+
+        if (log)
+        {
+            m_log.clear();
+            if (m_logFormat == LogFormat::Csv)
+            {
+                m_log += run.last;
+                m_log += kCsvTag[channel];
+            }
+            else
+            {
+                if (m_timestamps)
+                {
+                    m_log += run.last;
+                    m_log += ' ';
+                }
+                m_log += kLogTag[channel];
+            }
+            m_log += m_payload;
+            m_log += '\n';
+        }
+    }
+
+    OutputPipeline::FormatFn OutputPipeline::select(OutputFormat format, LogFormat logFormat, bool timestamps)
+    {
+        // 4 output formats x 2 log formats x timestamps on / off
+        const auto byLog = [&](auto fmt) -> FormatFn {
+            constexpr OutputFormat F = decltype(fmt)::value;
+            if (logFormat == LogFormat::Csv)
+            {
+                return timestamps ? &formatPacket<F, LogFormat::Csv, true> : &formatPacket<F, LogFormat::Csv, false>;
+            }
+            return timestamps ? &formatPacket<F, LogFormat::Text, true> : &formatPacket<F, LogFormat::Text, false>;
+        };
+
+        switch (format)
+        {
+        case OutputFormat::Ascii:
+            return byLog(std::integral_constant<OutputFormat, OutputFormat::Ascii>());
+        case OutputFormat::CEscape:
+            return byLog(std::integral_constant<OutputFormat, OutputFormat::CEscape>());
+        case OutputFormat::Raw:
+            return byLog(std::integral_constant<OutputFormat, OutputFormat::Raw>());
+        case OutputFormat::Hex:
+        default:
+            return byLog(std::integral_constant<OutputFormat, OutputFormat::Hex>());
+        }
+    }
+}
@@ -0,0 +1,76 @@
+/**
+ ****************************************************************************************
+ * @file   OutputPipeline.hpp
+ * @brief  Console and log line formatting, specialised once for the configuration.
+ *
+ *         Output format, log format and the timestamp flag do not change while
+ *         capturing. The constructor picks one instantiation of formatPacket()
+ *         for them, so the consumer loop runs straight-line code per packet:
+ *         no format switch, no per-byte escape check, no stream construction.
+ *         Lines are built in buffers that are reused for every packet.
+ *
+ * @author Patrik Neunteufel
+ * @date   Oct 2026
+ ****************************************************************************************
+ */
+#pragma once
+
+#include "Format.hpp"
+#include "RepeatCollapser.hpp"
+#include "UART.hpp"
+
+#include <string>
+
+namespace uart_listener
+{
+    class OutputPipeline
+    {
+    public:
+        /**
+         * @param rxColor ANSI sequence for the console [RX] tag, may be empty
+         */
+        OutputPipeline(OutputFormat format, LogFormat logFormat, bool timestamps, const std::string& rxColor,
+                       const std::string& txColor);
+
+        /**
+         * @brief Format a data packet into consoleLine() and / or logLine().
+         * Both lines end with '\n'; a line not asked for keeps its old content.
+         */
+        void format(const Packet& pkt, bool console, bool log)
+        {
+            m_format(*this, pkt, console, log);
+        }
+
+        /**
+         * @brief Same for an event packet (line error, disconnect, reconnect).
+         * @param ansi Highlight the console line (red, reconnects yellow)
+         */
+        void formatEvent(const Packet& pkt, const std::string& message, bool ansi, bool console, bool log);
+
+        /**
+         * @brief Same for a run of collapsed repeats (--collapse-repeats):
+         * "[LAST ][RX] == Nx FIRST .. LAST | payload", or a plain line for N = 1.
+         */
+        void formatRepeat(const RepeatRun& run, bool console, bool log);
+
+        const std::string& consoleLine() const { return m_console; }
+        const std::string& logLine() const { return m_log; }
+
+    private:
+        using FormatFn = void (*)(OutputPipeline&, const Packet&, bool, bool);
+
+        template<OutputFormat F, LogFormat L, bool Timestamps>
+        static void formatPacket(OutputPipeline& self, const Packet& pkt, bool console, bool log);
+
+        static FormatFn select(OutputFormat format, LogFormat logFormat, bool timestamps);
+
+        FormatFn     m_format;
+        OutputFormat m_outputFormat;
+        LogFormat    m_logFormat;
+        bool         m_timestamps;
+        std::string  m_consoleTag[2];   // per Channel: "[RX] ", with color if set
+        std::string  m_payload;
+        std::string  m_console;
+        std::string  m_log;
+    };
+}
@@ -0,0 +1,800 @@
+/**
+ ****************************************************************************************
+ * @file   Regex.cpp
+ * @brief  Regex parser, Thompson NFA construction and subset construction to a DFA.
+ *
+ * @author Patrik Neunteufel
+ * @date   Oct 2026
+ ****************************************************************************************
+ */
+
+#include "Regex.hpp"
+
+#include <algorithm>
+#include <bitset>
+#include <map>
+
+namespace uart_listener
+{
+    namespace
+    {
+        constexpr size_t kMaxDfaStates = 4096;
+        constexpr size_t kMaxNfaStates = 16384;   // counted repeats multiply; checked while cloning
+        constexpr size_t kMaxNesting   = 256;     // '(' levels; bounds the parser's recursion
+        constexpr int    kMaxRepeat    = 255;
+
+        using ByteSet = std::bitset<256>;
+
+        struct NfaState
+        {
+            bool             hasSet = false;
+            ByteSet          set;
+            int              next = -1;   // target when a byte in 'set' is consumed
+            std::vector<int> eps;         // epsilon transitions
+        };
+
+        struct Fragment
+        {
+            int start;
+            int accept;
+        };
+
+        // ====================================================================
+        // Parser (recursive descent, builds the NFA directly)
+        // ====================================================================
+
+        class Parser
+        {
+        public:
+            Parser(const std::string& src, std::vector<NfaState>& nfa)
+                : m_src(src), m_nfa(nfa)
+            {
+            }
+
+            bool parse(Fragment& out, bool& anchoredStart, bool& anchoredEnd, std::string& error)
+            {
+                size_t end = m_src.size();
+                anchoredStart = false;
+                anchoredEnd = false;
+
+                if (!m_src.empty() && m_src.front() == '^')
+                {
+                    anchoredStart = true;
+                    m_pos = 1;
+                }
+                if (end > m_pos && m_src.back() == '$' && !isEscaped(end - 1))
+                {
+                    anchoredEnd = true;
+                    --end;
+                }
+                m_end = end;
+
+                if (!parseAlternation(out))
+                {
+                    error = m_error;
+                    return false;
+                }
+                if (m_pos != m_end)
+                {
+                    error = "unexpected '" + std::string(1, m_src[m_pos]) + "' at position "
+                          + std::to_string(m_pos);
+                    return false;
+                }
+                if (m_nfa.size() > kMaxNfaStates)
+                {
+                    error = "pattern too large";
+                    return false;
+                }
+                // The anchors apply to the whole pattern, not to the first / last alternative
+                if ((anchoredStart || anchoredEnd) && m_topLevelAlternation)
+                {
+                    error = "'^' and '$' anchor the whole pattern; group the alternatives: ^(a|b)$";
+                    return false;
+                }
+                return true;
+            }
+
+        private:
+            const std::string&     m_src;
+            std::vector<NfaState>& m_nfa;
+            size_t                 m_pos = 0;
+            size_t                 m_end = 0;
+            size_t                 m_nesting = 0;
+            bool                   m_topLevelAlternation = false;
+            std::string            m_error;
+
+            bool isEscaped(size_t idx) const
+            {
+                size_t backslashes = 0;
+                while (idx > backslashes && m_src[idx - backslashes - 1] == '\\')
+                {
+                    ++backslashes;
+                }
+                return (backslashes % 2) == 1;
+            }
+
+            bool atEnd() const { return m_pos >= m_end; }
+            char peek() const { return m_src[m_pos]; }
+
+            bool fail(const std::string& msg)
+            {
+                if (m_error.empty())
+                {
+                    m_error = msg + " at position " + std::to_string(m_pos);
+                }
+                return false;
+            }
+
+            int newState()
+            {
+                m_nfa.emplace_back();
+                return static_cast<int>(m_nfa.size() - 1);
+            }
+
+            Fragment makeSet(const ByteSet& set)
+            {
+                int s = newState();
+                int a = newState();
+                m_nfa[s].hasSet = true;
+                m_nfa[s].set = set;
+                m_nfa[s].next = a;
+                return { s, a };
+            }
+
+            Fragment makeEmpty()
+            {
+                int s = newState();
+                return { s, s };
+            }
+
+            Fragment concat(Fragment a, Fragment b)
+            {
+                m_nfa[a.accept].eps.push_back(b.start);
+                return { a.start, b.accept };
+            }
+
+            bool parseAlternation(Fragment& out)
+            {
+                Fragment left{};
+                if (!parseConcat(left))
+                {
+                    return false;
+                }
+
+                while (!atEnd() && peek() == '|')
+                {
+                    m_topLevelAlternation |= (m_nesting == 0);
+                    ++m_pos;
+                    Fragment right{};
+                    if (!parseConcat(right))
+                    {
+                        return false;
+                    }
+                    int s = newState();
+                    int a = newState();
+                    m_nfa[s].eps = { left.start, right.start };
+                    m_nfa[left.accept].eps.push_back(a);
+                    m_nfa[right.accept].eps.push_back(a);
+                    left = { s, a };
+                }
+
+                out = left;
+                return true;
+            }
+
+            bool parseConcat(Fragment& out)
+            {
+                Fragment result = makeEmpty();
+                while (!atEnd() && peek() != '|' && peek() != ')')
+                {
+                    Fragment piece{};
+                    if (!parseRepeat(piece))
+                    {
+                        return false;
+                    }
+                    result = concat(result, piece);
+                }
+                out = result;
+                return true;
+            }
+
+            bool parseRepeat(Fragment& out)
+            {
+                const size_t atomStart = m_pos;
+                Fragment     atom{};
+                if (!parseAtom(atom))
+                {
+                    return false;
+                }
+                const size_t atomEnd = m_pos;
+                bool         quantified = false;
+
+                while (!atEnd())
+                {
+                    const char q = peek();
+                    if (q == '*' || q == '+' || q == '?')
+                    {
+                        ++m_pos;
+                        quantified = true;
+                        int s = newState();
+                        int a = newState();
+                        if (q == '*')
+                        {
+                            m_nfa[s].eps = { atom.start, a };
+                            m_nfa[atom.accept].eps.push_back(atom.start);
+                            m_nfa[atom.accept].eps.push_back(a);
+                        }
+                        else if (q == '+')
+                        {
+                            m_nfa[s].eps = { atom.start };
+                            m_nfa[atom.accept].eps.push_back(atom.start);
+                            m_nfa[atom.accept].eps.push_back(a);
+                        }
+                        else
+                        {
+                            m_nfa[s].eps = { atom.start, a };
+                            m_nfa[atom.accept].eps.push_back(a);
+                        }
+                        atom = { s, a };
+                    }
+                    else if (q == '{')
+                    {
+                        if (quantified)
+                        {
+                            return fail("counted repeat must directly follow its operand");
+                        }
+                        quantified = true;
+
+                        int minCount = 0;
+                        int maxCount = 0;
+                        if (!parseBounds(minCount, maxCount))
+                        {
+                            return false;
+                        }
+                        const size_t afterBounds = m_pos;
+                        if (!expandBounds(atom, atomStart, atomEnd, minCount, maxCount))
+                        {
+                            return false;
+                        }
+                        m_pos = afterBounds;
+                    }
+                    else
+                    {
+                        break;
+                    }
+                }
+
+                out = atom;
+                return true;
+            }
+
+            bool parseBounds(int& minCount, int& maxCount)
+            {
+                ++m_pos; // '{'
+                auto readInt = [this](int& value) {
+                    const size_t start = m_pos;
+                    value = 0;
+                    while (!atEnd() && peek() >= '0' && peek() <= '9')
+                    {
+                        value = value * 10 + (peek() - '0');
+                        if (value > kMaxRepeat)
+                        {
+                            return false;
+                        }
+                        ++m_pos;
+                    }
+                    return m_pos > start;
+                };
+
+                if (!readInt(minCount))
+                {
+                    return fail("invalid repeat count");
+                }
+                maxCount = minCount;
+                if (!atEnd() && peek() == ',')
+                {
+                    ++m_pos;
+                    if (!atEnd() && peek() == '}')
+                    {
+                        maxCount = -1; // unbounded
+                    }
+                    else if (!readInt(maxCount) || maxCount < minCount)
+                    {
+                        return fail("invalid repeat range");
+                    }
+                }
+                if (atEnd() || peek() != '}')
+                {
+                    return fail("missing '}'");
+                }
+                ++m_pos;
+                return true;
+            }
+
+            // Counted repetition: re-parse the atom source to get independent copies.
+            bool expandBounds(Fragment& atom, size_t atomStart, size_t atomEnd, int minCount, int maxCount)
+            {
+                auto cloneAtom = [&](Fragment& copy) {
+                    if (m_nfa.size() > kMaxNfaStates)
+                    {
+                        return fail("pattern too large");
+                    }
+                    m_pos = atomStart;
+                    const bool ok = parseAtom(copy);
+                    return ok && m_pos == atomEnd;
+                };
+
+                Fragment result = makeEmpty();
+                bool     first = true;
+
+                for (int i = 0; i < minCount; ++i)
+                {
+                    Fragment copy{};
+                    if (first)
+                    {
+                        copy = atom;
+                        first = false;
+                    }
+                    else if (!cloneAtom(copy))
+                    {
+                        return fail("invalid repeated expression");
+                    }
+                    result = concat(result, copy);
+                }
+
+                if (maxCount < 0)
+                {
+                    Fragment copy{};
+                    if (first)
+                    {
+                        copy = atom;
+                    }
+                    else if (!cloneAtom(copy))
+                    {
+                        return fail("invalid repeated expression");
+                    }
+                    int s = newState();
+                    int a = newState();
+                    m_nfa[s].eps = { copy.start, a };
+                    m_nfa[copy.accept].eps.push_back(copy.start);
+                    m_nfa[copy.accept].eps.push_back(a);
+                    result = concat(result, { s, a });
+                }
+                else
+                {
+                    for (int i = minCount; i < maxCount; ++i)
+                    {
+                        Fragment copy{};
+                        if (first)
+                        {
+                            copy = atom;
+                            first = false;
+                        }
+                        else if (!cloneAtom(copy))
+                        {
+                            return fail("invalid repeated expression");
+                        }
+                        int s = newState();
+                        int a = newState();
+                        m_nfa[s].eps = { copy.start, a };
+                        m_nfa[copy.accept].eps.push_back(a);
+                        result = concat(result, { s, a });
+                    }
+                }
+
+                atom = result;
+                return true;
+            }
+
+            bool parseAtom(Fragment& out)
+            {
+                if (atEnd())
+                {
+                    return fail("unexpected end of pattern");
+                }
+
+                const char c = peek();
+                if (c == '(')
+                {
+                    if (m_nesting == kMaxNesting)
+                    {
+                        return fail("pattern nested too deeply");
+                    }
+                    ++m_nesting;
+                    ++m_pos;
+                    if (!parseAlternation(out))
+                    {
+                        return false;
+                    }
+                    if (atEnd() || peek() != ')')
+                    {
+                        return fail("missing ')'");
+                    }
+                    ++m_pos;
+                    --m_nesting;
+                    return true;
+                }
+                if (c == '*' || c == '+' || c == '?' || c == '{')
+                {
+                    return fail("quantifier without operand");
+                }
+                if (c == '^' || c == '$')
+                {
+                    return fail("'^' and '$' are only allowed at the start and end of the pattern (use \\^, \\$)");
+                }
+                if (c == '.')
+                {
+                    ++m_pos;
+                    ByteSet all;
+                    all.set();
+                    out = makeSet(all);
+                    return true;
+                }
+                if (c == '[')
+                {
+                    ByteSet set;
+                    if (!parseClass(set))
+                    {
+                        return false;
+                    }
+                    out = makeSet(set);
+                    return true;
+                }
+                if (c == '\\')
+                {
+                    ByteSet set;
+                    if (!parseEscape(set))
+                    {
+                        return false;
+                    }
+                    out = makeSet(set);
+                    return true;
+                }
+
+                ++m_pos;
+                ByteSet set;
+                set.set(static_cast<uint8_t>(c));
+                out = makeSet(set);
+                return true;
+            }
+
+            static int hexValue(char c)
+            {
+                if (c >= '0' && c <= '9') return c - '0';
+                if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+                if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+                return -1;
+            }
+
+            // Parses an escape at m_pos ('\\'), returns the matched byte set.
+            bool parseEscape(ByteSet& set)
+            {
+                ++m_pos; // '\\'
+                if (atEnd())
+                {
+                    return fail("trailing backslash");
+                }
+
+                const char e = peek();
+                ++m_pos;
+
+                auto addRange = [&set](int lo, int hi) {
+                    for (int b = lo; b <= hi; ++b)
+                    {
+                        set.set(static_cast<size_t>(b));
+                    }
+                };
+
+                switch (e)
+                {
+                case 'r': set.set('\r'); return true;
+                case 'n': set.set('\n'); return true;
+                case 't': set.set('\t'); return true;
+                case '0': set.set(0);    return true;
+                case 'd': addRange('0', '9'); return true;
+                case 'w': addRange('0', '9'); addRange('a', 'z'); addRange('A', 'Z'); set.set('_'); return true;
+                case 's': set.set(' '); set.set('\t'); set.set('\r'); set.set('\n'); set.set('\f'); set.set('\v'); return true;
+                case 'D': addRange('0', '9'); set.flip(); return true;
+                case 'W': addRange('0', '9'); addRange('a', 'z'); addRange('A', 'Z'); set.set('_'); set.flip(); return true;
+                case 'S': set.set(' '); set.set('\t'); set.set('\r'); set.set('\n'); set.set('\f'); set.set('\v'); set.flip(); return true;
+                case 'x':
+                {
+                    if (m_pos + 2 > m_end || hexValue(m_src[m_pos]) < 0 || hexValue(m_src[m_pos + 1]) < 0)
+                    {
+                        return fail("invalid \\x escape");
+                    }
+                    set.set(static_cast<size_t>(hexValue(m_src[m_pos]) * 16 + hexValue(m_src[m_pos + 1])));
+                    m_pos += 2;
+                    return true;
+                }
+                default:
+                    set.set(static_cast<uint8_t>(e));
+                    return true;
+                }
+            }
+
+            bool parseClass(ByteSet& set)
+            {
+                ++m_pos; // '['
+                bool negate = false;
+                if (!atEnd() && peek() == '^')
+                {
+                    negate = true;
+                    ++m_pos;
+                }
+
+                bool firstItem = true;
+                while (!atEnd() && (peek() != ']' || firstItem))
+                {
+                    firstItem = false;
+
+                    ByteSet item;
+                    int     lo = -1;
+                    if (peek() == '\\')
+                    {
+                        if (!parseEscape(item))
+                        {
+                            return false;
+                        }
+                        if (item.count() == 1)
+                        {
+                            for (int b = 0; b < 256; ++b)
+                            {
+                                if (item.test(static_cast<size_t>(b))) lo = b;
+                            }
+                        }
+                    }
+                    else
+                    {
+                        lo = static_cast<uint8_t>(peek());
+                        item.set(static_cast<size_t>(lo));
+                        ++m_pos;
+                    }
+
+                    // Range a-z (a trailing '-' is a literal)
+                    if (lo >= 0 && m_pos + 1 < m_end && peek() == '-' && m_src[m_pos + 1] != ']')
+                    {
+                        ++m_pos;
+                        int hi = -1;
+                        if (peek() == '\\')
+                        {
+                            ByteSet hiSet;
+                            if (!parseEscape(hiSet) || hiSet.count() != 1)
+                            {
+                                return fail("invalid class range");
+                            }
+                            for (int b = 0; b < 256; ++b)
+                            {
+                                if (hiSet.test(static_cast<size_t>(b))) hi = b;
+                            }
+                        }
+                        else
+                        {
+                            hi = static_cast<uint8_t>(peek());
+                            ++m_pos;
+                        }
+                        if (hi < lo)
+                        {
+                            return fail("invalid class range");
+                        }
+                        for (int b = lo; b <= hi; ++b)
+                        {
+                            item.set(static_cast<size_t>(b));
+                        }
+                    }
+
+                    set |= item;
+                }
+
+                if (atEnd())
+                {
+                    return fail("missing ']'");
+                }
+                ++m_pos; // ']'
+
+                if (negate)
+                {
+                    set.flip();
+                }
+                return true;
+            }
+        };
+
+        void epsilonClosure(const std::vector<NfaState>& nfa, std::vector<int>& states)
+        {
+            std::vector<uint8_t> seen(nfa.size(), 0);
+            std::vector<int>     stack(states.begin(), states.end());
+            states.clear();
+
+            while (!stack.empty())
+            {
+                int s = stack.back();
+                stack.pop_back();
+                if (seen[static_cast<size_t>(s)])
+                {
+                    continue;
+                }
+                seen[static_cast<size_t>(s)] = 1;
+                states.push_back(s);
+                for (int t : nfa[static_cast<size_t>(s)].eps)
+                {
+                    stack.push_back(t);
+                }
+            }
+            std::sort(states.begin(), states.end());
+        }
+    }
+
+    std::optional<DfaRegex> DfaRegex::compile(const std::string& pattern, std::string& error, bool prefix)
+    {
+        std::vector<NfaState> nfa;
+        Fragment              root{};
+        bool                  anchoredStart = false;
+        bool                  anchoredEnd = false;
+
+        Parser parser(pattern, nfa);
+        if (!parser.parse(root, anchoredStart, anchoredEnd, error))
+        {
+            return std::nullopt;
+        }
+
+        DfaRegex re;
+        re.m_pattern = pattern;
+        re.m_anchoredStart = anchoredStart;
+        re.m_anchoredEnd = anchoredEnd;
+
+        // Byte equivalence classes: bytes that behave identically in every set
+        std::vector<ByteSet> sets;
+        for (const auto& st : nfa)
+        {
+            if (st.hasSet && std::find(sets.begin(), sets.end(), st.set) == sets.end())
+            {
+                sets.push_back(st.set);
+            }
+        }
+
+        std::map<std::vector<bool>, uint8_t> signatureToClass;
+        for (int b = 0; b < 256; ++b)
+        {
+            std::vector<bool> sig(sets.size());
+            for (size_t i = 0; i < sets.size(); ++i)
+            {
+                sig[i] = sets[i].test(static_cast<size_t>(b));
+            }
+            auto it = signatureToClass.find(sig);
+            if (it == signatureToClass.end())
+            {
+                it = signatureToClass.emplace(sig, static_cast<uint8_t>(signatureToClass.size())).first;
+            }
+            re.m_byteClass[static_cast<size_t>(b)] = it->second;
+        }
+        re.m_classCount = static_cast<uint32_t>(signatureToClass.size());
+
+        // Representative byte per class
+        std::vector<int> classRep(re.m_classCount, -1);
+        for (int b = 0; b < 256; ++b)
+        {
+            auto& rep = classRep[re.m_byteClass[static_cast<size_t>(b)]];
+            if (rep < 0)
+            {
+                rep = b;
+            }
+        }
+
+        // Subset construction; state 0 is the dead state
+        std::vector<int> startSet = { root.start };
+        epsilonClosure(nfa, startSet);
+
+        std::map<std::vector<int>, uint32_t> dfaIds;
+        std::vector<std::vector<int>>        dfaSets;
+
+        auto addState = [&](const std::vector<int>& set) -> uint32_t {
+            auto it = dfaIds.find(set);
+            if (it != dfaIds.end())
+            {
+                return it->second;
+            }
+            const uint32_t id = static_cast<uint32_t>(dfaSets.size());
+            dfaIds.emplace(set, id);
+            dfaSets.push_back(set);
+            re.m_transitions.resize(dfaSets.size() * re.m_classCount, kDeadState);
+            const bool accepting = std::binary_search(set.begin(), set.end(), root.accept);
+            re.m_accepting.push_back(accepting ? 1 : 0);
+            return id;
+        };
+
+        addState({});
+        re.m_startState = addState(startSet);
+
+        for (size_t cur = 1; cur < dfaSets.size(); ++cur)
+        {
+            if (dfaSets.size() > kMaxDfaStates)
+            {
+                error = "pattern too complex (DFA state limit exceeded)";
+                return std::nullopt;
+            }
+
+            for (uint32_t cls = 0; cls < re.m_classCount; ++cls)
+            {
+                const size_t     rep = static_cast<size_t>(classRep[cls]);
+                std::vector<int> next;
+                for (int s : dfaSets[cur])
+                {
+                    const auto& st = nfa[static_cast<size_t>(s)];
+                    if (st.hasSet && st.set.test(rep))
+                    {
+                        next.push_back(st.next);
+                    }
+                }
+                if (!anchoredStart && !prefix)
+                {
+                    // Unanchored search: a match may begin at every position
+                    next.push_back(root.start);
+                }
+                epsilonClosure(nfa, next);
+
+                const uint32_t target = next.empty() ? kDeadState : addState(next);
+                re.m_transitions[cur * re.m_classCount + cls] = target;
+            }
+        }
+
+        return re;
+    }
+
+    bool DfaRegex::search(const uint8_t* data, size_t size) const
+    {
+        uint32_t state = m_startState;
+
+        if (!m_anchoredEnd && m_accepting[state])
+        {
+            return true;
+        }
+
+        for (size_t i = 0; i < size; ++i)
+        {
+            state = m_transitions[state * m_classCount + m_byteClass[data[i]]];
+            if (state == kDeadState)
+            {
+                return false;
+            }
+            if (!m_anchoredEnd && m_accepting[state])
+            {
+                return true;
+            }
+        }
+
+        return m_accepting[state] != 0;
+    }
+
+    std::optional<DfaRegex::Span> DfaRegex::find(const uint8_t* data, size_t size) const
+    {
+        const size_t lastStart = m_anchoredStart ? 0 : size;
+        for (size_t start = 0; start <= lastStart; ++start)
+        {
+            // Longest match from 'start'; with '$' it has to reach the end
+            uint32_t state = m_startState;
+            size_t   best = SIZE_MAX;
+            if (m_accepting[state] && (!m_anchoredEnd || start == size))
+            {
+                best = 0;
+            }
+            for (size_t i = start; i < size; ++i)
+            {
+                state = m_transitions[state * m_classCount + m_byteClass[data[i]]];
+                if (state == kDeadState)
+                {
+                    break;
+                }
+                if (m_accepting[state] && (!m_anchoredEnd || i + 1 == size))
+                {
+                    best = i + 1 - start;
+                }
+            }
+            if (best != SIZE_MAX)
+            {
+                return Span{ start, best };
+            }
+        }
+        return std::nullopt;
+    }
+}
@@ -0,0 +1,87 @@
+/**
+ ****************************************************************************************
+ * @file   Regex.hpp
+ * @brief  Small byte-oriented regular expression engine compiled to a DFA.
+ *
+ *         Supported syntax:
+ *         - Literals, escapes (\r \n \t \0 \xNN \d \w \s \D \W \S and escaped metas)
+ *         - Any byte '.', classes [a-z0-9_] and negated classes [^...]
+ *         - Grouping (...), alternation a|b
+ *         - Quantifiers *, +, ?, {n}, {n,}, {n,m}
+ *         - Anchors ^ (pattern start) and $ (pattern end); they anchor the whole
+ *           pattern, so top-level alternatives must be grouped: ^(a|b)$
+ *         - Limits: 256 nested groups, repeats up to 255, 16384 NFA states
+ *
+ * @author Patrik Neunteufel
+ * @date   Oct 2026
+ ****************************************************************************************
+ */
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace uart_listener
+{
+    /**
+     * @brief Regular expression compiled once into a deterministic automaton.
+     *
+     * The pattern is translated to a Thompson NFA and then determinised by subset
+     * construction. Bytes are mapped to equivalence classes so the transition table
+     * stays small; matching is a single table lookup per input byte.
+     */
+    class DfaRegex
+    {
+    public:
+        /**
+         * @brief Compile a pattern.
+         * @param pattern Regular expression source
+         * @param error   Receives a description if compilation fails
+         * @param prefix  Build the automaton for find() instead of search():
+         *                matches start where the automaton starts
+         * @return Compiled regex, nullopt on syntax error or state explosion
+         */
+        static std::optional<DfaRegex> compile(const std::string& pattern, std::string& error,
+                                               bool prefix = false);
+
+        /**
+         * @brief Check whether the pattern matches anywhere in the data.
+         * @param data Input bytes
+         * @param size Number of bytes
+         * @return true on the first match found
+         */
+        bool search(const uint8_t* data, size_t size) const;
+
+        struct Span
+        {
+            size_t offset = 0;
+            size_t length = 0;
+        };
+
+        /**
+         * @brief Leftmost-longest match (regex compiled with prefix = true).
+         *
+         * Runs the automaton from every start position until one matches, so
+         * the cost is up to size * match length; meant for short frames.
+         * @return Position of the match, nullopt if there is none
+         */
+        std::optional<Span> find(const uint8_t* data, size_t size) const;
+
+        const std::string& pattern() const noexcept { return m_pattern; }
+
+    private:
+        static constexpr uint32_t kDeadState = 0;
+
+        std::string                  m_pattern;
+        std::array<uint8_t, 256>     m_byteClass{};
+        uint32_t                     m_classCount = 0;
+        uint32_t                     m_startState = 0;
+        std::vector<uint32_t>        m_transitions;  // [state * m_classCount + class]
+        std::vector<uint8_t>         m_accepting;
+        bool                         m_anchoredStart = false;
+        bool                         m_anchoredEnd = false;
+    };
+}
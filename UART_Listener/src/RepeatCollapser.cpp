@@ -0,0 +1,119 @@
+/**
+ ****************************************************************************************
+ * @file   RepeatCollapser.cpp
+ * @brief  Collapsing of consecutive identical frames per channel (--collapse-repeats).
+ *
+ * @author Patrik Neunteufel
+ * @date   Oct 2026
+ ****************************************************************************************
+ */
+
+#include "RepeatCollapser.hpp"
+
+#include <cstring>
+
+namespace uart_listener
+{
+    uint64_t frameHash(const uint8_t* data, size_t size)
+    {
+        constexpr uint64_t kPrime = 0x100000001B3ull;
+        uint64_t           hash = 0xCBF29CE484222325ull ^ size;
+
+        size_t i = 0;
+        for (; i + 8 <= size; i += 8)
+        {
+            uint64_t word;
+            std::memcpy(&word, data + i, sizeof(word));
+            hash = (hash ^ word) * kPrime;
+        }
+        for (; i < size; ++i)
+        {
+            hash = (hash ^ data[i]) * kPrime;
+        }
+        return hash;
+    }
+
+    RepeatCollapser::RepeatCollapser(const CollapseOptions& options)
+        : m_options(options)
+    {
+        m_channels[0].run.channel = Channel::RX;
+        m_channels[1].run.channel = Channel::TX;
+    }
+
+    bool RepeatCollapser::repeat(const Packet& pkt, bool console, bool log, Clock::time_point now)
+    {
+        ChannelState&  ch = m_channels[static_cast<size_t>(pkt.channel)];
+        const uint8_t* data = pkt.data.data();
+        const size_t   size = pkt.data.size();
+        const uint64_t hash = frameHash(data, size);
+
+        if (ch.known && hash == ch.hash && size == ch.frame.size() && console == ch.console && log == ch.log
+            && (size == 0 || std::memcmp(data, ch.frame.data(), size) == 0))
+        {
+            RepeatRun& run = ch.run;
+            if (run.count == 0)
+            {
+                run.first = pkt.timestamp;
+                run.data = ch.frame;
+                run.console = console;
+                run.log = log;
+                ch.runStart = now;
+            }
+            ++run.count;
+            run.last = pkt.timestamp;
+            ++m_framesCollapsed;
+            return true;
+        }
+
+        end(ch);
+        ch.known = true;
+        ch.hash = hash;
+        ch.frame.assign(data, data + size);
+        ch.console = console;
+        ch.log = log;
+        return false;
+    }
+
+    void RepeatCollapser::close(Channel channel)
+    {
+        end(m_channels[static_cast<size_t>(channel)]);
+    }
+
+    void RepeatCollapser::poll(Clock::time_point now, bool all)
+    {
+        for (ChannelState& ch : m_channels)
+        {
+            if (ch.run.count != 0 && (all || now - ch.runStart >= std::chrono::milliseconds(m_options.holdMs)))
+            {
+                end(ch);
+            }
+        }
+    }
+
+    bool RepeatCollapser::takeRun(RepeatRun& run)
+    {
+        if (m_next == m_ended.size())
+        {
+            return false;
+        }
+        run = std::move(m_ended[m_next++]);
+        if (m_next == m_ended.size())
+        {
+            m_ended.clear();
+            m_next = 0;
+        }
+        return true;
+    }
+
+    void RepeatCollapser::end(ChannelState& ch)
+    {
+        if (ch.run.count == 0)
+        {
+            return;
+        }
+        // The frame stays known: the next identical one starts a new run
+        m_ended.push_back(ch.run);
+        ch.run.count = 0;
+        ++m_runsWritten;
+    }
+}
@@ -0,0 +1,106 @@
+/**
+ ****************************************************************************************
+ * @file   RepeatCollapser.hpp
+ * @brief  Collapsing of consecutive identical frames per channel (--collapse-repeats).
+ *
+ *         Heartbeat and status frames repeated hundreds of times per second
+ *         dominate log size and formatting time. The first frame is written as
+ *         usual; identical frames that follow on the same channel are only
+ *         counted (hash, then memcmp). When a different frame arrives, an event
+ *         interrupts the channel or the run is older than --collapse-hold, the
+ *         run is written as one line:
+ *
+ *             12:00:01.234 [RX] == 522x 12:00:00.002 .. 12:00:01.234 | 7E 01 ...
+ *
+ *         i.e. the payload repeated 522 more times between the two timestamps.
+ *         The line carries the payload itself, so each one can be expanded on
+ *         its own; --analyze-file does that.
+ *
+ * @author Patrik Neunteufel
+ * @date   Oct 2026
+ ****************************************************************************************
+ */
+#pragma once
+
+#include "UART.hpp"
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace uart_listener
+{
+    struct CollapseOptions
+    {
+        bool     enabled = false;
+        uint32_t holdMs = 1000;   // longest run before its line is written
+    };
+
+    /**
+     * @brief A finished run of repeats (not counting the frame written before it).
+     */
+    struct RepeatRun
+    {
+        Channel              channel = Channel::RX;
+        uint64_t             count = 0;
+        std::string          first;      // timestamp of the first repeat
+        std::string          last;       // timestamp of the last repeat
+        std::vector<uint8_t> data;
+        bool                 console = false;
+        bool                 log = false;
+    };
+
+    /** @brief 64-bit FNV-1a over 8-byte words; equal hashes are confirmed with memcmp. */
+    uint64_t frameHash(const uint8_t* data, size_t size);
+
+    class RepeatCollapser
+    {
+    public:
+        using Clock = std::chrono::steady_clock;
+
+        explicit RepeatCollapser(const CollapseOptions& options);
+
+        /**
+         * @brief A data packet is about to be formatted.
+         * @param console, log Where its line would go; a repeat must go to the same places
+         * @return true if it repeats the channel's last frame and was counted.
+         *         Otherwise it becomes the channel's last frame; a run it ends is
+         *         available from takeRun() and has to be written before it.
+         */
+        bool repeat(const Packet& pkt, bool console, bool log, Clock::time_point now);
+
+        /** @brief End the open run of a channel (before an event line). */
+        void close(Channel channel);
+
+        /** @brief End runs older than the hold time; all of them with all = true. */
+        void poll(Clock::time_point now, bool all = false);
+
+        /** @brief Next ended run, in the order they ended. */
+        bool takeRun(RepeatRun& run);
+
+        uint64_t framesCollapsed() const noexcept { return m_framesCollapsed; }
+        uint64_t runsWritten() const noexcept { return m_runsWritten; }
+
+    private:
+        struct ChannelState
+        {
+            bool                 known = false;
+            uint64_t             hash = 0;
+            std::vector<uint8_t> frame;
+            bool                 console = false;
+            bool                 log = false;
+            RepeatRun            run;            // count == 0: no open run
+            Clock::time_point    runStart{};
+        };
+
+        void end(ChannelState& ch);
+
+        CollapseOptions        m_options;
+        ChannelState           m_channels[2];
+        std::vector<RepeatRun> m_ended;
+        size_t                 m_next = 0;        // first run in m_ended not taken yet
+        uint64_t               m_framesCollapsed = 0;
+        uint64_t               m_runsWritten = 0;
+    };
+}
@@ -0,0 +1,131 @@
+/**
+ ****************************************************************************************
+ * @file   SerialSettings.hpp
+ * @brief  Line settings (baud, framing, flow control) for opening serial ports.
+ *
+ * @author Patrik Neunteufel
+ * @date   Oct 2026
+ ****************************************************************************************
+ */
+#pragma once
+
+#include "Format.hpp"
+
+#include <cstdint>
+#include <string>
+
+namespace uart_listener
+{
+    enum class Parity
+    {
+        None = 0,
+        Odd,
+        Even,
+        Mark,
+        Space,
+        COUNT
+    };
+
+    enum class StopBits
+    {
+        One = 0,
+        OnePointFive,
+        Two,
+        COUNT
+    };
+
+    enum class FlowControl
+    {
+        None = 0,
+        RtsCts,   ///< RTS drops when the driver queue fills (sender must honour it via CTS)
+        DtrDsr,   ///< Same with DTR/DSR
+        COUNT
+    };
+
+    template<>
+    struct FormatMetaTraits<Parity>
+    {
+        static constexpr size_t count = static_cast<size_t>(Parity::COUNT);
+
+        // clang-format off
+        static constexpr std::array<const char*, count> names =
+        {{
+            "none",
+            "odd",
+            "even",
+            "mark",
+            "space"
+        }};
+        // clang-format on
+    };
+
+    template<>
+    struct FormatMetaTraits<StopBits>
+    {
+        static constexpr size_t count = static_cast<size_t>(StopBits::COUNT);
+
+        // clang-format off
+        static constexpr std::array<const char*, count> names =
+        {{
+            "1",
+            "1.5",
+            "2"
+        }};
+        // clang-format on
+    };
+
+    template<>
+    struct FormatMetaTraits<FlowControl>
+    {
+        static constexpr size_t count = static_cast<size_t>(FlowControl::COUNT);
+
+        // clang-format off
+        static constexpr std::array<const char*, count> names =
+        {{
+            "none",
+            "rtscts",
+            "dtrdsr"
+        }};
+        // clang-format on
+    };
+
+    using ParityTraits      = FormatTraitsBase<Parity>;
+    using StopBitsTraits    = FormatTraitsBase<StopBits>;
+    using FlowControlTraits = FormatTraitsBase<FlowControl>;
+
+    struct SerialSettings
+    {
+        uint32_t    baudRate = 115200;
+        uint8_t     dataBits = 8;
+        Parity      parity = Parity::None;
+        StopBits    stopBits = StopBits::One;
+        FlowControl flowControl = FlowControl::None;
+        uint32_t    inQueueSize = 64 * 1024;  // SetupComm input queue (bytes)
+
+        /**
+         * @brief Bits on the wire per character (start + data + parity + stop).
+         *
+         * 1.5 stop bits are counted as 2; only used for bus utilisation and pacing.
+         */
+        uint32_t bitsPerChar() const noexcept
+        {
+            return 1u + dataBits + (parity != Parity::None ? 1u : 0u) + (stopBits == StopBits::One ? 1u : 2u);
+        }
+
+        /**
+         * @brief Short form, e.g. "921600 8E1, flow rtscts".
+         */
+        std::string describe() const
+        {
+            static constexpr char kParity[] = { 'N', 'O', 'E', 'M', 'S' };
+
+            std::string text = std::to_string(baudRate) + " " + std::to_string(dataBits)
+                             + kParity[static_cast<size_t>(parity)] + StopBitsTraits::toString(stopBits);
+            if (flowControl != FlowControl::None)
+            {
+                text += std::string(", flow ") + FlowControlTraits::toString(flowControl);
+            }
+            return text;
+        }
+    };
+}
@@ -0,0 +1,180 @@
+/**
+ ****************************************************************************************
+ * @file   ShmRing.cpp
+ * @brief  Shared-memory packet ring writer.
+ *
+ * @author Patrik Neunteufel
+ * @date   Oct 2026
+ ****************************************************************************************
+ */
+#include "ShmRing.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <new>
+
+namespace uart_listener
+{
+    ShmRingWriter::~ShmRingWriter()
+    {
+        close();
+    }
+
+    bool ShmRingWriter::create(const std::string& name, size_t capacity, const SerialSettings& serial)
+    {
+        close();
+
+        const uint64_t dataSize = std::bit_ceil(std::max<uint64_t>(capacity, 64 * 1024));
+        const uint64_t mappingSize = sizeof(shm::RingHeader) + dataSize;
+        const std::string objectName = shm::mappingName(name);
+
+        m_mapping = CreateFileMappingA(INVALID_HANDLE_VALUE, nullptr, PAGE_READWRITE,
+                                       static_cast<DWORD>(mappingSize >> 32),
+                                       static_cast<DWORD>(mappingSize & 0xFFFFFFFF),
+                                       objectName.c_str());
+        if (m_mapping == NULL)
+        {
+            std::cerr << "Error creating shared memory " << objectName
+                      << " (Error code: " << GetLastError() << ")\n";
+            return false;
+        }
+        if (GetLastError() == ERROR_ALREADY_EXISTS)
+        {
+            // Another capture owns this name; two writers would corrupt the ring
+            std::cerr << "Error: shared memory " << objectName << " is already in use\n";
+            CloseHandle(m_mapping);
+            m_mapping = NULL;
+            return false;
+        }
+
+        void* view = MapViewOfFile(m_mapping, FILE_MAP_ALL_ACCESS, 0, 0, 0);
+        if (view == nullptr)
+        {
+            std::cerr << "Error mapping shared memory " << objectName
+                      << " (Error code: " << GetLastError() << ")\n";
+            CloseHandle(m_mapping);
+            m_mapping = NULL;
+            return false;
+        }
+
+        // Fresh mappings are zero filled; readers check magic last
+        m_header = new (view) shm::RingHeader();
+        m_header->version = shm::kVersion;
+        m_header->headerSize = static_cast<uint16_t>(sizeof(shm::RingHeader));
+        m_header->capacity = dataSize;
+        m_header->maxRecordPayload = static_cast<uint32_t>(dataSize / 4);
+        m_header->baudRate = serial.baudRate;
+        m_header->bitsPerChar = serial.bitsPerChar();
+        m_header->writerProcessId = GetCurrentProcessId();
+        std::atomic_thread_fence(std::memory_order_release);
+        m_header->magic = shm::kMagic;
+
+        m_data = static_cast<uint8_t*>(view) + sizeof(shm::RingHeader);
+        m_mask = dataSize - 1;
+        m_writePos = 0;
+        m_sequence = 0;
+        return true;
+    }
+
+    void ShmRingWriter::publish(const Packet& pkt)
+    {
+        if (m_header == nullptr)
+        {
+            return;
+        }
+
+        // Packets carry a steady_clock read time; readers want wall clock time
+        const auto    sinceRead = std::chrono::steady_clock::now() - pkt.readTime;
+        const auto    wallTime = std::chrono::system_clock::now() - sinceRead;
+        const int64_t unixTimeUs = std::chrono::duration_cast<std::chrono::microseconds>(
+                                       wallTime.time_since_epoch()).count();
+        const uint8_t channel = static_cast<uint8_t>(pkt.channel);
+
+        switch (pkt.kind)
+        {
+        case PacketKind::LineError:
+            writeRecord(shm::RecordKind::LineError, channel, pkt.lineErrors, unixTimeUs, nullptr, 0);
+            return;
+        case PacketKind::Disconnect:
+            writeRecord(shm::RecordKind::Disconnect, channel, pkt.systemError, unixTimeUs, nullptr, 0);
+            return;
+        case PacketKind::Reconnect:
+            writeRecord(shm::RecordKind::Reconnect, channel, pkt.outageMs, unixTimeUs, nullptr, 0);
+            return;
+        default:
+            break;
+        }
+
+        const size_t maxPayload = m_header->maxRecordPayload;
+        size_t       offset = 0;
+        do
+        {
+            const size_t chunk = std::min(pkt.data.size() - offset, maxPayload);
+            writeRecord(shm::RecordKind::Data, channel, 0, unixTimeUs,
+                        pkt.data.data() + offset, static_cast<uint32_t>(chunk));
+            offset += chunk;
+        } while (offset < pkt.data.size());
+    }
+
+    void ShmRingWriter::writeRecord(shm::RecordKind kind, uint8_t channel, uint32_t info, int64_t unixTimeUs,
+                                    const uint8_t* data, uint32_t size)
+    {
+        const uint64_t capacity = m_mask + 1;
+        const uint64_t recordSize = shm::alignRecord(sizeof(shm::RecordHeader) + size);
+
+        uint64_t       pos = m_writePos;
+        const uint64_t tail = capacity - (pos & m_mask);
+        const uint64_t skip = (tail < recordSize) ? tail : 0;  // records never wrap
+        const uint64_t end = pos + skip + recordSize;
+
+        // Announce the overwrite before touching any byte a reader may be copying
+        m_header->reservePos.store(end, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+
+        if (skip >= sizeof(shm::RecordHeader))
+        {
+            shm::RecordHeader pad{};
+            pad.size = static_cast<uint32_t>(skip - sizeof(shm::RecordHeader));
+            pad.kind = static_cast<uint8_t>(shm::RecordKind::Padding);
+            std::memcpy(m_data + (pos & m_mask), &pad, sizeof(pad));
+        }
+        pos += skip;
+
+        shm::RecordHeader header{};
+        header.size = size;
+        header.kind = static_cast<uint8_t>(kind);
+        header.channel = channel;
+        header.info = info;
+        header.unixTimeUs = unixTimeUs;
+        header.sequence = m_sequence++;
+
+        uint8_t* dst = m_data + (pos & m_mask);
+        std::memcpy(dst, &header, sizeof(header));
+        if (size > 0)
+        {
+            std::memcpy(dst + sizeof(header), data, size);
+        }
+
+        m_writePos = end;
+        m_header->writePos.store(end, std::memory_order_release);
+    }
+
+    void ShmRingWriter::close()
+    {
+        if (m_header != nullptr)
+        {
+            m_header->closed.store(1, std::memory_order_release);
+            UnmapViewOfFile(m_header);
+            m_header = nullptr;
+            m_data = nullptr;
+        }
+        if (m_mapping != NULL)
+        {
+            CloseHandle(m_mapping);
+            m_mapping = NULL;
+        }
+    }
+}
@@ -0,0 +1,58 @@
+/**
+ ****************************************************************************************
+ * @file   ShmRing.hpp
+ * @brief  Export of captured packets into a named shared-memory ring (--shm).
+ *
+ *         Other processes (decoders, dashboards) read the ring with
+ *         ShmRingReader.hpp instead of tailing the log file. The writer never
+ *         blocks on readers; a reader that falls behind loses data, not capture.
+ *
+ * @author Patrik Neunteufel
+ * @date   Oct 2026
+ ****************************************************************************************
+ */
+#pragma once
+
+#include "SerialSettings.hpp"
+#include "ShmRingLayout.hpp"
+#include "UART.hpp"
+
+#include <string>
+
+namespace uart_listener
+{
+    class ShmRingWriter
+    {
+    public:
+        ShmRingWriter() = default;
+        ~ShmRingWriter();
+
+        ShmRingWriter(const ShmRingWriter&) = delete;
+        ShmRingWriter& operator=(const ShmRingWriter&) = delete;
+
+        /**
+         * @brief Create the mapping "Local\uart_listener.NAME".
+         * @param capacity Data area size; rounded up to a power of two (min 64 KB)
+         */
+        bool create(const std::string& name, size_t capacity, const SerialSettings& serial);
+
+        bool isOpen() const noexcept { return m_header != nullptr; }
+
+        /** @brief Append a packet (data or event); never blocks. */
+        void publish(const Packet& pkt);
+
+        /** @brief Mark the ring closed for readers and unmap it. */
+        void close();
+
+    private:
+        void writeRecord(shm::RecordKind kind, uint8_t channel, uint32_t info, int64_t unixTimeUs,
+                         const uint8_t* data, uint32_t size);
+
+        HANDLE            m_mapping = NULL;
+        shm::RingHeader*  m_header = nullptr;
+        uint8_t*          m_data = nullptr;
+        uint64_t          m_mask = 0;
+        uint64_t          m_writePos = 0;
+        uint64_t          m_sequence = 0;
+    };
+}
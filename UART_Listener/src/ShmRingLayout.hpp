@@ -0,0 +1,83 @@
+/**
+ ****************************************************************************************
+ * @file   ShmRingLayout.hpp
+ * @brief  Memory layout of the shared-memory packet ring (--shm).
+ *
+ *         Shared by the writer in UART Listener and by external readers; depends
+ *         only on the standard library. One writer appends variable length
+ *         records to a byte ring and never waits for readers. Readers keep their
+ *         own position and detect being overtaken with a seqlock style check:
+ *
+ *           writer:  reservePos = end; fence(release); copy record; writePos = end (release)
+ *           reader:  writePos (acquire); copy record; fence(acquire); reservePos - readPos <= capacity ?
+ *
+ *         Records never wrap; a Padding record (or, if fewer than
+ *         sizeof(RecordHeader) bytes remain, nothing) fills the end of the ring.
+ *
+ * @author Patrik Neunteufel
+ * @date   Oct 2026
+ ****************************************************************************************
+ */
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace uart_listener::shm
+{
+    constexpr uint32_t kMagic = 0x54524155;  // "UART"
+    constexpr uint16_t kVersion = 1;
+    constexpr size_t   kRecordAlign = 8;
+
+    /// Kernel object name of the file mapping for a --shm NAME
+    inline std::string mappingName(const std::string& name)
+    {
+        return "Local\\uart_listener." + name;
+    }
+
+    enum class RecordKind : uint8_t
+    {
+        Data = 0,     // payload = captured bytes
+        LineError,    // info = line_error flags
+        Disconnect,   // info = Win32 error code
+        Reconnect,    // info = outage in ms
+        Padding = 0xFF
+    };
+
+    struct RecordHeader
+    {
+        uint32_t size;        // payload bytes following the header
+        uint8_t  kind;        // RecordKind
+        uint8_t  channel;     // 0 = RX, 1 = TX
+        uint16_t reserved;
+        uint32_t info;        // see RecordKind
+        uint32_t reserved2;
+        int64_t  unixTimeUs;  // read time, microseconds since 1970-01-01 UTC
+        uint64_t sequence;    // per ring, gaps mean the reader was overtaken
+    };
+    static_assert(sizeof(RecordHeader) == 32);
+
+    struct alignas(64) RingHeader
+    {
+        uint32_t magic;
+        uint16_t version;
+        uint16_t headerSize;        // sizeof(RingHeader); data starts here
+        uint64_t capacity;          // data area bytes, power of two
+        uint32_t maxRecordPayload;  // larger packets are split into several records
+        uint32_t baudRate;
+        uint32_t bitsPerChar;
+        uint32_t writerProcessId;
+        std::atomic<uint32_t> closed;  // 1 once the capture has ended
+
+        alignas(64) std::atomic<uint64_t> reservePos;  // end of the record being written
+        std::atomic<uint64_t> writePos;                // end of the last complete record
+    };
+    static_assert(std::atomic<uint64_t>::is_always_lock_free);
+
+    constexpr uint64_t alignRecord(uint64_t bytes)
+    {
+        return (bytes + kRecordAlign - 1) & ~uint64_t{ kRecordAlign - 1 };
+    }
+}
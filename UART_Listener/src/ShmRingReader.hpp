@@ -0,0 +1,201 @@
+/**
+ ****************************************************************************************
+ * @file   ShmRingReader.hpp
+ * @brief  Header-only reader for the shared-memory packet ring (--shm).
+ *
+ *         Clients need only this file and ShmRingLayout.hpp. Readers map the
+ *         ring read-only and tail it from the current write position; they can
+ *         never stall the capture. A reader that is overtaken by the writer
+ *         skips ahead and reports the skipped bytes.
+ *
+ *         ShmRingReader reader;
+ *         reader.open("bus1");
+ *         for (;;)
+ *         {
+ *             switch (reader.next(record, payload))
+ *             {
+ *             case ShmReadStatus::Record:  ... break;
+ *             case ShmReadStatus::Empty:   Sleep(1); break;
+ *             case ShmReadStatus::Overrun: ... reader.lostBytes() ... break;
+ *             case ShmReadStatus::Closed:  return;
+ *             }
+ *         }
+ *
+ * @author Patrik Neunteufel
+ * @date   Oct 2026
+ ****************************************************************************************
+ */
+#pragma once
+
+#include "ShmRingLayout.hpp"
+
+#include <cstring>
+#include <string>
+#include <vector>
+#include <windows.h>
+
+namespace uart_listener
+{
+    enum class ShmReadStatus
+    {
+        Record,   // record and payload filled in
+        Empty,    // nothing new yet; poll again
+        Overrun,  // writer overtook this reader; resumed at the newest record
+        Closed    // capture ended and everything has been read
+    };
+
+    class ShmRingReader
+    {
+    public:
+        ShmRingReader() = default;
+        ~ShmRingReader() { close(); }
+
+        ShmRingReader(const ShmRingReader&) = delete;
+        ShmRingReader& operator=(const ShmRingReader&) = delete;
+
+        /**
+         * @brief Attach to the ring of a running capture ("--shm NAME").
+         * @return false if no such capture runs or the layout version differs
+         */
+        bool open(const std::string& name)
+        {
+            close();
+
+            m_mapping = OpenFileMappingA(FILE_MAP_READ, FALSE, shm::mappingName(name).c_str());
+            if (m_mapping == NULL)
+            {
+                return false;
+            }
+
+            void* view = MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0);
+            if (view == nullptr)
+            {
+                close();
+                return false;
+            }
+            m_view = view;
+            m_header = static_cast<const shm::RingHeader*>(view);
+
+            if (m_header->magic != shm::kMagic || m_header->version != shm::kVersion)
+            {
+                close();
+                return false;
+            }
+            std::atomic_thread_fence(std::memory_order_acquire);
+
+            m_data = static_cast<const uint8_t*>(view) + m_header->headerSize;
+            m_capacity = m_header->capacity;
+            m_readPos = m_header->writePos.load(std::memory_order_acquire);
+            m_lostBytes = 0;
+            return true;
+        }
+
+        void close()
+        {
+            if (m_view != nullptr)
+            {
+                UnmapViewOfFile(m_view);
+                m_view = nullptr;
+                m_header = nullptr;
+            }
+            if (m_mapping != NULL)
+            {
+                CloseHandle(m_mapping);
+                m_mapping = NULL;
+            }
+        }
+
+        bool isOpen() const noexcept { return m_header != nullptr; }
+
+        /** @brief Ring header (baud rate, bits per char, capacity). */
+        const shm::RingHeader* header() const noexcept { return m_header; }
+
+        /** @brief Bytes skipped because the writer overtook this reader. */
+        uint64_t lostBytes() const noexcept { return m_lostBytes; }
+
+        /**
+         * @brief Fetch the next record; padding is skipped internally.
+         * @param record  Receives the record header
+         * @param payload Receives a copy of the payload (resized)
+         */
+        ShmReadStatus next(shm::RecordHeader& record, std::vector<uint8_t>& payload)
+        {
+            for (;;)
+            {
+                const uint64_t writePos = m_header->writePos.load(std::memory_order_acquire);
+                if (m_readPos == writePos)
+                {
+                    return m_header->closed.load(std::memory_order_acquire) ? ShmReadStatus::Closed
+                                                                             : ShmReadStatus::Empty;
+                }
+                if (overtaken())
+                {
+                    return resync();
+                }
+
+                const uint64_t offset = m_readPos & (m_capacity - 1);
+                const uint64_t tail = m_capacity - offset;
+                if (tail < sizeof(shm::RecordHeader))
+                {
+                    m_readPos += tail;
+                    continue;
+                }
+
+                std::memcpy(&record, m_data + offset, sizeof(record));
+                const bool     padding = (record.kind == static_cast<uint8_t>(shm::RecordKind::Padding));
+                const uint64_t recordSize = padding ? tail : shm::alignRecord(sizeof(record) + record.size);
+                if (!padding && (record.size > m_header->maxRecordPayload || recordSize > tail))
+                {
+                    return resync();  // torn header; its size must not be trusted for the copy
+                }
+
+                if (!padding)
+                {
+                    payload.resize(record.size);
+                    if (record.size > 0)
+                    {
+                        std::memcpy(payload.data(), m_data + offset + sizeof(record), record.size);
+                    }
+                }
+
+                // The copy is only valid if the writer has not started overwriting it since:
+                // neither overtaken nor a different header in the slot now
+                std::atomic_thread_fence(std::memory_order_acquire);
+                shm::RecordHeader again;
+                std::memcpy(&again, m_data + offset, sizeof(again));
+                if (overtaken() || again.sequence != record.sequence || again.size != record.size)
+                {
+                    return resync();
+                }
+
+                m_readPos += recordSize;
+                if (!padding)
+                {
+                    return ShmReadStatus::Record;
+                }
+            }
+        }
+
+    private:
+        bool overtaken() const noexcept
+        {
+            return m_header->reservePos.load(std::memory_order_relaxed) - m_readPos > m_capacity;
+        }
+
+        ShmReadStatus resync() noexcept
+        {
+            const uint64_t writePos = m_header->writePos.load(std::memory_order_acquire);
+            m_lostBytes += writePos - m_readPos;
+            m_readPos = writePos;
+            return ShmReadStatus::Overrun;
+        }
+
+        HANDLE                 m_mapping = NULL;
+        void*                  m_view = nullptr;
+        const shm::RingHeader* m_header = nullptr;
+        const uint8_t*         m_data = nullptr;
+        uint64_t               m_capacity = 0;
+        uint64_t               m_readPos = 0;
+        uint64_t               m_lostBytes = 0;
+    };
+}
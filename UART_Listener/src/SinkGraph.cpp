@@ -0,0 +1,446 @@
+/**
+ ****************************************************************************************
+ * @file   SinkGraph.cpp
+ * @brief  Additional output files, each with its own channel, format and decoder (--sink).
+ *
+ * @author Patrik Neunteufel
+ * @date   Oct 2026
+ ****************************************************************************************
+ */
+
+#include "SinkGraph.hpp"
+#include "Generator.hpp"
+#include "LogLine.hpp"
+#include "Trace.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cstdio>
+#include <functional>
+#include <iostream>
+
+namespace uart_listener
+{
+    namespace
+    {
+        std::string hexByte(uint8_t b)
+        {
+            char buf[8];
+            std::snprintf(buf, sizeof(buf), "0x%02X", b);
+            return buf;
+        }
+
+        std::string lower(std::string s)
+        {
+            std::transform(s.begin(), s.end(), s.begin(), [](unsigned char c) {
+                return static_cast<char>(std::tolower(c));
+            });
+            return s;
+        }
+    }
+
+    bool parseSinkSpec(const std::string& text, SinkSpec& spec, std::string& error)
+    {
+        // KIND:PATH[,key=value]...; the path may contain ':' (C:\...) but no ','
+        const size_t colon = text.find(':');
+        const auto   kind = SinkKindTraits::fromString(text.substr(0, colon));
+        if (colon == std::string::npos || !kind.has_value())
+        {
+            error = "use log:PATH[,options], raw:PATH[,options] or col:PATH[,options]";
+            return false;
+        }
+        spec = SinkSpec();
+        spec.kind = *kind;
+
+        const size_t comma = text.find(',', colon + 1);
+        spec.path = text.substr(colon + 1, comma - colon - 1);
+        if (spec.path.empty())
+        {
+            error = "missing file path";
+            return false;
+        }
+
+        size_t pos = comma;
+        while (pos != std::string::npos)
+        {
+            const size_t      next = text.find(',', pos + 1);
+            const std::string option = text.substr(pos + 1, next - pos - 1);
+            const size_t      eq = option.find('=');
+            const std::string key = lower(option.substr(0, eq));
+            const std::string value = (eq == std::string::npos) ? std::string() : option.substr(eq + 1);
+            pos = next;
+
+            if (key == "ch" || key == "channel")
+            {
+                const std::string ch = lower(value);
+                spec.rx = (ch == "rx" || ch == "both");
+                spec.tx = (ch == "tx" || ch == "both");
+                if (!spec.rx && !spec.tx)
+                {
+                    error = "ch must be rx, tx or both";
+                    return false;
+                }
+                continue;
+            }
+            if (spec.kind != SinkKind::Log)
+            {
+                error = std::string(SinkKindTraits::toString(spec.kind)) + " sinks take only ch=";
+                return false;
+            }
+
+            if (key == "format")
+            {
+                spec.format = OutputFormatTraits::fromString(value);
+                if (!spec.format.has_value())
+                {
+                    error = "format must be ascii, hex, c-escape or raw";
+                    return false;
+                }
+            }
+            else if (key == "log-format")
+            {
+                spec.logFormat = LogFormatTraits::fromString(value);
+                if (!spec.logFormat.has_value())
+                {
+                    error = "log-format must be text, csv or sqlite";
+                    return false;
+                }
+                if (*spec.logFormat == LogFormat::Sqlite && !sqliteAvailable())
+                {
+                    error = "this build has no SQLite support";
+                    return false;
+                }
+            }
+            else if (key == "decode")
+            {
+                const auto decoder = SinkDecoderTraits::fromString(value);
+                if (!decoder.has_value())
+                {
+                    error = "decode must be none or modbus";
+                    return false;
+                }
+                spec.decoder = *decoder;
+            }
+            else
+            {
+                error = "unknown option '" + option + "' (ch, format, log-format, decode)";
+                return false;
+            }
+        }
+        return true;
+    }
+
+    std::string decodeFrame(SinkDecoder decoder, const uint8_t* data, size_t size)
+    {
+        if (decoder != SinkDecoder::Modbus)
+        {
+            return std::string();
+        }
+
+        // RTU frame: address, function, data, CRC-16 low byte first
+        if (size < 4)
+        {
+            return "modbus short frame";
+        }
+        const uint16_t crc = static_cast<uint16_t>(data[size - 2] | (data[size - 1] << 8));
+        const bool     crcOk = (modbusCrc16(data, size - 2) == crc);
+
+        std::string out = "modbus addr " + std::to_string(data[0]) + " fn " + hexByte(data[1] & 0x7F);
+        if ((data[1] & 0x80) != 0 && size == 5)
+        {
+            out += " exception " + hexByte(data[2]);
+        }
+        out += crcOk ? " crc ok" : " crc BAD";
+        return out;
+    }
+
+    SinkGraph::Sink::Sink(const SinkSpec& spec, OutputFormat format, LogFormat logFormat, bool timestamps)
+        : spec(spec),
+          format(spec.format.value_or(format)),
+          logFormat(spec.logFormat.value_or(logFormat)),
+          output(this->format, this->logFormat, timestamps, std::string(), std::string())
+    {
+    }
+
+    SinkGraph::SinkGraph(std::vector<SinkSpec> specs, OutputFormat format, LogFormat logFormat, bool timestamps,
+                         const FileWriterOptions& writer, uint32_t flushMs)
+        : m_writer(writer), m_flushMs(std::max<uint32_t>(1, flushMs)), m_timestamps(timestamps), m_durable(writer.durableMs != 0)
+    {
+        // Sink files are flushed on their own thread; group commit covers the main files only
+        m_writer.durableMs = 0;
+        for (const auto& spec : specs)
+        {
+            m_sinks.push_back(std::make_unique<Sink>(spec, format, logFormat, timestamps));
+        }
+    }
+
+    SinkGraph::~SinkGraph()
+    {
+        stop();
+    }
+
+    bool SinkGraph::start(const std::string& ports, const SerialSettings& serial, const std::string& startTime)
+    {
+        const auto closeAll = [&]() {
+            for (auto& other : m_sinks)
+            {
+                other->file.close();
+                other->db.close();
+                other->col.close();
+            }
+        };
+
+        for (auto& sink : m_sinks)
+        {
+            const char* channels = (sink->spec.rx && sink->spec.tx) ? "both" : (sink->spec.rx ? "RX" : "TX");
+            if (sink->spec.kind == SinkKind::Log && sink->logFormat == LogFormat::Sqlite)
+            {
+                // Payloads are stored as bytes; the format does not apply
+                const std::vector<std::string> notes = {
+                    std::string("Sink: channels ") + channels + ", decode "
+                    + SinkDecoderTraits::toString(sink->spec.decoder)
+                };
+                if (!sink->db.open(sink->spec.path, ports, serial, startTime, notes, m_durable))
+                {
+                    closeAll();
+                    return false;
+                }
+                continue;
+            }
+
+            if (sink->spec.kind == SinkKind::Columnar)
+            {
+                if (!sink->col.open(sink->spec.path, m_writer, ports, serial, startTime))
+                {
+                    closeAll();
+                    return false;
+                }
+                continue;
+            }
+
+            const bool text = (sink->spec.kind == SinkKind::Log);
+            if (!sink->file.open(sink->spec.path, m_writer, text))
+            {
+                std::cerr << "Error creating sink file: " << sink->spec.path << "\n";
+                closeAll();
+                return false;
+            }
+            if (!text)
+            {
+                continue;
+            }
+
+            std::vector<std::string> notes = {
+                std::string("Sink: channels ") + channels + ", format " + OutputFormatTraits::toString(sink->format)
+                + ", decode " + SinkDecoderTraits::toString(sink->spec.decoder)
+            };
+
+            // The decoder adds a CSV column; the comment lines stay the same
+            const bool decodedCsv = (sink->logFormat == LogFormat::Csv && sink->spec.decoder != SinkDecoder::None);
+            writeLogHeader(sink->file, decodedCsv ? LogFormat::Text : sink->logFormat, ports, serial, startTime, notes);
+            if (decodedCsv)
+            {
+                sink->file << "Timestamp;Channel;Data;Decoded\n";
+            }
+        }
+
+        for (size_t i = 0; i < m_sinks.size(); ++i)
+        {
+            Sink& sink = *m_sinks[i];
+            sink.threadName = "sink " + std::to_string(i + 1);
+            sink.thread = std::thread(&SinkGraph::run, this, std::ref(sink));
+        }
+        m_started = true;
+        return true;
+    }
+
+    void SinkGraph::publish(const std::shared_ptr<const Packet>& pkt)
+    {
+        UART_TRACE_SCOPE("sink.publish");
+        for (auto& sinkPtr : m_sinks)
+        {
+            Sink& sink = *sinkPtr;
+            const bool wanted = (pkt->channel == Channel::RX) ? sink.spec.rx : sink.spec.tx;
+            if (!wanted || (sink.spec.kind == SinkKind::Raw && pkt->kind != PacketKind::Data)
+                || (sink.spec.filter.has_value() && pkt->kind == PacketKind::Data && !sink.spec.filter->matches(*pkt)))
+            {
+                continue;
+            }
+
+            std::unique_lock<std::mutex> lock(sink.mutex);
+            if (sink.queue.size() >= kQueueDepth)
+            {
+                ++sink.waits;
+                sink.space.wait(lock, [&]() { return sink.queue.size() < kQueueDepth; });
+            }
+            const bool wasEmpty = sink.queue.empty();
+            sink.queue.push_back(pkt);
+            lock.unlock();
+            if (wasEmpty)
+            {
+                sink.wake.notify_one();
+            }
+        }
+    }
+
+    void SinkGraph::run(Sink& sink)
+    {
+        UART_TRACE_THREAD_NAME(sink.threadName.c_str());
+        std::deque<std::shared_ptr<const Packet>> batch;
+        auto                                      lastFlush = std::chrono::steady_clock::now();
+        bool                                      unflushed = false;
+        const std::chrono::milliseconds           interval(sink.spec.commitMs != 0 ? sink.spec.commitMs : m_flushMs);
+
+        for (;;)
+        {
+            bool stopping = false;
+            {
+                // Nothing to flush: sleep until packets arrive instead of waking every interval
+                std::unique_lock<std::mutex> lock(sink.mutex);
+                const auto                   ready = [&]() { return !sink.queue.empty() || sink.stopping; };
+                if (unflushed)
+                {
+                    sink.wake.wait_for(lock, interval, ready);
+                }
+                else
+                {
+                    sink.wake.wait(lock, ready);
+                }
+                batch.swap(sink.queue);
+                stopping = sink.stopping;
+            }
+            sink.space.notify_one();
+
+            for (const auto& pkt : batch)
+            {
+                write(sink, *pkt);
+            }
+            unflushed = unflushed || !batch.empty();
+            batch.clear();
+
+            // SQLite: one transaction per flush interval, split only when it gets very large
+            const auto now = std::chrono::steady_clock::now();
+            if (unflushed
+                && (stopping || now - lastFlush >= interval
+                    || sink.db.pending() >= SqliteLog::kCommitRows))
+            {
+                UART_TRACE_SCOPE("sink.flush");
+                bool waiting = false;   // col: rows held back for a fuller block
+                if (sink.db.is_open())
+                {
+                    sink.db.commit();
+                }
+                else if (sink.col.is_open())
+                {
+                    waiting = !sink.col.flush(now);
+                }
+                else
+                {
+                    sink.file.flush();
+                }
+                lastFlush = now;
+                unflushed = waiting;
+            }
+            if (stopping)
+            {
+                std::lock_guard<std::mutex> lock(sink.mutex);
+                if (sink.queue.empty())
+                {
+                    break;
+                }
+            }
+        }
+    }
+
+    void SinkGraph::write(Sink& sink, const Packet& pkt)
+    {
+        UART_TRACE_SCOPE("sink.write");
+        ++sink.packets;
+        sink.bytes += pkt.data.size();
+
+        if (sink.spec.kind == SinkKind::Raw)
+        {
+            sink.file.write(reinterpret_cast<const char*>(pkt.data.data()), static_cast<std::streamsize>(pkt.data.size()));
+            return;
+        }
+        if (sink.col.is_open())
+        {
+            sink.col.append(pkt);
+            return;
+        }
+        if (sink.db.is_open())
+        {
+            const bool decode = (sink.spec.decoder != SinkDecoder::None && pkt.kind == PacketKind::Data);
+            sink.db.append(pkt, decode ? decodeFrame(sink.spec.decoder, pkt.data.data(), pkt.data.size())
+                                       : std::string());
+            return;
+        }
+        const bool data = pkt.kind == PacketKind::Data;
+        if (data)
+        {
+            sink.output.format(pkt, false, true);
+        }
+        else
+        {
+            sink.output.formatEvent(pkt, eventMessage(pkt), false, false, true);
+        }
+        const std::string& line = sink.output.logLine();
+        if (sink.spec.decoder == SinkDecoder::None)
+        {
+            sink.file.write(line.data(), static_cast<std::streamsize>(line.size()));
+            return;
+        }
+
+        // Decoded text goes before the line end: " | ..." in text logs, a column in CSV;
+        // events keep the column empty so every row has the same shape
+        sink.file.write(line.data(), static_cast<std::streamsize>(line.size() - 1));
+        sink.file << (sink.logFormat == LogFormat::Csv ? ";" : " | ")
+                  << (data ? decodeFrame(sink.spec.decoder, pkt.data.data(), pkt.data.size()) : std::string()) << "\n";
+    }
+
+    void SinkGraph::stop()
+    {
+        if (!m_started)
+        {
+            return;
+        }
+        for (auto& sink : m_sinks)
+        {
+            {
+                std::lock_guard<std::mutex> lock(sink->mutex);
+                sink->stopping = true;
+            }
+            sink->wake.notify_one();
+        }
+        for (auto& sink : m_sinks)
+        {
+            if (sink->thread.joinable())
+            {
+                sink->thread.join();
+            }
+            sink->file.close();
+            sink->db.close();
+            sink->col.close();
+        }
+        m_started = false;
+    }
+
+    void SinkGraph::writeSummary(std::ostream& out) const
+    {
+        for (const auto& sink : m_sinks)
+        {
+            out << "[INFO] Sink " << SinkKindTraits::toString(sink->spec.kind) << ":" << sink->spec.path << ": "
+                << sink->packets << " packets, " << sink->bytes << " bytes";
+            if (sink->db.errors() != 0)
+            {
+                out << ", " << sink->db.errors() << " SQLite errors";
+            }
+            if (sink->waits != 0)
+            {
+                out << ", capture waited " << sink->waits << "x for this sink";
+            }
+            out << "\n";
+        }
+    }
+}
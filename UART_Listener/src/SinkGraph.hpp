@@ -0,0 +1,199 @@
+/**
+ ****************************************************************************************
+ * @file   SinkGraph.hpp
+ * @brief  Additional output files, each with its own channel, format and decoder (--sink).
+ *
+ *         The main log and the console share --format. A sink is a further log
+ *         or raw file that takes only the packets of its channels and formats
+ *         them its own way, e.g. a hex log next to an ASCII console or an RX-only
+ *         raw dump. Every sink runs on its own thread with a bounded queue. The
+ *         consumer hands each packet to the sinks as one shared, read-only
+ *         buffer; the bytes are never copied per sink.
+ *
+ *         A log sink with log-format=sqlite writes a database instead (SqliteLog);
+ *         its thread inserts the queued packets in large transactions. A col
+ *         sink writes a columnar capture file for --query (ColumnarWriter).
+ *
+ *         SPEC: log:PATH[,ch=rx|tx|both][,format=FMT][,log-format=text|csv|sqlite][,decode=modbus]
+ *               raw:PATH[,ch=rx|tx|both]
+ *               col:PATH[,ch=rx|tx|both]
+ *
+ * @author Patrik Neunteufel
+ * @date   Oct 2026
+ ****************************************************************************************
+ */
+#pragma once
+
+#include "Columnar.hpp"
+#include "FileWriter.hpp"
+#include "Filter.hpp"
+#include "Format.hpp"
+#include "OutputPipeline.hpp"
+#include "SerialSettings.hpp"
+#include "SqliteLog.hpp"
+#include "UART.hpp"
+
+#include <array>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <ostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace uart_listener
+{
+    enum class SinkKind
+    {
+        Log = 0,   ///< Text or CSV lines, like the main log
+        Raw,       ///< Payload bytes only, like --rx-raw-out
+        Columnar,  ///< Column blocks for --query (ColumnarWriter)
+        COUNT
+    };
+
+    template<>
+    struct FormatMetaTraits<SinkKind>
+    {
+        static constexpr size_t count = static_cast<size_t>(SinkKind::COUNT);
+
+        // clang-format off
+        static constexpr std::array<const char*, count> names =
+        {{
+            "log",
+            "raw",
+            "col"
+        }};
+        // clang-format on
+    };
+
+    using SinkKindTraits = FormatTraitsBase<SinkKind>;
+
+    enum class SinkDecoder
+    {
+        None = 0,
+        Modbus,   ///< Modbus RTU: address, function, exception code, CRC check
+        COUNT
+    };
+
+    template<>
+    struct FormatMetaTraits<SinkDecoder>
+    {
+        static constexpr size_t count = static_cast<size_t>(SinkDecoder::COUNT);
+
+        // clang-format off
+        static constexpr std::array<const char*, count> names =
+        {{
+            "none",
+            "modbus"
+        }};
+        // clang-format on
+    };
+
+    using SinkDecoderTraits = FormatTraitsBase<SinkDecoder>;
+
+    struct SinkSpec
+    {
+        SinkKind                    kind = SinkKind::Log;
+        std::string                 path;
+        bool                        rx = true;
+        bool                        tx = true;
+        std::optional<OutputFormat> format;      // unset = --format
+        std::optional<LogFormat>    logFormat;   // unset = --log-format
+        SinkDecoder                 decoder = SinkDecoder::None;
+
+        // Set by main() for a SQLite main log only, not by --sink
+        std::optional<PacketFilter> filter;         // --log-filter; events always pass
+        uint32_t                    commitMs = 0;   // --durable interval; 0 = flushMs
+    };
+
+    /**
+     * @brief Parse one --sink argument.
+     * @param error Reason for a rejected spec
+     */
+    bool parseSinkSpec(const std::string& text, SinkSpec& spec, std::string& error);
+
+    /**
+     * @brief Decoder annotation for a log line, e.g. "modbus addr 1 fn 0x03 crc ok".
+     */
+    std::string decodeFrame(SinkDecoder decoder, const uint8_t* data, size_t size);
+
+    class SinkGraph
+    {
+    public:
+        static constexpr size_t kQueueDepth = 16384;   // packets per sink before the consumer waits
+
+        /**
+         * @param format     Default payload format (--format)
+         * @param logFormat  Default log container (--log-format)
+         * @param writer     File backend; sinks are flushed, not group-committed
+         * @param flushMs    Flush (SQLite: commit) interval of the sink files
+         */
+        SinkGraph(std::vector<SinkSpec> specs, OutputFormat format, LogFormat logFormat, bool timestamps,
+                  const FileWriterOptions& writer, uint32_t flushMs);
+        ~SinkGraph();
+
+        SinkGraph(const SinkGraph&) = delete;
+        SinkGraph& operator=(const SinkGraph&) = delete;
+
+        /**
+         * @brief Open the files, write the log headers and start one thread per sink.
+         * @return false if a file cannot be created; nothing is started then
+         */
+        bool start(const std::string& ports, const SerialSettings& serial, const std::string& startTime);
+
+        bool empty() const noexcept { return m_sinks.empty(); }
+
+        /**
+         * @brief Hand a packet to every sink of its channel (consumer thread).
+         * Waits while a sink is kQueueDepth packets behind.
+         */
+        void publish(const std::shared_ptr<const Packet>& pkt);
+
+        /** @brief Write what is queued, close the files and join the threads. */
+        void stop();
+
+        /** @brief One line per sink: packets, bytes, consumer waits. */
+        void writeSummary(std::ostream& out) const;
+
+    private:
+        struct Sink
+        {
+            Sink(const SinkSpec& spec, OutputFormat format, LogFormat logFormat, bool timestamps);
+
+            SinkSpec       spec;
+            OutputFormat   format;
+            LogFormat      logFormat;
+            OutputPipeline output;
+            CaptureFile    file;
+            SqliteLog      db;             // log-format=sqlite instead of file
+            ColumnarWriter col;            // col sinks instead of file
+            std::string    threadName;
+            std::thread    thread;
+
+            std::mutex                                mutex;
+            std::condition_variable                   wake;         // sink thread: work or stop
+            std::condition_variable                   space;        // consumer: room in the queue
+            std::deque<std::shared_ptr<const Packet>> queue;
+            bool                                      stopping = false;
+
+            // Written by the sink thread, read after join()
+            uint64_t packets = 0;
+            uint64_t bytes = 0;
+            uint64_t waits = 0;   // consumer only
+        };
+
+        void run(Sink& sink);
+        void write(Sink& sink, const Packet& pkt);
+
+        std::vector<std::unique_ptr<Sink>> m_sinks;
+        FileWriterOptions                  m_writer;
+        uint32_t                           m_flushMs;
+        bool                               m_timestamps;
+        bool                               m_durable;      // --durable: SQLite commits with synchronous=FULL
+        bool                               m_started = false;
+    };
+}
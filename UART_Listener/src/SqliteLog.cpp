@@ -0,0 +1,291 @@
+/**
+ ****************************************************************************************
+ * @file   SqliteLog.cpp
+ * @brief  SQLite capture database (--log-format sqlite, --sink log:PATH,log-format=sqlite).
+ *
+ * @author Patrik Neunteufel
+ * @date   Oct 2026
+ ****************************************************************************************
+ */
+
+#include "SqliteLog.hpp"
+#include "LogLine.hpp"
+
+#include <cstdio>
+#include <iostream>
+
+#ifndef UART_WITH_SQLITE
+#if __has_include(<sqlite3.h>)
+#define UART_WITH_SQLITE 1
+#else
+#define UART_WITH_SQLITE 0
+#endif
+#endif
+
+#if UART_WITH_SQLITE
+#include <sqlite3.h>
+#ifdef _MSC_VER
+#pragma comment(lib, "sqlite3.lib")
+#endif
+#endif
+
+namespace uart_listener
+{
+#if UART_WITH_SQLITE
+
+    namespace
+    {
+        const char* const kSchema =
+            "CREATE TABLE capture(key TEXT NOT NULL, value TEXT NOT NULL);"
+            "CREATE TABLE frames("
+            "  id INTEGER PRIMARY KEY,"
+            "  time_us INTEGER NOT NULL,"
+            "  ts TEXT NOT NULL,"
+            "  channel TEXT NOT NULL,"
+            "  length INTEGER NOT NULL,"
+            "  first_byte INTEGER,"
+            "  payload BLOB NOT NULL,"
+            "  decoded TEXT);"
+            "CREATE INDEX frames_time ON frames(time_us);"
+            "CREATE INDEX frames_first_byte ON frames(first_byte, time_us);"
+            "CREATE TABLE events("
+            "  id INTEGER PRIMARY KEY,"
+            "  time_us INTEGER NOT NULL,"
+            "  ts TEXT NOT NULL,"
+            "  channel TEXT NOT NULL,"
+            "  message TEXT NOT NULL);";
+    }
+
+    bool sqliteAvailable()
+    {
+        return true;
+    }
+
+    SqliteLog::~SqliteLog()
+    {
+        close();
+    }
+
+    bool SqliteLog::open(const std::string& path, const std::string& ports, const SerialSettings& serial,
+                         const std::string& startTime, const std::vector<std::string>& notes, bool durable)
+    {
+        close();
+        m_path = path;
+        m_errors = 0;
+
+        // Like the text logs, a new capture replaces the old file
+        for (const char* suffix : { "", "-wal", "-shm" })
+        {
+            std::remove((path + suffix).c_str());
+        }
+
+        if (sqlite3_open_v2(path.c_str(), &m_db, SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE | SQLITE_OPEN_NOMUTEX,
+                            nullptr) != SQLITE_OK)
+        {
+            std::cerr << "Error creating SQLite log: " << path << " ("
+                      << (m_db != nullptr ? sqlite3_errmsg(m_db) : "out of memory") << ")\n";
+            sqlite3_close(m_db);
+            m_db = nullptr;
+            return false;
+        }
+
+        // WAL: commits append to the journal instead of rewriting pages
+        const std::string pragmas =
+            std::string("PRAGMA journal_mode=WAL; PRAGMA synchronous=") + (durable ? "FULL;" : "NORMAL;");
+        if (!exec(pragmas.c_str()) || !exec(kSchema)
+            || sqlite3_prepare_v2(m_db,
+                                  "INSERT INTO frames(time_us, ts, channel, length, first_byte, payload, decoded)"
+                                  " VALUES(?, ?, ?, ?, ?, ?, ?)",
+                                  -1, &m_insertFrame, nullptr) != SQLITE_OK
+            || sqlite3_prepare_v2(m_db, "INSERT INTO events(time_us, ts, channel, message) VALUES(?, ?, ?, ?)", -1,
+                                  &m_insertEvent, nullptr) != SQLITE_OK)
+        {
+            std::cerr << "Error creating SQLite log: " << path << " (" << sqlite3_errmsg(m_db) << ")\n";
+            close();
+            return false;
+        }
+
+        // Same information as the '#' header of a text log
+        std::vector<std::pair<std::string, std::string>> info = {
+            { "started", startTime },
+            { "ports", ports },
+            { "line", serial.describe() },
+        };
+        for (const auto& note : notes)
+        {
+            info.emplace_back("note", note);
+        }
+        sqlite3_stmt* insert = nullptr;
+        if (sqlite3_prepare_v2(m_db, "INSERT INTO capture(key, value) VALUES(?, ?)", -1, &insert, nullptr) != SQLITE_OK)
+        {
+            fail("capture info");
+        }
+        else
+        {
+            for (const auto& [key, value] : info)
+            {
+                sqlite3_bind_text(insert, 1, key.c_str(), -1, SQLITE_STATIC);
+                sqlite3_bind_text(insert, 2, value.c_str(), -1, SQLITE_STATIC);
+                if (sqlite3_step(insert) != SQLITE_DONE)
+                {
+                    fail("capture info");
+                }
+                sqlite3_reset(insert);
+            }
+            sqlite3_finalize(insert);
+        }
+
+        m_steadyStart = std::chrono::steady_clock::now();
+        m_wallStartUs = std::chrono::duration_cast<std::chrono::microseconds>(
+                            std::chrono::system_clock::now().time_since_epoch())
+                            .count();
+        return true;
+    }
+
+    void SqliteLog::append(const Packet& pkt, const std::string& decoded)
+    {
+        if (m_db == nullptr)
+        {
+            return;
+        }
+        if (!m_inTransaction)
+        {
+            if (!exec("BEGIN"))
+            {
+                return;
+            }
+            m_inTransaction = true;
+        }
+
+        const auto    readTime = (pkt.readTime == std::chrono::steady_clock::time_point{})
+                                     ? std::chrono::steady_clock::now()
+                                     : pkt.readTime;
+        const int64_t timeUs =
+            m_wallStartUs + std::chrono::duration_cast<std::chrono::microseconds>(readTime - m_steadyStart).count();
+        const std::string& ts = pkt.timestamp;
+        const char*        channel = channelName(pkt.channel);
+
+        sqlite3_stmt* stmt = nullptr;
+        std::string   message;
+        if (pkt.kind == PacketKind::Data)
+        {
+            stmt = m_insertFrame;
+            const int size = static_cast<int>(pkt.data.size());
+            sqlite3_bind_int64(stmt, 1, timeUs);
+            sqlite3_bind_text(stmt, 2, ts.data(), static_cast<int>(ts.size()), SQLITE_STATIC);
+            sqlite3_bind_text(stmt, 3, channel, -1, SQLITE_STATIC);
+            sqlite3_bind_int(stmt, 4, size);
+            if (size > 0)
+            {
+                sqlite3_bind_int(stmt, 5, pkt.data[0]);
+                sqlite3_bind_blob(stmt, 6, pkt.data.data(), size, SQLITE_STATIC);
+            }
+            else
+            {
+                sqlite3_bind_null(stmt, 5);
+                sqlite3_bind_zeroblob(stmt, 6, 0);
+            }
+            if (decoded.empty())
+            {
+                sqlite3_bind_null(stmt, 7);
+            }
+            else
+            {
+                sqlite3_bind_text(stmt, 7, decoded.data(), static_cast<int>(decoded.size()), SQLITE_STATIC);
+            }
+        }
+        else
+        {
+            stmt = m_insertEvent;
+            message = eventMessage(pkt);
+            sqlite3_bind_int64(stmt, 1, timeUs);
+            sqlite3_bind_text(stmt, 2, ts.data(), static_cast<int>(ts.size()), SQLITE_STATIC);
+            sqlite3_bind_text(stmt, 3, channel, -1, SQLITE_STATIC);
+            sqlite3_bind_text(stmt, 4, message.data(), static_cast<int>(message.size()), SQLITE_STATIC);
+        }
+
+        if (sqlite3_step(stmt) != SQLITE_DONE)
+        {
+            fail("insert");
+        }
+        sqlite3_reset(stmt);
+        ++m_pending;
+    }
+
+    bool SqliteLog::commit()
+    {
+        if (!m_inTransaction)
+        {
+            return true;
+        }
+        m_inTransaction = false;
+        m_pending = 0;
+        return exec("COMMIT");
+    }
+
+    void SqliteLog::close()
+    {
+        if (m_db == nullptr)
+        {
+            return;
+        }
+        commit();
+        sqlite3_finalize(m_insertFrame);
+        sqlite3_finalize(m_insertEvent);
+        m_insertFrame = nullptr;
+        m_insertEvent = nullptr;
+        sqlite3_close(m_db);
+        m_db = nullptr;
+    }
+
+    bool SqliteLog::exec(const char* sql)
+    {
+        if (sqlite3_exec(m_db, sql, nullptr, nullptr, nullptr) != SQLITE_OK)
+        {
+            fail(sql);
+            return false;
+        }
+        return true;
+    }
+
+    void SqliteLog::fail(const char* what)
+    {
+        // A full disk fails every insert; report once, count the rest
+        if (m_errors++ == 0)
+        {
+            std::cerr << "Warning: SQLite log " << m_path << ": " << what << " failed (" << sqlite3_errmsg(m_db)
+                      << "), further errors are only counted\n";
+        }
+    }
+
+#else
+
+    bool sqliteAvailable()
+    {
+        return false;
+    }
+
+    SqliteLog::~SqliteLog() = default;
+
+    bool SqliteLog::open(const std::string& path, const std::string&, const SerialSettings&, const std::string&,
+                         const std::vector<std::string>&, bool)
+    {
+        std::cerr << "Error creating SQLite log: " << path << " (built without SQLite)\n";
+        return false;
+    }
+
+    void SqliteLog::append(const Packet&, const std::string&)
+    {
+    }
+
+    bool SqliteLog::commit()
+    {
+        return false;
+    }
+
+    void SqliteLog::close()
+    {
+    }
+
+#endif
+}
@@ -0,0 +1,99 @@
+/**
+ ****************************************************************************************
+ * @file   SqliteLog.hpp
+ * @brief  SQLite capture database (--log-format sqlite, --sink log:PATH,log-format=sqlite).
+ *
+ *         One row per frame in an indexed table, so captures can be queried
+ *         with SQL instead of converters:
+ *
+ *             frames(id, time_us, ts, channel, length, first_byte, payload, decoded)
+ *             events(id, time_us, ts, channel, message)
+ *             capture(key, value)        -- ports, line settings, start time
+ *
+ *         time_us is the read time in microseconds since the Unix epoch, ts the
+ *         timestamp as shown in text logs. Rows are inserted with prepared
+ *         statements inside large transactions (WAL journal), by the sink
+ *         thread that owns the database. The capture thread only hands rows
+ *         over; it waits only if SQLite falls behind by a full sink queue
+ *         (SinkGraph::kQueueDepth packets), so no row is dropped.
+ *
+ *         SQLite is used when <sqlite3.h> is found at build time (e.g. the vcpkg
+ *         port "sqlite3"); UART_WITH_SQLITE=0 or =1 forces it off or on.
+ *
+ * @author Patrik Neunteufel
+ * @date   Oct 2026
+ ****************************************************************************************
+ */
+#pragma once
+
+#include "SerialSettings.hpp"
+#include "UART.hpp"
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+struct sqlite3;
+struct sqlite3_stmt;
+
+namespace uart_listener
+{
+    /** @brief false if this build has no SQLite. */
+    bool sqliteAvailable();
+
+    class SqliteLog
+    {
+    public:
+        static constexpr size_t kCommitRows = 65536;   // a transaction is committed at the latest here
+
+        SqliteLog() = default;
+        ~SqliteLog();
+
+        SqliteLog(const SqliteLog&) = delete;
+        SqliteLog& operator=(const SqliteLog&) = delete;
+
+        /**
+         * @brief Create the database (an existing file is replaced) with its tables and indexes.
+         * @param notes   Stored in the capture table, one row each
+         * @param durable Commit with synchronous=FULL (--durable) instead of NORMAL
+         */
+        bool open(const std::string& path, const std::string& ports, const SerialSettings& serial,
+                  const std::string& startTime, const std::vector<std::string>& notes, bool durable);
+
+        bool is_open() const noexcept { return m_db != nullptr; }
+
+        /**
+         * @brief Insert a frame or event into the open transaction, begun on demand.
+         * @param decoded Decoder annotation of a frame; empty = NULL
+         */
+        void append(const Packet& pkt, const std::string& decoded);
+
+        /** @brief Rows inserted since the last commit. */
+        size_t pending() const noexcept { return m_pending; }
+
+        /** @brief Commit the open transaction, if any. */
+        bool commit();
+
+        /** @brief Commit, finalize the statements and close. */
+        void close();
+
+        uint64_t errors() const noexcept { return m_errors; }
+
+    private:
+        bool exec(const char* sql);
+        void fail(const char* what);
+
+        sqlite3*      m_db = nullptr;
+        sqlite3_stmt* m_insertFrame = nullptr;
+        sqlite3_stmt* m_insertEvent = nullptr;
+        std::string   m_path;
+        bool          m_inTransaction = false;
+        size_t        m_pending = 0;
+        uint64_t      m_errors = 0;
+
+        // Read times are steady_clock; stored as wall-clock microseconds
+        std::chrono::steady_clock::time_point m_steadyStart{};
+        int64_t                               m_wallStartUs = 0;
+    };
+}
@@ -0,0 +1,605 @@
+/**
+ ****************************************************************************************
+ * @file   StreamServer.cpp
+ * @brief  Localhost TCP fan-out of captured packets to any number of subscribers.
+ *
+ * @author Patrik Neunteufel
+ * @date   Oct 2026
+ ****************************************************************************************
+ */
+
+// Winsock2 must be included before windows.h (pulled in via UART.hpp)
+#include <winsock2.h>
+#include <ws2tcpip.h>
+
+#include "StreamServer.hpp"
+#include "LogLine.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <deque>
+#include <iostream>
+
+#pragma comment(lib, "Ws2_32.lib")
+
+namespace uart_listener
+{
+    namespace
+    {
+        // select() handles FD_SETSIZE (64) sockets; keep room for the listen and wake sockets
+        constexpr size_t kMaxSubscribers = 60;
+        constexpr size_t kMaxBatch = 64;  // WSABUFs per WSASend
+        constexpr auto   kRequestWindow = std::chrono::milliseconds(100);
+
+        /** Best effort: tell a client why it is closed. */
+        void sendError(SOCKET socket, const std::string& message)
+        {
+            const std::string line = "{\"error\":\"" + message + "\"}\n";
+            send(socket, line.data(), static_cast<int>(line.size()), 0);
+        }
+
+        std::string encodeJson(const Packet& pkt)
+        {
+            static constexpr char kHex[] = "0123456789abcdef";
+
+            std::string line;
+            line.reserve(64 + pkt.data.size() * 2);
+            line += "{\"ts\":\"";
+            line += pkt.timestamp;
+            line += "\",\"ch\":\"";
+            line += channelName(pkt.channel);
+            line += '"';
+
+            if (pkt.kind != PacketKind::Data)
+            {
+                // Event messages are plain ASCII without quotes or backslashes
+                line += ",\"event\":\"";
+                line += eventMessage(pkt);
+                line += "\"}\n";
+                return line;
+            }
+
+            line += ",\"len\":";
+            line += std::to_string(pkt.data.size());
+            line += ",\"hex\":\"";
+            for (uint8_t b : pkt.data)
+            {
+                line += kHex[b >> 4];
+                line += kHex[b & 0x0F];
+            }
+            line += "\"}\n";
+            return line;
+        }
+    }
+
+    struct StreamServer::Subscriber
+    {
+        SOCKET                                socket = INVALID_SOCKET;
+        std::chrono::steady_clock::time_point acceptTime{};
+
+        // Fixed before 'active' is set; read by publish() afterwards
+        StreamFormat      format = StreamFormat::Jsonl;
+        uint8_t           channelMask = 0x3;  // bit 0 = RX, bit 1 = TX
+        std::atomic<bool> active{ false };
+
+        // Shared with publish()
+        std::mutex          mutex;
+        std::deque<Message> queue;
+        size_t              queuedBytes = 0;
+        uint64_t            dropped = 0;
+        bool                overflowed = false;  // StreamDropPolicy::Disconnect
+
+        // Server thread only
+        std::vector<Message> inflight;
+        size_t               sentOfFirst = 0;
+        uint64_t             reportedDrops = 0;
+        std::string          request;
+    };
+
+    StreamServer::StreamServer(const StreamServerOptions& options)
+        : m_options(options), m_listenSocket(INVALID_SOCKET), m_wakeSocket(INVALID_SOCKET)
+    {
+    }
+
+    StreamServer::~StreamServer()
+    {
+        stop();
+    }
+
+    bool StreamServer::start()
+    {
+        WSADATA wsaData{};
+        if (WSAStartup(MAKEWORD(2, 2), &wsaData) != 0)
+        {
+            std::cerr << "Stream server: WSAStartup failed\n";
+            return false;
+        }
+        m_wsaStarted = true;
+
+        SOCKET s = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+        SOCKET w = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+        if (s == INVALID_SOCKET || w == INVALID_SOCKET)
+        {
+            std::cerr << "Stream server: socket() failed (code: " << WSAGetLastError() << ")\n";
+            if (s != INVALID_SOCKET) closesocket(s);
+            if (w != INVALID_SOCKET) closesocket(w);
+            stop();
+            return false;
+        }
+
+        sockaddr_in addr{};
+        addr.sin_family = AF_INET;
+        addr.sin_port = htons(m_options.port);
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+        sockaddr_in wakeAddr{};
+        wakeAddr.sin_family = AF_INET;
+        wakeAddr.sin_port = 0;
+        wakeAddr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+        if (bind(s, reinterpret_cast<const sockaddr*>(&addr), sizeof(addr)) == SOCKET_ERROR
+            || listen(s, 8) == SOCKET_ERROR
+            || bind(w, reinterpret_cast<const sockaddr*>(&wakeAddr), sizeof(wakeAddr)) == SOCKET_ERROR)
+        {
+            std::cerr << "Stream server: cannot listen on 127.0.0.1:" << m_options.port
+                      << " (code: " << WSAGetLastError() << ")\n";
+            closesocket(s);
+            closesocket(w);
+            stop();
+            return false;
+        }
+
+        unsigned long nonBlocking = 1;
+        ioctlsocket(w, FIONBIO, &nonBlocking);
+
+        m_listenSocket = static_cast<uintptr_t>(s);
+        m_wakeSocket = static_cast<uintptr_t>(w);
+        m_running.store(true);
+        m_thread = std::thread(&StreamServer::run, this);
+        return true;
+    }
+
+    void StreamServer::stop()
+    {
+        if (m_running.exchange(false))
+        {
+            wake();
+        }
+        if (m_thread.joinable())
+        {
+            m_thread.join();
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            for (auto& sub : m_subscribers)
+            {
+                closesocket(sub->socket);
+            }
+            m_subscribers.clear();
+            m_subscriberCount.store(0);
+        }
+
+        for (uintptr_t* s : { &m_listenSocket, &m_wakeSocket })
+        {
+            if (*s != static_cast<uintptr_t>(INVALID_SOCKET))
+            {
+                closesocket(static_cast<SOCKET>(*s));
+                *s = static_cast<uintptr_t>(INVALID_SOCKET);
+            }
+        }
+        if (m_wsaStarted)
+        {
+            WSACleanup();
+            m_wsaStarted = false;
+        }
+    }
+
+    void StreamServer::publish(const Packet& pkt)
+    {
+        if (m_subscriberCount.load(std::memory_order_relaxed) == 0)
+        {
+            return;
+        }
+
+        const uint8_t channelBit = static_cast<uint8_t>(1u << static_cast<unsigned>(pkt.channel));
+        Message       json;
+        Message       raw;
+        bool          queued = false;
+
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            for (auto& sub : m_subscribers)
+            {
+                if (!sub->active.load(std::memory_order_acquire) || !(sub->channelMask & channelBit))
+                {
+                    continue;
+                }
+
+                if (sub->format == StreamFormat::Raw)
+                {
+                    if (pkt.kind != PacketKind::Data)
+                    {
+                        continue;
+                    }
+                    if (!raw)
+                    {
+                        raw = std::make_shared<const std::string>(pkt.data.begin(), pkt.data.end());
+                    }
+                    enqueue(*sub, raw);
+                }
+                else
+                {
+                    if (!json)
+                    {
+                        json = std::make_shared<const std::string>(encodeJson(pkt));
+                    }
+                    enqueue(*sub, json);
+                }
+                queued = true;
+            }
+        }
+
+        if (queued)
+        {
+            wake();
+        }
+    }
+
+    void StreamServer::enqueue(Subscriber& sub, const Message& msg)
+    {
+        const size_t limit = size_t{ m_options.queueKb } * 1024;
+
+        std::lock_guard<std::mutex> lock(sub.mutex);
+        if (sub.overflowed)
+        {
+            return;
+        }
+
+        if (sub.queuedBytes + msg->size() > limit)
+        {
+            switch (m_options.dropPolicy)
+            {
+            case StreamDropPolicy::Newest:
+                ++sub.dropped;
+                m_dropped.fetch_add(1, std::memory_order_relaxed);
+                return;
+
+            case StreamDropPolicy::Disconnect:
+                sub.overflowed = true;
+                sub.dropped += sub.queue.size() + 1;
+                m_dropped.fetch_add(sub.queue.size() + 1, std::memory_order_relaxed);
+                sub.queue.clear();
+                sub.queuedBytes = 0;
+                return;
+
+            default:
+                while (!sub.queue.empty() && sub.queuedBytes + msg->size() > limit)
+                {
+                    sub.queuedBytes -= sub.queue.front()->size();
+                    sub.queue.pop_front();
+                    ++sub.dropped;
+                    m_dropped.fetch_add(1, std::memory_order_relaxed);
+                }
+                if (msg->size() > limit)
+                {
+                    ++sub.dropped;
+                    m_dropped.fetch_add(1, std::memory_order_relaxed);
+                    return;
+                }
+                break;
+            }
+        }
+
+        sub.queue.push_back(msg);
+        sub.queuedBytes += msg->size();
+    }
+
+    void StreamServer::wake()
+    {
+        // One datagram per idle period; the server clears the flag before draining the queues
+        if (m_wakePending.exchange(true, std::memory_order_acq_rel))
+        {
+            return;
+        }
+
+        sockaddr_in addr{};
+        int         len = sizeof(addr);
+        const SOCKET w = static_cast<SOCKET>(m_wakeSocket);
+        if (getsockname(w, reinterpret_cast<sockaddr*>(&addr), &len) == 0)
+        {
+            const char byte = 0;
+            sendto(w, &byte, 1, 0, reinterpret_cast<const sockaddr*>(&addr), len);
+        }
+    }
+
+    void StreamServer::run()
+    {
+        const SOCKET listenSocket = static_cast<SOCKET>(m_listenSocket);
+        const SOCKET wakeSocket = static_cast<SOCKET>(m_wakeSocket);
+
+        std::vector<std::shared_ptr<Subscriber>> subs;
+
+        while (m_running.load())
+        {
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                subs = m_subscribers;
+            }
+
+            // Send what is queued; only subscribers whose socket is full need select()
+            m_wakePending.store(false, std::memory_order_release);
+
+            const auto                               now = std::chrono::steady_clock::now();
+            std::vector<std::shared_ptr<Subscriber>> closed;
+            fd_set                                   readSet;
+            fd_set                                   writeSet;
+            FD_ZERO(&readSet);
+            FD_ZERO(&writeSet);
+            FD_SET(listenSocket, &readSet);
+            FD_SET(wakeSocket, &readSet);
+
+            for (auto& sub : subs)
+            {
+                if (!sub->active.load() && now - sub->acceptTime >= kRequestWindow)
+                {
+                    sub->active.store(true, std::memory_order_release);
+                }
+
+                const bool ok = flush(*sub);
+                if (!ok)
+                {
+                    closed.push_back(sub);
+                    continue;
+                }
+
+                FD_SET(sub->socket, &readSet);
+                if (!sub->inflight.empty())
+                {
+                    FD_SET(sub->socket, &writeSet);
+                }
+            }
+
+            if (!closed.empty())
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                for (auto& sub : closed)
+                {
+                    closesocket(sub->socket);
+                    m_subscribers.erase(std::find(m_subscribers.begin(), m_subscribers.end(), sub));
+                }
+                m_subscriberCount.store(m_subscribers.size());
+                continue;
+            }
+
+            // Short timeout while a subscriber may still send its request line
+            timeval tv{ 0, 200'000 };
+            for (auto& sub : subs)
+            {
+                if (!sub->active.load())
+                {
+                    tv.tv_usec = 20'000;
+                }
+            }
+
+            if (select(0, &readSet, &writeSet, nullptr, &tv) <= 0)
+            {
+                continue;
+            }
+
+            if (FD_ISSET(wakeSocket, &readSet))
+            {
+                char drain[64];
+                while (recv(wakeSocket, drain, sizeof(drain), 0) > 0)
+                {
+                }
+            }
+
+            if (FD_ISSET(listenSocket, &readSet))
+            {
+                acceptSubscriber();
+            }
+
+            for (auto& sub : subs)
+            {
+                if (FD_ISSET(sub->socket, &readSet) && !readRequest(*sub))
+                {
+                    std::lock_guard<std::mutex> lock(m_mutex);
+                    closesocket(sub->socket);
+                    m_subscribers.erase(std::find(m_subscribers.begin(), m_subscribers.end(), sub));
+                    m_subscriberCount.store(m_subscribers.size());
+                }
+            }
+        }
+    }
+
+    void StreamServer::acceptSubscriber()
+    {
+        SOCKET client = accept(static_cast<SOCKET>(m_listenSocket), nullptr, nullptr);
+        if (client == INVALID_SOCKET)
+        {
+            return;
+        }
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_subscribers.size() >= kMaxSubscribers)
+        {
+            sendError(client, "too many subscribers (max " + std::to_string(kMaxSubscribers) + ")");
+            closesocket(client);
+            return;
+        }
+
+        unsigned long nonBlocking = 1;
+        ioctlsocket(client, FIONBIO, &nonBlocking);
+        BOOL noDelay = TRUE;
+        setsockopt(client, IPPROTO_TCP, TCP_NODELAY, reinterpret_cast<const char*>(&noDelay), sizeof(noDelay));
+
+        auto sub = std::make_shared<Subscriber>();
+        sub->socket = client;
+        sub->acceptTime = std::chrono::steady_clock::now();
+        sub->format = m_options.format;
+
+        m_subscribers.push_back(std::move(sub));
+        m_subscriberCount.store(m_subscribers.size());
+        m_served.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    bool StreamServer::readRequest(Subscriber& sub)
+    {
+        char      buf[256];
+        const int n = recv(sub.socket, buf, sizeof(buf), 0);
+        if (n == 0)
+        {
+            return false;  // subscriber closed the connection
+        }
+        if (n < 0)
+        {
+            return WSAGetLastError() == WSAEWOULDBLOCK;
+        }
+
+        // Anything after the first line (or after activation) is ignored
+        if (sub.active.load())
+        {
+            return true;
+        }
+        sub.request.append(buf, static_cast<size_t>(n));
+        const size_t eol = sub.request.find('\n');
+        if (eol == std::string::npos && sub.request.size() < 64)
+        {
+            return true;
+        }
+
+        std::string line = sub.request.substr(0, eol);
+        std::transform(line.begin(), line.end(), line.begin(),
+                       [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+
+        // "jsonl" | "raw"  [ "rx" | "tx" ], whole tokens only; an empty line keeps the defaults
+        std::vector<std::string> tokens;
+        for (size_t pos = 0; pos < line.size();)
+        {
+            if (std::isspace(static_cast<unsigned char>(line[pos])))
+            {
+                ++pos;
+                continue;
+            }
+            size_t end = pos;
+            while (end < line.size() && !std::isspace(static_cast<unsigned char>(line[end])))
+            {
+                ++end;
+            }
+            tokens.push_back(line.substr(pos, end - pos));
+            pos = end;
+        }
+        bool valid = tokens.size() <= 2;
+        if (valid && !tokens.empty())
+        {
+            if (tokens[0] == "raw")
+            {
+                sub.format = StreamFormat::Raw;
+            }
+            else if (tokens[0] == "jsonl")
+            {
+                sub.format = StreamFormat::Jsonl;
+            }
+            else
+            {
+                valid = false;
+            }
+        }
+        if (valid && tokens.size() == 2)
+        {
+            if (tokens[1] == "rx")
+            {
+                sub.channelMask = 0x1;
+            }
+            else if (tokens[1] == "tx")
+            {
+                sub.channelMask = 0x2;
+            }
+            else
+            {
+                valid = false;
+            }
+        }
+        if (!valid)
+        {
+            sendError(sub.socket, "invalid request (use: jsonl|raw [rx|tx])");
+            return false;
+        }
+        sub.active.store(true, std::memory_order_release);
+        return true;
+    }
+
+    bool StreamServer::flush(Subscriber& sub)
+    {
+        for (;;)
+        {
+            if (sub.inflight.empty())
+            {
+                std::lock_guard<std::mutex> lock(sub.mutex);
+                if (sub.overflowed)
+                {
+                    return false;
+                }
+
+                // JSON subscribers learn about gaps in-band
+                if (sub.format == StreamFormat::Jsonl && sub.dropped != sub.reportedDrops)
+                {
+                    sub.inflight.push_back(std::make_shared<const std::string>(
+                        "{\"dropped\":" + std::to_string(sub.dropped - sub.reportedDrops) + "}\n"));
+                    sub.reportedDrops = sub.dropped;
+                }
+                while (!sub.queue.empty() && sub.inflight.size() < kMaxBatch)
+                {
+                    sub.queuedBytes -= sub.queue.front()->size();
+                    sub.inflight.push_back(std::move(sub.queue.front()));
+                    sub.queue.pop_front();
+                }
+                sub.sentOfFirst = 0;
+            }
+            if (sub.inflight.empty())
+            {
+                return true;
+            }
+
+            // Gather the whole batch into one call (writev)
+            WSABUF bufs[kMaxBatch + 1];
+            DWORD  count = 0;
+            for (size_t i = 0; i < sub.inflight.size(); ++i)
+            {
+                const size_t skip = (i == 0) ? sub.sentOfFirst : 0;
+                bufs[count].buf = const_cast<char*>(sub.inflight[i]->data() + skip);
+                bufs[count].len = static_cast<unsigned long>(sub.inflight[i]->size() - skip);
+                ++count;
+            }
+
+            DWORD sent = 0;
+            if (WSASend(sub.socket, bufs, count, &sent, 0, nullptr, nullptr) == SOCKET_ERROR)
+            {
+                return WSAGetLastError() == WSAEWOULDBLOCK;
+            }
+
+            size_t consumed = 0;
+            size_t remaining = sent;
+            while (consumed < sub.inflight.size())
+            {
+                const size_t left = sub.inflight[consumed]->size() - sub.sentOfFirst;
+                if (remaining < left)
+                {
+                    sub.sentOfFirst += remaining;
+                    break;
+                }
+                remaining -= left;
+                sub.sentOfFirst = 0;
+                ++consumed;
+            }
+            sub.inflight.erase(sub.inflight.begin(), sub.inflight.begin() + static_cast<std::ptrdiff_t>(consumed));
+
+            if (!sub.inflight.empty())
+            {
+                return true;  // socket buffer full, wait for select()
+            }
+        }
+    }
+}
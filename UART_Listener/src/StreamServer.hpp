@@ -0,0 +1,147 @@
+/**
+ ****************************************************************************************
+ * @file   StreamServer.hpp
+ * @brief  Localhost TCP fan-out of captured packets to up to 60 subscribers.
+ *
+ *         Only one process can own a COM port; --stream-port lets several people
+ *         watch the same capture. Every subscriber has its own bounded queue and
+ *         a drop policy, so a slow client loses its own data and never backs up
+ *         the capture. A subscriber may send one line to choose its stream:
+ *
+ *           "jsonl" | "raw"  [ "rx" | "tx" ]     e.g. "raw rx\n"
+ *
+ *         Without a request it gets the --stream-format default, both channels.
+ *         Any other request, and a connection beyond the 60 that select() can
+ *         serve, gets a {"error":...} line and is closed.
+ *
+ * @author Patrik Neunteufel
+ * @date   Oct 2026
+ ****************************************************************************************
+ */
+#pragma once
+
+#include "Format.hpp"
+#include "UART.hpp"
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace uart_listener
+{
+    enum class StreamFormat
+    {
+        Jsonl = 0,  ///< One JSON object per packet or event
+        Raw,        ///< Data bytes only, events are skipped
+        COUNT
+    };
+
+    /**
+     * @brief What happens when a subscriber's queue is full.
+     */
+    enum class StreamDropPolicy
+    {
+        Oldest = 0,   ///< Discard queued packets to make room (live view stays current)
+        Newest,       ///< Discard the incoming packet (stream stays contiguous up to the gap)
+        Disconnect,   ///< Close the subscriber
+        COUNT
+    };
+
+    template<>
+    struct FormatMetaTraits<StreamFormat>
+    {
+        static constexpr size_t count = static_cast<size_t>(StreamFormat::COUNT);
+
+        // clang-format off
+        static constexpr std::array<const char*, count> names =
+        {{
+            "jsonl",
+            "raw"
+        }};
+        // clang-format on
+    };
+
+    template<>
+    struct FormatMetaTraits<StreamDropPolicy>
+    {
+        static constexpr size_t count = static_cast<size_t>(StreamDropPolicy::COUNT);
+
+        // clang-format off
+        static constexpr std::array<const char*, count> names =
+        {{
+            "oldest",
+            "newest",
+            "disconnect"
+        }};
+        // clang-format on
+    };
+
+    using StreamFormatTraits     = FormatTraitsBase<StreamFormat>;
+    using StreamDropPolicyTraits = FormatTraitsBase<StreamDropPolicy>;
+
+    struct StreamServerOptions
+    {
+        uint16_t         port = 0;                 // 0 = server disabled
+        StreamFormat     format = StreamFormat::Jsonl;
+        StreamDropPolicy dropPolicy = StreamDropPolicy::Oldest;
+        uint32_t         queueKb = 1024;           // per subscriber
+    };
+
+    class StreamServer
+    {
+    public:
+        explicit StreamServer(const StreamServerOptions& options);
+        ~StreamServer();
+
+        StreamServer(const StreamServer&) = delete;
+        StreamServer& operator=(const StreamServer&) = delete;
+
+        /**
+         * @brief Bind to 127.0.0.1:port and start the server thread.
+         * @return false if Winsock init, bind or listen failed
+         */
+        bool start();
+
+        void stop();
+
+        /**
+         * @brief Queue a packet for all subscribers (consumer thread).
+         *
+         * Encodes each format at most once and shares the buffer between
+         * subscribers; never blocks on a subscriber socket.
+         */
+        void publish(const Packet& pkt);
+
+        uint64_t subscribersServed() const noexcept { return m_served.load(std::memory_order_relaxed); }
+        uint64_t messagesDropped() const noexcept { return m_dropped.load(std::memory_order_relaxed); }
+
+    private:
+        struct Subscriber;
+        using Message = std::shared_ptr<const std::string>;
+
+        void run();
+        void acceptSubscriber();
+        bool readRequest(Subscriber& sub);
+        bool flush(Subscriber& sub);
+        void enqueue(Subscriber& sub, const Message& msg);
+        void wake();
+
+        StreamServerOptions m_options;
+        uintptr_t           m_listenSocket;
+        uintptr_t           m_wakeSocket;      // loopback UDP socket, wakes select() on publish
+        std::atomic<bool>   m_wakePending{ false };
+        std::atomic<bool>   m_running{ false };
+        bool                m_wsaStarted = false;
+        std::thread         m_thread;
+
+        std::mutex                               m_mutex;  // guards m_subscribers
+        std::vector<std::shared_ptr<Subscriber>> m_subscribers;
+        std::atomic<size_t>                      m_subscriberCount{ 0 };
+        std::atomic<uint64_t>                    m_served{ 0 };
+        std::atomic<uint64_t>                    m_dropped{ 0 };
+    };
+}
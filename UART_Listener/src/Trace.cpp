@@ -0,0 +1,206 @@
+/**
+ ****************************************************************************************
+ * @file   Trace.cpp
+ * @brief  Per-thread trace ring buffers and Chrome trace JSON writer.
+ *
+ * @author Patrik Neunteufel
+ * @date   Oct 2026
+ ****************************************************************************************
+ */
+
+#include "Trace.hpp"
+
+#include <array>
+#include <fstream>
+#include <iomanip>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+namespace uart_listener::trace
+{
+    std::atomic<bool> g_enabled{ false };
+
+    namespace
+    {
+        constexpr size_t kRingCapacity = size_t{ 1 } << 16;  // spans per thread
+        constexpr size_t kRingMask = kRingCapacity - 1;
+
+        struct Event
+        {
+            std::atomic<const char*> name{ nullptr };
+            std::atomic<int64_t>     start{ 0 };
+            std::atomic<int64_t>     end{ 0 };
+        };
+
+        /**
+         * Single-producer ring. The owning thread is the only writer; dump() reads
+         * concurrently and validates against the head counter afterwards.
+         */
+        struct ThreadBuffer
+        {
+            std::array<Event, kRingCapacity> events;
+            std::atomic<uint64_t>            head{ 0 };
+            DWORD                            threadId = 0;
+            std::string                      threadName;
+        };
+
+        std::mutex                                 g_registryMutex;
+        std::vector<std::unique_ptr<ThreadBuffer>> g_registry;
+        std::string                                g_outputPath;
+        int64_t                                    g_origin = 0;
+
+        ThreadBuffer& localBuffer()
+        {
+            thread_local ThreadBuffer* buffer = nullptr;
+            if (buffer == nullptr)
+            {
+                auto owned = std::make_unique<ThreadBuffer>();
+                owned->threadId = GetCurrentThreadId();
+                buffer = owned.get();
+
+                std::lock_guard<std::mutex> lock(g_registryMutex);
+                g_registry.push_back(std::move(owned));
+            }
+            return *buffer;
+        }
+
+        void writeJsonString(std::ostream& out, const std::string& s)
+        {
+            out << '"';
+            for (char c : s)
+            {
+                if (c == '"' || c == '\\')
+                {
+                    out << '\\' << c;
+                }
+                else if (static_cast<unsigned char>(c) < 0x20)
+                {
+                    out << ' ';
+                }
+                else
+                {
+                    out << c;
+                }
+            }
+            out << '"';
+        }
+    }
+
+    void record(const char* name, int64_t start, int64_t end) noexcept
+    {
+        ThreadBuffer&  buf = localBuffer();
+        const uint64_t idx = buf.head.load(std::memory_order_relaxed);
+        Event&         ev = buf.events[idx & kRingMask];
+
+        ev.name.store(name, std::memory_order_relaxed);
+        ev.start.store(start, std::memory_order_relaxed);
+        ev.end.store(end, std::memory_order_relaxed);
+        buf.head.store(idx + 1, std::memory_order_release);
+    }
+
+    void setThreadName(const char* name)
+    {
+        // Without --trace-file no thread gets a ring (about 1.5 MB each)
+        if (!isEnabled())
+        {
+            return;
+        }
+        ThreadBuffer&               buf = localBuffer();
+        std::lock_guard<std::mutex> lock(g_registryMutex);
+        buf.threadName = name;
+    }
+
+    void enable(const std::string& outputPath)
+    {
+        g_outputPath = outputPath;
+        g_origin = now();
+        g_enabled.store(true);
+    }
+
+    bool isEnabled() noexcept
+    {
+        return g_enabled.load(std::memory_order_relaxed);
+    }
+
+    const std::string& outputPath()
+    {
+        return g_outputPath;
+    }
+
+    bool dump()
+    {
+        if (g_outputPath.empty())
+        {
+            return false;
+        }
+
+        std::ofstream out(g_outputPath, std::ios::out | std::ios::trunc);
+        if (!out.is_open())
+        {
+            return false;
+        }
+
+        LARGE_INTEGER freq;
+        QueryPerformanceFrequency(&freq);
+        const double usPerTick = 1e6 / static_cast<double>(freq.QuadPart);
+        const DWORD  pid = GetCurrentProcessId();
+
+        out << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n";
+        out << std::fixed << std::setprecision(3);
+
+        // Buffers live until exit; copy the list so that threads can register while we write
+        std::vector<std::pair<const ThreadBuffer*, std::string>> buffers;
+        {
+            std::lock_guard<std::mutex> lock(g_registryMutex);
+            for (const auto& buf : g_registry)
+            {
+                buffers.emplace_back(buf.get(), buf->threadName);
+            }
+        }
+
+        bool first = true;
+        for (const auto& [buf, threadName] : buffers)
+        {
+            if (!threadName.empty())
+            {
+                out << (first ? "" : ",\n")
+                    << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":" << pid
+                    << ",\"tid\":" << buf->threadId << ",\"args\":{\"name\":";
+                writeJsonString(out, threadName);
+                out << "}}";
+                first = false;
+            }
+
+            const uint64_t head = buf->head.load(std::memory_order_acquire);
+            const uint64_t begin = head > kRingCapacity ? head - kRingCapacity : 0;
+
+            for (uint64_t i = begin; i < head; ++i)
+            {
+                const Event& ev = buf->events[i & kRingMask];
+                const char*  name = ev.name.load(std::memory_order_relaxed);
+                const int64_t start = ev.start.load(std::memory_order_relaxed);
+                const int64_t end = ev.end.load(std::memory_order_relaxed);
+
+                // The writer may have lapped us while reading this slot; the fence keeps
+                // the slot reads above from moving past the head re-read
+                std::atomic_thread_fence(std::memory_order_acquire);
+                const uint64_t headNow = buf->head.load(std::memory_order_acquire);
+                if (headNow - i >= kRingCapacity || name == nullptr)
+                {
+                    continue;
+                }
+
+                out << (first ? "" : ",\n") << "{\"name\":\"" << name << "\",\"ph\":\"X\",\"pid\":" << pid
+                    << ",\"tid\":" << buf->threadId
+                    << ",\"ts\":" << static_cast<double>(start - g_origin) * usPerTick
+                    << ",\"dur\":" << static_cast<double>(end - start) * usPerTick << "}";
+                first = false;
+            }
+        }
+
+        out << "\n]}\n";
+        return out.good();
+    }
+}
@@ -0,0 +1,515 @@
+/**
+ ****************************************************************************************
+ * @file   Transaction.cpp
+ * @brief  Request/response pairing of TX and RX frames with latency per command type.
+ *
+ * @author Patrik Neunteufel
+ * @date   Oct 2026
+ ****************************************************************************************
+ */
+#include "Transaction.hpp"
+#include "DataFormat.hpp"
+
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+
+namespace uart_listener
+{
+    namespace
+    {
+        constexpr size_t kInitialSlots = 64;
+
+        // Read times of two adapters jitter by about one USB frame
+        constexpr auto kReadSkew = std::chrono::milliseconds(2);
+
+        uint64_t hashBytes(const uint8_t* data, size_t size) noexcept
+        {
+            uint64_t hash = 0xCBF29CE484222325ull;   // FNV-1a
+            for (size_t i = 0; i < size; ++i)
+            {
+                hash = (hash ^ data[i]) * 0x100000001B3ull;
+            }
+            return hash;
+        }
+
+        // c-escaped and safe inside a ';' separated field
+        std::string csvText(const uint8_t* data, size_t size)
+        {
+            std::string text = bytesToAscii(data, size, true);
+            std::string out;
+            out.reserve(text.size());
+            for (char c : text)
+            {
+                if (c == ';')
+                {
+                    out += "\\x3B";
+                }
+                else
+                {
+                    out += c;
+                }
+            }
+            return out;
+        }
+    }
+
+    TransactionTracker::TransactionTracker(const TransactionOptions& options, std::optional<DfaRegex> keyPattern,
+                                           PipelineCounters& counters)
+        : m_options(options)
+        , m_pattern(std::move(keyPattern))
+        , m_counters(counters)
+    {
+        m_options.idLength = std::clamp<uint32_t>(m_options.idLength, 1, kMaxKeyBytes);
+        if (m_options.match != TxnMatch::Sequence)
+        {
+            m_slots.resize(kInitialSlots);
+        }
+    }
+
+    bool TransactionTracker::open()
+    {
+        if (!m_options.csvPath.has_value())
+        {
+            return true;
+        }
+        m_csv.open(*m_options.csvPath);
+        if (!m_csv.is_open())
+        {
+            std::cerr << "Cannot create transaction CSV: " << *m_options.csvPath << "\n";
+            return false;
+        }
+        m_csv << "Timestamp;Result;Type;Id;Latency_us;Response\n";
+        return true;
+    }
+
+    void TransactionTracker::feed(const Packet& pkt)
+    {
+        if (pkt.kind != PacketKind::Data || pkt.data.empty())
+        {
+            return;
+        }
+
+        const size_t segments = pkt.segments.empty() ? 1 : pkt.segments.size();
+        if (!m_options.frameEnd.has_value())
+        {
+            // One frame per packet: the coalescer already merged reads that belong together
+            const auto end = pkt.readTime
+                           + std::chrono::microseconds(pkt.segments.empty() ? 0 : pkt.segments.back().deltaUs);
+            closeFrame(pkt.channel, pkt.data.data(), pkt.data.size(), pkt.readTime, end, pkt.timestamp);
+            return;
+        }
+
+        for (size_t s = 0; s < segments; ++s)
+        {
+            // Bytes of one driver read share its read time
+            const size_t begin = pkt.segments.empty() ? 0 : pkt.segments[s].offset;
+            const size_t end = (s + 1 < pkt.segments.size()) ? pkt.segments[s + 1].offset : pkt.data.size();
+            const auto   time = pkt.readTime
+                              + std::chrono::microseconds(pkt.segments.empty() ? 0 : pkt.segments[s].deltaUs);
+            addBytes(pkt.channel, pkt.data.data() + begin, end - begin, time, pkt.timestamp);
+        }
+    }
+
+    void TransactionTracker::poll(Clock::time_point now, bool final)
+    {
+        if (final)
+        {
+            // Requests first: a response cut off at the end may still close one
+            for (Channel channel : { Channel::TX, Channel::RX })
+            {
+                Frame& frame = m_frames[static_cast<size_t>(channel)];
+                if (!frame.data.empty())
+                {
+                    closeFrame(channel, frame.data.data(), frame.data.size(), frame.start, frame.end, frame.timestamp);
+                    frame.data.clear();
+                }
+            }
+        }
+        expire(now, final);
+        if (m_csv.is_open())
+        {
+            m_csv.flush();
+        }
+    }
+
+    void TransactionTracker::addBytes(Channel channel, const uint8_t* data, size_t size, Clock::time_point time,
+                                      const std::string& timestamp)
+    {
+        Frame&        frame = m_frames[static_cast<size_t>(channel)];
+        const uint8_t delimiter = *m_options.frameEnd;
+
+        while (size > 0)
+        {
+            if (frame.data.empty())
+            {
+                frame.start = time;
+                frame.timestamp = timestamp;
+            }
+            frame.end = time;
+
+            const size_t room = kMaxFrameBytes - frame.data.size();
+            const auto*  stop = std::find(data, data + std::min(size, room), delimiter);
+            const size_t take = (stop != data + std::min(size, room)) ? static_cast<size_t>(stop - data) + 1
+                                                                      : std::min(size, room);
+            frame.data.insert(frame.data.end(), data, data + take);
+            data += take;
+            size -= take;
+
+            if (frame.data.back() == delimiter || frame.data.size() == kMaxFrameBytes)
+            {
+                closeFrame(channel, frame.data.data(), frame.data.size(), frame.start, frame.end, frame.timestamp);
+                frame.data.clear();
+            }
+        }
+    }
+
+    void TransactionTracker::closeFrame(Channel channel, const uint8_t* data, size_t size, Clock::time_point start,
+                                        Clock::time_point end, const std::string& timestamp)
+    {
+        if (channel == Channel::TX)
+        {
+            request(data, size, end, timestamp);
+        }
+        else
+        {
+            response(data, size, start, timestamp);
+        }
+    }
+
+    void TransactionTracker::request(const uint8_t* data, size_t size, Clock::time_point end,
+                                     const std::string& timestamp)
+    {
+        ++m_requests;
+        expire(end, false);
+
+        Request req;
+        req.serial = ++m_serial;
+        req.end = end;
+        req.timestamp = timestamp;
+        if (m_options.match != TxnMatch::Sequence && !keyOf(data, size, req.key))
+        {
+            ++m_untracked;
+            return;
+        }
+        req.type = typeOf(data, size);
+
+        if (m_options.match != TxnMatch::Sequence)
+        {
+            // A request repeated before its answer replaces the first one
+            if (Request* previous = findOpen(req.key))
+            {
+                timeout(*previous);
+                eraseOpen(previous);
+            }
+            insertOpen(Request(req));
+        }
+        m_order.push_back(std::move(req));
+    }
+
+    void TransactionTracker::response(const uint8_t* data, size_t size, Clock::time_point start,
+                                      const std::string& timestamp)
+    {
+        // An answer after the timeout does not close the request any more
+        expire(start, false);
+
+        if (m_options.match == TxnMatch::Sequence)
+        {
+            // A frame that began before the request went out does not answer it
+            if (m_order.empty() || start + kReadSkew < m_order.front().end)
+            {
+                unsolicited(data, size, timestamp);
+                return;
+            }
+            complete(m_order.front(), start);
+            m_order.pop_front();
+            return;
+        }
+
+        Key      key;
+        Request* req = keyOf(data, size, key) ? findOpen(key) : nullptr;
+        if (req == nullptr)
+        {
+            unsolicited(data, size, timestamp);
+            return;
+        }
+        complete(*req, start);
+        eraseOpen(req);
+    }
+
+    void TransactionTracker::expire(Clock::time_point now, bool all)
+    {
+        const auto timeoutAfter = std::chrono::milliseconds(m_options.timeoutMs);
+        while (!m_order.empty() && (all || now - m_order.front().end > timeoutAfter))
+        {
+            const Request& oldest = m_order.front();
+            if (m_options.match == TxnMatch::Sequence)
+            {
+                timeout(oldest);
+            }
+            else if (Request* open = findOpen(oldest.key); open != nullptr && open->serial == oldest.serial)
+            {
+                timeout(*open);
+                eraseOpen(open);
+            }
+            // else: answered already, or replaced by a repeated request
+            m_order.pop_front();
+        }
+    }
+
+    void TransactionTracker::complete(const Request& req, Clock::time_point start)
+    {
+        const auto latency = start - req.end;
+        TypeStats& type = m_types[req.type];
+        type.latency.record(latency);
+        ++type.completed;
+        m_counters.txnLatency.record(latency);
+        bumpCounter(m_counters.txnCompleted, 1);
+
+        if (m_csv.is_open())
+        {
+            m_csv << req.timestamp << ";completed;" << type.name << ";"
+                  << csvText(req.key.bytes.data(), req.key.length) << ";"
+                  << std::chrono::duration_cast<std::chrono::microseconds>(latency).count() << ";\n";
+        }
+    }
+
+    void TransactionTracker::timeout(const Request& req)
+    {
+        TypeStats& type = m_types[req.type];
+        ++type.timeouts;
+        bumpCounter(m_counters.txnTimeouts, 1);
+
+        const std::string id = csvText(req.key.bytes.data(), req.key.length);
+        if (m_timeoutList.size() < kListed)
+        {
+            m_timeoutList.push_back({ req.timestamp, type.name, id });
+        }
+        if (m_csv.is_open())
+        {
+            m_csv << req.timestamp << ";timeout;" << type.name << ";" << id << ";;\n";
+        }
+    }
+
+    void TransactionTracker::unsolicited(const uint8_t* data, size_t size, const std::string& timestamp)
+    {
+        ++m_unsolicited;
+        bumpCounter(m_counters.txnUnsolicited, 1);
+
+        if (m_unsolicitedList.size() < kListed)
+        {
+            m_unsolicitedList.push_back({ timestamp, std::string(), csvText(data, std::min(size, kMaxKeyBytes)) });
+        }
+        if (m_csv.is_open())
+        {
+            m_csv << timestamp << ";unsolicited;;;;" << csvText(data, size) << "\n";
+        }
+    }
+
+    bool TransactionTracker::keyOf(const uint8_t* data, size_t size, Key& key) const
+    {
+        size_t offset = 0;
+        size_t length = 0;
+        if (m_options.match == TxnMatch::IdBytes)
+        {
+            if (size < static_cast<size_t>(m_options.idOffset) + m_options.idLength)
+            {
+                return false;
+            }
+            offset = m_options.idOffset;
+            length = m_options.idLength;
+        }
+        else
+        {
+            const auto span = m_pattern->find(data, size);
+            if (!span.has_value() || span->length == 0)
+            {
+                return false;
+            }
+            offset = span->offset;
+            length = std::min(span->length, kMaxKeyBytes);
+        }
+
+        key.length = static_cast<uint8_t>(length);
+        std::copy(data + offset, data + offset + length, key.bytes.begin());
+        key.hash = hashBytes(data + offset, length);
+        return true;
+    }
+
+    uint32_t TransactionTracker::typeOf(const uint8_t* data, size_t size)
+    {
+        const size_t begin = std::min<size_t>(m_options.typeOffset, size);
+        const size_t end = std::min<size_t>(begin + m_options.typeLength, size);
+        const std::string raw(reinterpret_cast<const char*>(data + begin), end - begin);
+
+        auto it = m_typeIndex.find(raw);
+        if (it != m_typeIndex.end())
+        {
+            return it->second;
+        }
+
+        // The last entry collects everything beyond kMaxTypes
+        if (m_types.size() + 1 == kMaxTypes)
+        {
+            m_types.emplace_back().name = "(other)";
+        }
+        if (m_types.size() == kMaxTypes)
+        {
+            return static_cast<uint32_t>(kMaxTypes - 1);
+        }
+
+        m_types.emplace_back().name = (begin == end) ? std::string("(short)") : csvText(data + begin, end - begin);
+        const auto index = static_cast<uint32_t>(m_types.size() - 1);
+        m_typeIndex.emplace(raw, index);
+        return index;
+    }
+
+    TransactionTracker::Request* TransactionTracker::findOpen(const Key& key)
+    {
+        const size_t mask = m_slots.size() - 1;
+        for (size_t i = key.hash & mask; m_slots[i].serial != 0; i = (i + 1) & mask)
+        {
+            if (m_slots[i].key == key)
+            {
+                return &m_slots[i];
+            }
+        }
+        return nullptr;
+    }
+
+    void TransactionTracker::insertOpen(Request&& req)
+    {
+        // At most half full, so that probe sequences stay short
+        if ((m_open + 1) * 2 > m_slots.size())
+        {
+            std::vector<Request> old(m_slots.size() * 2);
+            old.swap(m_slots);
+            m_open = 0;
+            for (Request& r : old)
+            {
+                if (r.serial != 0)
+                {
+                    insertOpen(std::move(r));
+                }
+            }
+        }
+
+        const size_t mask = m_slots.size() - 1;
+        size_t       i = req.key.hash & mask;
+        while (m_slots[i].serial != 0)
+        {
+            i = (i + 1) & mask;
+        }
+        m_slots[i] = std::move(req);
+        ++m_open;
+    }
+
+    void TransactionTracker::eraseOpen(Request* slot)
+    {
+        // Backward shift deletion: no tombstones, lookups stay as short as after insert
+        const size_t mask = m_slots.size() - 1;
+        size_t       hole = static_cast<size_t>(slot - m_slots.data());
+        m_slots[hole] = Request{};
+        --m_open;
+
+        for (size_t i = (hole + 1) & mask; m_slots[i].serial != 0; i = (i + 1) & mask)
+        {
+            const size_t home = m_slots[i].key.hash & mask;
+            // Move the entry back unless its home lies cyclically in (hole, i]
+            const bool stays = (hole < i) ? (home > hole && home <= i) : (home > hole || home <= i);
+            if (!stays)
+            {
+                m_slots[hole] = std::move(m_slots[i]);
+                m_slots[i] = Request{};
+                hole = i;
+            }
+        }
+    }
+
+    void TransactionTracker::writeReport(std::ostream& stream) const
+    {
+        // Built aside, so that the caller's stream keeps its number format
+        std::ostringstream out;
+        out << "=== Transactions (" << TxnMatchTraits::toString(m_options.match) << ") ===\n";
+
+        uint64_t completed = 0;
+        uint64_t timeouts = 0;
+        for (const TypeStats& type : m_types)
+        {
+            completed += type.completed;
+            timeouts += type.timeouts;
+        }
+        out << m_requests << " requests, " << completed << " completed, " << timeouts << " timed out";
+        if (m_untracked > 0)
+        {
+            out << ", " << m_untracked << " without ID";
+        }
+        out << "; " << m_unsolicited << " unsolicited response(s)\n";
+
+        if (!m_types.empty())
+        {
+            std::vector<const TypeStats*> sorted;
+            for (const TypeStats& type : m_types)
+            {
+                sorted.push_back(&type);
+            }
+            std::stable_sort(sorted.begin(), sorted.end(), [](const TypeStats* a, const TypeStats* b) {
+                return a->completed + a->timeouts > b->completed + b->timeouts;
+            });
+
+            size_t width = 4;
+            for (const TypeStats* type : sorted)
+            {
+                width = std::max(width, type->name.size());
+            }
+            out << std::left << std::setw(static_cast<int>(width)) << "Type" << std::right
+                << std::setw(10) << "Done" << std::setw(9) << "p50" << std::setw(9) << "p90"
+                << std::setw(9) << "p99" << std::setw(9) << "max" << std::setw(10) << "Timeouts" << "\n";
+            for (const TypeStats* type : sorted)
+            {
+                LatencyHistogram::Snapshot h;
+                type->latency.snapshot(h);
+                out << std::left << std::setw(static_cast<int>(width)) << type->name << std::right
+                    << std::setw(10) << type->completed;
+                if (h.total > 0)
+                {
+                    out << std::setw(9) << formatDurationNs(h.percentile(0.5))
+                        << std::setw(9) << formatDurationNs(h.percentile(0.9))
+                        << std::setw(9) << formatDurationNs(h.percentile(0.99))
+                        << std::setw(9) << formatDurationNs(h.maxNs);
+                }
+                else
+                {
+                    out << std::setw(36) << "-";
+                }
+                out << std::setw(10) << type->timeouts << "\n";
+            }
+        }
+
+        auto list = [&](const char* title, const std::vector<Listed>& entries, uint64_t total) {
+            if (entries.empty())
+            {
+                return;
+            }
+            out << title << (total > entries.size() ? " (first " + std::to_string(entries.size()) + ")" : "")
+                << ":\n";
+            for (const Listed& entry : entries)
+            {
+                out << "  " << entry.timestamp;
+                if (!entry.type.empty())
+                {
+                    out << " " << entry.type;
+                }
+                if (!entry.bytes.empty())
+                {
+                    out << (entry.type.empty() ? " " : " id ") << entry.bytes;
+                }
+                out << "\n";
+            }
+        };
+        list("Timeouts", m_timeoutList, timeouts);
+        list("Unsolicited", m_unsolicitedList, m_unsolicited);
+
+        stream << out.str();
+    }
+}
@@ -0,0 +1,198 @@
+/**
+ ****************************************************************************************
+ * @file   Transaction.hpp
+ * @brief  Request/response pairing of TX and RX frames with latency per command type.
+ *
+ *         Each TX frame is a request and opens a transaction; the RX frame that
+ *         answers it closes the transaction. The answer is the next RX frame
+ *         (--txn seq), the next RX frame carrying the same ID bytes (--txn id)
+ *         or the same text matched by a regex (--txn regex). The latency is the
+ *         time from the last byte of the request to the first byte of the response.
+ *
+ *         Open transactions live in a small open-addressing hash map keyed by
+ *         the ID; an expiry queue in request order settles the ones that get no
+ *         answer within --txn-timeout.
+ *
+ * @author Patrik Neunteufel
+ * @date   Oct 2026
+ ****************************************************************************************
+ */
+#pragma once
+
+#include "Format.hpp"
+#include "Metrics.hpp"
+#include "Regex.hpp"
+#include "UART.hpp"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <fstream>
+#include <optional>
+#include <ostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace uart_listener
+{
+    enum class TxnMatch
+    {
+        Sequence = 0,   ///< Responses answer the requests in order
+        IdBytes,        ///< Same bytes at a fixed offset in request and response
+        Pattern,        ///< Same text matched by a regex in request and response
+        COUNT
+    };
+
+    template<>
+    struct FormatMetaTraits<TxnMatch>
+    {
+        static constexpr size_t count = static_cast<size_t>(TxnMatch::COUNT);
+
+        // clang-format off
+        static constexpr std::array<const char*, count> names =
+        {{
+            "seq",
+            "id",
+            "regex"
+        }};
+        // clang-format on
+    };
+
+    using TxnMatchTraits = FormatTraitsBase<TxnMatch>;
+
+    struct TransactionOptions
+    {
+        bool                       enabled = false;
+        TxnMatch                   match = TxnMatch::Sequence;
+        uint32_t                   idOffset = 0;      // --txn id:OFFSET[:LEN]
+        uint32_t                   idLength = 1;
+        std::string                pattern;           // --txn regex:PATTERN
+        uint32_t                   typeOffset = 0;    // request bytes that name the command type
+        uint32_t                   typeLength = 8;
+        std::optional<uint8_t>     frameEnd;          // frames end with this byte; unset = one frame per packet
+        uint32_t                   timeoutMs = 1000;
+        std::optional<std::string> csvPath;           // every transaction, timeout and unsolicited frame
+    };
+
+    class TransactionTracker
+    {
+    public:
+        using Clock = std::chrono::steady_clock;
+
+        static constexpr size_t kMaxKeyBytes = 32;    // longer IDs are cut
+        static constexpr size_t kMaxFrameBytes = 4096;
+        static constexpr size_t kMaxTypes = 256;      // further command types are counted as "(other)"
+        static constexpr size_t kListed = 20;         // timeouts / unsolicited frames kept for the report
+
+        /**
+         * @param keyPattern Compiled with prefix = true; required for TxnMatch::Pattern
+         * @param counters   Receives the overall latency and result counters
+         */
+        TransactionTracker(const TransactionOptions& options, std::optional<DfaRegex> keyPattern,
+                           PipelineCounters& counters);
+
+        /** @brief Open the CSV file if one was requested. */
+        bool open();
+
+        /** @brief Feed a data packet of either channel, in queue order. */
+        void feed(const Packet& pkt);
+
+        /**
+         * @brief Settle requests older than the timeout.
+         * With 'final' set, frames still being assembled are closed first and
+         * every open request counts as a timeout.
+         */
+        void poll(Clock::time_point now, bool final = false);
+
+        /** @brief Latency percentiles per command type, timeouts and unsolicited frames. */
+        void writeReport(std::ostream& out) const;
+
+    private:
+        struct Key
+        {
+            uint64_t                          hash = 0;
+            uint8_t                           length = 0;
+            std::array<uint8_t, kMaxKeyBytes> bytes{};
+
+            bool operator==(const Key& other) const noexcept
+            {
+                return hash == other.hash && length == other.length
+                       && std::equal(bytes.begin(), bytes.begin() + length, other.bytes.begin());
+            }
+        };
+
+        struct Request
+        {
+            uint64_t          serial = 0;   // 0 = empty slot
+            Key               key;
+            uint32_t          type = 0;
+            Clock::time_point end{};        // read time of the last request byte
+            std::string       timestamp;
+        };
+
+        struct TypeStats
+        {
+            std::string      name;
+            LatencyHistogram latency;
+            uint64_t         completed = 0;
+            uint64_t         timeouts = 0;
+        };
+
+        struct Listed
+        {
+            std::string timestamp;
+            std::string type;      // timeouts: command type; unsolicited: empty
+            std::string bytes;     // c-escaped, cut to kMaxKeyBytes
+        };
+
+        struct Frame
+        {
+            std::vector<uint8_t> data;
+            Clock::time_point    start{};
+            Clock::time_point    end{};
+            std::string          timestamp;
+        };
+
+        void addBytes(Channel channel, const uint8_t* data, size_t size, Clock::time_point time,
+                      const std::string& timestamp);
+        void closeFrame(Channel channel, const uint8_t* data, size_t size, Clock::time_point start,
+                        Clock::time_point end, const std::string& timestamp);
+        void request(const uint8_t* data, size_t size, Clock::time_point end, const std::string& timestamp);
+        void response(const uint8_t* data, size_t size, Clock::time_point start, const std::string& timestamp);
+        void complete(const Request& req, Clock::time_point start);
+        void timeout(const Request& req);
+        void expire(Clock::time_point now, bool all);
+        void unsolicited(const uint8_t* data, size_t size, const std::string& timestamp);
+
+        bool     keyOf(const uint8_t* data, size_t size, Key& key) const;
+        uint32_t typeOf(const uint8_t* data, size_t size);
+
+        // Open-addressing map of open requests (TxnMatch::IdBytes / Pattern)
+        Request* findOpen(const Key& key);
+        void     insertOpen(Request&& req);
+        void     eraseOpen(Request* slot);
+
+        TransactionOptions      m_options;
+        std::optional<DfaRegex> m_pattern;
+        PipelineCounters&       m_counters;
+        std::ofstream           m_csv;
+
+        Frame m_frames[2];
+
+        std::vector<Request> m_slots;      // power-of-two size, linear probing
+        size_t               m_open = 0;
+        std::deque<Request>  m_order;      // requests in send order; seq mode: the open ones
+        uint64_t             m_serial = 0;
+
+        std::deque<TypeStats>                     m_types;   // deque: histograms cannot move
+        std::unordered_map<std::string, uint32_t> m_typeIndex;
+        uint64_t                                  m_requests = 0;
+        uint64_t                                  m_untracked = 0;   // requests without an ID
+        uint64_t                                  m_unsolicited = 0;
+        std::vector<Listed>                       m_timeoutList;
+        std::vector<Listed>                       m_unsolicitedList;
+    };
+}
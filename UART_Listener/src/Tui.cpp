@@ -0,0 +1,589 @@
+/**
+ ****************************************************************************************
+ * @file   Tui.cpp
+ * @brief  Full-screen terminal view with in-memory scrollback (--tui).
+ *
+ * @author Patrik Neunteufel
+ * @date   Oct 2026
+ ****************************************************************************************
+ */
+#include "Tui.hpp"
+#include "ANSI_support.hpp"
+#include "DataFormat.hpp"
+#include "LogLine.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+#include <cstring>
+
+namespace uart_listener
+{
+    namespace
+    {
+        constexpr size_t kSearchBatch = 256 * 1024;   // bytes compared per scrollback lock while searching
+
+        // Console key codes (_getch)
+        constexpr int kKeyUp = 72;
+        constexpr int kKeyDown = 80;
+        constexpr int kKeyPageUp = 73;
+        constexpr int kKeyPageDown = 81;
+        constexpr int kKeyHome = 71;
+        constexpr int kKeyEnd = 79;
+        constexpr int kKeyEnter = 13;
+        constexpr int kKeyBackspace = 8;
+        constexpr int kKeyEscape = 27;
+
+        const char* const kReverse = "\033[7m";
+        const char* const kReset = "\033[0m";
+
+        /// Search text with the escapes of the c-escape format: \r \n \t \0 \xNN \\ .
+        std::vector<uint8_t> parseNeedle(const std::string& text)
+        {
+            std::vector<uint8_t> out;
+            for (size_t i = 0; i < text.size(); ++i)
+            {
+                if (text[i] != '\\' || i + 1 >= text.size())
+                {
+                    out.push_back(static_cast<uint8_t>(text[i]));
+                    continue;
+                }
+                const char c = text[++i];
+                switch (c)
+                {
+                case 'r': out.push_back('\r'); break;
+                case 'n': out.push_back('\n'); break;
+                case 't': out.push_back('\t'); break;
+                case '0': out.push_back(0); break;
+                case 'x':
+                    if (i + 2 < text.size() && std::isxdigit(static_cast<unsigned char>(text[i + 1]))
+                        && std::isxdigit(static_cast<unsigned char>(text[i + 2])))
+                    {
+                        out.push_back(static_cast<uint8_t>(std::stoul(text.substr(i + 1, 2), nullptr, 16)));
+                        i += 2;
+                        break;
+                    }
+                    out.push_back('x');
+                    break;
+                default: out.push_back(static_cast<uint8_t>(c)); break;
+                }
+            }
+            return out;
+        }
+
+        /// Pad or cut to exactly 'width' columns (the text is plain ASCII).
+        std::string fit(std::string text, size_t width)
+        {
+            text.resize(width, ' ');
+            return text;
+        }
+    }
+
+    // ============================================================================
+    // Scrollback
+    // ============================================================================
+
+    Scrollback::Scrollback(size_t budgetBytes)
+        : m_ring(std::max<size_t>(budgetBytes / 2, kMaxFrameBytes))
+        , m_maxEntries(std::max<size_t>(budgetBytes / 2 / sizeof(Entry), 1024))
+    {
+    }
+
+    void Scrollback::append(Channel channel, PacketKind kind, const std::string& timestamp, const uint8_t* data,
+                            size_t size)
+    {
+        Entry entry{};
+        entry.length = static_cast<uint32_t>(std::min<size_t>(size, UINT32_MAX));
+        size = std::min(size, kMaxFrameBytes);
+        entry.stored = static_cast<uint32_t>(size);
+        entry.channel = channel;
+        entry.kind = kind;
+        std::memcpy(entry.timestamp.data(), timestamp.data(), std::min(timestamp.size(), entry.timestamp.size() - 1));
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+
+        // Make room: the oldest frames go first
+        const uint64_t capacity = m_ring.size();
+        while (!m_index.empty()
+               && (m_index.size() >= m_maxEntries || m_tail + size - m_index.front().offset > capacity))
+        {
+            m_index.pop_front();
+            ++m_first;
+        }
+
+        entry.offset = m_tail;
+        const size_t at = static_cast<size_t>(m_tail % capacity);
+        const size_t head = std::min<size_t>(size, capacity - at);
+        std::memcpy(m_ring.data() + at, data, head);
+        std::memcpy(m_ring.data(), data + head, size - head);
+        m_tail += size;
+        m_index.push_back(entry);
+    }
+
+    void Scrollback::range(uint64_t& first, uint64_t& end) const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        first = m_first;
+        end = m_first + m_index.size();
+    }
+
+    void Scrollback::read(uint64_t offset, size_t size, uint8_t* out) const
+    {
+        const size_t capacity = m_ring.size();
+        const size_t at = static_cast<size_t>(offset % capacity);
+        const size_t head = std::min(size, capacity - at);
+        std::memcpy(out, m_ring.data() + at, head);
+        std::memcpy(out + head, m_ring.data(), size - head);
+    }
+
+    void Scrollback::copy(uint64_t from, size_t count, size_t maxBytes, std::vector<Row>& rows) const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        rows.resize(0);
+        for (uint64_t n = std::max(from, m_first); n < m_first + m_index.size() && rows.size() < count; ++n)
+        {
+            const Entry& entry = m_index[static_cast<size_t>(n - m_first)];
+            Row&         row = rows.emplace_back();
+            row.number = n;
+            row.channel = entry.channel;
+            row.kind = entry.kind;
+            row.timestamp = entry.timestamp;
+            row.length = entry.length;
+            row.data.resize(std::min<size_t>(entry.stored, maxBytes));
+            read(entry.offset, row.data.size(), row.data.data());
+        }
+    }
+
+    std::optional<uint64_t> Scrollback::search(const std::vector<uint8_t>& needle, int64_t& cursor, bool older,
+                                               size_t maxBytes) const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        const int64_t first = static_cast<int64_t>(m_first);
+        const int64_t end = first + static_cast<int64_t>(m_index.size());
+        cursor = std::clamp<int64_t>(cursor, first - 1, end);
+
+        const size_t capacity = m_ring.size();
+        std::vector<uint8_t> wrapped;
+        for (size_t done = 0; done < maxBytes && cursor >= first && cursor < end;)
+        {
+            const Entry&  entry = m_index[static_cast<size_t>(cursor - first)];
+            const int64_t number = cursor;
+            cursor += older ? -1 : 1;
+            done += entry.stored + 1;
+
+            if (entry.stored < needle.size())
+            {
+                continue;
+            }
+
+            // In place unless the frame wraps around the end of the ring
+            const size_t   at = static_cast<size_t>(entry.offset % capacity);
+            const uint8_t* bytes = m_ring.data() + at;
+            if (at + entry.stored > capacity)
+            {
+                wrapped.resize(entry.stored);
+                read(entry.offset, entry.stored, wrapped.data());
+                bytes = wrapped.data();
+            }
+            if (std::search(bytes, bytes + entry.stored, needle.begin(), needle.end()) != bytes + entry.stored)
+            {
+                return static_cast<uint64_t>(number);
+            }
+        }
+        return std::nullopt;
+    }
+
+    // ============================================================================
+    // Tui
+    // ============================================================================
+
+    Tui::Tui(const TuiOptions& options, OutputFormat format, bool timestamps, std::string rxColor,
+             std::string txColor, std::string title)
+        : m_options(options)
+        , m_textFormat(format == OutputFormat::Ascii ? OutputFormat::Ascii : OutputFormat::CEscape)
+        , m_timestamps(timestamps)
+        , m_rxColor(std::move(rxColor))
+        , m_txColor(std::move(txColor))
+        , m_title(std::move(title))
+        , m_scrollback(static_cast<size_t>(options.scrollbackMb) * 1024 * 1024)
+        , m_hex(format == OutputFormat::Hex)
+    {
+        m_options.fps = std::clamp<uint32_t>(m_options.fps, 1, 60);
+    }
+
+    Tui::~Tui()
+    {
+        stop();
+    }
+
+    void Tui::start()
+    {
+        if (m_running.exchange(true))
+        {
+            return;
+        }
+        // Alternate screen buffer, cursor hidden; the normal screen comes back on stop()
+        std::fputs("\033[?1049h\033[?25l\033[2J", stdout);
+        std::fflush(stdout);
+        m_thread = std::thread(&Tui::renderLoop, this);
+    }
+
+    void Tui::stop()
+    {
+        if (!m_running.exchange(false))
+        {
+            return;
+        }
+        m_wake.notify_all();
+        if (m_thread.joinable())
+        {
+            m_thread.join();
+        }
+        std::fputs("\033[0m\033[?25h\033[?1049l", stdout);
+        std::fflush(stdout);
+    }
+
+    void Tui::append(const Packet& pkt, const std::string& message)
+    {
+        if (pkt.kind == PacketKind::Data)
+        {
+            m_scrollback.append(pkt.channel, pkt.kind, pkt.timestamp, pkt.data.data(), pkt.data.size());
+        }
+        else
+        {
+            m_scrollback.append(pkt.channel, pkt.kind, pkt.timestamp,
+                                reinterpret_cast<const uint8_t*>(message.data()), message.size());
+        }
+        m_dirty.store(true, std::memory_order_relaxed);
+    }
+
+    void Tui::setStatus(const std::string& line)
+    {
+        std::lock_guard<std::mutex> lock(m_viewMutex);
+        m_status = line;
+        m_dirty.store(true, std::memory_order_relaxed);
+    }
+
+    bool Tui::onKey(int key, bool extended)
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_viewMutex);
+
+            // Scrolling while following freezes the view where it is
+            auto scroll = [&](int64_t delta) {
+                m_follow = false;
+                m_top += delta;
+            };
+
+            if (m_editing)
+            {
+                if (extended)
+                {
+                    return true;
+                }
+                if (key == kKeyEscape)
+                {
+                    m_editing = false;
+                }
+                else if (key == kKeyEnter)
+                {
+                    m_editing = false;
+                    m_hit.reset();
+                    m_searchPending = !m_query.empty();
+                    m_searchOlder = true;
+                }
+                else if (key == kKeyBackspace)
+                {
+                    if (!m_query.empty())
+                    {
+                        m_query.pop_back();
+                    }
+                }
+                else if (key >= 32 && key < 127)
+                {
+                    m_query += static_cast<char>(key);
+                }
+            }
+            else if (extended)
+            {
+                const int64_t page = std::max(1, m_pageRows.load(std::memory_order_relaxed) - 1);
+                switch (key)
+                {
+                case kKeyUp: scroll(-1); break;
+                case kKeyDown: scroll(1); break;
+                case kKeyPageUp: scroll(-page); break;
+                case kKeyPageDown: scroll(page); break;
+                case kKeyHome: m_follow = false; m_top = 0; break;
+                case kKeyEnd: m_follow = true; m_hit.reset(); break;
+                default: return true;
+                }
+            }
+            else
+            {
+                switch (key)
+                {
+                case ' ':
+                case 'p':
+                case 'P':
+                    m_follow = !m_follow;
+                    if (m_follow)
+                    {
+                        m_hit.reset();
+                    }
+                    break;
+                case 'h':
+                case 'H':
+                    m_hex = !m_hex;
+                    break;
+                case '/':
+                    m_editing = true;
+                    m_query.clear();
+                    m_notice.clear();
+                    break;
+                case 'n':
+                case 'N':
+                    if (m_query.empty())
+                    {
+                        return true;
+                    }
+                    m_searchPending = true;
+                    m_searchOlder = (key == 'n');
+                    break;
+                default:
+                    return false;
+                }
+            }
+            m_dirty.store(true, std::memory_order_relaxed);
+        }
+        m_wake.notify_all();
+        return true;
+    }
+
+    void Tui::renderLoop()
+    {
+        const auto period = std::chrono::milliseconds(1000 / m_options.fps);
+        auto       lastFull = std::chrono::steady_clock::now();
+
+        while (m_running.load())
+        {
+            {
+                std::unique_lock<std::mutex> lock(m_wakeMutex);
+                m_wake.wait_for(lock, period);
+            }
+            if (!m_running.load())
+            {
+                break;
+            }
+
+            runSearch();
+
+            // A full redraw now and then repairs lines overwritten by other output
+            const auto now = std::chrono::steady_clock::now();
+            const bool full = now - lastFull >= std::chrono::seconds(1);
+            render(full);
+            if (full)
+            {
+                lastFull = now;
+            }
+        }
+    }
+
+    void Tui::runSearch()
+    {
+        std::vector<uint8_t> needle;
+        bool                 older = true;
+        int64_t              cursor = 0;
+        {
+            std::lock_guard<std::mutex> lock(m_viewMutex);
+            if (!m_searchPending)
+            {
+                return;
+            }
+            m_searchPending = false;
+            needle = parseNeedle(m_query);
+            older = m_searchOlder;
+
+            uint64_t first = 0;
+            uint64_t end = 0;
+            m_scrollback.range(first, end);
+            if (m_hit.has_value())
+            {
+                cursor = static_cast<int64_t>(*m_hit) + (older ? -1 : 1);
+            }
+            else
+            {
+                // From the bottom row on screen towards older frames
+                cursor = m_follow ? static_cast<int64_t>(end) - 1 : m_top + m_pageRows.load() - 1;
+            }
+        }
+
+        // Batches, so that the consumer is never held up for more than one of them
+        std::optional<uint64_t> hit;
+        while (!hit.has_value())
+        {
+            hit = m_scrollback.search(needle, cursor, older, kSearchBatch);
+            uint64_t first = 0;
+            uint64_t end = 0;
+            m_scrollback.range(first, end);
+            if (cursor < static_cast<int64_t>(first) || cursor >= static_cast<int64_t>(end))
+            {
+                break;
+            }
+        }
+
+        std::lock_guard<std::mutex> lock(m_viewMutex);
+        if (hit.has_value())
+        {
+            m_hit = hit;
+            m_follow = false;
+            m_top = static_cast<int64_t>(*hit) - m_pageRows.load() / 2;
+            m_notice.clear();
+        }
+        else
+        {
+            m_notice = std::string("Not found ") + (older ? "above" : "below") + ": " + m_query;
+        }
+        m_dirty.store(true, std::memory_order_relaxed);
+    }
+
+    void Tui::render(bool force)
+    {
+        if (!m_dirty.exchange(false) && !force)
+        {
+            return;
+        }
+
+        int columns = 80;
+        int lines = 25;
+        getConsoleWindowSize(columns, lines);
+        const size_t width = static_cast<size_t>(std::max(columns, 20));
+
+        // Snapshot of the view state; the frames are copied without holding it
+        bool                    hex;
+        bool                    follow;
+        bool                    editing;
+        int64_t                 top;
+        std::string             query;
+        std::string             notice;
+        std::string             status;
+        std::optional<uint64_t> hit;
+        uint64_t                first = 0;
+        uint64_t                end = 0;
+        int                     bodyRows = 0;
+        {
+            std::lock_guard<std::mutex> lock(m_viewMutex);
+            status = m_status;
+            bodyRows = std::max(1, lines - 2 - (status.empty() ? 0 : 1));
+            m_pageRows.store(bodyRows, std::memory_order_relaxed);
+
+            m_scrollback.range(first, end);
+            const int64_t lastTop = std::max<int64_t>(static_cast<int64_t>(first), static_cast<int64_t>(end) - bodyRows);
+            m_top = m_follow ? lastTop : std::clamp<int64_t>(m_top, static_cast<int64_t>(first), lastTop);
+
+            hex = m_hex;
+            follow = m_follow;
+            editing = m_editing;
+            top = m_top;
+            query = m_query;
+            notice = m_notice;
+            hit = m_hit;
+        }
+
+        // Hex needs three columns per byte, text at least one
+        std::vector<Scrollback::Row>& rows = m_rows;
+        m_scrollback.copy(static_cast<uint64_t>(top), static_cast<size_t>(bodyRows), hex ? width / 3 + 1 : width, rows);
+
+        std::string screen;
+        screen.reserve(width * static_cast<size_t>(lines + 2) * 2);
+        screen += "\033[H";
+
+        // Header
+        std::string header = " UART Listener  " + m_title + "  | frames " + std::to_string(end);
+        if (first > 0)
+        {
+            header += " (" + std::to_string(first) + " dropped)";
+        }
+        header += follow ? "  | LIVE" : "  | FROZEN at " + std::to_string(top);
+        header += "  | " + std::string(hex ? "hex" : OutputFormatTraits::toString(m_textFormat));
+        screen += kReverse + fit(header, width) + kReset + "\r\n";
+        if (!status.empty())
+        {
+            screen += fit(status, width) + "\033[K\r\n";
+        }
+
+        // Body: one frame per row, cut at the right edge
+        for (int i = 0; i < bodyRows; ++i)
+        {
+            if (static_cast<size_t>(i) < rows.size())
+            {
+                const Scrollback::Row& row = rows[static_cast<size_t>(i)];
+                const bool             isHit = hit.has_value() && *hit == row.number;
+                const char*            tag = channelTag(row.channel);
+                const std::string&     color = (row.channel == Channel::RX) ? m_rxColor : m_txColor;
+
+                std::string prefix;
+                if (m_timestamps)
+                {
+                    prefix = std::string(row.timestamp.data()) + " ";
+                }
+                const size_t used = prefix.size() + std::strlen(tag) + 1;
+
+                std::string payload;
+                if (row.kind != PacketKind::Data)
+                {
+                    payload.assign(row.data.begin(), row.data.end());
+                }
+                else
+                {
+                    payload = formatData(row.data.data(), row.data.size(), hex ? OutputFormat::Hex : m_textFormat);
+                }
+                const size_t room = (width > used) ? width - used : 0;
+                if (payload.size() > room || (row.length > row.data.size() && payload.size() >= room))
+                {
+                    payload.resize(room > 0 ? room - 1 : 0);
+                    payload += '>';
+                }
+
+                if (isHit)
+                {
+                    screen += kReverse + prefix + tag + " " + payload + kReset;
+                }
+                else
+                {
+                    screen += prefix;
+                    screen += color.empty() ? std::string(tag) : color + tag + kReset;
+                    screen += " ";
+                    if (row.kind != PacketKind::Data)
+                    {
+                        screen += (row.kind == PacketKind::Reconnect) ? "\033[93m" : "\033[91m";
+                        screen += payload + kReset;
+                    }
+                    else
+                    {
+                        screen += payload;
+                    }
+                }
+            }
+            screen += "\033[K\r\n";
+        }
+
+        // Footer: search input, last search result or key help
+        std::string footer;
+        if (editing)
+        {
+            footer = "/" + query + "_";
+        }
+        else if (!notice.empty())
+        {
+            footer = notice;
+        }
+        else
+        {
+            footer = " Up/Dn PgUp/PgDn Home/End scroll | Space freeze | H hex/text | / search, n/N older/newer | Q quit";
+        }
+        screen += kReverse + fit(footer, width) + kReset;
+
+        std::fwrite(screen.data(), 1, screen.size(), stdout);
+        std::fflush(stdout);
+    }
+}
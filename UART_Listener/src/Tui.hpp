@@ -0,0 +1,186 @@
+/**
+ ****************************************************************************************
+ * @file   Tui.hpp
+ * @brief  Full-screen terminal view with in-memory scrollback (--tui).
+ *
+ *         The consumer thread appends every displayed packet to a scrollback of
+ *         indexed frames: raw bytes in a fixed ring, one small index entry per
+ *         frame. A render thread draws only the rows that fit on the screen, at
+ *         a fixed frame rate, into the alternate screen buffer. The consumer
+ *         holds the scrollback lock for a memcpy; formatting and console output
+ *         happen in the render thread, so a slow console never backs up into
+ *         the capture or the log.
+ *
+ *         Keys: arrows / PgUp / PgDn / Home / End scroll, Space freezes the
+ *         view while the capture continues, H toggles hex and text, / searches
+ *         older frames, n / N jump to the next older / newer match.
+ *
+ * @author Patrik Neunteufel
+ * @date   Oct 2026
+ ****************************************************************************************
+ */
+#pragma once
+
+#include "Format.hpp"
+#include "UART.hpp"
+
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace uart_listener
+{
+    struct TuiOptions
+    {
+        bool     enabled = false;
+        uint32_t scrollbackMb = 256;   // bytes and index together
+        uint32_t fps = 20;
+    };
+
+    /**
+     * @brief Bounded store of frames, addressed by a running frame number.
+     *
+     * Half of the budget holds the bytes in a ring, the other half the index;
+     * when either is full the oldest frames are dropped. All methods lock; each
+     * call does a bounded amount of work so that append() never waits long.
+     */
+    class Scrollback
+    {
+    public:
+        static constexpr size_t kMaxFrameBytes = 64 * 1024;   // longer packets are cut
+
+        struct Row
+        {
+            uint64_t             number = 0;
+            Channel              channel = Channel::RX;
+            PacketKind           kind = PacketKind::Data;
+            std::array<char, 16> timestamp{};
+            uint32_t             length = 0;   // full frame length; data may hold less
+            std::vector<uint8_t> data;
+        };
+
+        explicit Scrollback(size_t budgetBytes);
+
+        void append(Channel channel, PacketKind kind, const std::string& timestamp, const uint8_t* data,
+                    size_t size);
+
+        /** @brief Frame numbers currently held: [first, end). */
+        void range(uint64_t& first, uint64_t& end) const;
+
+        /**
+         * @brief Copy up to 'count' frames starting at 'from', each cut to 'maxBytes'.
+         */
+        void copy(uint64_t from, size_t count, size_t maxBytes, std::vector<Row>& rows) const;
+
+        /**
+         * @brief Look for 'needle' in frames from 'cursor' on, about 'maxBytes' of them.
+         *
+         * Moves 'cursor' past the frames looked at, towards older frames if
+         * 'older' is set; the caller repeats until a hit or the end, so the
+         * lock is released between batches.
+         * @return Number of the matching frame
+         */
+        std::optional<uint64_t> search(const std::vector<uint8_t>& needle, int64_t& cursor, bool older,
+                                       size_t maxBytes) const;
+
+    private:
+        struct Entry
+        {
+            uint64_t             offset;   // absolute byte position in the ring
+            uint32_t             length;   // full frame length
+            uint32_t             stored;   // bytes in the ring, at most kMaxFrameBytes
+            Channel              channel;
+            PacketKind           kind;
+            std::array<char, 16> timestamp;
+        };
+
+        void read(uint64_t offset, size_t size, uint8_t* out) const;
+
+        mutable std::mutex   m_mutex;
+        std::vector<uint8_t> m_ring;
+        size_t               m_maxEntries;
+        std::deque<Entry>    m_index;
+        uint64_t             m_first = 0;   // frame number of m_index.front()
+        uint64_t             m_tail = 0;    // absolute byte position of the next frame
+    };
+
+    class Tui
+    {
+    public:
+        /**
+         * @param format   Initial text view (hex for --format hex, else text)
+         * @param rxColor  ANSI sequence for the [RX] tag, may be empty
+         * @param title    Shown in the header (ports)
+         */
+        Tui(const TuiOptions& options, OutputFormat format, bool timestamps, std::string rxColor,
+            std::string txColor, std::string title);
+        ~Tui();
+
+        Tui(const Tui&) = delete;
+        Tui& operator=(const Tui&) = delete;
+
+        /** @brief Switch to the alternate screen and start rendering. */
+        void start();
+
+        /** @brief Stop rendering and restore the normal screen. */
+        void stop();
+
+        /**
+         * @brief Add a packet (consumer thread).
+         * @param message Text of an event packet (line error, disconnect)
+         */
+        void append(const Packet& pkt, const std::string& message = std::string());
+
+        /** @brief Latest status line, shown in the footer. */
+        void setStatus(const std::string& line);
+
+        /**
+         * @brief Keyboard thread hook.
+         * @param extended Second byte of an arrow / navigation key
+         * @return false for keys the caller handles itself (Q, ESC, T)
+         */
+        bool onKey(int key, bool extended);
+
+    private:
+        void renderLoop();
+        void runSearch();
+        void render(bool force);
+
+        TuiOptions   m_options;
+        OutputFormat m_textFormat;   // ascii or c-escape; H switches to hex and back
+        bool         m_timestamps;
+        std::string  m_rxColor;
+        std::string  m_txColor;
+        std::string  m_title;
+        Scrollback   m_scrollback;
+
+        std::vector<Scrollback::Row> m_rows;   // render thread only
+
+        std::thread             m_thread;
+        std::mutex              m_wakeMutex;
+        std::condition_variable m_wake;
+        std::atomic<bool>       m_running{ false };
+        std::atomic<bool>       m_dirty{ true };
+        std::atomic<int>        m_pageRows{ 20 };   // body rows of the last frame, for PgUp/PgDn
+
+        // View state, changed by the keyboard thread and read by the render thread
+        std::mutex                 m_viewMutex;
+        bool                       m_hex = false;
+        bool                       m_follow = true;
+        int64_t                    m_top = 0;   // first row while not following
+        bool                       m_editing = false;
+        std::string                m_query;
+        bool                       m_searchPending = false;
+        bool                       m_searchOlder = true;
+        std::optional<uint64_t>    m_hit;
+        std::string                m_notice;
+        std::string                m_status;
+    };
+}
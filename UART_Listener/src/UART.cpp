@@ -10,10 +10,84 @@
 
 #include "UART.hpp"
 #include "Globals.hpp"
+#include "Trace.hpp"
+
+#include <algorithm>
 
 namespace uart_listener
 {
-    HANDLE openSerialPortReadOnly(const std::string& portName, uint32_t baudRate)
+    namespace
+    {
+        /**
+         * Applies baud rate, framing and flow control. The baud rate is passed
+         * through as-is; drivers that support BAUD_USER accept non-standard rates
+         * (2, 3, 4, 12 Mbaud), others reject or round them, which is reported.
+         */
+        bool applyLineSettings(HANDLE hSerial, const SerialSettings& settings, const std::string& portName)
+        {
+            DCB dcbSerialParams{};
+            dcbSerialParams.DCBlength = sizeof(dcbSerialParams);
+
+            if (!GetCommState(hSerial, &dcbSerialParams))
+            {
+                std::cerr << "Error reading port parameters: " << portName << "\n";
+                return false;
+            }
+
+            static constexpr BYTE kParity[] = { NOPARITY, ODDPARITY, EVENPARITY, MARKPARITY, SPACEPARITY };
+            static constexpr BYTE kStopBits[] = { ONESTOPBIT, ONE5STOPBITS, TWOSTOPBITS };
+
+            dcbSerialParams.BaudRate = settings.baudRate;
+            dcbSerialParams.ByteSize = settings.dataBits;
+            dcbSerialParams.Parity = kParity[static_cast<size_t>(settings.parity)];
+            dcbSerialParams.StopBits = kStopBits[static_cast<size_t>(settings.stopBits)];
+            dcbSerialParams.fBinary = TRUE;
+            dcbSerialParams.fParity = (settings.parity != Parity::None) ? TRUE : FALSE;
+            dcbSerialParams.fErrorChar = FALSE;
+            dcbSerialParams.fNull = FALSE;
+            dcbSerialParams.fAbortOnError = FALSE;  // errors are polled, reads must keep going
+            dcbSerialParams.fOutX = FALSE;
+            dcbSerialParams.fInX = FALSE;
+
+            // Hardware handshake: the driver drops RTS/DTR once the input queue is
+            // 3/4 full and raises it again below 1/4
+            dcbSerialParams.fOutxCtsFlow = (settings.flowControl == FlowControl::RtsCts) ? TRUE : FALSE;
+            dcbSerialParams.fRtsControl = (settings.flowControl == FlowControl::RtsCts)
+                                              ? RTS_CONTROL_HANDSHAKE
+                                              : RTS_CONTROL_ENABLE;
+            dcbSerialParams.fOutxDsrFlow = (settings.flowControl == FlowControl::DtrDsr) ? TRUE : FALSE;
+            dcbSerialParams.fDtrControl = (settings.flowControl == FlowControl::DtrDsr)
+                                              ? DTR_CONTROL_HANDSHAKE
+                                              : DTR_CONTROL_ENABLE;
+            dcbSerialParams.fDsrSensitivity = FALSE;
+            if (settings.flowControl != FlowControl::None)
+            {
+                const DWORD quarter = settings.inQueueSize / 4;
+                dcbSerialParams.XonLim = static_cast<WORD>(std::min<DWORD>(quarter, 0xFFFF));
+                dcbSerialParams.XoffLim = static_cast<WORD>(std::min<DWORD>(quarter, 0xFFFF));
+            }
+
+            if (!SetCommState(hSerial, &dcbSerialParams))
+            {
+                std::cerr << "Error setting port parameters: " << portName
+                          << " (" << settings.describe() << ", Error code: " << GetLastError() << ")\n";
+                return false;
+            }
+
+            // Some drivers accept any rate and silently use the nearest supported one
+            DCB applied{};
+            applied.DCBlength = sizeof(applied);
+            if (GetCommState(hSerial, &applied) && applied.BaudRate != settings.baudRate)
+            {
+                std::cerr << "Warning: " << portName << " runs at " << applied.BaudRate
+                          << " baud instead of " << settings.baudRate << "\n";
+            }
+
+            return true;
+        }
+    }
+
+    HANDLE openSerialPortReadOnly(const std::string& portName, const SerialSettings& settings, bool reportMissing)
     {
         HANDLE hSerial = CreateFileA(
             portName.c_str(),
@@ -27,49 +101,137 @@ namespace uart_listener
         if (hSerial == INVALID_HANDLE_VALUE)
         {
             DWORD err = GetLastError();
-            std::cerr << "Error opening port " << portName
-                << " (Error code: " << err << ")\n";
+            if (reportMissing || err != ERROR_FILE_NOT_FOUND)
+            {
+                std::cerr << "Error opening port " << portName
+                    << " (Error code: " << err << ")\n";
+            }
             return INVALID_HANDLE_VALUE;
         }
 
-        DCB dcbSerialParams{};
-        dcbSerialParams.DCBlength = sizeof(dcbSerialParams);
+        // Larger driver queue absorbs bursts while the reader is descheduled;
+        // must precede SetCommState, which validates the handshake limits against it
+        if (!SetupComm(hSerial, settings.inQueueSize, 4096))
+        {
+            std::cerr << "Warning: SetupComm(" << settings.inQueueSize << ") failed on " << portName
+                      << " (Error code: " << GetLastError() << ")\n";
+        }
 
-        if (!GetCommState(hSerial, &dcbSerialParams))
+        if (!applyLineSettings(hSerial, settings, portName))
         {
-            std::cerr << "Error reading port parameters: " << portName << "\n";
             CloseHandle(hSerial);
             return INVALID_HANDLE_VALUE;
         }
 
-        dcbSerialParams.BaudRate = baudRate;
-        dcbSerialParams.ByteSize = 8;
-        dcbSerialParams.StopBits = ONESTOPBIT;
-        dcbSerialParams.Parity = NOPARITY;
+        // Start from a clean error state so the first poll only reports new errors
+        DWORD errors = 0;
+        ClearCommError(hSerial, &errors, nullptr);
+
+        // Timeouts for overlapped mode: return as soon as at least one byte is
+        // available, or after 250 ms on an idle line (MAXDWORD/MAXDWORD/constant).
+        // All-zero totals would complete every read immediately and spin the reader.
+        COMMTIMEOUTS timeouts{};
+        timeouts.ReadIntervalTimeout = MAXDWORD;
+        timeouts.ReadTotalTimeoutMultiplier = MAXDWORD;
+        timeouts.ReadTotalTimeoutConstant = 250;
+        SetCommTimeouts(hSerial, &timeouts);
+
+        return hSerial;
+    }
 
-        if (!SetCommState(hSerial, &dcbSerialParams))
+    HANDLE openSerialPortWriteOnly(const std::string& portName, const SerialSettings& settings)
+    {
+        HANDLE hSerial = CreateFileA(
+            portName.c_str(),
+            GENERIC_WRITE,
+            0,
+            nullptr,
+            OPEN_EXISTING,
+            0,
+            nullptr);
+
+        if (hSerial == INVALID_HANDLE_VALUE)
+        {
+            DWORD err = GetLastError();
+            std::cerr << "Error opening port " << portName
+                << " (Error code: " << err << ")\n";
+            return INVALID_HANDLE_VALUE;
+        }
+
+        if (!applyLineSettings(hSerial, settings, portName))
         {
-            std::cerr << "Error setting port parameters: " << portName << "\n";
             CloseHandle(hSerial);
             return INVALID_HANDLE_VALUE;
         }
 
-        // Timeouts for overlapped mode
+        // Blocking writes, but never hang forever on a stalled port
         COMMTIMEOUTS timeouts{};
-        timeouts.ReadIntervalTimeout = MAXDWORD;
-        timeouts.ReadTotalTimeoutConstant = 0;
-        timeouts.ReadTotalTimeoutMultiplier = 0;
+        timeouts.WriteTotalTimeoutConstant = 1000;
+        timeouts.WriteTotalTimeoutMultiplier = 0;
         SetCommTimeouts(hSerial, &timeouts);
 
         return hSerial;
     }
 
+    bool pollLineStatus(HANDLE hSerial, LineStatus& status)
+    {
+        DWORD   errors = 0;
+        COMSTAT stat{};
+        if (!ClearCommError(hSerial, &errors, &stat))
+        {
+            return false;
+        }
+
+        status.errors = 0;
+        if (errors & CE_OVERRUN)  status.errors |= line_error::Overrun;
+        if (errors & CE_RXOVER)   status.errors |= line_error::RxOverflow;
+        if (errors & CE_FRAME)    status.errors |= line_error::Framing;
+        if (errors & CE_RXPARITY) status.errors |= line_error::Parity;
+        if (errors & CE_BREAK)    status.errors |= line_error::Break;
+        status.queuedBytes = stat.cbInQue;
+        return true;
+    }
+
+    const char* lineErrorName(size_t index)
+    {
+        static constexpr const char* kNames[line_error::kTypes] =
+        {
+            "overrun", "rx-overflow", "framing", "parity", "break"
+        };
+        return index < line_error::kTypes ? kNames[index] : "unknown";
+    }
+
+    std::string describeLineErrors(uint32_t errors)
+    {
+        std::string text;
+        for (size_t i = 0; i < line_error::kTypes; ++i)
+        {
+            if (errors & (1u << i))
+            {
+                if (!text.empty())
+                {
+                    text += ", ";
+                }
+                text += lineErrorName(i);
+            }
+        }
+        return text;
+    }
 
     void PacketQueue::push(Packet&& pkt)
     {
+        UART_TRACE_SCOPE("queue.push");
+        pkt.enqueueTime = std::chrono::steady_clock::now();
         {
             std::lock_guard<std::mutex> lock(m_mutex);
             m_queue.push_back(std::move(pkt));
+
+            const size_t depth = m_queue.size();
+            m_depth.store(depth, std::memory_order_relaxed);
+            if (depth > m_highWater.load(std::memory_order_relaxed))
+            {
+                m_highWater.store(depth, std::memory_order_relaxed);
+            }
         }
         m_cv.notify_one();
     }
@@ -78,9 +240,14 @@ namespace uart_listener
     {
         std::unique_lock<std::mutex> lock(m_mutex);
 
-        if (!m_cv.wait_for(lock, timeout, [this] {
-            return g_stopRequested.load() || !m_queue.empty();
-            }))
+        bool ready = false;
+        {
+            UART_TRACE_SCOPE("queue.wait");
+            ready = m_cv.wait_for(lock, timeout, [this] {
+                return g_stopRequested.load() || !m_queue.empty();
+                });
+        }
+        if (!ready)
         {
             return false; // Timeout
         }
@@ -90,8 +257,10 @@ namespace uart_listener
             return false;
         }
 
+        UART_TRACE_SCOPE("queue.pop");
         out = std::move(m_queue.front());
         m_queue.pop_front();
+        m_depth.store(m_queue.size(), std::memory_order_relaxed);
         return true;
     }
 
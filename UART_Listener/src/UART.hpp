@@ -9,6 +9,9 @@
  */
 #pragma once
 
+#include "SerialSettings.hpp"
+
+#include <atomic>
 #include <deque>
 #include <chrono>
 #include <condition_variable>
@@ -21,7 +24,51 @@
 
 namespace uart_listener
 {
-    HANDLE openSerialPortReadOnly(const std::string& portName, uint32_t baudRate);
+    /**
+     * @brief Open a port for overlapped reading with the given line settings.
+     * @param reportMissing Print an error if the port does not exist (off while reconnecting)
+     */
+    HANDLE openSerialPortReadOnly(const std::string& portName, const SerialSettings& settings,
+                                  bool reportMissing = true);
+
+    /**
+     * @brief Open a port for synchronous writing (test traffic, loopback benchmarks).
+     */
+    HANDLE openSerialPortWriteOnly(const std::string& portName, const SerialSettings& settings);
+
+    // ============================================================================
+    // Line errors
+    // ============================================================================
+
+    /// Error flags reported by ClearCommError, in the order of lineErrorName()
+    namespace line_error
+    {
+        constexpr uint32_t Overrun    = 1u << 0;  // CE_OVERRUN: UART FIFO overrun
+        constexpr uint32_t RxOverflow = 1u << 1;  // CE_RXOVER: driver input queue full
+        constexpr uint32_t Framing    = 1u << 2;  // CE_FRAME
+        constexpr uint32_t Parity     = 1u << 3;  // CE_RXPARITY
+        constexpr uint32_t Break      = 1u << 4;  // CE_BREAK
+        constexpr size_t   kTypes     = 5;
+    }
+
+    struct LineStatus
+    {
+        uint32_t errors = 0;       // line_error flags since the previous poll
+        uint32_t queuedBytes = 0;  // bytes waiting in the driver input queue
+    };
+
+    /**
+     * @brief Read and clear the driver's error state (ClearCommError).
+     *
+     * Windows reports which errors occurred since the last call, not how often;
+     * each poll with a flag set counts as one error event.
+     */
+    bool pollLineStatus(HANDLE hSerial, LineStatus& status);
+
+    const char* lineErrorName(size_t index);
+
+    /** @brief Comma separated error names, e.g. "overrun, framing". */
+    std::string describeLineErrors(uint32_t errors);
 
     // ============================================================================
     // Packet Queue (Thread-Safe)
@@ -33,11 +80,36 @@ namespace uart_listener
         TX
     };
 
+    enum class PacketKind : uint8_t
+    {
+        Data = 0,
+        LineError,    // driver reported line errors; data is empty
+        Disconnect,   // port vanished (adapter unplugged); data is empty
+        Reconnect     // port reopened after a Disconnect; data is empty
+    };
+
+    /// One driver read inside a coalesced packet
+    struct PacketSegment
+    {
+        uint32_t offset = 0;   // first byte of this read in Packet::data
+        uint32_t deltaUs = 0;  // read time relative to Packet::readTime
+    };
+
     struct Packet
     {
+        PacketKind           kind = PacketKind::Data;
         Channel              channel{};
         std::string          timestamp{};
         std::vector<uint8_t> data{};
+        std::vector<PacketSegment> segments{};  // per-read sub-records; empty = single read
+
+        std::chrono::steady_clock::time_point readTime{};     // ReadFile completed
+        std::chrono::steady_clock::time_point enqueueTime{};  // set by PacketQueue::push
+
+        uint32_t lineErrors = 0;     // PacketKind::LineError: line_error flags
+        uint32_t errorWindowMs = 0;  // errors occurred within this many ms before timestamp
+        uint32_t systemError = 0;    // PacketKind::Disconnect: Win32 error of the failed read
+        uint32_t outageMs = 0;       // PacketKind::Reconnect: time since the Disconnect
     };
 
     class PacketQueue
@@ -49,9 +121,14 @@ namespace uart_listener
 
         void notifyStop();
 
+        size_t depth() const noexcept { return m_depth.load(std::memory_order_relaxed); }
+        size_t highWater() const noexcept { return m_highWater.load(std::memory_order_relaxed); }
+
     private:
         std::mutex              m_mutex;
         std::condition_variable m_cv;
         std::deque<Packet>      m_queue;
+        std::atomic<size_t>     m_depth{ 0 };
+        std::atomic<size_t>     m_highWater{ 0 };
     };
 }
\ No newline at end of file
@@ -10,32 +10,185 @@
 #include "Worker.hpp"
 #include "Time.hpp"
 #include "Globals.hpp"
+#include "Trace.hpp"
 
+#include <algorithm>
 #include <conio.h>
 
 namespace uart_listener
 {
+    namespace
+    {
+        void dumpTraceOnDemand()
+        {
+            if (trace::dump())
+            {
+                std::cout << "\n[TRACE] Written to " << trace::outputPath() << "\n" << std::flush;
+            }
+            else
+            {
+                std::cerr << "\n[TRACE] Failed to write " << trace::outputPath() << "\n";
+            }
+        }
+    }
 
-    void serialReaderThread(HANDLE hSerial, Channel channel)
+    void serialReaderThread(HANDLE hSerial, Channel channel, ReaderOptions options)
     {
+        UART_TRACE_THREAD_NAME(channel == Channel::RX ? "RX reader" : "TX reader");
+
         constexpr size_t     kBufferSize = 512;
+        constexpr DWORD      kLineStatusPollMs = 250;
         std::vector<uint8_t> buffer(kBufferSize);
 
+        CoalesceOptions& coalesce = options.coalesce;
+
         // Create overlapped event for this thread
         HANDLE hReadEvent = CreateEvent(nullptr, TRUE, FALSE, nullptr);
         if (hReadEvent == NULL)
         {
             std::cerr << "Failed to create read event\n";
+            CloseHandle(hSerial);
             return;
         }
 
+        // Flush timer for coalesced packets; the default timer resolution (~15 ms)
+        // is far coarser than the latency budget, so ask for a high resolution one
+        HANDLE hFlushTimer = NULL;
+        if (coalesce.enabled())
+        {
+            hFlushTimer = CreateWaitableTimerExW(nullptr, nullptr,
+                                                 CREATE_WAITABLE_TIMER_HIGH_RESOLUTION, TIMER_ALL_ACCESS);
+            if (hFlushTimer == NULL)
+            {
+                std::cerr << "Warning: No high resolution timer, read coalescing disabled\n";
+                coalesce.maxBytes = 0;
+            }
+        }
+
         OVERLAPPED ov{};
         ov.hEvent = hReadEvent;
 
-        HANDLE waitHandles[2] = { g_hStopEvent, hReadEvent };
+        HANDLE waitHandles[3] = { g_hStopEvent, hReadEvent, hFlushTimer };
+
+        ChannelCounters& counters = g_metrics.channel(channel);
+        ReadCoalescer    coalescer(channel, coalesce);
+
+        auto flushPending = [&]()
+        {
+            if (!coalescer.hasPending())
+            {
+                return;
+            }
+            Packet     pkt = coalescer.take();
+            const auto readTime = pkt.readTime;
+            g_packetQueue.push(std::move(pkt));
+            counters.readToEnqueue.record(std::chrono::steady_clock::now() - readTime);
+        };
+
+        auto pushEvent = [&](Packet&& event)
+        {
+            event.channel = channel;
+            event.timestamp = getTimestampWithMs();
+            event.readTime = std::chrono::steady_clock::now();
+            g_packetQueue.push(std::move(event));
+        };
+
+        // Line errors are polled after every read and while the line is idle;
+        // an error event covers the time since the previous poll
+        auto lastPoll = std::chrono::steady_clock::now();
+        auto checkLineStatus = [&]()
+        {
+            LineStatus status;
+            if (!pollLineStatus(hSerial, status))
+            {
+                return;
+            }
+
+            const auto now = std::chrono::steady_clock::now();
+            counters.recordLineStatus(status);
+
+            if (status.errors != 0)
+            {
+                // Keep the event behind the data that was read before it
+                flushPending();
+
+                Packet event;
+                event.kind = PacketKind::LineError;
+                event.lineErrors = status.errors;
+                event.errorWindowMs = static_cast<uint32_t>(
+                    std::chrono::duration_cast<std::chrono::milliseconds>(now - lastPoll).count());
+                pushEvent(std::move(event));
+            }
+            lastPoll = now;
+        };
+
+        // A failed read means the device is gone (or the driver gave up on it).
+        // Without reconnect this ends the whole capture, as before.
+        auto disconnectedAt = std::chrono::steady_clock::now();
+        auto portLost = [&](DWORD err) -> bool
+        {
+            flushPending();
+
+            if (options.reconnectMaxMs == 0)
+            {
+                std::cerr << "\nSerial read error (code: " << err << ")\n";
+                g_stopRequested.store(true);
+                SetEvent(g_hStopEvent);
+                g_packetQueue.notifyStop();
+                return false;
+            }
+
+            CloseHandle(hSerial);
+            hSerial = INVALID_HANDLE_VALUE;
+            disconnectedAt = std::chrono::steady_clock::now();
+            counters.recordDisconnect();
+
+            Packet event;
+            event.kind = PacketKind::Disconnect;
+            event.systemError = err;
+            pushEvent(std::move(event));
+            return true;
+        };
+
+        // Reopen quickly at first (re-enumeration usually takes a few hundred ms),
+        // then back off so an adapter that stays away costs nothing
+        auto reconnect = [&]() -> bool
+        {
+            DWORD delayMs = 0;
+            for (;;)
+            {
+                if (WaitForSingleObject(g_hStopEvent, delayMs) == WAIT_OBJECT_0 || g_stopRequested.load())
+                {
+                    return false;
+                }
+
+                hSerial = openSerialPortReadOnly(options.portName, options.serial, false);
+                if (hSerial != INVALID_HANDLE_VALUE)
+                {
+                    break;
+                }
+                delayMs = std::min<DWORD>(delayMs == 0 ? 1 : delayMs * 2, options.reconnectMaxMs);
+            }
+
+            const auto now = std::chrono::steady_clock::now();
+            counters.recordReconnect();
+            lastPoll = now;
+
+            Packet event;
+            event.kind = PacketKind::Reconnect;
+            event.outageMs = static_cast<uint32_t>(
+                std::chrono::duration_cast<std::chrono::milliseconds>(now - disconnectedAt).count());
+            pushEvent(std::move(event));
+            return true;
+        };
 
         while (!g_stopRequested.load())
         {
+            if (hSerial == INVALID_HANDLE_VALUE && !reconnect())
+            {
+                break;
+            }
+
             ResetEvent(hReadEvent);
 
             DWORD bytesRead = 0;
@@ -51,8 +204,29 @@ namespace uart_listener
                 DWORD err = GetLastError();
                 if (err == ERROR_IO_PENDING)
                 {
-                    // Wait for either data or stop signal
-                    DWORD waitResult = WaitForMultipleObjects(2, waitHandles, FALSE, INFINITE);
+                    // Wait for data, stop signal or the coalescing deadline;
+                    // check line errors while idle
+                    DWORD waitResult = WAIT_FAILED;
+                    {
+                        UART_TRACE_SCOPE("reader.wait");
+                        for (;;)
+                        {
+                            const DWORD handleCount = coalescer.hasPending() ? 3 : 2;
+                            waitResult = WaitForMultipleObjects(handleCount, waitHandles, FALSE, kLineStatusPollMs);
+                            if (waitResult == WAIT_TIMEOUT)
+                            {
+                                checkLineStatus();
+                            }
+                            else if (waitResult == WAIT_OBJECT_0 + 2)
+                            {
+                                flushPending();
+                            }
+                            else
+                            {
+                                break;
+                            }
+                        }
+                    }
 
                     if (waitResult == WAIT_OBJECT_0)
                     {
@@ -62,15 +236,14 @@ namespace uart_listener
                     }
                     else if (waitResult == WAIT_OBJECT_0 + 1)
                     {
-                        // Read completed
+                        // Read completed (a removed device aborts the pending read)
                         if (!GetOverlappedResult(hSerial, &ov, &bytesRead, FALSE))
                         {
-                            DWORD ovErr = GetLastError();
-                            if (ovErr != ERROR_OPERATION_ABORTED)
+                            if (g_stopRequested.load() || !portLost(GetLastError()))
                             {
-                                std::cerr << "\nOverlapped read error (code: " << ovErr << ")\n";
+                                break;
                             }
-                            break;
+                            continue;
                         }
                     }
                     else
@@ -81,28 +254,57 @@ namespace uart_listener
                 }
                 else
                 {
-                    std::cerr << "\nSerial read error (code: " << err << ")\n";
-                    g_stopRequested.store(true);
-                    SetEvent(g_hStopEvent);
-                    g_packetQueue.notifyStop();
-                    break;
+                    if (!portLost(err))
+                    {
+                        break;
+                    }
+                    continue;
                 }
             }
 
-            if (bytesRead > 0)
+            if (bytesRead == 0)
             {
-                Packet pkt;
-                pkt.channel = channel;
-                pkt.timestamp = getTimestampWithMs();
-                pkt.data.assign(buffer.begin(), buffer.begin() + bytesRead);
-                g_packetQueue.push(std::move(pkt));
+                // Read timed out on an idle line
+                checkLineStatus();
+                continue;
+            }
+
+            UART_TRACE_SCOPE("reader.packet");
+
+            // Errors that came with this chunk are queued ahead of its data
+            checkLineStatus();
+
+            const auto now = std::chrono::steady_clock::now();
+            counters.recordChunk(bytesRead);
+
+            if (coalescer.append(buffer.data(), bytesRead, now))
+            {
+                flushPending();
+            }
+            else if (coalescer.startedPacket())
+            {
+                // Relative due time in 100 ns units
+                LARGE_INTEGER due;
+                due.QuadPart = -static_cast<LONGLONG>(coalesce.budgetUs) * 10;
+                SetWaitableTimer(hFlushTimer, &due, 0, nullptr, nullptr, FALSE);
             }
         }
 
+        // Data read before the stop request still belongs to the capture
+        flushPending();
+
+        if (hSerial != INVALID_HANDLE_VALUE)
+        {
+            CloseHandle(hSerial);
+        }
+        if (hFlushTimer != NULL)
+        {
+            CloseHandle(hFlushTimer);
+        }
         CloseHandle(hReadEvent);
     }
 
-    void keyboardMonitorThread()
+    void keyboardMonitorThread(KeyHandler onKey)
     {
         // Ensure console input is in the right mode for _kbhit/_getch
         HANDLE hIn = GetStdHandle(STD_INPUT_HANDLE);
@@ -122,7 +324,16 @@ namespace uart_listener
                 // Handle extended keys (arrows, function keys return 0 or 0xE0 first)
                 if (key == 0 || key == 0xE0)
                 {
-                    (void)_getch(); // Consume the second byte
+                    const int code = _getch(); // Consume the second byte
+                    if (onKey)
+                    {
+                        onKey(code, true);
+                    }
+                    continue;
+                }
+
+                if (onKey && onKey(key, false))
+                {
                     continue;
                 }
 
@@ -135,6 +346,13 @@ namespace uart_listener
                     break;
                 }
 
+                // 'T' dumps the trace buffers without stopping capture
+                if ((key == 't' || key == 'T') && trace::isEnabled())
+                {
+                    dumpTraceOnDemand();
+                    continue;
+                }
+
                 // Also allow 'q' or 'Q' to quit
                 if (key == 'q' || key == 'Q')
                 {
@@ -200,6 +418,13 @@ namespace uart_listener
                         break;
                     }
 
+                    // 'T' dumps the trace buffers without stopping capture
+                    if ((ch == 't' || ch == 'T') && trace::isEnabled())
+                    {
+                        dumpTraceOnDemand();
+                        continue;
+                    }
+
                     // Also allow 'q' or 'Q'
                     if (ch == 'q' || ch == 'Q')
                     {
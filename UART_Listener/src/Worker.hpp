@@ -9,12 +9,35 @@
  */
 #pragma once
 
+#include "Coalescer.hpp"
+#include "SerialSettings.hpp"
 #include "UART.hpp"
 
+#include <functional>
+#include <string>
+
 namespace uart_listener
 {
-	void serialReaderThread(HANDLE hSerial, Channel channel);
-	void keyboardMonitorThread();
+	struct ReaderOptions
+	{
+		std::string     portName;             // Windows device path (\\.\COMn), used to reopen
+		SerialSettings  serial;
+		CoalesceOptions coalesce;
+		uint32_t        reconnectMaxMs = 200;  // reopen backoff cap; 0 = a lost port stops the capture
+	};
+
+	/**
+	 * @brief Capture loop for one channel; takes ownership of hSerial and closes it.
+	 *
+	 * If the port vanishes (USB adapter unplugged), Disconnect/Reconnect events are
+	 * queued and the port is reopened with exponential backoff while the other
+	 * channel keeps capturing.
+	 */
+	void serialReaderThread(HANDLE hSerial, Channel channel, ReaderOptions options);
+	/// Sees every key first; returns true if it handled the key (--tui navigation)
+	using KeyHandler = std::function<bool(int key, bool extended)>;
+
+	void keyboardMonitorThread(KeyHandler onKey = KeyHandler());
 	// Alternative: Use Windows Console API directly for more reliable key detection
 	void keyboardMonitorThreadWinAPI();
 }
\ No newline at end of file